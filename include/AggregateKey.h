@@ -0,0 +1,149 @@
+#pragma once
+
+#include "GroupTraits.h"
+
+/**
+ * An aggregate of G1 (ECP) or G2 (ECP2) public keys that is kept up to date as members join
+ * and leave, for validator or committee sets that change by a few keys per epoch.
+ *
+ * Every member occupies a slot; slots are the bit positions of signer bitmaps, and slots freed
+ * by remove() are handed out again by later add() calls. The sum of all members is maintained
+ * directly, so add, remove and replace cost one or two point additions. Behind it sits a
+ * segment tree of partial sums over the slots (leaves are the keys, each inner node the sum of
+ * its two children), brought up to date lazily: only the paths above the slots changed since
+ * the last query are recomputed, O(changes * log n) additions.
+ *
+ * aggregate() sums a signer subset from the tree: the bitmap is split into runs of consecutive
+ * signers, and each run costs at most 2 log n node additions. A subset with more signers than
+ * non-signers is summed as the total minus the runs of non-signers instead, so a set that
+ * misses k members costs O(k log n) additions rather than one per signer.
+ *
+ * Derived forms of the total are cached until the next change: its affine form and, on G2,
+ * the precomputed Miller-loop lines MIRACL's PAIR_another_pc takes.
+ *
+ * Not thread-safe.
+ */
+template<typename Point>
+class AggregateKey {
+public:
+    typedef GroupTraits<Point> G;
+    typedef vector<uint64_t> Bitmap;           // bit i (word i / 64, bit i % 64) is slot i
+
+    AggregateKey();
+
+    /**
+     * keys[i] in slot i, with the tree built bottom-up (n - 1 additions)
+     */
+    explicit AggregateKey(const vector<Point> &keys);
+
+    /**
+     * Adds a member
+     * @return Its slot
+     */
+    size_t add(const Point &key);
+
+    /**
+     * Removes the member in a slot
+     * @throws out_of_range if the slot holds no member
+     */
+    void remove(size_t slot);
+
+    /**
+     * Replaces the key of a member (key rotation)
+     * @throws out_of_range if the slot holds no member
+     */
+    void replace(size_t slot, const Point &key);
+
+    bool contains(size_t slot) const { return slot < slots() && (occupied_[slot / 64] >> (slot % 64) & 1); }
+
+    /**
+     * @throws out_of_range if the slot holds no member
+     */
+    const Point &key(size_t slot) const;
+
+    /**
+     * Number of members
+     */
+    size_t size() const { return members_; }
+
+    /**
+     * Number of slots, i.e. the bit width of signer bitmaps
+     */
+    size_t slots() const { return slots_; }
+
+    /**
+     * Slots that hold a member
+     */
+    const Bitmap &members() const { return occupied_; }
+
+    /**
+     * Sum of all members
+     */
+    const Point &total() const { return total_; }
+
+    /**
+     * Sum of the members whose bits are set
+     * @param signers At least slots() bits; bits past slots() are ignored
+     * @throws invalid_argument if a set bit names a slot without a member
+     */
+    Point aggregate(const Bitmap &signers);
+
+    /**
+     * Sum of the members in slots [begin, end)
+     */
+    Point range(size_t begin, size_t end);
+
+    /**
+     * total() in affine coordinates, cached until the next change
+     */
+    const Point &affineTotal();
+
+    /**
+     * Miller-loop lines of total() for PAIR_another_pc (G2 only), cached until the next change
+     * @throws logic_error on G1
+     */
+    const vector<FP4> &prepared();
+
+private:
+    size_t slots_ = 0;                         // slots in use or freed
+    size_t capacity_;                          // leaves of the tree, a power of two >= slots_
+    size_t members_ = 0;
+    vector<Point> tree_;                       // 2 * capacity_ nodes, root at 1, leaves at capacity_
+    Bitmap occupied_;
+    vector<size_t> freeSlots_;
+    vector<size_t> dirty_;                     // tree nodes whose parents are stale
+    Point total_;
+    Point affine_;
+    bool affineValid_ = false;
+    vector<FP4> lines_;
+
+    void setLeaf(size_t slot, const Point &key);
+
+    /**
+     * Recomputes the ancestors of the dirty leaves, one level at a time
+     */
+    void refresh();
+
+    /**
+     * Doubles the capacity: the old tree becomes the left half of the new one, no additions
+     */
+    void grow();
+
+    void addRuns(Point &sum, const Bitmap &bits, bool subtract);
+
+    void checkMember(size_t slot) const;
+
+    void changed() {
+        affineValid_ = false;
+        lines_.clear();
+    }
+};
+
+typedef AggregateKey<ECP> G1AggregateKey;
+typedef AggregateKey<ECP2> G2AggregateKey;
+
+template<>
+const vector<FP4> &AggregateKey<ECP2>::prepared();
+
+extern template class AggregateKey<ECP>;
+extern template class AggregateKey<ECP2>;
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Tools.h"
+
+/**
+ * Instruction-set level of the curve arithmetic behind the wrappers of Tools.h: ECP_mul,
+ * ECP2_mul and FP12_pow with mpz_class exponents, e, pairingProductIsOne, randECP, randECP2 and
+ * hashToPoint.
+ *
+ * On x86-64 the build compiles MIRACL's field, curve and pairing code three times: with the
+ * default flags, for AVX2 + BMI2 + ADX (x86-64-v3 class machines) and for AVX-512. The extra
+ * copies live in renamed namespaces (BLS12381_avx2, BLS12381_avx512, ...), so they link into
+ * the same library without clashing, and all share MIRACL's data layout, so points and GT
+ * elements pass between them unchanged. The level is picked on first use from the running CPU
+ * and its tuning profile (see Tuning.h), unless the environment variable WRAPPER_CURVE_ISA
+ * (baseline, avx2 or avx512) names another supported one. Other builds have the baseline level only.
+ *
+ * Direct calls into MIRACL (ECP_mul(&P, BIG), PAIR_ate, ...) always run the baseline copy.
+ */
+enum class CurveIsa {
+    Baseline,
+    AVX2,
+    AVX512
+};
+
+/**
+ * Level used by the wrappers
+ */
+CurveIsa CurveIsa_active();
+
+/**
+ * Forces a level (tests and benchmarks); a level the build or the CPU lacks falls back to the best available one
+ * @return The level actually selected
+ */
+CurveIsa CurveIsa_set(CurveIsa isa);
+
+/**
+ * Whether a level is built in and the running CPU supports it
+ */
+bool CurveIsa_supported(CurveIsa isa);
+
+/**
+ * Printable level name, as accepted by WRAPPER_CURVE_ISA
+ */
+const char *CurveIsa_name(CurveIsa isa);
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "Tools.h"
+#include <atomic>
+
+/**
+ * Discrete logarithms of small exponents in G1 (ECP) or GT (FP12) by baby-step giant-step,
+ * e.g. to decrypt exponential ElGamal: given T = m * P (T = P^m in GT) with m in [0, range),
+ * find m.
+ *
+ * The table holds the baby steps j * P for j = 1 .. M, keyed by a 64-bit hash of a coordinate
+ * that P and -P share (the affine x in G1; in GT the component that conjugation, the inverse of
+ * the cyclotomic subgroup, leaves alone). A match of T - i * 2M * P therefore stands for
+ * m = i * 2M + j or i * 2M - j, and each giant step covers 2M exponents. Every slot is a single
+ * 64-bit word: 32 bits of the hash and j, in an open-addressing table of 2^k >= 2M slots, so
+ * the table takes 16 to 32 bytes per baby step (256 MB for M = 2^24). The truncated hashes
+ * may collide, so every candidate is confirmed by one short scalar multiplication.
+ *
+ * A query takes about range / 2M giant steps. In G1 they are normalized in blocks with one
+ * shared inversion and their slots prefetched before they are probed. With range = 2^40 and
+ * M = 2^24 that is 2^15 steps per query. The default M = sqrt(range / 2) balances building the
+ * table against a single query; batches of queries want a larger table, since every doubling
+ * of M halves the cost of each query.
+ *
+ * The table is built on all cores and depends only on the base and M, so it can be stored in
+ * a PrecomputeCache (Precompute_addDiscreteLog) and mapped by later processes instead of being
+ * rebuilt. Queries are const and may run concurrently.
+ */
+template<typename Group>
+class DiscreteLog {
+public:
+    /**
+     * Builds the baby-step table of `base`
+     * @param base Generator (a point of prime order in G1, or an element of GT)
+     * @param range Exponents are searched in [0, range), range in [1, 2^62]
+     * @param babySteps Number of baby steps M in [1, 2^32); 0 picks defaultBabySteps(range)
+     * @throws invalid_argument for an unsupported range or number of baby steps
+     */
+    DiscreteLog(const Group &base, uint64_t range, uint64_t babySteps = 0);
+
+    /**
+     * Uses an existing table (e.g. mapped from a PrecomputeCache) without copying it;
+     * the table must outlive this object and must have been built for the same base
+     * @throws invalid_argument if count does not match tableSize(babySteps)
+     */
+    DiscreteLog(const Group &base, uint64_t range, const uint64_t *table, size_t count, uint64_t babySteps);
+
+    DiscreteLog(const DiscreteLog &) = delete;
+
+    DiscreteLog &operator=(const DiscreteLog &) = delete;
+
+    DiscreteLog(DiscreteLog &&) = default;
+
+    DiscreteLog &operator=(DiscreteLog &&) = default;
+
+    /**
+     * The exponent m in [0, range()) with T = m * base, or -1 if there is none
+     * @param threads Worker threads the giant steps are split over; 0 uses every core
+     */
+    int64_t solve(const Group &T, unsigned threads = 1) const;
+
+    /**
+     * solve() of every target; the targets are spread over the workers, and the giant steps of
+     * each target too when there are fewer targets than workers
+     * @param threads Worker threads; 0 uses every core
+     */
+    vector<int64_t> solveBatch(const vector<Group> &targets, unsigned threads = 0) const;
+
+    const Group &base() const { return base_; }
+
+    uint64_t range() const { return range_; }
+
+    uint64_t babySteps() const { return m_; }
+
+    /**
+     * Giant steps of a query that finds nothing (the worst case)
+     */
+    uint64_t giantSteps() const { return giants_; }
+
+    /**
+     * The table (tableSize(babySteps()) slots), e.g. to store it in a PrecomputeCache
+     */
+    const uint64_t *table() const { return table_; }
+
+    /**
+     * Number of table slots for M baby steps
+     */
+    static size_t tableSize(uint64_t babySteps);
+
+    /**
+     * ceil(sqrt(range / 2)): as many baby steps as a query takes giant steps
+     */
+    static uint64_t defaultBabySteps(uint64_t range);
+
+    /**
+     * 64-bit hash of an element, equal for the element and its inverse (the table key); names
+     * the base of a stored table
+     */
+    static uint64_t fingerprint(const Group &x);
+
+private:
+    Group base_;
+    Group giant_;            // -(2M) * base
+    uint64_t range_;
+    uint64_t m_;
+    uint64_t giants_;
+    size_t mask_;
+    vector<uint64_t> own_;
+    const uint64_t *table_;
+
+    void init(const Group &base, uint64_t range, uint64_t babySteps);
+
+    void search(const Group &T, uint64_t lo, uint64_t hi, atomic<int64_t> &found) const;
+};
+
+typedef DiscreteLog<ECP> G1DiscreteLog;
+typedef DiscreteLog<FP12> GTDiscreteLog;
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Tools.h"
+
+/**
+ * Fixed-base scalar multiplication with a precomputed table of 8-bit windows.
+ *
+ * The table of a base point B holds d * 2^(8i) * B for every window i < 32 and digit
+ * d in [1, 255], in affine coordinates (entry i * 255 + d - 1). A multiplication by a scalar
+ * modulo the curve order is then at most 32 point additions and no doublings.
+ * Tables are plain arrays of MIRACL structs, so they can live in a PrecomputeCache.
+ */
+const int FIXED_BASE_WINDOW = 8;
+const int FIXED_BASE_WINDOWS = 32;
+const size_t FIXED_BASE_TABLE_SIZE = (size_t) FIXED_BASE_WINDOWS * 255;
+
+/**
+ * Builds the fixed-base table of a G1 point
+ * @param table Output, resized to FIXED_BASE_TABLE_SIZE
+ * @param base The base point
+ */
+void ECP_fixedBaseTable(vector<ECP> &table, const ECP &base);
+
+/**
+ * Builds the fixed-base table of a G2 point
+ * @param table Output, resized to FIXED_BASE_TABLE_SIZE
+ * @param base The base point
+ */
+void ECP2_fixedBaseTable(vector<ECP2> &table, const ECP2 &base);
+
+/**
+ * k * B from the table of B
+ * @param table FIXED_BASE_TABLE_SIZE entries built by ECP_fixedBaseTable
+ * @param k Scalar, reduced modulo the curve order
+ * @return k * B
+ */
+ECP ECP_mulFixedBase(const ECP *table, BIG k);
+
+/**
+ * k * B from the table of B, for any mpz_class k (reduced modulo the curve order internally)
+ */
+ECP ECP_mulFixedBase(const ECP *table, const mpz_class &k);
+
+/**
+ * k * B from the table of a G2 point B
+ * @param table FIXED_BASE_TABLE_SIZE entries built by ECP2_fixedBaseTable
+ * @param k Scalar, reduced modulo the curve order
+ * @return k * B
+ */
+ECP2 ECP2_mulFixedBase(const ECP2 *table, BIG k);
+
+/**
+ * k * B from the table of a G2 point B, for any mpz_class k
+ */
+ECP2 ECP2_mulFixedBase(const ECP2 *table, const mpz_class &k);
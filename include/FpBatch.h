@@ -0,0 +1,88 @@
+#pragma once
+
+#include "Tools.h"
+
+/**
+ * Batched arithmetic in the BLS12381 base field Fp.
+ *
+ * The SIMD backends run 4 (AVX2) or 8 (AVX-512F) independent field operations side by side on
+ * 29-bit limbs, the exact halves of MIRACL's 58-bit limbs, in MIRACL's own Montgomery form, so
+ * converting to and from FP is a shift and mask per limb. The backend is picked on first use
+ * from the running CPU and its tuning profile (see Tuning.h); the scalar backend is MIRACL itself.
+ *
+ * Every result is fully reduced (XES = 1) and bit-identical to the MIRACL operation followed
+ * by FP_reduce. Inputs may be in any state MIRACL accepts; outputs may alias inputs.
+ */
+enum class FpBackend {
+    Scalar,
+    AVX2,
+    AVX512
+};
+
+/**
+ * Backend used by the FpBatch_* functions
+ */
+FpBackend FpBatch_backend();
+
+/**
+ * Forces a backend (tests and benchmarks); a backend the CPU lacks falls back to the best available one
+ * @return The backend actually selected
+ */
+FpBackend FpBatch_setBackend(FpBackend backend);
+
+/**
+ * Whether the running CPU supports a backend
+ */
+bool FpBatch_supported(FpBackend backend);
+
+/**
+ * Printable backend name
+ */
+const char *FpBatch_backendName(FpBackend backend);
+
+/**
+ * r[i] = a[i] * b[i] for i < n
+ */
+void FpBatch_mul(FP *r, const FP *a, const FP *b, size_t n);
+
+/**
+ * r[i] = a[i]^2 for i < n
+ */
+void FpBatch_sqr(FP *r, const FP *a, size_t n);
+
+/**
+ * r[i] = a[i] + b[i] for i < n
+ */
+void FpBatch_add(FP *r, const FP *a, const FP *b, size_t n);
+
+/**
+ * r[i] = a[i] - b[i] for i < n
+ */
+void FpBatch_sub(FP *r, const FP *a, const FP *b, size_t n);
+
+/**
+ * r[i] = 1 / a[i] for i < n with a single FP_inv (Montgomery's trick); zeros map to zero
+ */
+void FpBatch_inv(FP *r, const FP *a, size_t n);
+
+/**
+ * Converts n G1 points to affine coordinates with one shared inversion.
+ * Each point ends up exactly as ECP_affine would leave it.
+ * @param P Points, converted in place
+ * @param n Number of points
+ */
+void ECP_batchAffine(ECP *P, size_t n);
+
+/**
+ * Converts n G2 points to affine coordinates with one shared inversion.
+ * Each point ends up exactly as ECP2_affine would leave it.
+ * @param P Points, converted in place
+ * @param n Number of points
+ */
+void ECP2_batchAffine(ECP2 *P, size_t n);
+
+/**
+ * eq[i] = (P[i] == Q[i]) for i < n, using the projective cross products of ECP_equals
+ * evaluated in batches
+ */
+void ECP_batchEquals(const ECP *P, const ECP *Q, size_t n, bool *eq);
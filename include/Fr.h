@@ -0,0 +1,201 @@
+#pragma once
+
+#include "Tools.h"
+
+/**
+ * Native arithmetic in Fq, the scalar field of BLS12381 (q = CURVE_Order).
+ *
+ * Elements are four 64-bit limbs in Montgomery form (R = 2^256), so a modular multiplication
+ * is a handful of 64x64->128 multiplies instead of an mpz_class temporary or a BIG_modmul
+ * with a full double-length division. Use it for bulk scalar work (polynomials, sharing,
+ * Lagrange weights) and convert to BIG / mpz_class at the boundaries.
+ */
+struct Fr {
+    uint64_t v[4];
+};
+
+namespace fr_detail {
+    typedef unsigned __int128 u128;
+
+    const uint64_t Q[4] = {0xffffffff00000001ULL, 0x53bda402fffe5bfeULL, 0x3339d80809a1d805ULL, 0x73eda753299d7d48ULL};
+    const uint64_t R1[4] = {0x00000001fffffffeULL, 0x5884b7fa00034802ULL, 0x998c4fefecbc4ff5ULL, 0x1824b159acc5056fULL};
+    const uint64_t R2[4] = {0xc999e990f3f29c6dULL, 0x2b6cedcb87925c23ULL, 0x05d314967254398fULL, 0x0748d9d99f59ff11ULL};
+    const uint64_t QINV = 0xfffffffeffffffffULL;  // -q^-1 mod 2^64
+
+    /**
+     * (carry, lo) = a * b + t + carry
+     */
+    inline void mac(uint64_t &lo, uint64_t &carry, uint64_t a, uint64_t b, uint64_t t) {
+        u128 c = (u128) a * b + t + carry;
+        lo = (uint64_t) c;
+        carry = (uint64_t) (c >> 64);
+    }
+
+    /**
+     * r = a - q if a >= q (a < 2q)
+     */
+    inline void reduceOnce(uint64_t r[4], const uint64_t a[4]) {
+        uint64_t t[4];
+        u128 borrow = 0;
+        for (int i = 0; i < 4; ++i) {
+            u128 d = (u128) a[i] - Q[i] - borrow;
+            t[i] = (uint64_t) d;
+            borrow = (d >> 64) & 1;
+        }
+        uint64_t mask = (uint64_t) 0 - (uint64_t) borrow;  // all ones if a < q
+        for (int i = 0; i < 4; ++i) r[i] = (a[i] & mask) | (t[i] & ~mask);
+    }
+}
+
+inline void Fr_zero(Fr &r) {
+    r.v[0] = r.v[1] = r.v[2] = r.v[3] = 0;
+}
+
+inline void Fr_one(Fr &r) {
+    for (int i = 0; i < 4; ++i) r.v[i] = fr_detail::R1[i];
+}
+
+inline bool Fr_isZero(const Fr &a) {
+    return (a.v[0] | a.v[1] | a.v[2] | a.v[3]) == 0;
+}
+
+inline bool Fr_equals(const Fr &a, const Fr &b) {
+    return ((a.v[0] ^ b.v[0]) | (a.v[1] ^ b.v[1]) | (a.v[2] ^ b.v[2]) | (a.v[3] ^ b.v[3])) == 0;
+}
+
+inline void Fr_add(Fr &r, const Fr &a, const Fr &b) {
+    // a + b < 2q < 2^256, so no carry out of the top limb
+    uint64_t t[4];
+    fr_detail::u128 c = 0;
+    for (int i = 0; i < 4; ++i) {
+        c += (fr_detail::u128) a.v[i] + b.v[i];
+        t[i] = (uint64_t) c;
+        c >>= 64;
+    }
+    fr_detail::reduceOnce(r.v, t);
+}
+
+inline void Fr_sub(Fr &r, const Fr &a, const Fr &b) {
+    uint64_t t[4];
+    fr_detail::u128 borrow = 0;
+    for (int i = 0; i < 4; ++i) {
+        fr_detail::u128 d = (fr_detail::u128) a.v[i] - b.v[i] - borrow;
+        t[i] = (uint64_t) d;
+        borrow = (d >> 64) & 1;
+    }
+    uint64_t mask = (uint64_t) 0 - (uint64_t) borrow;
+    fr_detail::u128 c = 0;
+    for (int i = 0; i < 4; ++i) {
+        c += (fr_detail::u128) t[i] + (fr_detail::Q[i] & mask);
+        r.v[i] = (uint64_t) c;
+        c >>= 64;
+    }
+}
+
+inline void Fr_neg(Fr &r, const Fr &a) {
+    Fr z;
+    Fr_zero(z);
+    Fr_sub(r, z, a);
+}
+
+/**
+ * Montgomery multiplication (CIOS): r = a * b * 2^-256 mod q, i.e. the product in Montgomery form
+ */
+inline void Fr_mul(Fr &r, const Fr &a, const Fr &b) {
+    using fr_detail::Q;
+    using fr_detail::mac;
+    uint64_t t0 = 0, t1 = 0, t2 = 0, t3 = 0, t4 = 0, t5, c, m, lo;
+    for (int i = 0; i < 4; ++i) {
+        uint64_t bi = b.v[i];
+        c = 0;
+        mac(t0, c, a.v[0], bi, t0);
+        mac(t1, c, a.v[1], bi, t1);
+        mac(t2, c, a.v[2], bi, t2);
+        mac(t3, c, a.v[3], bi, t3);
+        fr_detail::u128 s = (fr_detail::u128) t4 + c;
+        t4 = (uint64_t) s;
+        t5 = (uint64_t) (s >> 64);
+
+        m = t0 * fr_detail::QINV;
+        c = 0;
+        mac(lo, c, m, Q[0], t0);
+        mac(t0, c, m, Q[1], t1);
+        mac(t1, c, m, Q[2], t2);
+        mac(t2, c, m, Q[3], t3);
+        s = (fr_detail::u128) t4 + c;
+        t3 = (uint64_t) s;
+        t4 = t5 + (uint64_t) (s >> 64);
+    }
+    uint64_t t[4] = {t0, t1, t2, t3};
+    fr_detail::reduceOnce(r.v, t);
+}
+
+inline void Fr_sqr(Fr &r, const Fr &a) {
+    Fr_mul(r, a, a);
+}
+
+/**
+ * Sets r to the small integer x
+ */
+void Fr_fromU64(Fr &r, uint64_t x);
+
+/**
+ * Converts an mpz_class (any value, reduced modulo q) into Fr
+ */
+void Fr_fromMpz(Fr &r, const mpz_class &a);
+
+/**
+ * Converts an Fr into its canonical mpz_class value in [0, q)
+ */
+mpz_class Fr_toMpz(const Fr &a);
+
+/**
+ * Converts a BIG (reduced modulo q) into Fr
+ */
+void Fr_fromBIG(Fr &r, BIG a);
+
+/**
+ * Converts an Fr into its canonical BIG value in [0, q)
+ */
+void Fr_toBIG(BIG r, const Fr &a);
+
+/**
+ * Converts an Fr into its canonical little-endian 64-bit limbs
+ */
+void Fr_toWords(uint64_t w[4], const Fr &a);
+
+/**
+ * Exponentiation by a 256-bit exponent given as little-endian 64-bit limbs
+ */
+void Fr_pow(Fr &r, const Fr &a, const uint64_t e[4]);
+
+/**
+ * Primitive n-th root of unity (n a power of two, n <= 2^32)
+ */
+void Fr_rootOfUnity(Fr &r, size_t n);
+
+/**
+ * In-place radix-2 number theoretic transform of length n (a power of two):
+ * a[i] <- sum_j a[j] * omega^(i*j) with omega = Fr_rootOfUnity(n), or the inverse
+ * transform (including the 1/n scaling) when inverse is set.
+ */
+void Fr_ntt(Fr *a, size_t n, bool inverse = false);
+
+/**
+ * Modular inverse, r = a^-1 (r = 0 when a = 0)
+ */
+void Fr_inv(Fr &r, const Fr &a);
+
+/**
+ * Inverts n elements with a single field inversion (Montgomery's trick).
+ * Zero inputs are mapped to zero. r and a may alias.
+ * @param r Output array of n elements
+ * @param a Input array of n elements
+ * @param n Number of elements
+ */
+void Fr_batchInv(Fr *r, const Fr *a, size_t n);
+
+/**
+ * Uniformly random element of Fq drawn from a MIRACL csprng (rejection sampling)
+ */
+void Fr_random(Fr &r, csprng &rng);
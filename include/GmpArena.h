@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Tools.h"
+
+/**
+ * Allocation counters of the calling thread (see GmpArena_stats)
+ */
+struct GmpArenaStats {
+    uint64_t arenaAllocs = 0;        // GMP allocations served by the thread's arena
+    uint64_t heapAllocs = 0;         // GMP allocations passed to the previous allocator
+    uint64_t reallocs = 0;           // GMP reallocations, either kind
+    uint64_t frees = 0;              // GMP frees, either kind
+    uint64_t resets = 0;             // times the arena was rewound to empty
+    size_t reserved = 0;             // bytes of arena chunks held by the thread
+};
+
+/**
+ * Installs the GMP memory hooks (mp_set_memory_functions) that route allocations to the
+ * thread-local arenas. Allocations made outside a GmpArenaScope, or before installation, keep
+ * going to the allocator that was installed before (GMP's malloc wrappers by default), so
+ * installing is transparent; it also turns on the counters of GmpArena_stats. Idempotent;
+ * GmpArenaScope calls it. Call it before starting threads that use GMP.
+ */
+void GmpArena_install();
+
+/**
+ * Counters of the calling thread; all zero until the hooks are installed
+ */
+GmpArenaStats GmpArena_stats();
+
+/**
+ * Zeroes the counters of the calling thread (reserved is kept)
+ */
+void GmpArena_resetStats();
+
+/**
+ * Opt-in arena for the GMP allocations of a block of mpz-heavy code, e.g.
+ *
+ *     {
+ *         GmpArenaScope arena;
+ *         vector<mpz_class> lambdas = getLagrangeBasis(x, q);
+ *         ...
+ *     }   // every limb allocated above is reclaimed at once
+ *
+ * While a scope is open on a thread, every new limb allocation GMP makes on that thread is
+ * bumped out of thread-local chunks, and freed blocks of up to 512 bytes are kept on per-size
+ * free lists for reuse, so the hot loops of interpolation and polynomial evaluation never
+ * reach the global allocator and never contend with other threads. When the outermost scope
+ * closes and no block is still in use, the arena is rewound; its chunks stay with the thread
+ * for the next scope and are released when the thread exits.
+ *
+ * mpz values created inside a scope may outlive it: the arena is then not rewound until the
+ * last of them is freed, and growing one after the scope moves it to the heap. They must be
+ * destroyed (or grown) on the thread that created them, however, since only that thread's
+ * arena recognizes their memory. The library's own lazily built values (getCurveOrder() and
+ * the like) are always allocated on the heap, whichever scope first touches them. Scopes nest.
+ * Not copyable.
+ */
+class GmpArenaScope {
+public:
+    /**
+     * @param chunkBytes Size of the first chunk the thread's arena reserves; later chunks double
+     */
+    explicit GmpArenaScope(size_t chunkBytes = 64 << 10);
+
+    GmpArenaScope(const GmpArenaScope &) = delete;
+
+    GmpArenaScope &operator=(const GmpArenaScope &) = delete;
+
+    ~GmpArenaScope();
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "FpBatch.h"
+
+/**
+ * Uniform access to the G1 (ECP) and G2 (ECP2) group operations of MIRACL,
+ * so that generic algorithms (MSM, batch containers, ...) can be written once
+ * as templates and instantiated for both groups.
+ */
+template<typename Point>
+struct GroupTraits;
+
+template<>
+struct GroupTraits<ECP> {
+    static void inf(ECP &P) { ECP_inf(&P); }
+
+    static bool isInf(const ECP &P) { return ECP_isinf(const_cast<ECP *>(&P)); }
+
+    static void generator(ECP &P) { ECP_generator(&P); }
+
+    static void copy(ECP &P, const ECP &Q) { ECP_copy(&P, const_cast<ECP *>(&Q)); }
+
+    static void add(ECP &P, const ECP &Q) { ECP_add(&P, const_cast<ECP *>(&Q)); }
+
+    static void sub(ECP &P, const ECP &Q) { ECP_sub(&P, const_cast<ECP *>(&Q)); }
+
+    static void dbl(ECP &P) { ECP_dbl(&P); }
+
+    static void neg(ECP &P) { ECP_neg(&P); }
+
+    static void affine(ECP &P) { ECP_affine(&P); }
+
+    static void mul(ECP &P, BIG e) { ECP_mul(&P, e); }
+
+    static bool equals(const ECP &P, const ECP &Q) {
+        return ECP_equals(const_cast<ECP *>(&P), const_cast<ECP *>(&Q));
+    }
+
+    static void batchAffine(ECP *P, size_t n) { ECP_batchAffine(P, n); }
+
+    static void batchEquals(const ECP *P, const ECP *Q, size_t n, bool *eq) { ECP_batchEquals(P, Q, n, eq); }
+
+    static bool isMember(const ECP &P) { return PAIR_G1member(const_cast<ECP *>(&P)); }
+
+    static size_t encodedSize(bool compress) { return compress ? MODBYTES_B384_58 + 1 : 2 * MODBYTES_B384_58 + 1; }
+
+    static void toOctet(octet &W, ECP &P, bool compress) { ECP_toOctet(&W, &P, compress); }
+
+    static bool fromOctet(ECP &P, octet &W) { return ECP_fromOctet(&P, &W); }
+};
+
+template<>
+struct GroupTraits<ECP2> {
+    static void inf(ECP2 &P) { ECP2_inf(&P); }
+
+    static bool isInf(const ECP2 &P) { return ECP2_isinf(const_cast<ECP2 *>(&P)); }
+
+    static void generator(ECP2 &P) { ECP2_generator(&P); }
+
+    static void copy(ECP2 &P, const ECP2 &Q) { ECP2_copy(&P, const_cast<ECP2 *>(&Q)); }
+
+    static void add(ECP2 &P, const ECP2 &Q) { ECP2_add(&P, const_cast<ECP2 *>(&Q)); }
+
+    static void sub(ECP2 &P, const ECP2 &Q) { ECP2_sub(&P, const_cast<ECP2 *>(&Q)); }
+
+    static void dbl(ECP2 &P) { ECP2_dbl(&P); }
+
+    static void neg(ECP2 &P) { ECP2_neg(&P); }
+
+    static void affine(ECP2 &P) { ECP2_affine(&P); }
+
+    static void mul(ECP2 &P, BIG e) { ECP2_mul(&P, e); }
+
+    static bool equals(const ECP2 &P, const ECP2 &Q) {
+        return ECP2_equals(const_cast<ECP2 *>(&P), const_cast<ECP2 *>(&Q));
+    }
+
+    static void batchAffine(ECP2 *P, size_t n) { ECP2_batchAffine(P, n); }
+
+    static void batchEquals(const ECP2 *P, const ECP2 *Q, size_t n, bool *eq) {
+        for (size_t i = 0; i < n; ++i) eq[i] = equals(P[i], Q[i]);
+    }
+
+    static bool isMember(const ECP2 &P) { return PAIR_G2member(const_cast<ECP2 *>(&P)); }
+
+    static size_t encodedSize(bool compress) { return compress ? 2 * MODBYTES_B384_58 + 1 : 4 * MODBYTES_B384_58 + 1; }
+
+    static void toOctet(octet &W, ECP2 &P, bool compress) { ECP2_toOctet(&W, &P, compress); }
+
+    static bool fromOctet(ECP2 &P, octet &W) { return ECP2_fromOctet(&P, &W); }
+};
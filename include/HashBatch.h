@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Tools.h"
+
+/**
+ * SHA-256 of many short messages at once, for hashing identities and challenges in bulk.
+ *
+ * The multi-buffer backends run 4 (SSE2 / generic vectors), 8 (AVX2) or 16 (AVX-512F)
+ * independent SHA-256 computations side by side, one message per vector lane; the SHA-NI
+ * backend hashes one message at a time with the CPU's SHA instructions, and the scalar backend
+ * is MIRACL's HASH256. The best backend of the running CPU is picked on first use. Lanes of a
+ * group run as many blocks as its longest message, so the lane backends suit batches of
+ * messages of similar length (e.g. 48-byte BIGs, one block each).
+ *
+ * The HashBatch_hash* functions return exactly what the per-item hashZp256 / hashToZp256 /
+ * hashToPoint of Tools.h return for every item. With q the curve order, the reduction of the
+ * digest is one Montgomery multiplication instead of BIG_mod.
+ */
+enum class HashBackend {
+    Scalar,
+    Lanes4,
+    ShaNi,
+    AVX2,
+    AVX512
+};
+
+/**
+ * Backend used by the HashBatch_* functions
+ */
+HashBackend HashBatch_backend();
+
+/**
+ * Forces a backend (tests and benchmarks); a backend the CPU lacks falls back to the best available one
+ * @return The backend actually selected
+ */
+HashBackend HashBatch_setBackend(HashBackend backend);
+
+/**
+ * Whether the running CPU supports a backend
+ */
+bool HashBatch_supported(HashBackend backend);
+
+/**
+ * Printable backend name
+ */
+const char *HashBatch_backendName(HashBackend backend);
+
+/**
+ * digests[32 * i .. 32 * i + 32) = SHA-256 of messages[i] (lengths[i] bytes), for i < n
+ */
+void HashBatch_sha256(unsigned char *digests, const unsigned char *const *messages, const size_t *lengths, size_t n);
+
+/**
+ * res[i] = hashZp256(res, &cts[i], q): like hashZp256, the first cts[i].max bytes are hashed
+ */
+void HashBatch_hashZp256(BIG *res, const octet *cts, size_t n, const BIG q);
+
+/**
+ * res[i] = hashToZp256(res, in[i], q)
+ */
+void HashBatch_hashToZp256(BIG *res, const BIG *in, size_t n, const BIG q);
+
+/**
+ * The mpz_class hashToZp256 of every element of `in`
+ */
+vector<mpz_class> HashBatch_hashToZp256(const vector<mpz_class> &in, const mpz_class &q);
+
+/**
+ * out[i] = hashToPoint(in[i], q): the hashes are computed in one batch, then one scalar
+ * multiplication of the generator per item
+ */
+void HashBatch_hashToPoint(ECP *out, const BIG *in, size_t n, const BIG q);
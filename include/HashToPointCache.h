@@ -0,0 +1,100 @@
+#pragma once
+
+#include "Tools.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+/**
+ * Knobs of the hashToPoint cache
+ */
+struct HashToPointCacheConfig {
+    size_t maxBytes = 16 << 20;      // memory bound of the entry table
+    size_t shards = 0;               // writer lock shards, rounded up to a power of two (0 = 4 per hardware thread)
+};
+
+/**
+ * Counters of the hashToPoint cache
+ */
+struct HashToPointCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;             // lookups that ran hashToPoint
+    uint64_t evictions = 0;          // entries replaced to make room
+    size_t entries = 0;              // entries currently held
+    size_t capacity = 0;             // entries the memory bound allows
+
+    double hitRate() const { return hits + misses ? (double) hits / (double) (hits + misses) : 0; }
+};
+
+/**
+ * Concurrent memo of hashToPoint(id, q), for workloads that hash the same identities again and
+ * again (e.g. IBE key extraction and encryption).
+ *
+ * Entries are keyed on the 48-byte encodings of id and q and hold the point in affine form, the
+ * form the pairing functions take their G1 argument in, so a hit costs no hash, no scalar
+ * multiplication and no normalization. The table is set-associative (8 ways per set) with a
+ * fixed number of entries derived from maxBytes, and evicts with CLOCK inside each set.
+ *
+ * Lookups take no lock: each entry carries a sequence number that writers make odd while they
+ * change it, and a reader retries the set if the number moved under it. Insertions lock one of
+ * several shards, so concurrent misses on different identities rarely contend. The counters
+ * are per shard as well.
+ */
+class HashToPointCache {
+public:
+    explicit HashToPointCache(const HashToPointCacheConfig &config = HashToPointCacheConfig());
+
+    HashToPointCache(const HashToPointCache &) = delete;
+
+    HashToPointCache &operator=(const HashToPointCache &) = delete;
+
+    ~HashToPointCache();
+
+    /**
+     * hashToPoint(id, q), from the cache when present
+     * @param id Integer to hash
+     * @param q Order of the elliptic curve to mod the hash result
+     * @return The point, in affine form
+     */
+    ECP get(BIG id, BIG q);
+
+    ECP get(const mpz_class &id, const mpz_class &q);
+
+    /**
+     * Cached hashToPoint(id, q) without computing it on a miss
+     * @return true (and P set) on a hit
+     */
+    bool lookup(ECP &P, BIG id, BIG q);
+
+    /**
+     * Drops every entry; the counters are kept
+     */
+    void clear();
+
+    /**
+     * Snapshot of the counters
+     */
+    HashToPointCacheStats stats() const;
+
+private:
+    struct Slot;
+    struct Shard;
+
+    size_t sets_;                    // power of two
+    unique_ptr<Slot[]> slots_;       // sets_ * WAYS
+    unique_ptr<uint8_t[]> hands_;    // CLOCK hand of each set, guarded by the set's shard
+    unique_ptr<Shard[]> shards_;
+    size_t shardMask_;
+
+    size_t setOf(uint64_t hash) const { return (size_t) (hash >> 8) & (sets_ - 1); }
+
+    /**
+     * Lock-free probe of the set of `hash`
+     */
+    bool find(ECP &P, const uint64_t key[], uint64_t hash);
+
+    /**
+     * Stores P (affine) under the lock of the set's shard, unless another thread already did
+     */
+    void insert(const uint64_t key[], uint64_t hash, ECP &P);
+};
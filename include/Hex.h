@@ -0,0 +1,177 @@
+#pragma once
+
+#include "MappedFile.h"
+
+/**
+ * Hex encoding and decoding of bytes, BIG, mpz_class, octets and points.
+ *
+ * The byte-level codec converts 32 bytes per step with AVX2 shuffles when the CPU has it
+ * (picked on first use) and through lookup tables otherwise. Decoding validates every
+ * character and accepts upper and lower case; encoding writes lower case, the format of
+ * charsToString and mpz_class::get_str(16).
+ *
+ * BIG values are 96 hex digits (48 bytes, big-endian); shorter input is zero-extended on the
+ * left, as str_to_BIG always did. Points are the hex of their MIRACL octet encoding.
+ */
+
+/**
+ * out[0 .. 2n) = lower-case hex of in[0 .. n)
+ */
+void Hex_encode(char *out, const unsigned char *in, size_t n);
+
+/**
+ * out[0 .. n) = bytes of the 2n hex digits in[0 .. 2n)
+ * @return false if a character is not a hex digit (out is then unspecified)
+ */
+bool Hex_decode(unsigned char *out, const char *in, size_t n);
+
+string Hex_encode(const unsigned char *in, size_t n);
+
+/**
+ * Decodes len hex digits (len may be odd) into the last (len + 1) / 2 bytes of out[0 .. outLen),
+ * zeroing the bytes before them
+ * @throws invalid_argument on a non-hex character or if the value does not fit in outLen bytes
+ */
+void Hex_decodeRight(unsigned char *out, size_t outLen, const char *in, size_t len);
+
+string Hex_encodeBIG(BIG b);
+
+/**
+ * @throws invalid_argument on malformed input or more than 96 digits
+ */
+void Hex_decodeBIG(BIG b, const char *in, size_t len);
+
+/**
+ * Same digits as a.get_str(16), with a leading '-' for negative values
+ */
+string Hex_encodeMpz(const mpz_class &a);
+
+/**
+ * @throws invalid_argument on malformed input
+ */
+void Hex_decodeMpz(mpz_class &a, const char *in, size_t len);
+
+string Hex_encodeOctet(const octet &o);
+
+/**
+ * Decodes into o.val (o.max must be large enough) and sets o.len
+ * @throws invalid_argument on malformed input or if o.max is too small
+ */
+void Hex_decodeOctet(octet &o, const char *in, size_t len);
+
+string Hex_encodeECP(ECP &P, bool compress = true);
+
+/**
+ * @throws invalid_argument on malformed input or if it is not a point on the curve
+ */
+void Hex_decodeECP(ECP &P, const char *in, size_t len);
+
+string Hex_encodeECP2(ECP2 &P, bool compress = true);
+
+void Hex_decodeECP2(ECP2 &P, const char *in, size_t len);
+
+/**
+ * Streams whitespace-separated hex tokens (one value per token, e.g. one per line) out of a
+ * buffer or a memory-mapped file, without copying the input.
+ */
+class HexReader {
+public:
+    /**
+     * Reads from a buffer that must outlive the reader
+     */
+    HexReader(const char *data, size_t len) : data_(data), end_(data + len) {}
+
+    /**
+     * Maps the file at `path` and reads from it
+     * @throws runtime_error if the file cannot be mapped
+     */
+    explicit HexReader(const string &path);
+
+    HexReader(const HexReader &) = delete;
+
+    HexReader &operator=(const HexReader &) = delete;
+
+    /**
+     * Each next() decodes one token
+     * @return false at the end of the input
+     * @throws runtime_error naming the line of a malformed token
+     */
+    bool next(BIG b);
+
+    bool next(mpz_class &a);
+
+    bool next(ECP &P);
+
+    bool next(ECP2 &P);
+
+    bool next(vector<unsigned char> &bytes);
+
+    /**
+     * Decodes every remaining token (mpz_class, ECP, ECP2 or vector<unsigned char>)
+     */
+    template<typename T>
+    vector<T> readAll() {
+        vector<T> out;
+        T v;
+        while (next(v)) out.push_back(v);
+        return out;
+    }
+
+    /**
+     * 1-based line of the last token returned
+     */
+    size_t line() const { return line_; }
+
+private:
+    MappedFile file_;
+    const char *data_;
+    const char *end_;
+    size_t line_ = 0;
+    size_t nextLine_ = 1;
+
+    bool token(const char *&begin, size_t &len);
+
+    [[noreturn]] void fail(const invalid_argument &e) const;
+};
+
+/**
+ * Buffers hex values, one per line, and writes them to a FILE* in large blocks
+ */
+class HexWriter {
+public:
+    /**
+     * @param out Stream to write to; not closed by the writer
+     */
+    explicit HexWriter(FILE *out) : out_(out) {}
+
+    ~HexWriter();
+
+    HexWriter(const HexWriter &) = delete;
+
+    HexWriter &operator=(const HexWriter &) = delete;
+
+    void write(BIG b);
+
+    void write(const mpz_class &a);
+
+    void write(ECP &P, bool compress = true);
+
+    void write(ECP2 &P, bool compress = true);
+
+    void write(const unsigned char *bytes, size_t n);
+
+    /**
+     * Writes out the buffered lines
+     * @throws runtime_error on I/O failure
+     */
+    void flush();
+
+private:
+    FILE *out_;
+    string buf_;
+
+    /**
+     * Appends the hex of bytes[0 .. n) and a newline
+     */
+    void line(const unsigned char *bytes, size_t n);
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "Tools.h"
+
+/**
+ * Streaming hybrid encryption under a GT key (e.g. a pairing value shared through IBE or a
+ * threshold scheme), for payloads of any size in constant memory.
+ *
+ * The AES-256 key comes from GT_kdf over the GT element, a random 32-byte salt, the header
+ * and a caller-chosen context string, so every message has its own key. The payload is cut
+ * into chunks that are sealed independently with AES-256-GCM; the nonce of chunk i is i as a
+ * 64-bit big-endian number followed by three zero bytes and a final-chunk flag (the STREAM
+ * construction), so chunks cannot be reordered, dropped or appended to, and a stream cut at
+ * a chunk boundary fails to authenticate. GCM runs on AES-NI and PCLMULQDQ when the CPU has
+ * them and on MIRACL's GCM otherwise; both produce the same bytes.
+ *
+ * Chunks are sealed and opened in parallel: the calling thread reads the next batch of
+ * chunks and writes the previous one while worker threads process the current one, so
+ * memory stays at about 2 * batchChunks * chunkBytes.
+ *
+ * Format: HYBRID_HEADER_BYTES of header ("GTAE", version 1, 3 zero bytes, the chunk size as a
+ * 32-bit little-endian number, the salt), then every chunk's ciphertext followed by its
+ * 16-byte tag. Every chunk but the last holds exactly chunkBytes of plaintext; the last one
+ * may be empty.
+ */
+const size_t HYBRID_HEADER_BYTES = 44;
+const size_t HYBRID_TAG_BYTES = 16;
+const size_t HYBRID_MAX_CHUNK_BYTES = (size_t) 1 << 26;
+const size_t HYBRID_MAX_BATCH_BYTES = (size_t) 1 << 28;    // buffers of both pipeline stages together
+
+struct HybridConfig {
+    size_t chunkBytes = 64 << 10;              // plaintext bytes per chunk (decryption takes it from the header)
+    size_t threads = 0;                        // threads sealing / opening chunks (0 = hardware concurrency, 1 = the caller)
+    size_t batchChunks = 0;                    // chunks per pipeline stage (0 = 4 per thread), capped by HYBRID_MAX_BATCH_BYTES
+};
+
+/**
+ * HKDF-SHA256 (RFC 5869) with a GT element as input key material: the twelve Fp coefficients
+ * of the reduced element, each as 48 big-endian bytes in the order a.a.a, a.a.b, a.b.a, ...,
+ * c.b.b, are hashed straight from the limbs without building an octet
+ * @param out Output key material, outLen bytes
+ * @param outLen At most 255 * 32 bytes
+ * @param g GT element
+ * @param salt HKDF salt (may be empty)
+ * @param info HKDF context information
+ * @throws invalid_argument if outLen is too large
+ */
+void GT_kdf(unsigned char *out, size_t outLen, const FP12 &g, const unsigned char *salt, size_t saltLen,
+            const string &info);
+
+/**
+ * Encrypts everything `in` delivers
+ * @param key GT key
+ * @param rng Source of the salt
+ * @param context Bound into the key; decryption must pass the same string
+ * @return Number of plaintext bytes
+ * @throws invalid_argument for a chunk size outside [1, HYBRID_MAX_CHUNK_BYTES]
+ * @throws runtime_error if writing fails
+ */
+uint64_t Hybrid_encrypt(const FP12 &key, istream &in, ostream &out, csprng &rng, const string &context = "",
+                        const HybridConfig &config = HybridConfig());
+
+/**
+ * Decrypts a stream written by Hybrid_encrypt. Chunks are written only once they have
+ * authenticated, but the chunks before a failing one have been written already: discard the
+ * output when this throws.
+ * @return Number of plaintext bytes
+ * @throws runtime_error on a malformed header, a truncated stream, a chunk that fails to
+ *         authenticate (wrong key or context, tampering, truncation) or a write failure
+ */
+uint64_t Hybrid_decrypt(const FP12 &key, istream &in, ostream &out, const string &context = "",
+                        const HybridConfig &config = HybridConfig());
+
+/**
+ * In-memory forms of the above
+ */
+vector<unsigned char> Hybrid_encrypt(const FP12 &key, const vector<unsigned char> &plain, csprng &rng,
+                                     const string &context = "", const HybridConfig &config = HybridConfig());
+
+vector<unsigned char> Hybrid_decrypt(const FP12 &key, const vector<unsigned char> &cipher,
+                                     const string &context = "", const HybridConfig &config = HybridConfig());
+
+/**
+ * Whether chunks are sealed with AES-NI and PCLMULQDQ (otherwise with MIRACL's GCM)
+ */
+bool Hybrid_aesni();
+
+/**
+ * Switches between AES-NI (when the CPU has it) and MIRACL's GCM (tests and benchmarks)
+ * @return Whether AES-NI is used now
+ */
+bool Hybrid_setAesni(bool enable);
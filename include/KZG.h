@@ -0,0 +1,125 @@
+#pragma once
+
+#include "Tools.h"
+#include "MappedFile.h"
+
+/**
+ * KZG polynomial commitments over BLS12381.
+ *
+ * The structured reference string (powers of tau) is kept in a binary file whose payload is
+ * the raw in-memory representation of the points, so loading it is a single mmap: no octet
+ * decoding or point validation happens at startup. The file optionally also carries the
+ * Lagrange basis [L_i(tau)]_1 over the multiplicative subgroup of size `lagrangeSize`
+ * (roots of unity of Fq), which allows committing to evaluations directly.
+ */
+
+/**
+ * Header of an SRS file; the points follow at the given byte offsets
+ */
+struct KZGSrsHeader {
+    char magic[8];            // "KZGSRS\0\0"
+    uint32_t version;         // KZG_SRS_VERSION
+    uint32_t g1Size;          // sizeof(ECP) of the writer, guards against layout mismatch
+    uint32_t g2Size;          // sizeof(ECP2) of the writer
+    uint32_t reserved;
+    uint64_t powers;          // number of G1 powers: [tau^0]_1 ... [tau^(powers-1)]_1
+    uint64_t lagrangeSize;    // size of the Lagrange basis (power of two), 0 if absent
+    uint64_t g1Offset;
+    uint64_t lagrangeOffset;
+    uint64_t g2Offset;        // [1]_2 followed by [tau]_2
+};
+
+const uint32_t KZG_SRS_VERSION = 1;
+
+/**
+ * An opening of a committed polynomial f at the point z: y = f(z) and the witness proof
+ */
+struct KZGOpening {
+    ECP commitment;
+    mpz_class z;
+    mpz_class y;
+    ECP proof;
+};
+
+/**
+ * Generates an SRS file from a known trapdoor tau. For tests and local benchmarks only:
+ * whoever knows tau can forge openings.
+ * @param path Output file
+ * @param powers Number of G1 powers (maximum polynomial degree + 1)
+ * @param lagrangeSize Size of the Lagrange basis, a power of two (0 to omit it)
+ * @param tau The trapdoor
+ */
+void KZG_generateSRS(const string &path, size_t powers, size_t lagrangeSize, const mpz_class &tau);
+
+/**
+ * Returns a primitive n-th root of unity of Fq (n must be a power of two, n <= 2^32)
+ * @param n Order of the root
+ * @return The root of unity
+ */
+mpz_class rootOfUnity(size_t n);
+
+class KZG {
+public:
+    /**
+     * Memory-maps an SRS file produced by KZG_generateSRS
+     * @param srsPath Path to the SRS file
+     * @throws runtime_error if the file is missing, truncated or was written with another layout
+     */
+    explicit KZG(const string &srsPath);
+
+    /**
+     * Maximum number of coefficients a committed polynomial may have
+     */
+    size_t maxCoefficients() const { return header_->powers; }
+
+    /**
+     * Size of the Lagrange basis carried by the SRS (0 if absent)
+     */
+    size_t lagrangeSize() const { return header_->lagrangeSize; }
+
+    /**
+     * Commits to a polynomial given by its coefficients (constant term first)
+     * @param coeffs Polynomial coefficients
+     * @return The commitment [f(tau)]_1
+     */
+    ECP commit(const vector<mpz_class> &coeffs) const;
+
+    /**
+     * Commits to the polynomial taking the value evals[i] at omega^i, omega = rootOfUnity(lagrangeSize())
+     * @param evals Evaluations over the domain (missing trailing values are treated as zero)
+     * @return The commitment [f(tau)]_1
+     */
+    ECP commitLagrange(const vector<mpz_class> &evals) const;
+
+    /**
+     * Opens a polynomial at z, computing y = f(z) and the proof [(f(tau) - y) / (tau - z)]_1
+     * @param coeffs Polynomial coefficients
+     * @param z Evaluation point
+     * @param commitment Commitment to the polynomial (copied into the returned opening)
+     * @return The opening
+     */
+    KZGOpening open(const vector<mpz_class> &coeffs, const mpz_class &z, const ECP &commitment) const;
+
+    /**
+     * Verifies a single opening with one pairing-product check
+     * @param opening The opening to verify
+     * @return true if the opening is valid
+     */
+    bool verify(const KZGOpening &opening) const;
+
+    /**
+     * Verifies many openings (of possibly different polynomials at different points) at once.
+     * The equations are combined with random weights into a single two-pairing check.
+     * @param openings The openings to verify
+     * @param rng Seed used for the random weights (initialized by initRNG)
+     * @return true if all openings are valid (with overwhelming probability)
+     */
+    bool batchVerify(const vector<KZGOpening> &openings, csprng &rng) const;
+
+private:
+    MappedFile file_;
+    const KZGSrsHeader *header_ = nullptr;
+    const ECP *g1_ = nullptr;
+    const ECP *lagrange_ = nullptr;
+    const ECP2 *g2_ = nullptr;
+};
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "PointBatch.h"
+
+/**
+ * Up to this many terms, the ECP_msm / ECP2_msm entry points use Straus' interleaved wNAF
+ * method (one shared doubling chain) instead of Pippenger's buckets, unless a tuning profile
+ * moves the cut-over (see Tuning.h)
+ */
+const size_t STRAUS_MAX_TERMS = 8;
+
+/**
+ * Multi-scalar multiplication (Pippenger's bucket method) on G1:
+ * computes scalars[0] * points[0] + ... + scalars[n-1] * points[n-1]
+ * @param points Input points
+ * @param scalars Input scalars, reduced modulo the curve order
+ * @param n Number of terms
+ * @return The resulting G1 point (infinity when n == 0)
+ */
+ECP ECP_msm(const ECP *points, BIG *scalars, size_t n);
+
+/**
+ * Multi-scalar multiplication on G1 with mpz_class scalars
+ * @param points Input points
+ * @param scalars Input scalars, any value (reduced modulo the curve order internally)
+ * @return The resulting G1 point
+ */
+ECP ECP_msm(const vector<ECP> &points, const vector<mpz_class> &scalars);
+
+/**
+ * Multi-scalar multiplication on G1 over a raw point array (e.g. a memory-mapped table)
+ * @param points Input points, at least scalars.size() of them
+ * @param scalars Input scalars, any value (reduced modulo the curve order internally)
+ * @return The resulting G1 point
+ */
+ECP ECP_msm(const ECP *points, const vector<mpz_class> &scalars);
+
+/**
+ * Multi-scalar multiplication (Pippenger's bucket method) on G2
+ * @param points Input points
+ * @param scalars Input scalars, reduced modulo the curve order
+ * @param n Number of terms
+ * @return The resulting G2 point (infinity when n == 0)
+ */
+ECP2 ECP2_msm(const ECP2 *points, BIG *scalars, size_t n);
+
+/**
+ * Multi-scalar multiplication on G2 with mpz_class scalars
+ * @param points Input points
+ * @param scalars Input scalars, any value (reduced modulo the curve order internally)
+ * @return The resulting G2 point
+ */
+ECP2 ECP2_msm(const vector<ECP2> &points, const vector<mpz_class> &scalars);
+
+/**
+ * Multi-scalar multiplication on G2 over a raw point array (e.g. a memory-mapped table)
+ * @param points Input points, at least scalars.size() of them
+ * @param scalars Input scalars, any value (reduced modulo the curve order internally)
+ * @return The resulting G2 point
+ */
+ECP2 ECP2_msm(const ECP2 *points, const vector<mpz_class> &scalars);
+
+/**
+ * Multi-scalar multiplication over a point batch, read in place
+ * @param points Input points, as many as scalars
+ * @param scalars Input scalars, any value (reduced modulo the curve order internally)
+ */
+ECP ECP_msm(const G1Batch &points, const vector<mpz_class> &scalars);
+
+ECP2 ECP2_msm(const G2Batch &points, const vector<mpz_class> &scalars);
+
+/**
+ * Picks the Pippenger window width (in bits) used for an MSM of n terms, from the active tuning profile
+ * @param n Number of terms
+ * @return Window width in bits
+ */
+int msmWindowBits(size_t n);
+
+/**
+ * The built-in window width for n terms, about log2(n) - log2(log2(n)), used without a tuning profile
+ */
+int msmDefaultWindowBits(size_t n);
+
+/**
+ * k * P in time proportional to the bit length of k, for public scalars such as 64-128-bit
+ * batch-verification challenges (wNAF; not constant time, unlike ECP_mul)
+ * @param P Input point
+ * @param k Any integer; negative values and values beyond the curve order are reduced to the
+ *          representative of least magnitude, so e.g. -1 costs as little as 1
+ * @return k * P
+ */
+ECP ECP_mulShort(const ECP &P, const mpz_class &k);
+
+ECP2 ECP2_mulShort(const ECP2 &P, const mpz_class &k);
+
+/**
+ * a * P + b * Q with one shared doubling chain (Straus / Shamir), for public scalars
+ */
+ECP ECP_mul2(const ECP &P, const mpz_class &a, const ECP &Q, const mpz_class &b);
+
+ECP2 ECP2_mul2(const ECP2 &P, const mpz_class &a, const ECP2 &Q, const mpz_class &b);
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Tools.h"
+
+/**
+ * Read-only memory mapping of a whole file (RAII).
+ * The mapping is shared, so several processes mapping the same file share the page cache
+ * and nothing is parsed or copied at load time.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+
+    /**
+     * Maps the file at `path` read-only
+     * @param path File to map
+     * @throws runtime_error if the file cannot be opened or mapped
+     */
+    explicit MappedFile(const string &path);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    MappedFile(MappedFile &&other) noexcept;
+
+    MappedFile &operator=(MappedFile &&other) noexcept;
+
+    const unsigned char *data() const { return data_; }
+
+    size_t size() const { return size_; }
+
+    bool isOpen() const { return data_ != nullptr; }
+
+    /**
+     * Unmaps the file (no-op if nothing is mapped)
+     */
+    void close();
+
+private:
+    const unsigned char *data_ = nullptr;
+    size_t size_ = 0;
+};
+
+/**
+ * Writes a buffer to `path` atomically (temporary file + rename), so that a concurrent
+ * reader mapping the same path never observes a partially written file.
+ * @param path Destination file
+ * @param data Bytes to write
+ * @param len Number of bytes
+ * @throws runtime_error on I/O failure
+ */
+void writeFileAtomic(const string &path, const void *data, size_t len);
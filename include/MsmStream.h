@@ -0,0 +1,139 @@
+#pragma once
+
+#include "MSM.h"
+#include <functional>
+#include <iterator>
+
+/**
+ * Default bucket memory of an MsmStream
+ */
+const size_t MSM_STREAM_BUCKET_BYTES = (size_t) 64 << 20;
+
+/**
+ * Default number of terms read per chunk by MsmStream::addSource
+ */
+const size_t MSM_STREAM_CHUNK_TERMS = (size_t) 1 << 16;
+
+struct ScalarWords;
+
+/**
+ * A sequence of MSM terms read chunk by chunk: every call fills up to `max` points and scalars
+ * (any value below 2^384, reduced modulo the curve order by the reader) and returns how many it
+ * filled; 0 ends the sequence
+ */
+template<typename Point>
+using MsmChunkSource = function<size_t(Point *points, BIG *scalars, size_t max)>;
+
+/**
+ * Out-of-core multi-scalar multiplication for inputs larger than memory: the terms arrive in
+ * chunks, e.g. from memory-mapped files, and only the Pippenger buckets stay resident.
+ *
+ * Unlike the in-memory ECP_msm, which walks all terms once per window, the stream keeps the
+ * buckets of every window at once, so each chunk is visited a single time and can be dropped
+ * afterwards. The window width is the one ECP_msm would pick for the expected number of terms,
+ * narrowed until all buckets fit in the memory budget; memory use does not grow with the
+ * number of terms. The windows are split over the worker threads, and addSource reads the
+ * next chunk on another thread while the current one is being added. The result is the same
+ * group element as ECP_msm / ECP2_msm on all the terms.
+ */
+template<typename Point>
+class MsmStream {
+public:
+    typedef GroupTraits<Point> G;
+
+    /**
+     * @param expectedTerms Expected total number of terms, to pick the window width (0: many)
+     * @param maxBucketBytes Memory the buckets may take
+     * @param threads Worker threads; 0 uses every core
+     * @throws invalid_argument if even 1-bit windows exceed maxBucketBytes
+     */
+    explicit MsmStream(size_t expectedTerms = 0, size_t maxBucketBytes = MSM_STREAM_BUCKET_BYTES,
+                       unsigned threads = 0);
+
+    /**
+     * Adds n terms; the arrays are not kept
+     */
+    void add(const Point *points, const BIG *scalars, size_t n);
+
+    void add(const Point *points, const mpz_class *scalars, size_t n);
+
+    void add(const vector<Point> &points, const vector<mpz_class> &scalars);
+
+    /**
+     * Adds every term of `source`, reading the next chunk of chunkTerms terms while the
+     * previous one is added (two chunk buffers in flight)
+     * @throws whatever the source throws
+     */
+    void addSource(const MsmChunkSource<Point> &source, size_t chunkTerms = MSM_STREAM_CHUNK_TERMS);
+
+    /**
+     * The sum of the terms added so far (more terms may still be added afterwards)
+     */
+    Point result() const;
+
+    size_t terms() const { return terms_; }
+
+    int windowBits() const { return c_; }
+
+    size_t bucketBytes() const { return buckets_.size() * sizeof(Point); }
+
+private:
+    int c_;
+    int windows_;
+    size_t perWindow_;            // 2^c - 1 buckets per window
+    unsigned threads_;
+    size_t terms_ = 0;
+    vector<Point> buckets_;       // window j owns buckets [j * perWindow_, (j + 1) * perWindow_)
+    vector<char> used_;
+
+    void accumulate(const Point *points, const ScalarWords *scalars, size_t n);
+};
+
+typedef MsmStream<ECP> G1MsmStream;
+typedef MsmStream<ECP2> G2MsmStream;
+
+extern template class MsmStream<ECP>;
+extern template class MsmStream<ECP2>;
+
+/**
+ * Terms from two files, mapped rather than read: the points as back-to-back encodings of
+ * PointBatch::encodedSize(compressed) bytes (PointBatch::toBytes), the scalars as 32-byte
+ * big-endian values. Every chunk is decoded as it is read; the pages of the following chunk are
+ * requested ahead and those of consumed chunks released, so the resident part of the files
+ * stays about one chunk. Uncompressed points decode without a square root, so they are read
+ * much faster than compressed ones. Two empty files are an empty term set.
+ * @throws runtime_error if a file cannot be mapped
+ * @throws invalid_argument if the sizes do not describe the same number of terms (the source
+ *         itself throws if a point does not decode)
+ */
+template<typename Point>
+MsmChunkSource<Point> MsmStream_files(const string &pointsPath, const string &scalarsPath, bool compressed = true);
+
+/**
+ * Multi-scalar multiplication over the terms of two files (see MsmStream_files), in bounded memory;
+ * the point at infinity for empty files, like ECP_msm of no terms
+ */
+ECP ECP_msmFiles(const string &pointsPath, const string &scalarsPath, bool compressed = true);
+
+ECP2 ECP2_msmFiles(const string &pointsPath, const string &scalarsPath, bool compressed = true);
+
+/**
+ * Terms from a range of points and a parallel range of mpz_class scalars (any iterators, e.g.
+ * over a container that is filled lazily), converted chunk by chunk
+ */
+template<typename PointIt, typename ScalarIt>
+MsmChunkSource<typename iterator_traits<PointIt>::value_type>
+MsmStream_iterators(PointIt points, PointIt end, ScalarIt scalars) {
+    typedef typename iterator_traits<PointIt>::value_type Point;
+    return [points, end, scalars](Point *P, BIG *s, size_t max) mutable {
+        const mpz_class &q = getCurveOrder();
+        size_t n = 0;
+        for (; n < max && points != end; ++n, ++points, ++scalars) {
+            P[n] = *points;
+            mpz_class t = *scalars % q;
+            if (t < 0) t += q;
+            mpz_to_BIG(t, s[n]);
+        }
+        return n;
+    };
+}
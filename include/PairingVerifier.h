@@ -0,0 +1,114 @@
+#pragma once
+
+#include "Tools.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+
+/**
+ * A pairing-product check: passes iff e(g1[0], g2[0]) * ... * e(g1[n-1], g2[n-1]) == 1
+ */
+struct PairingCheck {
+    vector<ECP> g1;
+    vector<ECP2> g2;
+};
+
+/**
+ * Knobs of the asynchronous verifier
+ */
+struct PairingVerifierConfig {
+    size_t maxBatch = 64;                        // upper bound on checks merged into one multi-pairing
+    chrono::microseconds maxLatency{500};        // longest time a check waits for companions
+    size_t workers = 0;                          // worker threads (0 = hardware concurrency)
+};
+
+/**
+ * Counters of the asynchronous verifier
+ */
+struct PairingVerifierStats {
+    uint64_t submitted = 0;
+    uint64_t batches = 0;            // multi-pairings executed
+    uint64_t failedBatches = 0;      // batches that did not verify and were split up
+    uint64_t individualChecks = 0;   // checks re-run on their own after a failed batch
+    uint64_t rejected = 0;           // checks reported as invalid
+    double meanBatchSize = 0;
+    vector<uint64_t> batchSizeHistogram;  // [i] counts batches of size in [2^i, 2^(i+1))
+};
+
+/**
+ * In-process asynchronous pairing verification service.
+ *
+ * Checks submitted from any thread are queued; workers coalesce them until either the batch
+ * size limit or the latency budget of the oldest pending check is reached. A batch is verified
+ * as one multi-pairing after raising every check to an independent random 128-bit exponent
+ * (applied to its G1 points), so a single Miller loop and final exponentiation cover the whole
+ * batch. Only when the combined check fails are the checks of that batch verified one by one.
+ * After a failure the batch size limit is halved and then grows back on successes, so a stream
+ * with many invalid checks does not keep paying for doomed batches.
+ */
+class PairingVerifier {
+public:
+    explicit PairingVerifier(const PairingVerifierConfig &config = PairingVerifierConfig());
+
+    /**
+     * Verifies everything still pending, then stops the workers
+     */
+    ~PairingVerifier();
+
+    PairingVerifier(const PairingVerifier &) = delete;
+
+    PairingVerifier &operator=(const PairingVerifier &) = delete;
+
+    /**
+     * Submits a check; the future becomes ready once it has been verified
+     * @param check The pairing-product check
+     * @return Future holding the verdict
+     */
+    future<bool> submit(PairingCheck check);
+
+    /**
+     * Submits a check; the callback is invoked on a worker thread with the verdict
+     * @param check The pairing-product check
+     * @param callback Receives the verdict
+     */
+    void submit(PairingCheck check, function<void(bool)> callback);
+
+    /**
+     * Snapshot of the counters
+     */
+    PairingVerifierStats stats() const;
+
+private:
+    struct Pending {
+        PairingCheck check;
+        function<void(bool)> done;
+        chrono::steady_clock::time_point enqueued;
+    };
+
+    PairingVerifierConfig config_;
+    mutable mutex mutex_;
+    condition_variable cv_;
+    deque<Pending> pending_;
+    size_t batchLimit_;
+    bool stopping_ = false;
+    vector<thread> workers_;
+
+    mutable mutex statsMutex_;
+    PairingVerifierStats stats_;
+
+    void workerLoop();
+
+    /**
+     * Blocks until a batch is due (size limit or latency budget), then removes it from the queue.
+     * Returns an empty batch when the verifier is shutting down and nothing is pending.
+     */
+    vector<Pending> takeBatch();
+
+    void verifyBatch(vector<Pending> &batch, csprng &rng);
+
+    static bool verifyOne(const PairingCheck &check);
+};
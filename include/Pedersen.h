@@ -0,0 +1,129 @@
+#pragma once
+
+#include "Tools.h"
+
+/**
+ * Pedersen vector commitments in G1: C = r * H + v[0] * G[0] + ... + v[n-1] * G[n-1].
+ *
+ * The generators are derived by hashing to the curve (RFC 9380 hash_to_curve with SHA-256
+ * and the SSWU map, under a domain separation tag), so nobody knows a discrete-log relation
+ * between them; G[i] depends only on the tag and i, so commitment keys of different sizes
+ * agree on their common prefix. hashToPoint cannot be used here: it returns hash * g, whose
+ * discrete log is public.
+ *
+ * For every generator P (the G[i] and H) the key stores P, 2^w P, 2^(2w) P, ... in affine
+ * coordinates. A commitment recodes every value into signed w-bit digits and drops the
+ * matching table entry of every (value, digit position) into one set of 2^(w-1) buckets,
+ * which are folded once at the end: about (n + 1) * 256 / w additions and no doublings,
+ * against the 256 / w bucket passes and 256 doublings of a variable-base MSM, and against
+ * n full scalar multiplications of an ECP_mul loop.
+ */
+const char *const PEDERSEN_DEFAULT_DST = "MIRACL-WRAPPER-PEDERSEN-V01-CS01-with-BLS12381G1_XMD:SHA-256_SSWU_RO_";
+
+class PedersenVector {
+public:
+    /**
+     * Derives the generators and builds their tables
+     * @param n Vector length (number of value generators)
+     * @param windowBits Digit width w in [2, 16]; 0 picks the fastest width for n
+     * @param dst Domain separation tag of the generators
+     * @throws invalid_argument for an unsupported window width
+     */
+    explicit PedersenVector(size_t n, int windowBits = 0, const string &dst = PEDERSEN_DEFAULT_DST);
+
+    /**
+     * Uses an existing table (e.g. mapped from a PrecomputeCache) without copying it;
+     * the table must outlive this object
+     * @throws invalid_argument if count does not match tableSize(n, windowBits)
+     */
+    PedersenVector(const ECP *table, size_t count, size_t n, int windowBits);
+
+    PedersenVector(const PedersenVector &) = delete;
+
+    PedersenVector &operator=(const PedersenVector &) = delete;
+
+    PedersenVector(PedersenVector &&) = default;
+
+    PedersenVector &operator=(PedersenVector &&) = default;
+
+    /**
+     * Vector length
+     */
+    size_t size() const { return n_; }
+
+    int windowBits() const { return w_; }
+
+    /**
+     * G[i] (affine)
+     * @throws out_of_range if i >= size()
+     */
+    const ECP &generator(size_t i) const;
+
+    /**
+     * H (affine), the generator of the blinding factor
+     */
+    const ECP &blindingGenerator() const { return table_[n_ * windows_]; }
+
+    /**
+     * Commits to values (missing trailing values count as zero)
+     * @param values At most size() values, any value (reduced modulo the curve order internally)
+     * @param blinding Blinding factor r
+     * @throws invalid_argument if there are more values than generators
+     */
+    ECP commit(const vector<mpz_class> &values, const mpz_class &blinding = 0) const;
+
+    /**
+     * Whether C opens to values and blinding
+     */
+    bool open(const ECP &C, const vector<mpz_class> &values, const mpz_class &blinding = 0) const;
+
+    /**
+     * Changes slot i of the committed vector from oldValue to newValue in place:
+     * C += (newValue - oldValue) * G[i], one scalar multiplication whatever the vector length
+     * (short differences such as +1 / -1 are cheapest)
+     * @throws out_of_range if slot >= size()
+     */
+    void update(ECP &C, size_t slot, const mpz_class &oldValue, const mpz_class &newValue) const;
+
+    /**
+     * Changes the blinding factor of C in place: C += (newBlinding - oldBlinding) * H
+     */
+    void reblind(ECP &C, const mpz_class &oldBlinding, const mpz_class &newBlinding) const;
+
+    /**
+     * Homomorphic addition: commit(a, r) + commit(b, s) == commit(a + b, r + s)
+     */
+    static ECP add(const ECP &A, const ECP &B);
+
+    /**
+     * The table ((size() + 1) * windows entries, generator-major, H last), e.g. to store it in
+     * a PrecomputeCache
+     */
+    const ECP *table() const { return table_; }
+
+    /**
+     * Number of table entries for n generators and a window width
+     */
+    static size_t tableSize(size_t n, int windowBits);
+
+    /**
+     * The window width the constructor picks for n generators: the one minimising
+     * (n + 1) * windows + 2^w additions
+     */
+    static int defaultWindowBits(size_t n);
+
+    /**
+     * The i-th generator under a domain separation tag (hash_to_curve of the 8-byte big-endian
+     * index); the blinding generator is hashed from the message "H"
+     */
+    static ECP deriveGenerator(const string &dst, uint64_t i);
+
+private:
+    size_t n_;
+    int w_;
+    int windows_;
+    vector<ECP> own_;
+    const ECP *table_;
+
+    static int windowCount(int windowBits);
+};
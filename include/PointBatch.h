@@ -0,0 +1,139 @@
+#pragma once
+
+#include "GroupTraits.h"
+
+/**
+ * A batch of G1 (ECP) or G2 (ECP2) points in one contiguous array.
+ *
+ * The points are stored as plain MIRACL structs, so data() can be handed to any API that takes
+ * a point array (ECP_msm, PrecomputeCacheBuilder::add, ...) without copying. Whole-batch
+ * operations go through the batched field code: normalize() converts every point to affine
+ * coordinates with a single field inversion, equality on G1 evaluates the projective cross
+ * products with FpBatch_mul, and serialization normalizes once up front so the per-point
+ * encoder never inverts.
+ */
+template<typename Point>
+class PointBatch {
+public:
+    typedef GroupTraits<Point> G;
+
+    PointBatch() = default;
+
+    /**
+     * n points at infinity
+     */
+    explicit PointBatch(size_t n);
+
+    explicit PointBatch(vector<Point> points) : points_(std::move(points)) {}
+
+    PointBatch(const Point *points, size_t n) : points_(points, points + n) {}
+
+    size_t size() const { return points_.size(); }
+
+    bool empty() const { return points_.empty(); }
+
+    Point *data() { return points_.data(); }
+
+    const Point *data() const { return points_.data(); }
+
+    Point &operator[](size_t i) { return points_[i]; }
+
+    const Point &operator[](size_t i) const { return points_[i]; }
+
+    typename vector<Point>::iterator begin() { return points_.begin(); }
+
+    typename vector<Point>::iterator end() { return points_.end(); }
+
+    typename vector<Point>::const_iterator begin() const { return points_.begin(); }
+
+    typename vector<Point>::const_iterator end() const { return points_.end(); }
+
+    /**
+     * The underlying storage
+     */
+    const vector<Point> &points() const { return points_; }
+
+    void push_back(const Point &P) { points_.push_back(P); }
+
+    /**
+     * Resizes the batch; new points are at infinity
+     */
+    void resize(size_t n);
+
+    void reserve(size_t n) { points_.reserve(n); }
+
+    /**
+     * Converts every point to affine coordinates (z = 1) with one shared inversion, leaving each
+     * point exactly as ECP_affine / ECP2_affine would
+     */
+    void normalize();
+
+    /**
+     * P[i] = P[i] + other[i]
+     * @throws invalid_argument if the sizes differ
+     */
+    void add(const PointBatch &other);
+
+    /**
+     * P[i] = P[i] - other[i]
+     * @throws invalid_argument if the sizes differ
+     */
+    void sub(const PointBatch &other);
+
+    /**
+     * P[i] = -P[i]; affine points stay affine
+     */
+    void negate();
+
+    /**
+     * Sum of all points
+     */
+    Point sum() const;
+
+    /**
+     * eq[i] = (P[i] == other[i]) as group elements, whatever their coordinates
+     * @throws invalid_argument if the sizes differ
+     */
+    void equalsEach(const PointBatch &other, bool *eq) const;
+
+    /**
+     * True if both batches have the same size and hold the same group elements in order
+     */
+    bool operator==(const PointBatch &other) const;
+
+    bool operator!=(const PointBatch &other) const { return !(*this == other); }
+
+    /**
+     * True if every point lies in the prime-order subgroup (PAIR_G1member / PAIR_G2member)
+     */
+    bool allInSubgroup() const;
+
+    /**
+     * Bytes per point of toBytes / fromBytes
+     */
+    static size_t encodedSize(bool compress) { return G::encodedSize(compress); }
+
+    /**
+     * Normalizes the batch and encodes it as size() back-to-back MIRACL octets
+     * of encodedSize(compress) bytes each (the point at infinity has no encoding)
+     */
+    vector<unsigned char> toBytes(bool compress = true);
+
+    /**
+     * Decodes the output of toBytes
+     * @throws invalid_argument if the length is not a multiple of encodedSize(compress)
+     *         or a point does not decode
+     */
+    static PointBatch fromBytes(const unsigned char *bytes, size_t len, bool compress = true);
+
+private:
+    vector<Point> points_;
+
+    void checkSize(const PointBatch &other) const;
+};
+
+typedef PointBatch<ECP> G1Batch;
+typedef PointBatch<ECP2> G2Batch;
+
+extern template class PointBatch<ECP>;
+extern template class PointBatch<ECP2>;
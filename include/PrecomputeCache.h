@@ -0,0 +1,174 @@
+#pragma once
+
+#include "DiscreteLog.h"
+#include "MappedFile.h"
+#include "Shamir.h"
+#include <functional>
+
+/**
+ * On-disk cache of precomputed tables, memory-mapped read-only at startup.
+ *
+ * A cache file is a header, a section table and 64-byte aligned sections. Each section is a
+ * named array of fixed-size elements (raw MIRACL / Fr structs) with its own 64-bit checksum.
+ * The header records the format version and a fingerprint of the curve and of the struct
+ * layouts the tables were written with; a file that does not match the running build, or
+ * whose checksums do not verify, is rejected (PrecomputeCache) or rebuilt (openOrBuild).
+ * Files are replaced atomically, so processes starting concurrently either map the old
+ * file or the new one, and all of them share the same page cache.
+ */
+const uint32_t PRECOMPUTE_CACHE_VERSION = 1;
+
+struct PrecomputeCacheHeader {
+    char magic[8];          // "PRECOMP\0"
+    uint32_t version;       // PRECOMPUTE_CACHE_VERSION
+    uint32_t sectionCount;
+    char curve[16];         // curve and BIG layout the file was built for
+    uint32_t fpSize;        // sizeof(FP), sizeof(ECP), sizeof(ECP2), sizeof(Fr) of the writer
+    uint32_t g1Size;
+    uint32_t g2Size;
+    uint32_t frSize;
+    uint64_t tableOffset;   // offset of sectionCount PrecomputeSectionEntry
+    uint64_t fileSize;
+    uint64_t tableChecksum;
+};
+
+struct PrecomputeSectionEntry {
+    char name[48];          // NUL-terminated
+    uint64_t offset;
+    uint64_t size;          // bytes
+    uint64_t elemSize;
+    uint64_t checksum;
+};
+
+/**
+ * Collects sections and writes a cache file
+ */
+class PrecomputeCacheBuilder {
+public:
+    /**
+     * Adds a section holding count elements of type T
+     * @throws invalid_argument on a duplicate or over-long name
+     */
+    template<typename T>
+    void add(const string &name, const T *data, size_t count) {
+        addRaw(name, data, sizeof(T), count);
+    }
+
+    void addRaw(const string &name, const void *data, size_t elemSize, size_t count);
+
+    /**
+     * Writes the cache atomically
+     * @throws runtime_error on I/O failure
+     */
+    void write(const string &path) const;
+
+private:
+    struct Section {
+        string name;
+        size_t elemSize;
+        vector<unsigned char> bytes;
+    };
+    vector<Section> sections_;
+};
+
+class PrecomputeCache {
+public:
+    PrecomputeCache() = default;
+
+    /**
+     * Maps and validates a cache file
+     * @param path Cache file
+     * @param verifyChecksums Also verify the section checksums (reads every page once)
+     * @throws runtime_error if the file is missing, corrupt, or built for another version/curve
+     */
+    explicit PrecomputeCache(const string &path, bool verifyChecksums = true);
+
+    /**
+     * Maps the cache at `path`; if it is missing or invalid, calls `build` to fill a builder,
+     * writes the file atomically and maps the result
+     * @param rebuilt Set to whether the file had to be (re)built
+     */
+    static PrecomputeCache openOrBuild(const string &path, const function<void(PrecomputeCacheBuilder &)> &build,
+                                       bool *rebuilt = nullptr);
+
+    bool has(const string &name) const { return find(name) != nullptr; }
+
+    /**
+     * Typed view of a section
+     * @param count Set to the number of elements
+     * @throws runtime_error if the section is missing or its element size differs from sizeof(T)
+     */
+    template<typename T>
+    const T *get(const string &name, size_t &count) const {
+        const PrecomputeSectionEntry *e = section(name, sizeof(T));
+        count = e->size / sizeof(T);
+        return (const T *) (file_.data() + e->offset);
+    }
+
+    /**
+     * Names of all sections
+     */
+    vector<string> sections() const;
+
+    size_t fileSize() const { return file_.size(); }
+
+private:
+    MappedFile file_;
+    const PrecomputeSectionEntry *entries_ = nullptr;
+    size_t count_ = 0;
+
+    const PrecomputeSectionEntry *find(const string &name) const;
+
+    const PrecomputeSectionEntry *section(const string &name, size_t elemSize) const;
+};
+
+/**
+ * 64-bit checksum used by the cache format (not cryptographic)
+ */
+uint64_t precomputeChecksum(const void *data, size_t len);
+
+// Standard sections
+extern const char *const PRECOMPUTE_G1_GENERATOR;  // fixed-base table of the G1 generator (ECP)
+extern const char *const PRECOMPUTE_G2_GENERATOR;  // fixed-base table of the G2 generator (ECP2)
+extern const char *const PRECOMPUTE_GT_GENERATOR;  // GTFixedBase table of e(g1, g2) (FP12)
+const int PRECOMPUTE_GT_WINDOW = 6;                // window width of PRECOMPUTE_GT_GENERATOR
+
+/**
+ * Adds the fixed-base tables of the G1 and G2 generators
+ */
+void Precompute_addGenerators(PrecomputeCacheBuilder &builder);
+
+/**
+ * Adds the GTFixedBase table of e(g1, g2); load it with
+ * GTFixedBase(cache.get<FP12>(PRECOMPUTE_GT_GENERATOR, n), n, PRECOMPUTE_GT_WINDOW)
+ */
+void Precompute_addGTGenerator(PrecomputeCacheBuilder &builder);
+
+/**
+ * Section name of the reconstruction weights of a Shamir configuration
+ */
+string Precompute_shamirSection(const ShamirEngine &engine);
+
+/**
+ * Adds the reconstruction weights of `engine` for the parties 0 .. t-1
+ */
+void Precompute_addShamirWeights(PrecomputeCacheBuilder &builder, const ShamirEngine &engine);
+
+/**
+ * Seeds the weight cache of `engine` from a cache file
+ * @return false if the file holds no weights for this configuration
+ */
+bool Precompute_loadShamirWeights(const PrecomputeCache &cache, ShamirEngine &engine);
+
+/**
+ * Section name of a DiscreteLog table: group, fingerprint of the base and number of baby steps
+ */
+template<typename Group>
+string Precompute_discreteLogSection(const Group &base, uint64_t babySteps);
+
+/**
+ * Adds the baby-step table of `dlog`; load it with
+ * DiscreteLog<Group>(base, range, cache.get<uint64_t>(Precompute_discreteLogSection(base, M), n), n, M)
+ */
+template<typename Group>
+void Precompute_addDiscreteLog(PrecomputeCacheBuilder &builder, const DiscreteLog<Group> &dlog);
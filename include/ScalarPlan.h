@@ -0,0 +1,68 @@
+#pragma once
+
+#include "PointBatch.h"
+
+/**
+ * A scalar converted and recoded once, for multiplying any number of G1 / G2 points by it
+ * (re-randomizing credentials, signing many messages with one key, ...).
+ *
+ * The scalar is reduced modulo the curve order and split along the curve endomorphisms:
+ * k = k0 + k1 * lambda on G1, where phi(x, y) = (beta * x, y) acts as lambda (two parts of
+ * about 128 bits), and k = k0 + k1 * u + k2 * u^2 + k3 * u^3 on G2, where the
+ * untwist-Frobenius-twist map psi acts as u = x mod q (four parts of about 64 bits). Every part
+ * is recoded in width-5 NAF. Applying the plan then takes about 128 (G1) or 64 (G2) doublings
+ * and one addition per nonzero digit, against about 255 doublings for ECP_mul. The eigenvalues
+ * are checked against the generators on first use; should a check fail, the plan falls back to
+ * a single wNAF of the full scalar.
+ *
+ * The batch entry points run all points through the digit sequence in lockstep in affine
+ * coordinates on G1, so each doubling or addition step costs one field inversion for the whole
+ * batch (batched Fp arithmetic, see FpBatch.h). G2 points are multiplied one at a time.
+ *
+ * Points must lie in the prime-order subgroups (as every point this library produces does),
+ * since the endomorphisms act as lambda / u only there. Not constant time.
+ */
+class ScalarPlan {
+public:
+    static const int WINDOW = 5;     // wNAF width: digits are odd and in (-16, 16)
+
+    /**
+     * @param k Any integer (reduced modulo the curve order)
+     */
+    explicit ScalarPlan(const mpz_class &k);
+
+    /**
+     * @param k Normalized BIG (reduced modulo the curve order)
+     */
+    explicit ScalarPlan(BIG k);
+
+    /**
+     * P = k * P
+     */
+    void apply(ECP &P) const;
+
+    void apply(ECP2 &P) const;
+
+    /**
+     * P[i] = k * P[i] for i < n; results are affine
+     */
+    void apply(ECP *P, size_t n) const;
+
+    void apply(ECP2 *P, size_t n) const;
+
+    void apply(G1Batch &points) const { apply(points.data(), points.size()); }
+
+    void apply(G2Batch &points) const { apply(points.data(), points.size()); }
+
+    /**
+     * Whether the scalar is zero modulo the curve order
+     */
+    bool isZero() const { return zero_; }
+
+private:
+    bool zero_;
+    vector<int8_t> g1_[2];           // wNAF digits of the G1 parts, least significant first
+    vector<int8_t> g2_[4];           // same for G2
+
+    void init(mpz_class k);
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "Fr.h"
+
+/**
+ * Bulk generator of uniform nonzero scalars modulo the curve order q.
+ *
+ * The keystream is ChaCha20 (8 blocks per call, AVX2 when the CPU has it). Candidates are
+ * 255-bit little-endian words from the keystream, accepted when 0 < x < q (about 90% of them);
+ * the rejection test runs on plain 64-bit words for a whole buffer at a time, and accepted
+ * values are written straight into BIG limbs, mpz_class or Fr without string or byte-order
+ * round trips. An Fr output takes the accepted words as its Montgomery representation, which
+ * is uniform as well.
+ *
+ * Not thread-safe: use one generator per thread.
+ */
+class ScalarRng {
+public:
+    /**
+     * Keyed from the operating system (std::random_device)
+     */
+    ScalarRng();
+
+    /**
+     * Deterministic stream from a 64-bit seed (reproducible tests and benchmarks; not secret)
+     */
+    explicit ScalarRng(uint64_t seed);
+
+    /**
+     * Keyed with a 32-byte ChaCha20 key
+     */
+    explicit ScalarRng(const unsigned char key[32]);
+
+    /**
+     * Keyed from an existing MIRACL generator (initialized by initRNG)
+     */
+    explicit ScalarRng(csprng &rng);
+
+    /**
+     * Raw keystream bytes
+     */
+    void bytes(unsigned char *out, size_t len);
+
+    /**
+     * Fills out[0 .. n-1] with uniform scalars in [1, q)
+     */
+    void fill(BIG *out, size_t n);
+
+    void fill(mpz_class *out, size_t n);
+
+    void fill(Fr *out, size_t n);
+
+    void fill(vector<mpz_class> &out) { fill(out.data(), out.size()); }
+
+    void fill(vector<Fr> &out) { fill(out.data(), out.size()); }
+
+    /**
+     * A single scalar in [1, q)
+     */
+    mpz_class nextMpz();
+
+private:
+    uint32_t state_[16];
+    uint64_t counter_ = 0;
+    unsigned char buf_[512];
+    size_t pos_ = sizeof(buf_);
+
+    void setKey(const unsigned char key[32]);
+
+    void refill();
+
+    /**
+     * Next n accepted candidates as 4 little-endian words each
+     */
+    void candidates(uint64_t *words, size_t n);
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "GroupTraits.h"
+#include "ScalarRng.h"
+
+/**
+ * Schnorr-style proof of knowledge of x with X = x * g, in G1 (ECP) or G2 (ECP2): a commitment
+ * R = k * g, a challenge c and the response s = k + c * x mod q. It verifies iff
+ * s * g == R + c * X.
+ *
+ * Challenges are either chosen by a verifier or derived by Fiat-Shamir with Schnorr_challenge /
+ * Schnorr_challenges (SHA-512 of g, X, R and a message, reduced modulo q).
+ *
+ * Batch verification folds the equations of many proofs, each weighted by an independent
+ * random 128-bit r_i, into
+ *   (sum r_i * s_i) * g - sum (r_i * c_i) * X_i - sum r_i * R_i == 0,
+ * one multi-scalar multiplication over the X_i (and g) and one over the R_i with 128-bit
+ * scalars. A batch holding an invalid proof passes with probability at most 2^-128. When the
+ * combined check fails, the batch is bisected with the same weights until the failing proofs
+ * are isolated: k bad proofs among n cost O(k log n) combined checks.
+ *
+ * The points must be members of the prime-order subgroup (as after PAIR_G1member /
+ * PAIR_G2member on decoded input); the random weights give no guarantee otherwise.
+ */
+template<typename Point>
+struct SchnorrProof {
+    Point X;                 // public key x * g
+    Point R;                 // commitment k * g
+    mpz_class c;             // challenge
+    mpz_class s;             // response k + c * x mod q
+};
+
+typedef SchnorrProof<ECP> G1SchnorrProof;
+typedef SchnorrProof<ECP2> G2SchnorrProof;
+
+/**
+ * Outcome of a batch verification
+ */
+struct SchnorrBatchResult {
+    bool valid = true;                   // every proof verified
+    vector<size_t> invalid;              // indices of the failing proofs, ascending
+    size_t checks = 0;                   // combined checks evaluated (1 if the whole batch verified)
+};
+
+/**
+ * Fiat-Shamir challenge of one proof: SHA-512 over a domain tag, g, X, R (compressed) and
+ * the message, reduced modulo the curve order
+ */
+template<typename Point>
+mpz_class Schnorr_challenge(const Point &g, const Point &X, const Point &R, const string &message);
+
+/**
+ * Sets proofs[i].c to the Fiat-Shamir challenge of proof i, equal to Schnorr_challenge but
+ * with every point converted to affine coordinates by one shared inversion
+ * @param messages Empty (no messages) or one per proof
+ * @throws invalid_argument if messages has another size
+ */
+template<typename Point>
+void Schnorr_challenges(const Point &g, vector<SchnorrProof<Point>> &proofs, const vector<string> &messages = {});
+
+/**
+ * Non-interactive proof of knowledge of x (challenge from Schnorr_challenge)
+ */
+template<typename Point>
+SchnorrProof<Point> Schnorr_prove(const Point &g, const mpz_class &x, const string &message, ScalarRng &rng);
+
+/**
+ * Verifies one proof: s * g - c * X == R, with one shared doubling chain
+ */
+template<typename Point>
+bool Schnorr_verify(const Point &g, const SchnorrProof<Point> &proof);
+
+/**
+ * Verifies a batch of proofs against the same base g, isolating the failing ones by bisection
+ * @param rng Source of the weights; the overload without it uses a per-thread generator
+ *            seeded from the OS
+ */
+template<typename Point>
+SchnorrBatchResult Schnorr_batchVerify(const Point &g, const vector<SchnorrProof<Point>> &proofs, ScalarRng &rng);
+
+template<typename Point>
+SchnorrBatchResult Schnorr_batchVerify(const Point &g, const vector<SchnorrProof<Point>> &proofs);
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "Fr.h"
+#include <map>
+#include <mutex>
+
+/**
+ * Batched Shamir secret sharing over Fq.
+ *
+ * A whole batch of secrets is shared to n parties in one call. The result is laid out
+ * party-major: the values held by party p are contiguous, so handing a party its shares is
+ * a single slice. Reconstruction evaluates directly at the secret point(s) with Lagrange
+ * weights that are computed once per set of contributing parties and cached.
+ *
+ * Evaluation domains:
+ *  - Integers:      party p holds f(p + 1), the convention used with getLagrangeBasis.
+ *                   Sharing costs O(n * t) field multiplications per secret.
+ *  - RootsOfUnity:  party p holds f(omega^p) with omega = Fr_rootOfUnity(N), N the power of two
+ *                   >= max(n, t). Every polynomial is evaluated with one NTT, O(N log N)
+ *                   per secret independently of t.
+ *
+ * Packed sharing (packing = k > 1, Integers domain only) embeds k secrets in one polynomial
+ * of degree t - 1 at the points 0, -1, ..., -(k-1). Any t parties reconstruct, while up to
+ * t - k parties learn nothing.
+ */
+enum class ShamirDomain {
+    Integers,
+    RootsOfUnity
+};
+
+/**
+ * Shares produced by ShamirEngine::share
+ */
+struct ShamirShares {
+    size_t parties = 0;
+    size_t secrets = 0;     // number of shared secrets
+    size_t perParty = 0;    // values held by each party (secrets / packing, rounded up)
+    vector<Fr> data;        // data[p * perParty + i]
+
+    /**
+     * Contiguous shares of party p (perParty values)
+     */
+    const Fr *party(size_t p) const { return data.data() + p * perParty; }
+};
+
+class ShamirEngine {
+public:
+    /**
+     * @param parties Number of parties n
+     * @param threshold Number of shares t needed to reconstruct (polynomial degree t - 1)
+     * @param domain Evaluation points of the parties
+     * @param packing Secrets embedded per polynomial (1 = plain Shamir)
+     * @throws invalid_argument for inconsistent parameters
+     */
+    ShamirEngine(size_t parties, size_t threshold, ShamirDomain domain = ShamirDomain::Integers, size_t packing = 1);
+
+    size_t parties() const { return n_; }
+
+    size_t threshold() const { return t_; }
+
+    size_t packing() const { return k_; }
+
+    ShamirDomain domain() const { return domain_; }
+
+    /**
+     * Evaluation point of party p
+     */
+    const Fr &partyPoint(size_t p) const { return points_[p]; }
+
+    /**
+     * Shares a batch of secrets
+     * @param secrets Secrets to share
+     * @param count Number of secrets
+     * @param rng Seed used for the random polynomial coefficients (initialized by initRNG)
+     * @return Party-major shares
+     */
+    ShamirShares share(const Fr *secrets, size_t count, csprng &rng) const;
+
+    /**
+     * Shares a batch of mpz_class secrets (reduced modulo q)
+     */
+    ShamirShares share(const vector<mpz_class> &secrets, csprng &rng) const;
+
+    /**
+     * Reconstructs all secrets from the shares of a set of at least t parties (the first t are used).
+     * @param ids Indices of the contributing parties (distinct, < parties())
+     * @param rows rows[i] points to the perParty shares of party ids[i]
+     * @param secrets Number of secrets in the batch
+     * @return The secrets, in sharing order
+     * @throws invalid_argument if fewer than t parties contribute
+     */
+    vector<Fr> reconstruct(const vector<size_t> &ids, const vector<const Fr *> &rows, size_t secrets) const;
+
+    /**
+     * Reconstructs all secrets of a ShamirShares batch from the parties in `ids`
+     */
+    vector<Fr> reconstruct(const ShamirShares &shares, const vector<size_t> &ids) const;
+
+    /**
+     * Lagrange weights mapping the shares of the first t entries of `ids` to the values of the
+     * polynomial at the secret points; weights[s * t + i] belongs to secret slot s and party ids[i].
+     * Cached per id set.
+     */
+    vector<Fr> reconstructionWeights(const vector<size_t> &ids) const;
+
+    /**
+     * Seeds the weight cache with precomputed weights (e.g. from a PrecomputeCache)
+     * @param ids Contributing parties; only the first t are used as the key
+     * @param weights packing() * threshold() values laid out as in reconstructionWeights
+     */
+    void preloadWeights(const vector<size_t> &ids, const Fr *weights);
+
+private:
+    size_t n_, t_, k_;
+    ShamirDomain domain_;
+    size_t nttSize_ = 0;
+    vector<Fr> points_;       // party evaluation points
+    vector<Fr> shareWeights_; // packed only: n x t matrix from defining values to party shares
+
+    mutable mutex cacheMutex_;
+    mutable map<vector<size_t>, vector<Fr>> weightCache_;
+
+    static const size_t WEIGHT_CACHE_LIMIT = 64;
+
+    /**
+     * Barycentric weights 1 / prod_{m != i} (xs[i] - xs[m])
+     */
+    static vector<Fr> baryWeights(const vector<Fr> &xs);
+
+    /**
+     * Lagrange weights w[i] = L_i(target) for the polynomial through the points xs, in O(|xs|)
+     */
+    static void lagrangeAt(Fr *w, const vector<Fr> &xs, const vector<Fr> &bary, const Fr &target);
+
+    /**
+     * The k points carrying the secrets: 0, -1, ..., -(k-1)
+     */
+    vector<Fr> secretPoints() const;
+};
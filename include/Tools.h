@@ -1,3 +1,5 @@
+#pragma once
+
 #include <iostream>
 #include <pair_BLS12381.h>
 #include <bls_BLS12381.h>
@@ -62,16 +64,18 @@ string charsToString(char *ch);
 mpz_class BIG_to_mpz(BIG big);
 
 /**
- * Converts an mpz_class integer to a BIG integer
+ * Converts an mpz_class integer to a BIG integer (the magnitude, for negative t)
  * @param t mpz_class integer to be converted
  * @param big Output BIG integer
+ * @throws invalid_argument if |t| does not fit in 384 bits
  */
 void mpz_to_BIG(const mpz_class& t, BIG& big);
 
 /**
  * Converts a string to a BIG integer
- * @param hex_string The string to be converted
+ * @param hex_string The string to be converted: up to 96 hex digits, zero-extended on the left
  * @param big Output BIG integer
+ * @throws invalid_argument on a non-hex character or more than 96 digits
  */
 void str_to_BIG(string hex_string, BIG &big);
 
@@ -109,9 +113,16 @@ void initState(gmp_randstate_t& state);
  */
 mpz_class rand_mpz(gmp_randstate_t state);
 
+/**
+ * Returns the order q of the BLS12381 groups as an mpz_class (converted once and cached)
+ * @return Reference to the cached curve order
+ */
+const mpz_class &getCurveOrder();
+
 
 /**
- * Computes base^exp % mod, with the result stored in res
+ * Computes base^exp % mod, with the result stored in res.
+ * Modulo the curve order, the tuning profile may route it to Fr_pow (see Tuning.h).
  * @param base Base number
  * @param exp Exponent
  * @param mod Modulus
@@ -120,13 +131,23 @@ mpz_class rand_mpz(gmp_randstate_t state);
 mpz_class pow_mpz(const mpz_class& base, const mpz_class& exp, const mpz_class& mod);
 
 /**
- * Computes the modular multiplicative inverse of a under modulo m, result stored in res
+ * Computes the modular multiplicative inverse of a under modulo m, result stored in res.
+ * Odd moduli up to 384 bits use binary-GCD divsteps without allocating, unless the tuning profile
+ * prefers mpz_invert (see Tuning.h); others use mpz_invert.
  * @param a Integer to find the inverse of
  * @param m Modulus
  * @return Modular multiplicative inverse, or 0 if it doesn't exist
  */
 mpz_class invert_mpz(const mpz_class& a, const mpz_class& m);
 
+/**
+ * Inverts every element of a modulo m with a single modular inversion (Montgomery's trick)
+ * @param a Integers to invert, any value
+ * @param m Modulus
+ * @return The inverses; 0 for elements that have none (in particular for multiples of m)
+ */
+vector<mpz_class> invert_mpz_batch(const vector<mpz_class>& a, const mpz_class& m);
+
 /**
  * Computes the Lagrange interpolation coefficients for a given set of points under a modulus.
  * @param x Vector of x-coordinates of the interpolation points.
@@ -250,12 +271,37 @@ ECP hashToPoint(mpz_class big, mpz_class q);
 FP12 e(ECP P1, ECP2 P2);
 
 /**
- * Computes the modular multiplicative inverse of an integer a under modulo m, result stored in res
- * @param res Stores the multiplicative inverse
+ * Checks whether the product of pairings e(P1[0], P2[0]) * ... * e(P1[n-1], P2[n-1]) equals 1.
+ * All pairs share one Miller loop and a single final exponentiation.
+ * @param P1 Elements on G1
+ * @param P2 Elements on G2, same length as P1
+ * @return true if the pairing product is the identity of GT
+ */
+bool pairingProductIsOne(const vector<ECP> &P1, const vector<ECP2> &P2);
+
+/**
+ * Computes the modular multiplicative inverse of an integer a under modulo m, result stored in res.
+ * Odd moduli use Bernstein-Yang divsteps on 62-bit limbs; even moduli fall back to the
+ * extended Euclidean algorithm.
+ * @param res Stores the multiplicative inverse (0 if it doesn't exist and m is odd)
  * @param a Integer to find the inverse of
  * @param m Modulus
+ * @param constantTime Run a fixed number of divsteps with no secret-dependent branches
+ *        (for secret a; a must already be reduced modulo m)
+ * @throws invalid_argument if constantTime is set and m is even
+ */
+void BIG_inv(BIG &res, const BIG a, const BIG m, bool constantTime = false);
+
+/**
+ * r[i] = a[i]^-1 mod m for i < n with a single modular inversion (Montgomery's trick).
+ * Uses the native Fq arithmetic when m is the curve order.
+ * @param r Results, may alias a
+ * @param a Integers to invert
+ * @param n Number of elements
+ * @param m Modulus
+ * Elements without an inverse (e.g. zero) map to zero.
  */
-void BIG_inv(BIG &res, const BIG a, const BIG m);
+void BIG_batchInv(BIG *r, const BIG *a, size_t n, const BIG m);
 
 /**
  * Outputs a BIG integer in hexadecimal format, including a newline
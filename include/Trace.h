@@ -0,0 +1,107 @@
+#pragma once
+
+#include "Tools.h"
+
+/**
+ * Opt-in record and replay of Tools.h calls, to compare builds of the library on the mix of
+ * operations and input sizes a production process actually runs.
+ *
+ * While a trace is active, every outermost call of the arithmetic entry points of Tools.h
+ * (scalar multiplications, pairings, GT and modular arithmetic, Lagrange interpolation,
+ * hashing; not the conversion and printing helpers) is recorded with its thread, start time,
+ * duration and a size describing its input (see TraceOp), optionally with its encoded
+ * arguments. Calls made by a traced call are part of it and are not recorded on their own.
+ * With tracing off, the cost per call is one relaxed atomic load.
+ *
+ * Records are buffered per thread and appended to the file in chunks. The file is a header
+ * ("WTRACE", TRACE_FORMAT_VERSION, flags) followed by chunks (u32 length, u32 thread, then
+ * records); a record is its operation byte followed by LEB128 varints: size, start (relative to
+ * the previous record of the chunk), duration and, when inputs are captured, the input length
+ * and bytes. A record without inputs takes about 8 bytes.
+ *
+ * Tracing starts with Trace_start, or at load time when the environment variable
+ * WRAPPER_TRACE names the trace file (WRAPPER_TRACE_INPUTS=1 also captures inputs); such a
+ * trace is completed when the process exits normally.
+ *
+ * Trace_replay (and the trace_replay tool) re-executes a trace against the running build and
+ * reports the recorded and replayed time of every operation. Captured inputs are replayed
+ * exactly; other records are replayed on random inputs of the recorded size, modulo the curve
+ * order where the operation takes a modulus.
+ */
+const uint32_t TRACE_FORMAT_VERSION = 1;
+
+enum class TraceOp : uint8_t {
+    ECP_mul,                 // size: bits of the scalar
+    ECP2_mul,                // size: bits of the scalar
+    FP12_mul,                // FP12_mulMy; size 0
+    FP12_pow,                // size: bits of the exponent
+    FP12_inv,                // size 0
+    Pairing,                 // e(); size 0
+    PairingProduct,          // pairingProductIsOne; size: number of pairs
+    PowMpz,                  // pow_mpz; size: bits of the exponent
+    InvertMpz,               // invert_mpz; size: bits of the modulus
+    InvertMpzBatch,          // invert_mpz_batch; size: number of elements
+    LagrangeCoffs,           // getLagrangeCoffs; size: number of points
+    ComputePoly,             // computePoly; size: number of coefficients
+    LagrangeBasis,           // getLagrangeBasis; size: number of points
+    HashZp256,               // size: bytes hashed
+    HashToZp256,             // BIG and mpz_class overloads; size 48
+    HashToPoint,             // BIG and mpz_class overloads; size 48
+    BigInv,                  // BIG_inv, variable time; size: bits of the modulus
+    BigInvConstantTime,      // BIG_inv, constant time; size: bits of the modulus
+    BigBatchInv,             // BIG_batchInv; size: number of elements
+    RandECP,                 // size 0
+    RandECP2,                // size 0
+    Count
+};
+
+/**
+ * Name of the Tools.h function an operation stands for (e.g. "ECP_mul", "e")
+ */
+const char *TraceOp_name(TraceOp op);
+
+struct TraceRecord {
+    TraceOp op;
+    uint32_t thread;                 // thread number within the trace, from 0
+    uint64_t size;                   // see TraceOp
+    uint64_t start;                  // ns since the trace started
+    uint64_t duration;               // ns
+    vector<unsigned char> input;     // encoded arguments; empty unless inputs were captured
+};
+
+/**
+ * Starts recording to `path` (truncated)
+ * @param captureInputs Also record the arguments of every call, for exact replay
+ * @throws runtime_error if a trace is already active or the file cannot be created
+ */
+void Trace_start(const string &path, bool captureInputs = false);
+
+/**
+ * Stops recording and completes the file (no-op if no trace is active)
+ */
+void Trace_stop();
+
+bool Trace_active();
+
+/**
+ * Reads a trace; the records are ordered by start time. An incomplete last chunk (a process
+ * that did not exit normally) is ignored.
+ * @throws runtime_error if the file is missing or not a trace of this format
+ */
+vector<TraceRecord> Trace_read(const string &path);
+
+struct TraceOpStats {
+    TraceOp op;
+    size_t calls = 0;
+    size_t synthesized = 0;          // calls replayed on random inputs
+    uint64_t recordedNs = 0;
+    uint64_t replayedNs = 0;
+};
+
+/**
+ * Re-executes the records one after another on the calling thread (nothing is recorded
+ * meanwhile) and sums the recorded and replayed durations per operation
+ * @param repeats Every record is executed this many times and the fastest run counts
+ * @return One entry per operation present in the trace, in TraceOp order
+ */
+vector<TraceOpStats> Trace_replay(const vector<TraceRecord> &records, int repeats = 1);
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "MSM.h"
+#include "FpBatch.h"
+#include "CurveIsa.h"
+
+/**
+ * Per-CPU tuning of the choices the wrapper makes between equivalent kernels: the FpBatch
+ * backend, the curve ISA level, divsteps or mpz_invert in invert_mpz, mpz_powm or Fr_pow in
+ * pow_mpz modulo the curve order, the Straus / Pippenger cut-over of ECP_msm and ECP2_msm and
+ * the Pippenger window width per input size.
+ *
+ * Tuning_measure times the public entry points under each candidate choice and returns the
+ * fastest profile. Profiles are kept in a text file, one section per CPU model (see
+ * Tuning_defaultPath), written by Tuning_save or the tuning_profile tool.
+ *
+ * The profile in effect is settled on first use, when one of the dispatching functions first
+ * consults Tuning_active(), from the environment variable WRAPPER_TUNING:
+ *  - unset: the file's profile for the running CPU model if there is one, else Tuning_defaults()
+ *  - "auto": the same, but a CPU without a stored profile is measured once (about a second)
+ *    and the result is stored for later processes
+ *  - "off": Tuning_defaults(), the file is not read
+ * WRAPPER_CURVE_ISA, when set, still takes precedence over the profile's curve level.
+ */
+const int TUNING_PROFILE_VERSION = 1;
+const int TUNING_MSM_CLASSES = 25;             // window classes: n in [2^k, 2^(k+1)), the last one open-ended
+
+struct TuningProfile {
+    string cpu;                                // CPU model the profile belongs to
+    FpBackend fpBackend;
+    CurveIsa curveIsa;
+    bool divstepsInverse;                      // invert_mpz: divsteps (true) or mpz_invert
+    bool frPow;                                // pow_mpz modulo the curve order: Fr_pow (true) or mpz_powm
+    size_t strausMaxTerms;                     // ECP_msm / ECP2_msm use Straus up to this many terms
+    int msmWindow[TUNING_MSM_CLASSES];         // Pippenger window bits for n in [2^k, 2^(k+1))
+};
+
+struct TuningConfig {
+    int repeats = 3;                           // each candidate is timed this many times, the best run counts
+    size_t maxMsmTerms = 4096;                 // largest MSM measured; bigger classes keep the offset of this one
+};
+
+/**
+ * Model name of the running CPU ("unknown" if it cannot be determined)
+ */
+string Tuning_cpuModel();
+
+/**
+ * The built-in choices for the running CPU: best available backend and ISA level, divsteps,
+ * mpz_powm, STRAUS_MAX_TERMS and msmDefaultWindowBits
+ */
+TuningProfile Tuning_defaults();
+
+/**
+ * Micro-benchmarks the candidates on the running CPU. The active profile is swapped while
+ * measuring and restored afterwards; results of the wrapper stay correct throughout, only
+ * concurrent callers' timings are disturbed.
+ * @return The fastest profile, for Tuning_cpuModel()
+ */
+TuningProfile Tuning_measure(const TuningConfig &config = TuningConfig());
+
+/**
+ * The profile in effect, settled on first use (see above)
+ */
+const TuningProfile &Tuning_active();
+
+/**
+ * Makes a profile the active one and switches FpBatch and the curve ISA level to its choices;
+ * backends the CPU lacks fall back as in FpBatch_setBackend and CurveIsa_set
+ */
+void Tuning_apply(const TuningProfile &profile);
+
+/**
+ * The profile file: WRAPPER_TUNING_FILE, else $XDG_CACHE_HOME/miracl-wrapper/tuning.conf, else
+ * $HOME/.cache/miracl-wrapper/tuning.conf
+ */
+string Tuning_defaultPath();
+
+/**
+ * Reads all profiles of a file; sections of another TUNING_PROFILE_VERSION are skipped
+ * @return The profiles, none if the file does not exist
+ * @throws runtime_error on a malformed file
+ */
+vector<TuningProfile> Tuning_load(const string &path);
+
+/**
+ * Stores a profile in a file, replacing the section of the same CPU model; the file and its
+ * directory are created as needed and replaced atomically
+ * @throws runtime_error on I/O failure or a malformed existing file
+ */
+void Tuning_save(const string &path, const TuningProfile &profile);
+
+/**
+ * A profile as a file section
+ */
+string Tuning_format(const TuningProfile &profile);
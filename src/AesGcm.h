@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * AES-256-GCM with a 96-bit IV and no associated data, on AES-NI and PCLMULQDQ.
+ *
+ * Implemented in AesGcmAesni.cpp, which is compiled for those instructions; call only after
+ * checking the CPU. The key schedule and the powers of the hash key are kept as plain bytes
+ * so that this header needs no intrinsics.
+ */
+struct AesGcmAesniKey {
+    alignas(16) unsigned char roundKeys[15 * 16];
+    alignas(16) unsigned char hPowers[4 * 16];     // H, H^2, H^3, H^4, byte-reversed as the GHASH code uses them
+};
+
+void aesGcmSetKey_aesni(AesGcmAesniKey &k, const unsigned char key[32]);
+
+/**
+ * Encrypts len bytes (in and out may be the same buffer) and computes the tag over the ciphertext
+ */
+void aesGcmEncrypt_aesni(const AesGcmAesniKey &k, const unsigned char iv[12], const unsigned char *in,
+                         unsigned char *out, size_t len, unsigned char tag[16]);
+
+/**
+ * Decrypts len bytes (in and out may be the same buffer) and computes the tag over the ciphertext;
+ * the caller compares it with the received one
+ */
+void aesGcmDecrypt_aesni(const AesGcmAesniKey &k, const unsigned char iv[12], const unsigned char *in,
+                         unsigned char *out, size_t len, unsigned char tag[16]);
@@ -0,0 +1,194 @@
+// Compiled with -maes -mpclmul -msse4.1 (see CMakeLists.txt); only called after runtime CPU detection
+#include "AesGcm.h"
+#include <cstring>
+#include <immintrin.h>
+
+namespace {
+    const int ROUNDS = 14;
+
+    inline __m128i bswap(__m128i x) {
+        return _mm_shuffle_epi8(x, _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+    }
+
+    inline __m128i load(const unsigned char *p) {
+        return _mm_loadu_si128((const __m128i *) p);
+    }
+
+    /**
+     * One step of the AES-256 key schedule: the next even round key from the previous one and
+     * the (rotated, substituted) word of `assist`
+     */
+    inline __m128i expandA(__m128i key, __m128i assist) {
+        assist = _mm_shuffle_epi32(assist, 0xff);
+        key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+        key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+        key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+        return _mm_xor_si128(key, assist);
+    }
+
+    /**
+     * The next odd round key (substitution without rotation or round constant)
+     */
+    inline __m128i expandB(__m128i key, __m128i even) {
+        __m128i assist = _mm_shuffle_epi32(_mm_aeskeygenassist_si128(even, 0), 0xaa);
+        key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+        key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+        key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+        return _mm_xor_si128(key, assist);
+    }
+
+    inline __m128i encryptBlock(const __m128i *rk, __m128i x) {
+        x = _mm_xor_si128(x, rk[0]);
+        for (int r = 1; r < ROUNDS; ++r) x = _mm_aesenc_si128(x, rk[r]);
+        return _mm_aesenclast_si128(x, rk[ROUNDS]);
+    }
+
+    /**
+     * (hi:lo) ^= a * b, carry-less, without reduction
+     */
+    inline void clmulAdd(__m128i a, __m128i b, __m128i &lo, __m128i &hi) {
+        __m128i t0 = _mm_clmulepi64_si128(a, b, 0x00);
+        __m128i t1 = _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x10), _mm_clmulepi64_si128(a, b, 0x01));
+        __m128i t2 = _mm_clmulepi64_si128(a, b, 0x11);
+        lo = _mm_xor_si128(lo, _mm_xor_si128(t0, _mm_slli_si128(t1, 8)));
+        hi = _mm_xor_si128(hi, _mm_xor_si128(t2, _mm_srli_si128(t1, 8)));
+    }
+
+    /**
+     * Reduces a 256-bit product of byte-reversed operands modulo the GHASH polynomial: a shift
+     * by one bit undoes the bit reflection, then two folding steps (Gueron and Kounavis)
+     */
+    inline __m128i reduce(__m128i lo, __m128i hi) {
+        __m128i c0 = _mm_srli_epi32(lo, 31), c1 = _mm_srli_epi32(hi, 31);
+        lo = _mm_slli_epi32(lo, 1);
+        hi = _mm_slli_epi32(hi, 1);
+        hi = _mm_or_si128(hi, _mm_srli_si128(c0, 12));
+        hi = _mm_or_si128(hi, _mm_slli_si128(c1, 4));
+        lo = _mm_or_si128(lo, _mm_slli_si128(c0, 4));
+
+        __m128i a = _mm_xor_si128(_mm_xor_si128(_mm_slli_epi32(lo, 31), _mm_slli_epi32(lo, 30)), _mm_slli_epi32(lo, 25));
+        __m128i carry = _mm_srli_si128(a, 4);
+        lo = _mm_xor_si128(lo, _mm_slli_si128(a, 12));
+        __m128i b = _mm_xor_si128(_mm_xor_si128(_mm_srli_epi32(lo, 1), _mm_srli_epi32(lo, 2)), _mm_srli_epi32(lo, 7));
+        lo = _mm_xor_si128(lo, _mm_xor_si128(b, carry));
+        return _mm_xor_si128(hi, lo);
+    }
+
+    inline __m128i gfmul(__m128i a, __m128i b) {
+        __m128i lo = _mm_setzero_si128(), hi = _mm_setzero_si128();
+        clmulAdd(a, b, lo, hi);
+        return reduce(lo, hi);
+    }
+
+    /**
+     * GHASH state; absorbs ciphertext blocks four at a time with one reduction
+     */
+    struct Ghash {
+        __m128i h[4];                          // H^1 .. H^4
+        __m128i x = _mm_setzero_si128();
+
+        explicit Ghash(const unsigned char *powers) {
+            for (int i = 0; i < 4; ++i) h[i] = load(powers + 16 * i);
+        }
+
+        void block(__m128i c) {
+            x = gfmul(_mm_xor_si128(x, bswap(c)), h[0]);
+        }
+
+        void blocks4(const __m128i *c) {
+            __m128i lo = _mm_setzero_si128(), hi = _mm_setzero_si128();
+            clmulAdd(_mm_xor_si128(x, bswap(c[0])), h[3], lo, hi);
+            clmulAdd(bswap(c[1]), h[2], lo, hi);
+            clmulAdd(bswap(c[2]), h[1], lo, hi);
+            clmulAdd(bswap(c[3]), h[0], lo, hi);
+            x = reduce(lo, hi);
+        }
+    };
+
+    /**
+     * Counter block IV || BE32(counter)
+     */
+    inline __m128i counterBlock(__m128i iv, uint32_t counter) {
+        return _mm_insert_epi32(iv, (int) __builtin_bswap32(counter), 3);
+    }
+
+    void crypt(const AesGcmAesniKey &k, const unsigned char iv[12], const unsigned char *in, unsigned char *out,
+               size_t len, unsigned char tag[16], bool encrypt) {
+        const __m128i *rk = (const __m128i *) k.roundKeys;
+        unsigned char ivBlock[16] = {0};
+        memcpy(ivBlock, iv, 12);
+        __m128i base = load(ivBlock);
+        Ghash g(k.hPowers);
+        uint32_t counter = 2;
+        size_t i = 0;
+        for (; i + 128 <= len; i += 128, counter += 8) {
+            __m128i s[8], c[8];
+            for (int j = 0; j < 8; ++j) s[j] = _mm_xor_si128(counterBlock(base, counter + j), rk[0]);
+            for (int r = 1; r < ROUNDS; ++r) {
+                for (int j = 0; j < 8; ++j) s[j] = _mm_aesenc_si128(s[j], rk[r]);
+            }
+            for (int j = 0; j < 8; ++j) {
+                __m128i d = load(in + i + 16 * j);
+                __m128i e = _mm_xor_si128(d, _mm_aesenclast_si128(s[j], rk[ROUNDS]));
+                c[j] = encrypt ? e : d;
+                _mm_storeu_si128((__m128i *) (out + i + 16 * j), e);
+            }
+            g.blocks4(c);
+            g.blocks4(c + 4);
+        }
+        for (; i + 16 <= len; i += 16, ++counter) {
+            __m128i d = load(in + i);
+            __m128i e = _mm_xor_si128(d, encryptBlock(rk, counterBlock(base, counter)));
+            g.block(encrypt ? e : d);
+            _mm_storeu_si128((__m128i *) (out + i), e);
+        }
+        if (i < len) {
+            unsigned char ks[16], last[16] = {0};
+            _mm_storeu_si128((__m128i *) ks, encryptBlock(rk, counterBlock(base, counter)));
+            for (size_t j = 0; i + j < len; ++j) {
+                unsigned char d = in[i + j], e = d ^ ks[j];
+                last[j] = encrypt ? e : d;
+                out[i + j] = e;
+            }
+            g.block(load(last));
+        }
+        // length block: 0 bits of associated data, 8 * len bits of ciphertext (byte-reversed)
+        g.x = gfmul(_mm_xor_si128(g.x, _mm_set_epi64x(0, (long long) (8 * (uint64_t) len))), g.h[0]);
+        __m128i t = _mm_xor_si128(bswap(g.x), encryptBlock(rk, counterBlock(base, 1)));
+        _mm_storeu_si128((__m128i *) tag, t);
+    }
+}
+
+void aesGcmSetKey_aesni(AesGcmAesniKey &k, const unsigned char key[32]) {
+    __m128i *rk = (__m128i *) k.roundKeys;
+    __m128i a = load(key), b = load(key + 16);
+    rk[0] = a;
+    rk[1] = b;
+    // _mm_aeskeygenassist_si128 needs its round constant as an immediate
+#define AES256_ROUND(i, rcon)                                         \
+    rk[i] = a = expandA(a, _mm_aeskeygenassist_si128(b, rcon));       \
+    rk[i + 1] = b = expandB(b, a);
+    AES256_ROUND(2, 0x01)
+    AES256_ROUND(4, 0x02)
+    AES256_ROUND(6, 0x04)
+    AES256_ROUND(8, 0x08)
+    AES256_ROUND(10, 0x10)
+    AES256_ROUND(12, 0x20)
+    rk[14] = expandA(a, _mm_aeskeygenassist_si128(b, 0x40));
+#undef AES256_ROUND
+
+    __m128i h = bswap(encryptBlock(rk, _mm_setzero_si128()));
+    __m128i *powers = (__m128i *) k.hPowers;
+    powers[0] = h;
+    for (int i = 1; i < 4; ++i) powers[i] = gfmul(powers[i - 1], h);
+}
+
+void aesGcmEncrypt_aesni(const AesGcmAesniKey &k, const unsigned char iv[12], const unsigned char *in,
+                         unsigned char *out, size_t len, unsigned char tag[16]) {
+    crypt(k, iv, in, out, len, tag, true);
+}
+
+void aesGcmDecrypt_aesni(const AesGcmAesniKey &k, const unsigned char iv[12], const unsigned char *in,
+                         unsigned char *out, size_t len, unsigned char tag[16]) {
+    crypt(k, iv, in, out, len, tag, false);
+}
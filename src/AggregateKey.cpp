@@ -0,0 +1,222 @@
+#include "../include/AggregateKey.h"
+#include <algorithm>
+
+namespace {
+    /**
+     * First position in [from, limit) whose bit equals `value`, or limit
+     */
+    size_t nextBit(const vector<uint64_t> &bits, size_t from, size_t limit, bool value) {
+        while (from < limit) {
+            uint64_t w = bits[from / 64];
+            if (!value) w = ~w;
+            w &= ~0ULL << (from % 64);
+            if (w) return min(limit, from / 64 * 64 + (size_t) __builtin_ctzll(w));
+            from = from / 64 * 64 + 64;
+        }
+        return limit;
+    }
+}
+
+template<typename Point>
+AggregateKey<Point>::AggregateKey() : capacity_(1), tree_(2) {
+    for (Point &P: tree_) G::inf(P);
+    G::inf(total_);
+}
+
+template<typename Point>
+AggregateKey<Point>::AggregateKey(const vector<Point> &keys) {
+    slots_ = members_ = keys.size();
+    capacity_ = 1;
+    while (capacity_ < slots_) capacity_ *= 2;
+    tree_.resize(2 * capacity_);
+    for (Point &P: tree_) G::inf(P);
+    copy(keys.begin(), keys.end(), tree_.begin() + capacity_);
+    for (size_t k = capacity_ - 1; k >= 1; --k) {
+        tree_[k] = tree_[2 * k];
+        G::add(tree_[k], tree_[2 * k + 1]);
+    }
+    total_ = tree_[1];
+    occupied_.assign((slots_ + 63) / 64, 0);
+    for (size_t i = 0; i < slots_; ++i) occupied_[i / 64] |= 1ULL << (i % 64);
+}
+
+template<typename Point>
+void AggregateKey<Point>::checkMember(size_t slot) const {
+    if (!contains(slot)) {
+        throw out_of_range("AggregateKey: slot " + to_string(slot) + " holds no member");
+    }
+}
+
+template<typename Point>
+const Point &AggregateKey<Point>::key(size_t slot) const {
+    checkMember(slot);
+    return tree_[capacity_ + slot];
+}
+
+template<typename Point>
+void AggregateKey<Point>::setLeaf(size_t slot, const Point &key) {
+    tree_[capacity_ + slot] = key;
+    dirty_.push_back(capacity_ + slot);
+}
+
+template<typename Point>
+size_t AggregateKey<Point>::add(const Point &key) {
+    size_t slot;
+    if (!freeSlots_.empty()) {
+        slot = freeSlots_.back();
+        freeSlots_.pop_back();
+    } else {
+        slot = slots_++;
+        if (slots_ > capacity_) grow();
+        if (occupied_.size() * 64 < slots_) occupied_.push_back(0);
+    }
+    setLeaf(slot, key);
+    occupied_[slot / 64] |= 1ULL << (slot % 64);
+    members_++;
+    G::add(total_, key);
+    changed();
+    return slot;
+}
+
+template<typename Point>
+void AggregateKey<Point>::remove(size_t slot) {
+    checkMember(slot);
+    G::sub(total_, tree_[capacity_ + slot]);
+    Point inf;
+    G::inf(inf);
+    setLeaf(slot, inf);
+    occupied_[slot / 64] &= ~(1ULL << (slot % 64));
+    members_--;
+    freeSlots_.push_back(slot);
+    changed();
+}
+
+template<typename Point>
+void AggregateKey<Point>::replace(size_t slot, const Point &key) {
+    checkMember(slot);
+    G::sub(total_, tree_[capacity_ + slot]);
+    G::add(total_, key);
+    setLeaf(slot, key);
+    changed();
+}
+
+template<typename Point>
+void AggregateKey<Point>::refresh() {
+    while (!dirty_.empty()) {
+        size_t n = 0;
+        for (size_t k: dirty_) {
+            if (k > 1) dirty_[n++] = k / 2;
+        }
+        dirty_.resize(n);
+        sort(dirty_.begin(), dirty_.end());
+        dirty_.erase(unique(dirty_.begin(), dirty_.end()), dirty_.end());
+        for (size_t k: dirty_) {
+            tree_[k] = tree_[2 * k];
+            G::add(tree_[k], tree_[2 * k + 1]);
+        }
+    }
+}
+
+template<typename Point>
+void AggregateKey<Point>::grow() {
+    refresh();
+    vector<Point> tree(4 * capacity_);
+    for (Point &P: tree) G::inf(P);
+    // node k at depth d moves to k + 2^d: same place in the left half, one level down
+    for (size_t k = 1; k < 2 * capacity_; ++k) {
+        size_t depthBit = (size_t) 1 << (63 - __builtin_clzll(k));
+        tree[k + depthBit] = tree_[k];
+    }
+    tree[1] = tree[2];
+    tree_.swap(tree);
+    capacity_ *= 2;
+}
+
+template<typename Point>
+Point AggregateKey<Point>::range(size_t begin, size_t end) {
+    if (begin > end || end > slots_) {
+        throw out_of_range("AggregateKey: range [" + to_string(begin) + ", " + to_string(end) + ") exceeds " +
+                           to_string(slots_) + " slots");
+    }
+    refresh();
+    Point sum;
+    G::inf(sum);
+    for (size_t l = begin + capacity_, r = end + capacity_; l < r; l /= 2, r /= 2) {
+        if (l & 1) G::add(sum, tree_[l++]);
+        if (r & 1) G::add(sum, tree_[--r]);
+    }
+    return sum;
+}
+
+template<typename Point>
+void AggregateKey<Point>::addRuns(Point &sum, const Bitmap &bits, bool subtract) {
+    for (size_t begin = nextBit(bits, 0, slots_, true); begin < slots_;) {
+        size_t end = nextBit(bits, begin, slots_, false);
+        Point part = range(begin, end);
+        if (subtract) {
+            G::sub(sum, part);
+        } else {
+            G::add(sum, part);
+        }
+        begin = nextBit(bits, end, slots_, true);
+    }
+}
+
+template<typename Point>
+Point AggregateKey<Point>::aggregate(const Bitmap &signers) {
+    size_t words = occupied_.size();
+    if (signers.size() < words) {
+        throw invalid_argument("AggregateKey: bitmap of " + to_string(64 * signers.size()) + " bits for " +
+                               to_string(slots_) + " slots");
+    }
+    Bitmap bits(words), missing(words);
+    size_t count = 0;
+    for (size_t w = 0; w < words; ++w) {
+        uint64_t valid = slots_ - 64 * w >= 64 ? ~0ULL : (1ULL << (slots_ - 64 * w)) - 1;
+        bits[w] = signers[w] & valid;
+        if (bits[w] & ~occupied_[w]) {
+            size_t slot = 64 * w + (size_t) __builtin_ctzll(bits[w] & ~occupied_[w]);
+            throw invalid_argument("AggregateKey: signer slot " + to_string(slot) + " holds no member");
+        }
+        missing[w] = occupied_[w] & ~bits[w];
+        count += (size_t) __builtin_popcountll(bits[w]);
+    }
+    Point sum;
+    if (2 * count > members_) {
+        sum = total_;
+        addRuns(sum, missing, true);
+    } else {
+        G::inf(sum);
+        addRuns(sum, bits, false);
+    }
+    return sum;
+}
+
+template<typename Point>
+const Point &AggregateKey<Point>::affineTotal() {
+    if (!affineValid_) {
+        affine_ = total_;
+        G::affine(affine_);
+        affineValid_ = true;
+    }
+    return affine_;
+}
+
+template<typename Point>
+const vector<FP4> &AggregateKey<Point>::prepared() {
+    throw logic_error("AggregateKey: prepared lines exist for G2 keys only");
+}
+
+template<>
+const vector<FP4> &AggregateKey<ECP2>::prepared() {
+    if (lines_.empty()) {
+        ECP2 Q = affineTotal();
+        if (ECP2_isinf(&Q)) throw logic_error("AggregateKey: no lines for an empty aggregate");
+        lines_.resize(G2_TABLE_BLS12381);
+        PAIR_precomp(lines_.data(), &Q);
+    }
+    return lines_;
+}
+
+template class AggregateKey<ECP>;
+template class AggregateKey<ECP2>;
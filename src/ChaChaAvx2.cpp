@@ -0,0 +1,6 @@
+// Compiled with -mavx2 (see CMakeLists.txt); only called after runtime CPU detection
+#include "ChaChaKernel.h"
+
+void chacha20Blocks_avx2(const uint32_t *in, uint64_t counter, unsigned char *out) {
+    chacha20Blocks(in, counter, out);
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+/**
+ * ChaCha20 block function over several blocks at once (one block per vector lane).
+ *
+ * Written with GCC/Clang vector extensions so the same code compiles to SSE2 in the baseline
+ * objects and to 256-bit AVX2 in ChaChaAvx2.cpp. Internal linkage and no STL, for the same
+ * reason as FpBatchKernel.h.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+    const int CHACHA_LANES = 8;
+    const size_t CHACHA_BATCH_BYTES = 64 * CHACHA_LANES;
+
+    typedef uint32_t ChaChaVec __attribute__((vector_size(4 * CHACHA_LANES)));
+
+#define CHACHA_ROTL(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+#define CHACHA_QR(a, b, c, d)                                   \
+    x[a] += x[b]; x[d] = CHACHA_ROTL(x[d] ^ x[a], 16);           \
+    x[c] += x[d]; x[b] = CHACHA_ROTL(x[b] ^ x[c], 12);           \
+    x[a] += x[b]; x[d] = CHACHA_ROTL(x[d] ^ x[a], 8);            \
+    x[c] += x[d]; x[b] = CHACHA_ROTL(x[b] ^ x[c], 7);
+
+    /**
+     * Writes the CHACHA_LANES keystream blocks counter, counter + 1, ... of the state `in`
+     * (words 12-13 hold the 64-bit block counter and are ignored) to out, in block order
+     */
+    inline void chacha20Blocks(const uint32_t in[16], uint64_t counter, unsigned char *out) {
+        ChaChaVec s[16], x[16];
+        for (int i = 0; i < 16; ++i) {
+            for (int l = 0; l < CHACHA_LANES; ++l) s[i][l] = in[i];
+        }
+        for (int l = 0; l < CHACHA_LANES; ++l) {
+            s[12][l] = (uint32_t) (counter + l);
+            s[13][l] = (uint32_t) ((counter + l) >> 32);
+        }
+        for (int i = 0; i < 16; ++i) x[i] = s[i];
+        for (int round = 0; round < 10; ++round) {
+            CHACHA_QR(0, 4, 8, 12)
+            CHACHA_QR(1, 5, 9, 13)
+            CHACHA_QR(2, 6, 10, 14)
+            CHACHA_QR(3, 7, 11, 15)
+            CHACHA_QR(0, 5, 10, 15)
+            CHACHA_QR(1, 6, 11, 12)
+            CHACHA_QR(2, 7, 8, 13)
+            CHACHA_QR(3, 4, 9, 14)
+        }
+        // Transpose lanes back into consecutive little-endian blocks (x86 is little-endian)
+        uint32_t words[16][CHACHA_LANES];
+        for (int i = 0; i < 16; ++i) {
+            ChaChaVec v = x[i] + s[i];
+            memcpy(words[i], &v, sizeof(v));
+        }
+        for (int l = 0; l < CHACHA_LANES; ++l) {
+            uint32_t block[16];
+            for (int i = 0; i < 16; ++i) block[i] = words[i][l];
+            memcpy(out + 64 * l, block, 64);
+        }
+    }
+
+#undef CHACHA_QR
+#undef CHACHA_ROTL
+}
@@ -0,0 +1,84 @@
+#include "../include/CurveIsa.h"
+#include "../include/Tuning.h"
+#include "CurveKernels.h"
+#include <atomic>
+
+namespace {
+    const CurveKernels &kernelsFor(CurveIsa isa) {
+#ifdef WRAPPER_X86_SIMD
+        if (isa == CurveIsa::AVX512) return curveKernels_avx512;
+        if (isa == CurveIsa::AVX2) return curveKernels_avx2;
+#endif
+        return curveKernels_baseline;
+    }
+
+    CurveIsa bestIsa() {
+        if (CurveIsa_supported(CurveIsa::AVX512)) return CurveIsa::AVX512;
+        if (CurveIsa_supported(CurveIsa::AVX2)) return CurveIsa::AVX2;
+        return CurveIsa::Baseline;
+    }
+
+    /**
+     * WRAPPER_CURVE_ISA when it names a supported level, otherwise the tuning profile's level
+     */
+    CurveIsa initialIsa() {
+        const char *env = getenv("WRAPPER_CURVE_ISA");
+        if (env) {
+            for (CurveIsa isa: {CurveIsa::Baseline, CurveIsa::AVX2, CurveIsa::AVX512}) {
+                if (strcmp(env, CurveIsa_name(isa)) == 0 && CurveIsa_supported(isa)) return isa;
+            }
+        }
+        CurveIsa tuned = Tuning_active().curveIsa;
+        return CurveIsa_supported(tuned) ? tuned : bestIsa();
+    }
+
+    atomic<int> activeIsa{-1};
+}
+
+const CurveKernels &curveKernels() {
+    int isa = activeIsa.load(memory_order_relaxed);
+    if (isa < 0) {
+        isa = (int) initialIsa();
+        activeIsa.store(isa, memory_order_relaxed);
+    }
+    return kernelsFor((CurveIsa) isa);
+}
+
+bool CurveIsa_supported(CurveIsa isa) {
+    switch (isa) {
+        case CurveIsa::Baseline:
+            return true;
+#ifdef WRAPPER_X86_SIMD
+        case CurveIsa::AVX2:
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("adx");
+        case CurveIsa::AVX512:
+            return CurveIsa_supported(CurveIsa::AVX2) && __builtin_cpu_supports("avx512f") &&
+                   __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512dq") &&
+                   __builtin_cpu_supports("avx512vl");
+#endif
+        default:
+            return false;
+    }
+}
+
+CurveIsa CurveIsa_active() {
+    curveKernels();
+    return (CurveIsa) activeIsa.load(memory_order_relaxed);
+}
+
+CurveIsa CurveIsa_set(CurveIsa isa) {
+    if (!CurveIsa_supported(isa)) isa = bestIsa();
+    activeIsa.store((int) isa, memory_order_relaxed);
+    return isa;
+}
+
+const char *CurveIsa_name(CurveIsa isa) {
+    switch (isa) {
+        case CurveIsa::AVX2:
+            return "avx2";
+        case CurveIsa::AVX512:
+            return "avx512";
+        default:
+            return "baseline";
+    }
+}
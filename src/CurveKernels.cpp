@@ -0,0 +1,63 @@
+// Compiled once per ISA level. The x86-64 build compiles it (with MIRACL's field and curve
+// sources) again with -DB384_58=B384_58_<isa> -DBLS12381=BLS12381_<isa>
+// -DWRAPPER_CURVE_ISA=<isa>, so every MIRACL name below resolves to that level's copy.
+#include <pair_BLS12381.h>
+#include <cstring>
+#include "CurveKernels.h"
+
+#ifndef WRAPPER_CURVE_ISA
+#define WRAPPER_CURVE_ISA baseline
+#endif
+#define CURVE_KERNELS_NAME2(isa) curveKernels_##isa
+#define CURVE_KERNELS_NAME(isa) CURVE_KERNELS_NAME2(isa)
+
+using namespace B384_58;
+using namespace BLS12381;
+
+namespace {
+    void ecpMul(void *P, const void *k) {
+        BIG t;
+        memcpy(t, k, sizeof(BIG));
+        ECP_mul((ECP *) P, t);
+    }
+
+    void ecp2Mul(void *P, const void *k) {
+        BIG t;
+        memcpy(t, k, sizeof(BIG));
+        ECP2_mul((ECP2 *) P, t);
+    }
+
+    void gtPow(void *r, const void *k) {
+        BIG t;
+        memcpy(t, k, sizeof(BIG));
+        FP12 *g = (FP12 *) r;
+        FP12_pow(g, g, t);
+        FP12_reduce(g);
+    }
+
+    void pair(void *r, const void *P, const void *Q) {
+        ECP p = *(const ECP *) P;
+        ECP2 q = *(const ECP2 *) Q;
+        FP12 *v = (FP12 *) r;
+        PAIR_ate(v, &q, &p);
+        PAIR_fexp(v);
+        FP12_reduce(v);
+    }
+
+    bool productIsOne(const void *P, const void *Q, size_t n) {
+        FP12 r[ATE_BITS_BLS12381];
+        PAIR_initmp(r);
+        for (size_t i = 0; i < n; ++i) {
+            ECP p = ((const ECP *) P)[i];
+            ECP2 q = ((const ECP2 *) Q)[i];
+            if (ECP_isinf(&p) || ECP2_isinf(&q)) continue;
+            PAIR_another(r, &q, &p);
+        }
+        FP12 v;
+        PAIR_miller(&v, r);
+        PAIR_fexp(&v);
+        return FP12_isunity(&v);
+    }
+}
+
+extern const CurveKernels CURVE_KERNELS_NAME(WRAPPER_CURVE_ISA) = {ecpMul, ecp2Mul, gtPow, pair, productIsOne};
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * Entry points of one ISA build of the curve arithmetic (see CurveIsa.h).
+ *
+ * This header is shared by builds in which the MIRACL namespaces carry different names, so it
+ * names no MIRACL type: pointers are to ECP, ECP2, FP12 and BIG objects, whose layout is the
+ * same in every build.
+ */
+struct CurveKernels {
+    void (*ecpMul)(void *P, const void *k);                  // P = k * P
+    void (*ecp2Mul)(void *P, const void *k);
+    void (*gtPow)(void *r, const void *k);                   // r = r^k, reduced
+    void (*pair)(void *r, const void *P, const void *Q);     // r = e(P, Q), reduced
+    bool (*productIsOne)(const void *P, const void *Q, size_t n);
+};
+
+extern const CurveKernels curveKernels_baseline;
+extern const CurveKernels curveKernels_avx2;       // x86-64 builds only
+extern const CurveKernels curveKernels_avx512;     // x86-64 builds only
+
+/**
+ * Kernels of the active level
+ */
+const CurveKernels &curveKernels();
@@ -0,0 +1,273 @@
+#include "../include/DiscreteLog.h"
+#include "../include/FpBatch.h"
+#include "../include/MSM.h"
+#include <cmath>
+#include <memory>
+#include <thread>
+
+namespace {
+    const size_t BLOCK = 256;                 // steps normalized and probed together
+    const uint64_t MIN_SPAN = 4096;           // fewest giant steps handed to one worker
+
+    /**
+     * Hash of field coefficients, in canonical form; never 0, which marks the identity
+     */
+    uint64_t keyOf(const FP *const coeffs[], size_t n) {
+        uint64_t h = 0;
+        for (size_t c = 0; c < n; ++c) {
+            FP t = *coeffs[c];
+            BIG v;
+            FP_redc(v, &t);
+            for (int i = 0; i < NLEN_B384_58; ++i) {
+                h = (h ^ (uint64_t) v[i]) * 0x9e3779b97f4a7c15ULL;
+                h ^= h >> 29;
+            }
+        }
+        // splitmix64 finalizer
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+        h ^= h >> 31;
+        return h ? h : 1;
+    }
+
+    /**
+     * The group written multiplicatively: G1 additions and GT multiplications
+     */
+    template<typename Group>
+    struct Ops;
+
+    template<>
+    struct Ops<ECP> {
+        static void op(ECP &x, const ECP &y) { ECP_add(&x, const_cast<ECP *>(&y)); }
+
+        static void inverse(ECP &x) { ECP_neg(&x); }
+
+        static ECP power(const ECP &x, uint64_t k) { return ECP_mulShort(x, mpz_class((unsigned long) k)); }
+
+        static bool equals(const ECP &x, const ECP &y) { return ECP_equals(const_cast<ECP *>(&x), const_cast<ECP *>(&y)); }
+
+        /**
+         * Keys of n elements (normalized in place with one inversion): hash of the affine x
+         */
+        static void keys(ECP *x, size_t n, uint64_t *out) {
+            ECP_batchAffine(x, n);
+            for (size_t i = 0; i < n; ++i) {
+                const FP *coeffs[1] = {&x[i].x};
+                out[i] = ECP_isinf(&x[i]) ? 0 : keyOf(coeffs, 1);
+            }
+        }
+    };
+
+    template<>
+    struct Ops<FP12> {
+        static void op(FP12 &x, const FP12 &y) {
+            FP12 t = y;
+            FP12_mul(&x, &t);
+            FP12_reduce(&x);
+        }
+
+        // the conjugate is the inverse in the cyclotomic subgroup
+        static void inverse(FP12 &x) { FP12_conj(&x, &x); }
+
+        static FP12 power(const FP12 &x, uint64_t k) {
+            FP12 r = x;
+            FP12_pow(r, mpz_class((unsigned long) k));
+            return r;
+        }
+
+        static bool equals(const FP12 &x, const FP12 &y) {
+            return FP12_equals(const_cast<FP12 *>(&x), const_cast<FP12 *>(&y));
+        }
+
+        /**
+         * Keys of n elements: hash of a.a, which FP12_conj leaves unchanged (it negates a.b,
+         * b.a and c.b), so that x and 1 / x share their key
+         */
+        static void keys(FP12 *x, size_t n, uint64_t *out) {
+            for (size_t i = 0; i < n; ++i) {
+                const FP *coeffs[2] = {&x[i].a.a.a, &x[i].a.a.b};
+                out[i] = FP12_isunity(&x[i]) ? 0 : keyOf(coeffs, 2);
+            }
+        }
+    };
+
+    size_t threadCount(unsigned threads) {
+        return threads ? threads : max(1u, thread::hardware_concurrency());
+    }
+}
+
+template<typename Group>
+size_t DiscreteLog<Group>::tableSize(uint64_t babySteps) {
+    size_t slots = 16;
+    while (slots < 2 * babySteps) slots *= 2;
+    return slots;
+}
+
+template<typename Group>
+uint64_t DiscreteLog<Group>::defaultBabySteps(uint64_t range) {
+    uint64_t half = (range + 1) / 2;
+    auto m = (uint64_t) sqrt((double) half);
+    while (m * m < half) ++m;
+    while (m > 1 && (m - 1) * (m - 1) >= half) --m;
+    return max<uint64_t>(1, min<uint64_t>(m, UINT32_MAX));
+}
+
+template<typename Group>
+uint64_t DiscreteLog<Group>::fingerprint(const Group &x) {
+    Group t = x;
+    uint64_t key;
+    Ops<Group>::keys(&t, 1, &key);
+    return key;
+}
+
+template<typename Group>
+void DiscreteLog<Group>::init(const Group &base, uint64_t range, uint64_t babySteps) {
+    if (range == 0 || range > ((uint64_t) 1 << 62)) {
+        throw invalid_argument("DiscreteLog: range must be in [1, 2^62]");
+    }
+    if (babySteps >= ((uint64_t) 1 << 32)) {
+        throw invalid_argument("DiscreteLog: at most 2^32 - 1 baby steps");
+    }
+    base_ = base;
+    range_ = range;
+    m_ = babySteps ? babySteps : defaultBabySteps(range);
+    giants_ = (range_ - 1 + m_) / (2 * m_) + 1;
+    mask_ = tableSize(m_) - 1;
+    giant_ = Ops<Group>::power(base_, 2 * m_);
+    Ops<Group>::inverse(giant_);
+}
+
+template<typename Group>
+DiscreteLog<Group>::DiscreteLog(const Group &base, uint64_t range, uint64_t babySteps) {
+    typedef Ops<Group> O;
+    init(base, range, babySteps);
+    own_.assign(mask_ + 1, 0);
+    uint64_t *slots = own_.data();
+    // Every worker walks its own run of baby steps from one scalar multiplication and inserts
+    // them lock-free (linear probing; a slot is claimed by compare-and-swap from 0)
+    size_t threads = (size_t) min<uint64_t>(m_ / BLOCK + 1, threadCount(0));
+    uint64_t per = (m_ + threads - 1) / threads;
+    auto build = [&](size_t t) {
+        uint64_t lo = 1 + t * per, hi = min(m_ + 1, lo + per);
+        if (lo >= hi) return;
+        Group P = O::power(base_, lo);
+        vector<Group> block(BLOCK);
+        uint64_t keys[BLOCK];
+        for (uint64_t j0 = lo; j0 < hi; j0 += BLOCK) {
+            size_t n = (size_t) min<uint64_t>(BLOCK, hi - j0);
+            for (size_t k = 0; k < n; ++k) {
+                block[k] = P;
+                O::op(P, base_);
+            }
+            O::keys(block.data(), n, keys);
+            for (size_t k = 0; k < n; ++k) {
+                uint64_t entry = (keys[k] >> 32 << 32) | (j0 + k);
+                for (size_t s = keys[k] & mask_;; s = (s + 1) & mask_) {
+                    uint64_t empty = 0;
+                    if (__atomic_compare_exchange_n(&slots[s], &empty, entry, false, __ATOMIC_RELAXED,
+                                                    __ATOMIC_RELAXED)) {
+                        break;
+                    }
+                }
+            }
+        }
+    };
+    vector<thread> workers;
+    for (size_t t = 1; t < threads; ++t) workers.emplace_back(build, t);
+    build(0);
+    for (thread &t: workers) t.join();
+    table_ = own_.data();
+}
+
+template<typename Group>
+DiscreteLog<Group>::DiscreteLog(const Group &base, uint64_t range, const uint64_t *table, size_t count,
+                                uint64_t babySteps) {
+    if (babySteps == 0) {
+        throw invalid_argument("DiscreteLog: the number of baby steps of a stored table must be given");
+    }
+    init(base, range, babySteps);
+    if (count != mask_ + 1) {
+        throw invalid_argument("DiscreteLog: table size does not match the number of baby steps");
+    }
+    table_ = table;
+}
+
+template<typename Group>
+void DiscreteLog<Group>::search(const Group &T, uint64_t lo, uint64_t hi, atomic<int64_t> &found) const {
+    typedef Ops<Group> O;
+    Group Q = T;
+    if (lo > 0) O::op(Q, O::power(giant_, lo));
+    // m is accepted if it is in range and m * base == T (the keys are truncated hashes)
+    auto accept = [&](int64_t m, bool verify) {
+        if (m < 0 || (uint64_t) m >= range_) return false;
+        if (verify && !O::equals(O::power(base_, (uint64_t) m), T)) return false;
+        found.store(m, memory_order_relaxed);
+        return true;
+    };
+    vector<Group> block(BLOCK);
+    uint64_t keys[BLOCK];
+    for (uint64_t i0 = lo; i0 < hi; i0 += BLOCK) {
+        // another worker found the answer
+        if (found.load(memory_order_relaxed) >= 0) return;
+        size_t n = (size_t) min<uint64_t>(BLOCK, hi - i0);
+        for (size_t k = 0; k < n; ++k) {
+            block[k] = Q;
+            O::op(Q, giant_);
+        }
+        O::keys(block.data(), n, keys);
+        for (size_t k = 0; k < n; ++k) __builtin_prefetch(&table_[keys[k] & mask_]);
+        for (size_t k = 0; k < n; ++k) {
+            auto step = (int64_t) ((i0 + k) * 2 * m_);
+            if (keys[k] == 0) {
+                if (accept(step, false)) return;
+                continue;
+            }
+            uint64_t tag = keys[k] >> 32;
+            for (size_t s = keys[k] & mask_;; s = (s + 1) & mask_) {
+                uint64_t entry = table_[s];
+                if (entry == 0) break;
+                if (entry >> 32 != tag) continue;
+                auto j = (int64_t) (uint32_t) entry;
+                if (accept(step + j, true) || accept(step - j, true)) return;
+            }
+        }
+    }
+}
+
+template<typename Group>
+int64_t DiscreteLog<Group>::solve(const Group &T, unsigned threads) const {
+    return solveBatch(vector<Group>(1, T), threads)[0];
+}
+
+template<typename Group>
+vector<int64_t> DiscreteLog<Group>::solveBatch(const vector<Group> &targets, unsigned threads) const {
+    if (targets.empty()) return {};
+    size_t workers = threadCount(threads);
+    // Fewer targets than workers: split the giant steps of each target into parts
+    uint64_t parts = 1;
+    if (targets.size() < workers) {
+        parts = min<uint64_t>((workers + targets.size() - 1) / targets.size(), (giants_ + MIN_SPAN - 1) / MIN_SPAN);
+        parts = max<uint64_t>(parts, 1);
+    }
+    uint64_t span = (giants_ + parts - 1) / parts;
+    size_t items = targets.size() * parts;
+    unique_ptr<atomic<int64_t>[]> found(new atomic<int64_t>[targets.size()]);
+    for (size_t t = 0; t < targets.size(); ++t) found[t].store(-1, memory_order_relaxed);
+    atomic<size_t> next{0};
+    auto run = [&] {
+        for (size_t w; (w = next.fetch_add(1)) < items;) {
+            uint64_t lo = (w % parts) * span;
+            search(targets[w / parts], lo, min(giants_, lo + span), found[w / parts]);
+        }
+    };
+    vector<thread> pool;
+    for (size_t t = 1; t < min(workers, items); ++t) pool.emplace_back(run);
+    run();
+    for (thread &t: pool) t.join();
+    vector<int64_t> result(targets.size());
+    for (size_t t = 0; t < targets.size(); ++t) result[t] = found[t].load(memory_order_relaxed);
+    return result;
+}
+
+template class DiscreteLog<ECP>;
+template class DiscreteLog<FP12>;
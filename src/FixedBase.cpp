@@ -0,0 +1,70 @@
+#include "../include/FixedBase.h"
+#include "../include/FpBatch.h"
+#include "../include/GroupTraits.h"
+#include "Scalar.h"
+
+template<typename Point>
+static void buildTable(vector<Point> &table, const Point &base) {
+    typedef GroupTraits<Point> G;
+    table.resize(FIXED_BASE_TABLE_SIZE);
+    Point row;
+    G::copy(row, base);
+    for (int i = 0; i < FIXED_BASE_WINDOWS; ++i) {
+        Point *t = &table[(size_t) i * 255];
+        G::copy(t[0], row);
+        for (int d = 1; d < 255; ++d) {
+            G::copy(t[d], t[d - 1]);
+            G::add(t[d], row);
+        }
+        // next row starts at 256 * row
+        G::copy(row, t[254]);
+        G::add(row, t[0]);
+    }
+}
+
+template<typename Point>
+static Point mulTable(const Point *table, const ScalarWords &k) {
+    typedef GroupTraits<Point> G;
+    assert(k.bits() <= FIXED_BASE_WINDOW * FIXED_BASE_WINDOWS);
+    Point res;
+    G::inf(res);
+    for (int i = 0; i < FIXED_BASE_WINDOWS; ++i) {
+        uint32_t d = k.window(i * FIXED_BASE_WINDOW, FIXED_BASE_WINDOW);
+        if (d != 0) G::add(res, table[(size_t) i * 255 + d - 1]);
+    }
+    return res;
+}
+
+void ECP_fixedBaseTable(vector<ECP> &table, const ECP &base) {
+    buildTable(table, base);
+    ECP_batchAffine(table.data(), table.size());
+}
+
+void ECP2_fixedBaseTable(vector<ECP2> &table, const ECP2 &base) {
+    buildTable(table, base);
+    for (ECP2 &P: table) ECP2_affine(&P);
+}
+
+ECP ECP_mulFixedBase(const ECP *table, BIG k) {
+    ScalarWords s;
+    scalarFromBIG(s, k);
+    return mulTable(table, s);
+}
+
+ECP ECP_mulFixedBase(const ECP *table, const mpz_class &k) {
+    ScalarWords s;
+    scalarFromMpz(s, k, &getCurveOrder());
+    return mulTable(table, s);
+}
+
+ECP2 ECP2_mulFixedBase(const ECP2 *table, BIG k) {
+    ScalarWords s;
+    scalarFromBIG(s, k);
+    return mulTable(table, s);
+}
+
+ECP2 ECP2_mulFixedBase(const ECP2 *table, const mpz_class &k) {
+    ScalarWords s;
+    scalarFromMpz(s, k, &getCurveOrder());
+    return mulTable(table, s);
+}
@@ -0,0 +1,406 @@
+#include "../include/FpBatch.h"
+#include "../include/Tuning.h"
+#include <atomic>
+
+// Kernels on interleaved 29-bit limbs, see FpBatchKernel.h
+typedef void (*FpBatchKernel)(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t groups, const void *c);
+
+#ifdef WRAPPER_X86_SIMD
+void fpBatchMul_avx2(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t groups, const void *c);
+void fpBatchAdd_avx2(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t groups, const void *c);
+void fpBatchSub_avx2(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t groups, const void *c);
+void fpBatchMul_avx512(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t groups, const void *c);
+void fpBatchAdd_avx512(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t groups, const void *c);
+void fpBatchSub_avx512(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t groups, const void *c);
+#endif
+
+namespace {
+    const int LIMBS = 14;                 // 29-bit limbs per element
+    const int LIMB_BITS = 29;
+    const uint64_t LIMB_MASK = (1ULL << LIMB_BITS) - 1;
+    const size_t MAX_WIDTH = 8;
+    const size_t CHUNK = 64;              // elements converted per kernel call
+
+    struct Kernels {
+        FpBackend backend;
+        size_t width;
+        FpBatchKernel mul, add, sub;
+    };
+
+    const Kernels SCALAR_KERNELS = {FpBackend::Scalar, 1, nullptr, nullptr, nullptr};
+#ifdef WRAPPER_X86_SIMD
+    const Kernels AVX2_KERNELS = {FpBackend::AVX2, 4, fpBatchMul_avx2, fpBatchAdd_avx2, fpBatchSub_avx2};
+    const Kernels AVX512_KERNELS = {FpBackend::AVX512, 8, fpBatchMul_avx512, fpBatchAdd_avx512, fpBatchSub_avx512};
+#endif
+
+    /**
+     * Modulus in 29-bit limbs followed by -p^-1 mod 2^29 (the kernels' FpBatchConst)
+     */
+    struct Consts {
+        uint64_t w[LIMBS + 1];
+
+        Consts() {
+            BIG p;
+            BIG_rcopy(p, Modulus);
+            for (int k = 0; k < LIMBS / 2; ++k) {
+                w[2 * k] = (uint64_t) p[k] & LIMB_MASK;
+                w[2 * k + 1] = (uint64_t) p[k] >> LIMB_BITS;
+            }
+            // Newton iteration for p^-1 mod 2^64, each step doubles the correct bits
+            uint64_t p0 = (uint64_t) p[0], inv = p0;
+            for (int i = 0; i < 5; ++i) inv *= 2 - p0 * inv;
+            w[LIMBS] = (0 - inv) & LIMB_MASK;
+        }
+    };
+
+    const uint64_t *consts() {
+        static const Consts c;
+        return c.w;
+    }
+
+    const Kernels &kernelsFor(FpBackend backend) {
+#ifdef WRAPPER_X86_SIMD
+        if (backend == FpBackend::AVX512) return AVX512_KERNELS;
+        if (backend == FpBackend::AVX2) return AVX2_KERNELS;
+#endif
+        return SCALAR_KERNELS;
+    }
+
+    FpBackend bestBackend() {
+        if (FpBatch_supported(FpBackend::AVX512)) return FpBackend::AVX512;
+        if (FpBatch_supported(FpBackend::AVX2)) return FpBackend::AVX2;
+        return FpBackend::Scalar;
+    }
+
+    atomic<int> activeBackend{-1};
+
+    const Kernels &kernels() {
+        int b = activeBackend.load(memory_order_relaxed);
+        if (b < 0) {
+            FpBackend tuned = Tuning_active().fpBackend;
+            b = (int) (FpBatch_supported(tuned) ? tuned : bestBackend());
+            activeBackend.store(b, memory_order_relaxed);
+        }
+        return kernelsFor((FpBackend) b);
+    }
+
+    /**
+     * Writes x into lane i of an interleaved buffer of groups of W elements
+     */
+    void pack(uint64_t *buf, size_t W, size_t i, const FP *x) {
+        uint64_t *base = buf + (i / W) * LIMBS * W + i % W;
+        FP t;
+        FP_copy(&t, const_cast<FP *>(x));
+        // Bring the value into [0, p) with canonical limbs, as FP_reduce does
+        if (t.XES > 1) {
+            FP_reduce(&t);
+        } else {
+            BIG_norm(t.g);
+        }
+        for (int k = 0; k < LIMBS / 2; ++k) {
+            base[2 * k * W] = (uint64_t) t.g[k] & LIMB_MASK;
+            base[(2 * k + 1) * W] = (uint64_t) t.g[k] >> LIMB_BITS;
+        }
+    }
+
+    void packZero(uint64_t *buf, size_t W, size_t i) {
+        uint64_t *base = buf + (i / W) * LIMBS * W + i % W;
+        for (int j = 0; j < LIMBS; ++j) base[j * W] = 0;
+    }
+
+    /**
+     * Reads lane i of an interleaved buffer back into a reduced FP
+     */
+    void unpack(FP *r, const uint64_t *buf, size_t W, size_t i) {
+        const uint64_t *base = buf + (i / W) * LIMBS * W + i % W;
+        for (int k = 0; k < LIMBS / 2; ++k) {
+            r->g[k] = (chunk) (base[2 * k * W] | (base[(2 * k + 1) * W] << LIMB_BITS));
+        }
+        r->XES = 1;
+    }
+
+    /**
+     * Runs a binary kernel over n elements, CHUNK at a time through stack buffers
+     */
+    void run(FpBatchKernel kernel, size_t W, FP *r, const FP *a, const FP *b, size_t n) {
+        uint64_t ba[LIMBS * CHUNK], bb[LIMBS * CHUNK], br[LIMBS * CHUNK];
+        for (size_t off = 0; off < n; off += CHUNK) {
+            size_t m = min(CHUNK, n - off);
+            size_t groups = (m + W - 1) / W;
+            for (size_t i = 0; i < groups * W; ++i) {
+                if (i < m) {
+                    pack(ba, W, i, &a[off + i]);
+                    pack(bb, W, i, &b[off + i]);
+                } else {
+                    packZero(ba, W, i);
+                    packZero(bb, W, i);
+                }
+            }
+            kernel(br, ba, bb, groups, consts());
+            for (size_t i = 0; i < m; ++i) unpack(&r[off + i], br, W, i);
+        }
+    }
+
+    /**
+     * Montgomery's trick with MIRACL arithmetic; zero[i] marks inputs that map to zero
+     */
+    void scalarInv(FP *r, const FP *a, const vector<char> &zero, size_t n) {
+        vector<FP> prefix(n);
+        FP acc, t;
+        FP_one(&acc);
+        for (size_t i = 0; i < n; ++i) {
+            prefix[i] = acc;
+            if (!zero[i]) FP_mul(&acc, &acc, const_cast<FP *>(&a[i]));
+        }
+        FP_inv(&acc, &acc, nullptr);
+        for (size_t i = n; i-- > 0;) {
+            if (zero[i]) {
+                FP_zero(&r[i]);
+                continue;
+            }
+            FP_copy(&t, const_cast<FP *>(&a[i]));
+            FP_mul(&r[i], &acc, &prefix[i]);
+            FP_reduce(&r[i]);
+            FP_mul(&acc, &acc, &t);
+        }
+    }
+}
+
+bool FpBatch_supported(FpBackend backend) {
+    switch (backend) {
+        case FpBackend::Scalar:
+            return true;
+#ifdef WRAPPER_X86_SIMD
+        case FpBackend::AVX2:
+            return __builtin_cpu_supports("avx2");
+        case FpBackend::AVX512:
+            return __builtin_cpu_supports("avx512f");
+#endif
+        default:
+            return false;
+    }
+}
+
+FpBackend FpBatch_backend() {
+    return kernels().backend;
+}
+
+FpBackend FpBatch_setBackend(FpBackend backend) {
+    if (!FpBatch_supported(backend)) backend = bestBackend();
+    activeBackend.store((int) backend, memory_order_relaxed);
+    return backend;
+}
+
+const char *FpBatch_backendName(FpBackend backend) {
+    switch (backend) {
+        case FpBackend::AVX2:
+            return "avx2";
+        case FpBackend::AVX512:
+            return "avx512";
+        default:
+            return "scalar";
+    }
+}
+
+void FpBatch_mul(FP *r, const FP *a, const FP *b, size_t n) {
+    const Kernels &k = kernels();
+    if (k.backend != FpBackend::Scalar) {
+        run(k.mul, k.width, r, a, b, n);
+        return;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        FP_mul(&r[i], const_cast<FP *>(&a[i]), const_cast<FP *>(&b[i]));
+        FP_reduce(&r[i]);
+    }
+}
+
+void FpBatch_sqr(FP *r, const FP *a, size_t n) {
+    const Kernels &k = kernels();
+    if (k.backend != FpBackend::Scalar) {
+        run(k.mul, k.width, r, a, a, n);
+        return;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        FP_sqr(&r[i], const_cast<FP *>(&a[i]));
+        FP_reduce(&r[i]);
+    }
+}
+
+void FpBatch_add(FP *r, const FP *a, const FP *b, size_t n) {
+    const Kernels &k = kernels();
+    if (k.backend != FpBackend::Scalar) {
+        run(k.add, k.width, r, a, b, n);
+        return;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        FP_add(&r[i], const_cast<FP *>(&a[i]), const_cast<FP *>(&b[i]));
+        FP_reduce(&r[i]);
+    }
+}
+
+void FpBatch_sub(FP *r, const FP *a, const FP *b, size_t n) {
+    const Kernels &k = kernels();
+    if (k.backend != FpBackend::Scalar) {
+        run(k.sub, k.width, r, a, b, n);
+        return;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        FP_sub(&r[i], const_cast<FP *>(&a[i]), const_cast<FP *>(&b[i]));
+        FP_reduce(&r[i]);
+    }
+}
+
+void FpBatch_inv(FP *r, const FP *a, size_t n) {
+    if (n == 0) return;
+    vector<char> zero(n);
+    for (size_t i = 0; i < n; ++i) zero[i] = (char) FP_iszilch(const_cast<FP *>(&a[i]));
+
+    const Kernels &k = kernels();
+    size_t W = k.width;
+    if (k.backend == FpBackend::Scalar || n < 2 * W) {
+        scalarInv(r, a, zero, n);
+        return;
+    }
+
+    // W interleaved prefix-product chains, lane l covering elements l, l + W, l + 2W, ...
+    size_t groups = (n + W - 1) / W, stride = LIMBS * W;
+    vector<uint64_t> x(groups * stride), prefix(groups * stride);
+    FP one;
+    FP_one(&one);
+    for (size_t i = 0; i < groups * W; ++i) {
+        pack(x.data(), W, i, i < n && !zero[i] ? &a[i] : &one);
+    }
+    uint64_t acc[LIMBS * MAX_WIDTH], tmp[LIMBS * MAX_WIDTH];
+    for (size_t l = 0; l < W; ++l) pack(acc, W, l, &one);
+    for (size_t g = 0; g < groups; ++g) {
+        memcpy(&prefix[g * stride], acc, stride * sizeof(uint64_t));
+        k.mul(acc, acc, &x[g * stride], 1, consts());
+    }
+
+    // Invert the W chain products together
+    FP lanes[MAX_WIDTH];
+    for (size_t l = 0; l < W; ++l) unpack(&lanes[l], acc, W, l);
+    scalarInv(lanes, lanes, vector<char>(W, 0), W);
+    for (size_t l = 0; l < W; ++l) pack(acc, W, l, &lanes[l]);
+
+    for (size_t g = groups; g-- > 0;) {
+        k.mul(tmp, acc, &prefix[g * stride], 1, consts());
+        k.mul(acc, acc, &x[g * stride], 1, consts());
+        for (size_t l = 0; l < W; ++l) {
+            size_t i = g * W + l;
+            if (i >= n) continue;
+            if (zero[i]) {
+                FP_zero(&r[i]);
+            } else {
+                unpack(&r[i], tmp, W, l);
+            }
+        }
+    }
+}
+
+void ECP_batchAffine(ECP *P, size_t n) {
+    FP one;
+    FP_one(&one);
+    vector<size_t> idx;
+    vector<FP> z;
+    for (size_t i = 0; i < n; ++i) {
+        if (ECP_isinf(&P[i]) || FP_equals(&P[i].z, &one)) continue;
+        idx.push_back(i);
+        z.push_back(P[i].z);
+    }
+    size_t m = idx.size();
+    if (m == 0) return;
+
+    FpBatch_inv(z.data(), z.data(), m);
+    vector<FP> x(m), y(m);
+    for (size_t j = 0; j < m; ++j) {
+        x[j] = P[idx[j]].x;
+        y[j] = P[idx[j]].y;
+    }
+    FpBatch_mul(x.data(), x.data(), z.data(), m);
+    FpBatch_mul(y.data(), y.data(), z.data(), m);
+    for (size_t j = 0; j < m; ++j) {
+        ECP &Q = P[idx[j]];
+        Q.x = x[j];
+        Q.y = y[j];
+        FP_copy(&Q.z, &one);
+    }
+}
+
+void ECP2_batchAffine(ECP2 *P, size_t n) {
+    vector<size_t> idx;
+    for (size_t i = 0; i < n; ++i) {
+        if (ECP2_isinf(&P[i])) continue;
+        if (FP2_isunity(&P[i].z)) {
+            FP2_reduce(&P[i].x);
+            FP2_reduce(&P[i].y);
+            continue;
+        }
+        idx.push_back(i);
+    }
+    size_t m = idx.size();
+    if (m == 0) return;
+
+    // 1 / (a + bu) = (a - bu) / (a^2 + b^2): one batched Fp inversion of the norms
+    vector<FP> za(m), zb(m), t(m), u(m);
+    for (size_t j = 0; j < m; ++j) {
+        za[j] = P[idx[j]].z.a;
+        zb[j] = P[idx[j]].z.b;
+    }
+    FpBatch_sqr(t.data(), za.data(), m);
+    FpBatch_sqr(u.data(), zb.data(), m);
+    FpBatch_add(t.data(), t.data(), u.data(), m);
+    FpBatch_inv(t.data(), t.data(), m);
+    FpBatch_mul(za.data(), za.data(), t.data(), m);
+    FpBatch_mul(zb.data(), zb.data(), t.data(), m);
+    for (size_t j = 0; j < m; ++j) FP_zero(&t[j]);
+    FpBatch_sub(zb.data(), t.data(), zb.data(), m);
+
+    // (xa + xb u)(za + zb u) = (xa za - xb zb) + (xa zb + xb za) u
+    vector<FP> xa(m), xb(m), r0(m), r1(m);
+    FP2 one;
+    FP2_one(&one);
+    for (int coord = 0; coord < 2; ++coord) {
+        for (size_t j = 0; j < m; ++j) {
+            const FP2 &c = coord == 0 ? P[idx[j]].x : P[idx[j]].y;
+            xa[j] = c.a;
+            xb[j] = c.b;
+        }
+        FpBatch_mul(r0.data(), xa.data(), za.data(), m);
+        FpBatch_mul(t.data(), xb.data(), zb.data(), m);
+        FpBatch_sub(r0.data(), r0.data(), t.data(), m);
+        FpBatch_mul(r1.data(), xa.data(), zb.data(), m);
+        FpBatch_mul(t.data(), xb.data(), za.data(), m);
+        FpBatch_add(r1.data(), r1.data(), t.data(), m);
+        for (size_t j = 0; j < m; ++j) {
+            FP2 &c = coord == 0 ? P[idx[j]].x : P[idx[j]].y;
+            c.a = r0[j];
+            c.b = r1[j];
+        }
+    }
+    for (size_t j = 0; j < m; ++j) FP2_copy(&P[idx[j]].z, &one);
+}
+
+void ECP_batchEquals(const ECP *P, const ECP *Q, size_t n, bool *eq) {
+    // X1 Z2 == X2 Z1 and Y1 Z2 == Y2 Z1, as in ECP_equals
+    FP l[CHUNK], r[CHUNK], a[CHUNK], b[CHUNK];
+    for (size_t off = 0; off < n; off += CHUNK) {
+        size_t m = min(CHUNK, n - off);
+        for (int coord = 0; coord < 2; ++coord) {
+            for (size_t j = 0; j < m; ++j) {
+                a[j] = coord == 0 ? P[off + j].x : P[off + j].y;
+                b[j] = Q[off + j].z;
+            }
+            FpBatch_mul(l, a, b, m);
+            for (size_t j = 0; j < m; ++j) {
+                a[j] = coord == 0 ? Q[off + j].x : Q[off + j].y;
+                b[j] = P[off + j].z;
+            }
+            FpBatch_mul(r, a, b, m);
+            for (size_t j = 0; j < m; ++j) {
+                bool same = FP_equals(&l[j], &r[j]);
+                eq[off + j] = coord == 0 ? same : eq[off + j] && same;
+            }
+        }
+    }
+}
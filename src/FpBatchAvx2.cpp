@@ -0,0 +1,34 @@
+// Compiled with -mavx2 (see CMakeLists.txt); only called after runtime CPU detection
+#include "FpBatchKernel.h"
+#include <immintrin.h>
+
+namespace {
+    struct FpbAvx2 {
+        typedef __m256i T;
+        static const int W = 4;
+
+        static T zero() { return _mm256_setzero_si256(); }
+
+        static T set1(uint64_t x) { return _mm256_set1_epi64x((long long) x); }
+
+        static T load(const uint64_t *p) { return _mm256_loadu_si256((const __m256i *) p); }
+
+        static void store(uint64_t *p, T v) { _mm256_storeu_si256((__m256i *) p, v); }
+
+        static T add(T a, T b) { return _mm256_add_epi64(a, b); }
+
+        static T sub(T a, T b) { return _mm256_sub_epi64(a, b); }
+
+        static T mul(T a, T b) { return _mm256_mul_epu32(a, b); }
+
+        static T band(T a, T b) { return _mm256_and_si256(a, b); }
+
+        static T bor(T a, T b) { return _mm256_or_si256(a, b); }
+
+        static T bandnot(T a, T b) { return _mm256_andnot_si256(a, b); }
+
+        static T srli(T a, int n) { return _mm256_srli_epi64(a, n); }
+    };
+}
+
+FPBATCH_DEFINE_ENTRY_POINTS(avx2, FpbAvx2)
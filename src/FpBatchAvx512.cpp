@@ -0,0 +1,34 @@
+// Compiled with -mavx512f (see CMakeLists.txt); only called after runtime CPU detection
+#include "FpBatchKernel.h"
+#include <immintrin.h>
+
+namespace {
+    struct FpbAvx512 {
+        typedef __m512i T;
+        static const int W = 8;
+
+        static T zero() { return _mm512_setzero_si512(); }
+
+        static T set1(uint64_t x) { return _mm512_set1_epi64((long long) x); }
+
+        static T load(const uint64_t *p) { return _mm512_loadu_si512((const void *) p); }
+
+        static void store(uint64_t *p, T v) { _mm512_storeu_si512((void *) p, v); }
+
+        static T add(T a, T b) { return _mm512_add_epi64(a, b); }
+
+        static T sub(T a, T b) { return _mm512_sub_epi64(a, b); }
+
+        static T mul(T a, T b) { return _mm512_mul_epu32(a, b); }
+
+        static T band(T a, T b) { return _mm512_and_si512(a, b); }
+
+        static T bor(T a, T b) { return _mm512_or_si512(a, b); }
+
+        static T bandnot(T a, T b) { return _mm512_andnot_si512(a, b); }
+
+        static T srli(T a, int n) { return _mm512_srli_epi64(a, (unsigned int) n); }
+    };
+}
+
+FPBATCH_DEFINE_ENTRY_POINTS(avx512, FpbAvx512)
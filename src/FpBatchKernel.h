@@ -0,0 +1,152 @@
+#pragma once
+
+/**
+ * Lane-parallel Montgomery arithmetic modulo the BLS12381 base field prime.
+ *
+ * Included by FpBatchAvx2.cpp and FpBatchAvx512.cpp, each compiled for its own instruction
+ * set; a vector policy V supplies the lane type T, the lane count W and the lane operations. Everything here has internal linkage and uses no STL, so that code
+ * generated for a wider ISA can never be merged by the linker into the baseline objects.
+ *
+ * Representation: an element is 14 limbs of 29 bits (406 bits), the exact split of MIRACL's
+ * 7 x 58-bit B384_58 limbs, and values are kept in MIRACL's Montgomery form (R = 2^406).
+ * A group holds W elements interleaved limb-major: limb j of lane l is at [j * W + l].
+ * Every 29 x 29-bit product fits the 32 x 32 -> 64-bit lane multiply of SSE/AVX.
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+namespace {
+
+    const int FPB_LIMBS = 14;
+    const int FPB_BITS = 29;
+    const uint64_t FPB_MASK = (1ULL << FPB_BITS) - 1;
+
+    /**
+     * Modulus limbs followed by -p^-1 mod 2^29, prepared by FpBatch.cpp
+     */
+    struct FpBatchConst {
+        uint64_t p[FPB_LIMBS];
+        uint64_t pinv;
+    };
+
+    /**
+     * r = a * b * 2^-406 mod p (word-by-word Montgomery, carries deferred: every lane limb
+     * accumulates at most 28 products of 58 bits, which stays below 2^64)
+     */
+    template<class V>
+    inline void fpb_mulGroup(uint64_t *r, const uint64_t *a, const uint64_t *b, const FpBatchConst &c) {
+        typedef typename V::T T;
+        const int W = V::W;
+        T t[FPB_LIMBS], bj[FPB_LIMBS], p[FPB_LIMBS];
+        T mask = V::set1(FPB_MASK), pinv = V::set1(c.pinv);
+        for (int j = 0; j < FPB_LIMBS; ++j) {
+            t[j] = V::zero();
+            bj[j] = V::load(b + j * W);
+            p[j] = V::set1(c.p[j]);
+        }
+        for (int i = 0; i < FPB_LIMBS; ++i) {
+            T ai = V::load(a + i * W);
+            T t0 = V::add(t[0], V::mul(ai, bj[0]));
+            T m = V::band(V::mul(t0, pinv), mask);
+            t0 = V::add(t0, V::mul(m, p[0]));
+            T carry = V::srli(t0, FPB_BITS);
+            for (int j = 1; j < FPB_LIMBS; ++j) {
+                t[j - 1] = V::add(V::add(t[j], V::mul(ai, bj[j])), V::mul(m, p[j]));
+            }
+            t[0] = V::add(t[0], carry);
+            t[FPB_LIMBS - 1] = V::zero();
+        }
+
+        // Normalize to 29-bit limbs; the value is below 2p
+        T carry = V::zero();
+        for (int j = 0; j < FPB_LIMBS; ++j) {
+            T v = V::add(t[j], carry);
+            carry = V::srli(v, FPB_BITS);
+            t[j] = V::band(v, mask);
+        }
+
+        // Conditional subtraction of p
+        T d[FPB_LIMBS], borrow = V::zero();
+        for (int j = 0; j < FPB_LIMBS; ++j) {
+            T v = V::sub(V::sub(t[j], p[j]), borrow);
+            borrow = V::srli(v, 63);
+            d[j] = V::band(v, mask);
+        }
+        T keep = V::sub(V::zero(), borrow);  // all ones where t < p
+        for (int j = 0; j < FPB_LIMBS; ++j) {
+            V::store(r + j * W, V::bor(V::band(t[j], keep), V::bandnot(keep, d[j])));
+        }
+    }
+
+    /**
+     * r = a + b mod p
+     */
+    template<class V>
+    inline void fpb_addGroup(uint64_t *r, const uint64_t *a, const uint64_t *b, const FpBatchConst &c) {
+        typedef typename V::T T;
+        const int W = V::W;
+        T mask = V::set1(FPB_MASK);
+        T t[FPB_LIMBS], d[FPB_LIMBS], carry = V::zero(), borrow = V::zero();
+        for (int j = 0; j < FPB_LIMBS; ++j) {
+            T v = V::add(V::add(V::load(a + j * W), V::load(b + j * W)), carry);
+            carry = V::srli(v, FPB_BITS);
+            t[j] = V::band(v, mask);
+        }
+        for (int j = 0; j < FPB_LIMBS; ++j) {
+            T v = V::sub(V::sub(t[j], V::set1(c.p[j])), borrow);
+            borrow = V::srli(v, 63);
+            d[j] = V::band(v, mask);
+        }
+        T keep = V::sub(V::zero(), borrow);
+        for (int j = 0; j < FPB_LIMBS; ++j) {
+            V::store(r + j * W, V::bor(V::band(t[j], keep), V::bandnot(keep, d[j])));
+        }
+    }
+
+    /**
+     * r = a - b mod p
+     */
+    template<class V>
+    inline void fpb_subGroup(uint64_t *r, const uint64_t *a, const uint64_t *b, const FpBatchConst &c) {
+        typedef typename V::T T;
+        const int W = V::W;
+        T mask = V::set1(FPB_MASK);
+        T t[FPB_LIMBS], borrow = V::zero();
+        for (int j = 0; j < FPB_LIMBS; ++j) {
+            T v = V::sub(V::sub(V::load(a + j * W), V::load(b + j * W)), borrow);
+            borrow = V::srli(v, 63);
+            t[j] = V::band(v, mask);
+        }
+        T addP = V::sub(V::zero(), borrow);  // all ones where a < b
+        T carry = V::zero();
+        for (int j = 0; j < FPB_LIMBS; ++j) {
+            T v = V::add(V::add(t[j], V::band(V::set1(c.p[j]), addP)), carry);
+            carry = V::srli(v, FPB_BITS);
+            V::store(r + j * W, V::band(v, mask));
+        }
+    }
+}
+
+/**
+ * Entry points of one ISA variant: process `groups` consecutive groups of W elements
+ */
+#define FPBATCH_DEFINE_ENTRY_POINTS(SUFFIX, V)                                                            \
+    void fpBatchMul_##SUFFIX(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t groups,          \
+                             const void *c) {                                                           \
+        const size_t stride = FPB_LIMBS * V::W;                                                         \
+        for (size_t g = 0; g < groups; ++g)                                                             \
+            fpb_mulGroup<V>(r + g * stride, a + g * stride, b + g * stride, *(const FpBatchConst *) c); \
+    }                                                                                                   \
+    void fpBatchAdd_##SUFFIX(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t groups,          \
+                             const void *c) {                                                           \
+        const size_t stride = FPB_LIMBS * V::W;                                                         \
+        for (size_t g = 0; g < groups; ++g)                                                             \
+            fpb_addGroup<V>(r + g * stride, a + g * stride, b + g * stride, *(const FpBatchConst *) c); \
+    }                                                                                                   \
+    void fpBatchSub_##SUFFIX(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t groups,          \
+                             const void *c) {                                                           \
+        const size_t stride = FPB_LIMBS * V::W;                                                         \
+        for (size_t g = 0; g < groups; ++g)                                                             \
+            fpb_subGroup<V>(r + g * stride, a + g * stride, b + g * stride, *(const FpBatchConst *) c); \
+    }
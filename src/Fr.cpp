@@ -0,0 +1,183 @@
+#include "../include/Fr.h"
+#include "ModInv.h"
+
+static void Fr_fromWords(Fr &r, const uint64_t w[4]) {
+    // w < q: multiplying by R^2 moves it into Montgomery form
+    Fr t, r2;
+    memcpy(t.v, w, sizeof(t.v));
+    memcpy(r2.v, fr_detail::R2, sizeof(r2.v));
+    Fr_mul(r, t, r2);
+}
+
+void Fr_toWords(uint64_t w[4], const Fr &a) {
+    // Multiplying by 1 strips the Montgomery factor
+    Fr one = {{1, 0, 0, 0}}, t;
+    Fr_mul(t, a, one);
+    memcpy(w, t.v, sizeof(t.v));
+}
+
+void Fr_fromU64(Fr &r, uint64_t x) {
+    uint64_t w[4] = {x, 0, 0, 0};
+    Fr_fromWords(r, w);
+}
+
+void Fr_fromMpz(Fr &r, const mpz_class &a) {
+    const mpz_class &q = getCurveOrder();
+    uint64_t w[4] = {0, 0, 0, 0};
+    if (a >= 0 && a < q) {
+        mpz_export(w, nullptr, -1, sizeof(uint64_t), 0, 0, a.get_mpz_t());
+    } else {
+        mpz_class t = a % q;
+        if (t < 0) t += q;
+        mpz_export(w, nullptr, -1, sizeof(uint64_t), 0, 0, t.get_mpz_t());
+    }
+    Fr_fromWords(r, w);
+}
+
+mpz_class Fr_toMpz(const Fr &a) {
+    uint64_t w[4];
+    Fr_toWords(w, a);
+    mpz_class res;
+    mpz_import(res.get_mpz_t(), 4, -1, sizeof(uint64_t), 0, 0, w);
+    return res;
+}
+
+void Fr_fromBIG(Fr &r, BIG a) {
+    char bytes[MODBYTES_B384_58];
+    BIG_toBytes(bytes, a);
+    uint64_t w[4] = {0, 0, 0, 0};
+    for (int i = 0; i < 32; ++i) {
+        int bit = 8 * (31 - i);
+        w[bit >> 6] |= (uint64_t) (unsigned char) bytes[MODBYTES_B384_58 - 32 + i] << (bit & 63);
+    }
+    Fr_fromWords(r, w);
+}
+
+void Fr_toBIG(BIG r, const Fr &a) {
+    uint64_t w[4];
+    Fr_toWords(w, a);
+    char bytes[32];
+    for (int i = 0; i < 32; ++i) {
+        int bit = 8 * (31 - i);
+        bytes[i] = (char) (w[bit >> 6] >> (bit & 63));
+    }
+    BIG_fromBytesLen(r, bytes, 32);
+}
+
+void Fr_pow(Fr &r, const Fr &a, const uint64_t e[4]) {
+    Fr acc, base = a;
+    Fr_one(acc);
+    for (int i = 255; i >= 0; --i) {
+        Fr_sqr(acc, acc);
+        if ((e[i >> 6] >> (i & 63)) & 1) Fr_mul(acc, acc, base);
+    }
+    r = acc;
+}
+
+void Fr_inv(Fr &r, const Fr &a) {
+    // Constant-time divsteps give (aR)^-1; one multiplication by R^3 brings it back to a^-1 R
+    static const ModInvModulus M = [] {
+        ModInvModulus m;
+        uint64_t q[MODINV_WORDS] = {fr_detail::Q[0], fr_detail::Q[1], fr_detail::Q[2], fr_detail::Q[3], 0, 0};
+        modinvSetup(m, q);
+        return m;
+    }();
+    static const Fr R3 = [] {
+        Fr r2, r3;
+        memcpy(r2.v, fr_detail::R2, sizeof(r2.v));
+        Fr_mul(r3, r2, r2);
+        return r3;
+    }();
+    uint64_t w[MODINV_WORDS] = {a.v[0], a.v[1], a.v[2], a.v[3], 0, 0}, x[MODINV_WORDS];
+    modinv(x, w, M, true);
+    Fr t;
+    memcpy(t.v, x, sizeof(t.v));
+    Fr_mul(r, t, R3);
+}
+
+void Fr_rootOfUnity(Fr &r, size_t n) {
+    // q - 1 = 2^32 * t with t odd and 7 a generator of Fq^*, so 7^t has order 2^32
+    assert(n > 0 && (n & (n - 1)) == 0 && n <= (1ULL << 32));
+    static const Fr root32 = [] {
+        uint64_t t[4] = {fr_detail::Q[0] - 1, fr_detail::Q[1], fr_detail::Q[2], fr_detail::Q[3]};
+        for (int i = 0; i < 4; ++i) t[i] = (t[i] >> 32) | (i < 3 ? t[i + 1] << 32 : 0);
+        Fr seven, res;
+        Fr_fromU64(seven, 7);
+        Fr_pow(res, seven, t);
+        return res;
+    }();
+    r = root32;
+    for (size_t k = n; k < (1ULL << 32); k <<= 1) Fr_sqr(r, r);
+}
+
+void Fr_ntt(Fr *a, size_t n, bool inverse) {
+    assert(n > 0 && (n & (n - 1)) == 0);
+    for (size_t i = 1, j = 0; i < n; ++i) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) swap(a[i], a[j]);
+    }
+    for (size_t len = 2; len <= n; len <<= 1) {
+        Fr w;
+        Fr_rootOfUnity(w, len);
+        if (inverse) Fr_inv(w, w);
+        size_t half = len >> 1;
+        vector<Fr> tw(half);
+        Fr_one(tw[0]);
+        for (size_t k = 1; k < half; ++k) Fr_mul(tw[k], tw[k - 1], w);
+        for (size_t i = 0; i < n; i += len) {
+            for (size_t k = 0; k < half; ++k) {
+                Fr u = a[i + k], v;
+                Fr_mul(v, a[i + k + half], tw[k]);
+                Fr_add(a[i + k], u, v);
+                Fr_sub(a[i + k + half], u, v);
+            }
+        }
+    }
+    if (inverse) {
+        Fr nInv;
+        Fr_fromU64(nInv, n);
+        Fr_inv(nInv, nInv);
+        for (size_t i = 0; i < n; ++i) Fr_mul(a[i], a[i], nInv);
+    }
+}
+
+void Fr_batchInv(Fr *r, const Fr *a, size_t n) {
+    if (n == 0) return;
+    vector<Fr> prefix(n);
+    Fr acc;
+    Fr_one(acc);
+    for (size_t i = 0; i < n; ++i) {
+        prefix[i] = acc;
+        if (!Fr_isZero(a[i])) Fr_mul(acc, acc, a[i]);
+    }
+    Fr inv;
+    Fr_inv(inv, acc);
+    for (size_t i = n; i-- > 0;) {
+        if (Fr_isZero(a[i])) {
+            Fr_zero(r[i]);
+            continue;
+        }
+        Fr ai = a[i];
+        Fr_mul(r[i], inv, prefix[i]);
+        Fr_mul(inv, inv, ai);
+    }
+}
+
+void Fr_random(Fr &r, csprng &rng) {
+    // 255-bit candidates are accepted with probability q / 2^255 ~ 0.9; a uniform value in [0, q)
+    // is also a uniform Montgomery representation, so no conversion is needed
+    for (;;) {
+        for (int i = 0; i < 4; ++i) {
+            uint64_t w = 0;
+            for (int j = 0; j < 8; ++j) w = (w << 8) | (uint64_t) (RAND_byte(&rng) & 0xff);
+            r.v[i] = w;
+        }
+        r.v[3] &= 0x7fffffffffffffffULL;
+        uint64_t t[4];
+        fr_detail::reduceOnce(t, r.v);
+        if (memcmp(t, r.v, sizeof(t)) != 0) continue;  // r >= q
+        return;
+    }
+}
@@ -0,0 +1,93 @@
+#include "../include/GTFixedBase.h"
+#include "Scalar.h"
+
+int GTFixedBase::windowCount(int windowBits) {
+    // One extra digit position absorbs the carry of the signed recoding
+    int bits = (int) mpz_sizeinbase(getCurveOrder().get_mpz_t(), 2);
+    return (bits + windowBits - 1) / windowBits + 1;
+}
+
+size_t GTFixedBase::tableSize(int windowBits) {
+    return (size_t) windowCount(windowBits) << (windowBits - 1);
+}
+
+GTFixedBase::GTFixedBase(const FP12 &base, int windowBits) : w_(windowBits) {
+    if (w_ < 2 || w_ > 10) {
+        throw invalid_argument("GTFixedBase: window width must be in [2, 10]");
+    }
+    windows_ = windowCount(w_);
+    size_t half = (size_t) 1 << (w_ - 1);
+    own_.resize(tableSize(w_));
+    FP12 row;
+    FP12_copy(&row, const_cast<FP12 *>(&base));
+    FP12_reduce(&row);
+    for (int i = 0; i < windows_; ++i) {
+        FP12 *t = &own_[(size_t) i * half];
+        FP12_copy(&t[0], &row);
+        for (size_t d = 1; d < half; ++d) {
+            FP12_copy(&t[d], &t[d - 1]);
+            FP12_mul(&t[d], &row);
+            FP12_reduce(&t[d]);
+        }
+        // next row: row^(2^w) = (row^half)^2
+        FP12_usqr(&row, &t[half - 1]);
+        FP12_reduce(&row);
+    }
+    table_ = own_.data();
+}
+
+GTFixedBase::GTFixedBase(const FP12 *table, size_t count, int windowBits) : w_(windowBits), table_(table) {
+    if (w_ < 2 || w_ > 10) {
+        throw invalid_argument("GTFixedBase: window width must be in [2, 10]");
+    }
+    if (count != tableSize(w_)) {
+        throw invalid_argument("GTFixedBase: table size does not match the window width");
+    }
+    windows_ = windowCount(w_);
+}
+
+static void powDigits(FP12 &r, const FP12 *table, int w, int windows, const ScalarWords &e) {
+    int half = 1 << (w - 1);
+    bool started = false;
+    int carry = 0;
+    for (int i = 0; i < windows; ++i) {
+        int d = (int) e.window(i * w, w) + carry;
+        carry = 0;
+        if (d > half) {
+            d -= 2 * half;
+            carry = 1;
+        }
+        if (d == 0) continue;
+        FP12 t;
+        const FP12 *entry = &table[(size_t) i * half + (size_t) abs(d) - 1];
+        if (d > 0) {
+            FP12_copy(&t, const_cast<FP12 *>(entry));
+        } else {
+            FP12_conj(&t, const_cast<FP12 *>(entry));
+        }
+        if (started) {
+            FP12_mul(&r, &t);
+        } else {
+            FP12_copy(&r, &t);
+            started = true;
+        }
+    }
+    if (started) {
+        FP12_reduce(&r);
+    } else {
+        FP12_one(&r);
+    }
+}
+
+void GTFixedBase::pow(FP12 &r, const mpz_class &e) const {
+    ScalarWords s;
+    scalarFromMpz(s, e, &getCurveOrder());
+    powDigits(r, table_, w_, windows_, s);
+}
+
+void GTFixedBase::pow(FP12 &r, BIG e) const {
+    ScalarWords s;
+    scalarFromBIG(s, e);
+    assert(s.bits() <= w_ * (windows_ - 1));
+    powDigits(r, table_, w_, windows_, s);
+}
@@ -0,0 +1,228 @@
+#include "GmpHeapScope.h"
+#include <mutex>
+
+namespace {
+    const size_t ALIGN = 16;
+    const size_t SMALL_CLASSES = 32;           // free lists for blocks of 16, 32, ..., 512 bytes
+
+    struct FreeBlock {
+        FreeBlock *next;
+    };
+
+    struct Chunk {
+        char *base;
+        size_t size;
+    };
+
+    size_t blockSize(size_t n) {
+        return n ? (n + ALIGN - 1) & ~(ALIGN - 1) : ALIGN;
+    }
+
+    /**
+     * Chunks of one thread, bumped in order; blocks are blockSize() bytes, so a free knows the
+     * size class from the size GMP passes back
+     */
+    struct Arena {
+        vector<Chunk> chunks;
+        size_t current = 0;                    // chunk being bumped
+        size_t offset = 0;                     // bump offset in chunks[current]
+        size_t firstChunk = 64 << 10;
+        FreeBlock *freeLists[SMALL_CLASSES] = {};
+        size_t live = 0;                       // blocks handed out and not freed yet
+        int depth = 0;                         // open scopes
+
+        ~Arena() {
+            for (Chunk &c: chunks) free(c.base);
+        }
+
+        bool owns(const void *p) const {
+            const char *b = (const char *) p;
+            for (const Chunk &c: chunks) {
+                if (b >= c.base && b < c.base + c.size) return true;
+            }
+            return false;
+        }
+
+        char *top() const {
+            return chunks.empty() ? nullptr : chunks[current].base + offset;
+        }
+
+        void *alloc(size_t n) {
+            size_t size = blockSize(n);
+            live++;
+            if (size <= ALIGN * SMALL_CLASSES) {
+                FreeBlock *&head = freeLists[size / ALIGN - 1];
+                if (head) {
+                    FreeBlock *b = head;
+                    head = b->next;
+                    return b;
+                }
+            }
+            if (chunks.empty() || offset + size > chunks[current].size) nextChunk(size);
+            char *p = chunks[current].base + offset;
+            offset += size;
+            return p;
+        }
+
+        /**
+         * Moves the bump pointer to the first chunk after the current one that fits `size`
+         * bytes, reserving a new chunk (twice the size of the last one) when none does
+         */
+        void nextChunk(size_t size) {
+            size_t next = chunks.empty() ? 0 : current + 1;
+            while (next < chunks.size() && chunks[next].size < size) next++;
+            if (next == chunks.size()) {
+                size_t bytes = max(chunks.empty() ? firstChunk : 2 * chunks.back().size, size);
+                char *base = (char *) malloc(bytes);
+                if (!base) throw bad_alloc();
+                chunks.push_back({base, bytes});
+            }
+            current = next;
+            offset = 0;
+        }
+
+        void release(void *p, size_t n) {
+            size_t size = blockSize(n);
+            live--;
+            if ((char *) p + size == top()) {
+                offset -= size;
+            } else if (size <= ALIGN * SMALL_CLASSES) {
+                FreeBlock *b = (FreeBlock *) p;
+                FreeBlock *&head = freeLists[size / ALIGN - 1];
+                b->next = head;
+                head = b;
+            }
+            if (live == 0 && depth == 0) rewind();
+        }
+
+        void rewind();
+    };
+
+    void *(*prevAlloc)(size_t);
+    void *(*prevRealloc)(void *, size_t, size_t);
+    void (*prevFree)(void *, size_t);
+
+    // Plain pointers and counters, so the hooks reach them without thread_local init guards
+    thread_local Arena *tlArena = nullptr;
+    thread_local GmpArenaStats tlStats;
+    thread_local int tlHeapDepth = 0;         // open GmpHeapScopes
+
+    void Arena::rewind() {
+        current = 0;
+        offset = 0;
+        memset(freeLists, 0, sizeof(freeLists));
+        tlStats.resets++;
+    }
+
+    /**
+     * Deletes the thread's arena when the thread exits; an arena that still has blocks in use
+     * (mpz values destroyed after this point) is left allocated
+     */
+    struct ArenaOwner {
+        ~ArenaOwner() {
+            if (tlArena && tlArena->live == 0) {
+                delete tlArena;
+                tlArena = nullptr;
+            }
+        }
+    };
+
+    Arena &threadArena() {
+        static thread_local ArenaOwner owner;
+        (void) owner;
+        if (!tlArena) tlArena = new Arena();
+        return *tlArena;
+    }
+
+    /**
+     * Whether new blocks of this thread come from its arena
+     */
+    bool arenaActive(const Arena *a) {
+        return a && a->depth && tlHeapDepth == 0;
+    }
+
+    void *hookAlloc(size_t n) {
+        Arena *a = tlArena;
+        if (arenaActive(a)) {
+            tlStats.arenaAllocs++;
+            return a->alloc(n);
+        }
+        tlStats.heapAllocs++;
+        return prevAlloc(n);
+    }
+
+    void *hookRealloc(void *p, size_t oldSize, size_t newSize) {
+        tlStats.reallocs++;
+        Arena *a = tlArena;
+        if (!a || !a->owns(p)) return prevRealloc(p, oldSize, newSize);
+        size_t oldBlock = blockSize(oldSize), newBlock = blockSize(newSize);
+        char *end = (char *) p + oldBlock;
+        // the newest block grows or shrinks in place
+        if (arenaActive(a) && end == a->top() && a->offset - oldBlock + newBlock <= a->chunks[a->current].size) {
+            a->offset = a->offset - oldBlock + newBlock;
+            return p;
+        }
+        if (newBlock == oldBlock) return p;
+        void *q;
+        if (arenaActive(a)) {
+            q = a->alloc(newSize);
+        } else {
+            // grown after its scope closed (or under a GmpHeapScope): the value moves to the heap
+            q = prevAlloc(newSize);
+        }
+        memcpy(q, p, min(oldSize, newSize));
+        a->release(p, oldSize);
+        return q;
+    }
+
+    void hookFree(void *p, size_t n) {
+        tlStats.frees++;
+        Arena *a = tlArena;
+        if (a && a->owns(p)) {
+            a->release(p, n);
+        } else {
+            prevFree(p, n);
+        }
+    }
+}
+
+void GmpArena_install() {
+    static once_flag once;
+    call_once(once, [] {
+        mp_get_memory_functions(&prevAlloc, &prevRealloc, &prevFree);
+        mp_set_memory_functions(hookAlloc, hookRealloc, hookFree);
+    });
+}
+
+GmpArenaStats GmpArena_stats() {
+    GmpArenaStats st = tlStats;
+    st.reserved = 0;
+    if (tlArena) {
+        for (const Chunk &c: tlArena->chunks) st.reserved += c.size;
+    }
+    return st;
+}
+
+void GmpArena_resetStats() {
+    tlStats = GmpArenaStats();
+}
+
+GmpArenaScope::GmpArenaScope(size_t chunkBytes) {
+    GmpArena_install();
+    Arena &a = threadArena();
+    if (a.chunks.empty()) a.firstChunk = max(chunkBytes, (size_t) 4096);
+    a.depth++;
+}
+
+GmpArenaScope::~GmpArenaScope() {
+    Arena &a = *tlArena;
+    if (--a.depth == 0 && a.live == 0) a.rewind();
+}
+
+GmpHeapScope::GmpHeapScope() {
+    tlHeapDepth++;
+}
+
+GmpHeapScope::~GmpHeapScope() {
+    tlHeapDepth--;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "../include/GmpArena.h"
+
+/**
+ * Sends the GMP allocations of the calling thread to the previous allocator while it lives,
+ * even inside a GmpArenaScope. For values that outlive every scope, such as the library's
+ * lazily built statics: placed in an arena they would keep it from rewinding, and be freed at
+ * exit by a thread that does not own it. Nests; not copyable.
+ */
+class GmpHeapScope {
+public:
+    GmpHeapScope();
+
+    GmpHeapScope(const GmpHeapScope &) = delete;
+
+    GmpHeapScope &operator=(const GmpHeapScope &) = delete;
+
+    ~GmpHeapScope();
+};
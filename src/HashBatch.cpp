@@ -0,0 +1,220 @@
+#include "../include/HashBatch.h"
+#include "../include/Fr.h"
+#include "CurveKernels.h"
+#include <atomic>
+
+#define SHA256_LANES 4
+#include "Sha256Kernel.h"
+
+// One group of up to `lanes` messages, see Sha256Kernel.h
+typedef void (*Sha256LanesFn)(const unsigned char *const *msgs, const size_t *lens, int count, unsigned char *digests);
+
+#ifdef WRAPPER_X86_SIMD
+void sha256Lanes_avx2(const unsigned char *const *msgs, const size_t *lens, int count, unsigned char *digests);
+void sha256Lanes_avx512(const unsigned char *const *msgs, const size_t *lens, int count, unsigned char *digests);
+void sha256_shani(const unsigned char *msg, size_t len, unsigned char *digest);
+#endif
+
+namespace {
+    const size_t GROUP = 256;                 // items hashed per HashBatch_sha256 call of the Zp functions
+
+    HashBackend bestBackend() {
+        if (HashBatch_supported(HashBackend::AVX512)) return HashBackend::AVX512;
+        if (HashBatch_supported(HashBackend::AVX2)) return HashBackend::AVX2;
+        if (HashBatch_supported(HashBackend::ShaNi)) return HashBackend::ShaNi;
+        return HashBackend::Lanes4;
+    }
+
+    atomic<int> activeBackend{-1};
+
+    HashBackend backend() {
+        int b = activeBackend.load(memory_order_relaxed);
+        if (b < 0) {
+            b = (int) bestBackend();
+            activeBackend.store(b, memory_order_relaxed);
+        }
+        return (HashBackend) b;
+    }
+
+    void runLanes(Sha256LanesFn fn, int lanes, unsigned char *digests, const unsigned char *const *messages,
+                  const size_t *lengths, size_t n) {
+        for (size_t i = 0; i < n; i += lanes) {
+            fn(messages + i, lengths + i, (int) min<size_t>(lanes, n - i), digests + 32 * i);
+        }
+    }
+
+    /**
+     * 2^384 mod q: multiplying a 256-bit digest d by it in Montgomery form (one division by
+     * 2^256) gives d * 2^128 mod q, the value hashZp256 reduces with BIG_mod
+     */
+    const Fr &digestFactor() {
+        static const Fr f = [] {
+            mpz_class c = (mpz_class(1) << 384) % getCurveOrder();
+            Fr r = {{0, 0, 0, 0}};
+            mpz_export(r.v, nullptr, -1, sizeof(uint64_t), 0, 0, c.get_mpz_t());
+            return r;
+        }();
+        return f;
+    }
+
+    /**
+     * res = the hashZp256 result of a digest: the digest in the top 32 of 48 bytes, modulo q
+     */
+    void digestToZp(BIG res, const unsigned char *digest, BIG q, bool curveOrder) {
+        char bytes[MODBYTES_B384_58] = {0};
+        if (curveOrder) {
+            Fr d, r;
+            for (int i = 0; i < 4; ++i) {
+                uint64_t w = 0;
+                for (int j = 0; j < 8; ++j) w = w << 8 | digest[8 * (3 - i) + j];
+                d.v[i] = w;
+            }
+            // d < 2^256 and the factor < q, so the product is fully reduced
+            Fr_mul(r, d, digestFactor());
+            for (int i = 0; i < 32; ++i) {
+                int bit = 8 * (31 - i);
+                bytes[MODBYTES_B384_58 - 32 + i] = (char) (r.v[bit >> 6] >> (bit & 63));
+            }
+            BIG_fromBytes(res, bytes);
+            return;
+        }
+        memcpy(bytes, digest, 32);
+        BIG_fromBytesLen(res, bytes, MODBYTES_B384_58);
+        BIG_mod(res, q);
+    }
+
+    bool isCurveOrder(BIG q) {
+        BIG order;
+        BIG_rcopy(order, CURVE_Order);
+        BIG_norm(q);
+        return BIG_comp(q, order) == 0;
+    }
+}
+
+bool HashBatch_supported(HashBackend backend) {
+    switch (backend) {
+        case HashBackend::Scalar:
+        case HashBackend::Lanes4:
+            return true;
+#ifdef WRAPPER_X86_SIMD
+        case HashBackend::ShaNi:
+            return __builtin_cpu_supports("sha") && __builtin_cpu_supports("sse4.1");
+        case HashBackend::AVX2:
+            return __builtin_cpu_supports("avx2");
+        case HashBackend::AVX512:
+            return __builtin_cpu_supports("avx512f");
+#endif
+        default:
+            return false;
+    }
+}
+
+HashBackend HashBatch_backend() {
+    return backend();
+}
+
+HashBackend HashBatch_setBackend(HashBackend b) {
+    if (!HashBatch_supported(b)) b = bestBackend();
+    activeBackend.store((int) b, memory_order_relaxed);
+    return b;
+}
+
+const char *HashBatch_backendName(HashBackend backend) {
+    switch (backend) {
+        case HashBackend::Lanes4:
+            return "lanes4";
+        case HashBackend::ShaNi:
+            return "sha-ni";
+        case HashBackend::AVX2:
+            return "avx2";
+        case HashBackend::AVX512:
+            return "avx512";
+        default:
+            return "scalar";
+    }
+}
+
+void HashBatch_sha256(unsigned char *digests, const unsigned char *const *messages, const size_t *lengths, size_t n) {
+    switch (backend()) {
+#ifdef WRAPPER_X86_SIMD
+        case HashBackend::AVX512:
+            runLanes(sha256Lanes_avx512, 16, digests, messages, lengths, n);
+            return;
+        case HashBackend::AVX2:
+            runLanes(sha256Lanes_avx2, 8, digests, messages, lengths, n);
+            return;
+        case HashBackend::ShaNi:
+            for (size_t i = 0; i < n; ++i) sha256_shani(messages[i], lengths[i], digests + 32 * i);
+            return;
+#endif
+        case HashBackend::Lanes4:
+            runLanes(sha256Lanes, SHA256_LANES, digests, messages, lengths, n);
+            return;
+        default:
+            for (size_t i = 0; i < n; ++i) {
+                hash256 h;
+                HASH256_init(&h);
+                for (size_t j = 0; j < lengths[i]; ++j) HASH256_process(&h, messages[i][j]);
+                HASH256_hash(&h, (char *) digests + 32 * i);
+            }
+    }
+}
+
+void HashBatch_hashZp256(BIG *res, const octet *cts, size_t n, const BIG q) {
+    BIG qq;
+    BIG_rcopy(qq, q);
+    bool curveOrder = isCurveOrder(qq);
+    const unsigned char *messages[GROUP];
+    size_t lengths[GROUP];
+    unsigned char digests[32 * GROUP];
+    for (size_t i0 = 0; i0 < n; i0 += GROUP) {
+        size_t m = min(GROUP, n - i0);
+        for (size_t i = 0; i < m; ++i) {
+            messages[i] = (const unsigned char *) cts[i0 + i].val;
+            lengths[i] = (size_t) max(cts[i0 + i].max, 0);
+        }
+        HashBatch_sha256(digests, messages, lengths, m);
+        for (size_t i = 0; i < m; ++i) digestToZp(res[i0 + i], digests + 32 * i, qq, curveOrder);
+    }
+}
+
+void HashBatch_hashToZp256(BIG *res, const BIG *in, size_t n, const BIG q) {
+    BIG qq;
+    BIG_rcopy(qq, q);
+    bool curveOrder = isCurveOrder(qq);
+    const unsigned char *messages[GROUP];
+    size_t lengths[GROUP];
+    unsigned char bytes[MODBYTES_B384_58 * GROUP], digests[32 * GROUP];
+    for (size_t i0 = 0; i0 < n; i0 += GROUP) {
+        size_t m = min(GROUP, n - i0);
+        for (size_t i = 0; i < m; ++i) {
+            BIG t;
+            BIG_rcopy(t, in[i0 + i]);
+            BIG_toBytes((char *) bytes + MODBYTES_B384_58 * i, t);
+            messages[i] = bytes + MODBYTES_B384_58 * i;
+            lengths[i] = MODBYTES_B384_58;
+        }
+        HashBatch_sha256(digests, messages, lengths, m);
+        for (size_t i = 0; i < m; ++i) digestToZp(res[i0 + i], digests + 32 * i, qq, curveOrder);
+    }
+}
+
+vector<mpz_class> HashBatch_hashToZp256(const vector<mpz_class> &in, const mpz_class &q) {
+    vector<BIG> b(in.size()), r(in.size());
+    for (size_t i = 0; i < in.size(); ++i) mpz_to_BIG(in[i], b[i]);
+    BIG qb;
+    mpz_to_BIG(q, qb);
+    HashBatch_hashToZp256(r.data(), b.data(), in.size(), qb);
+    vector<mpz_class> res(in.size());
+    for (size_t i = 0; i < in.size(); ++i) res[i] = BIG_to_mpz(r[i]);
+    return res;
+}
+
+void HashBatch_hashToPoint(ECP *out, const BIG *in, size_t n, const BIG q) {
+    vector<BIG> hashes(n);
+    HashBatch_hashToZp256(hashes.data(), in, n, q);
+    for (size_t i = 0; i < n; ++i) {
+        ECP_generator(&out[i]);
+        curveKernels().ecpMul(&out[i], hashes[i]);
+    }
+}
@@ -0,0 +1,188 @@
+#include "../include/HashToPointCache.h"
+#include <thread>
+
+namespace {
+    const size_t WAYS = 8;
+    const size_t KEY_WORDS = 2 * MODBYTES_B384_58 / 8;   // id and q, 48 bytes each
+    static_assert(sizeof(ECP) % 8 == 0, "ECP is copied as 64-bit words");
+    const size_t POINT_WORDS = sizeof(ECP) / 8;
+
+    uint64_t hashKey(const uint64_t key[KEY_WORDS]) {
+        uint64_t h = 0;
+        for (size_t i = 0; i < KEY_WORDS; ++i) {
+            h = (h ^ key[i]) * 0x9e3779b97f4a7c15ULL;
+            h ^= h >> 29;
+        }
+        // splitmix64 finalizer
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+        return h ^ (h >> 31);
+    }
+
+    size_t floorPow2(size_t n) {
+        size_t p = 1;
+        while (p * 2 <= n) p *= 2;
+        return p;
+    }
+}
+
+/**
+ * One entry. Every field is atomic so that lock-free readers may race with a writer; the
+ * sequence number tells them whether what they copied is consistent.
+ */
+struct HashToPointCache::Slot {
+    atomic<uint32_t> seq;            // odd while a writer changes the entry
+    atomic<uint8_t> ref;             // CLOCK reference bit, set by hits
+    atomic<uint64_t> tag;            // hash | 1, or 0 for an empty slot
+    atomic<uint64_t> key[KEY_WORDS];
+    atomic<uint64_t> point[POINT_WORDS];
+};
+
+struct alignas(64) HashToPointCache::Shard {
+    mutex lock;
+    atomic<uint64_t> hits{0};
+    atomic<uint64_t> misses{0};
+    atomic<uint64_t> evictions{0};
+    atomic<size_t> entries{0};
+};
+
+HashToPointCache::HashToPointCache(const HashToPointCacheConfig &config) {
+    sets_ = floorPow2(max<size_t>(1, config.maxBytes / (sizeof(Slot) * WAYS)));
+    size_t shards = config.shards ? config.shards : 4 * max(1u, thread::hardware_concurrency());
+    shards = min(floorPow2(2 * shards - 1), sets_);
+    shardMask_ = shards - 1;
+    // value-initialized: every slot empty with sequence number 0
+    slots_.reset(new Slot[sets_ * WAYS]());
+    hands_.reset(new uint8_t[sets_]());
+    shards_.reset(new Shard[shards]);
+}
+
+HashToPointCache::~HashToPointCache() = default;
+
+bool HashToPointCache::find(ECP &P, const uint64_t key[], uint64_t hash) {
+    uint64_t tag = hash | 1;
+    Slot *set = &slots_[setOf(hash) * WAYS];
+    uint64_t words[POINT_WORDS];
+    for (size_t w = 0; w < WAYS; ++w) {
+        Slot &s = set[w];
+        for (;;) {
+            uint32_t seq = s.seq.load(memory_order_acquire);
+            // a writer is busy on this slot: report a miss rather than wait for it
+            if ((seq & 1) || s.tag.load(memory_order_relaxed) != tag) break;
+            bool same = true;
+            for (size_t i = 0; i < KEY_WORDS; ++i) same = same && s.key[i].load(memory_order_relaxed) == key[i];
+            for (size_t i = 0; same && i < POINT_WORDS; ++i) words[i] = s.point[i].load(memory_order_relaxed);
+            atomic_thread_fence(memory_order_acquire);
+            if (s.seq.load(memory_order_relaxed) != seq) continue;
+            if (!same) break;
+            memcpy(&P, words, sizeof(ECP));
+            if (!s.ref.load(memory_order_relaxed)) s.ref.store(1, memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void HashToPointCache::insert(const uint64_t key[], uint64_t hash, ECP &P) {
+    uint64_t tag = hash | 1;
+    size_t setIndex = setOf(hash);
+    Slot *set = &slots_[setIndex * WAYS];
+    Shard &shard = shards_[setIndex & shardMask_];
+    lock_guard<mutex> guard(shard.lock);
+    Slot *victim = nullptr;
+    for (size_t w = 0; w < WAYS; ++w) {
+        Slot &s = set[w];
+        uint64_t t = s.tag.load(memory_order_relaxed);
+        if (t == tag) {
+            bool same = true;
+            for (size_t i = 0; i < KEY_WORDS; ++i) same = same && s.key[i].load(memory_order_relaxed) == key[i];
+            if (same) return;
+        }
+        if (t == 0 && !victim) victim = &s;
+    }
+    if (victim) {
+        shard.entries.fetch_add(1, memory_order_relaxed);
+    } else {
+        // CLOCK: skip (and clear) recently hit entries; hits racing with the sweep cannot stall it
+        uint8_t &hand = hands_[setIndex];
+        for (size_t sweep = 0; sweep < 2 * WAYS && set[hand].ref.load(memory_order_relaxed); ++sweep) {
+            set[hand].ref.store(0, memory_order_relaxed);
+            hand = (uint8_t) ((hand + 1) % WAYS);
+        }
+        victim = &set[hand];
+        hand = (uint8_t) ((hand + 1) % WAYS);
+        shard.evictions.fetch_add(1, memory_order_relaxed);
+    }
+    uint64_t words[POINT_WORDS];
+    memcpy(words, &P, sizeof(ECP));
+    uint32_t seq = victim->seq.load(memory_order_relaxed);
+    victim->seq.store(seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    victim->tag.store(tag, memory_order_relaxed);
+    for (size_t i = 0; i < KEY_WORDS; ++i) victim->key[i].store(key[i], memory_order_relaxed);
+    for (size_t i = 0; i < POINT_WORDS; ++i) victim->point[i].store(words[i], memory_order_relaxed);
+    victim->ref.store(0, memory_order_relaxed);
+    victim->seq.store(seq + 2, memory_order_release);
+}
+
+ECP HashToPointCache::get(BIG id, BIG q) {
+    ECP P;
+    if (lookup(P, id, q)) return P;
+    P = hashToPoint(id, q);
+    ECP_affine(&P);
+    uint64_t key[KEY_WORDS];
+    BIG_toBytes((char *) key, id);
+    BIG_toBytes((char *) key + MODBYTES_B384_58, q);
+    insert(key, hashKey(key), P);
+    return P;
+}
+
+ECP HashToPointCache::get(const mpz_class &id, const mpz_class &q) {
+    BIG tb, tq;
+    mpz_to_BIG(id, tb);
+    mpz_to_BIG(q, tq);
+    return get(tb, tq);
+}
+
+bool HashToPointCache::lookup(ECP &P, BIG id, BIG q) {
+    uint64_t key[KEY_WORDS];
+    BIG_toBytes((char *) key, id);
+    BIG_toBytes((char *) key + MODBYTES_B384_58, q);
+    uint64_t hash = hashKey(key);
+    Shard &shard = shards_[setOf(hash) & shardMask_];
+    bool hit = find(P, key, hash);
+    (hit ? shard.hits : shard.misses).fetch_add(1, memory_order_relaxed);
+    return hit;
+}
+
+void HashToPointCache::clear() {
+    for (size_t sh = 0; sh <= shardMask_; ++sh) {
+        Shard &shard = shards_[sh];
+        lock_guard<mutex> guard(shard.lock);
+        for (size_t set = sh; set < sets_; set += shardMask_ + 1) {
+            for (size_t w = 0; w < WAYS; ++w) {
+                Slot &s = slots_[set * WAYS + w];
+                if (!s.tag.load(memory_order_relaxed)) continue;
+                uint32_t seq = s.seq.load(memory_order_relaxed);
+                s.seq.store(seq + 1, memory_order_relaxed);
+                atomic_thread_fence(memory_order_release);
+                s.tag.store(0, memory_order_relaxed);
+                s.seq.store(seq + 2, memory_order_release);
+            }
+        }
+        shard.entries.store(0, memory_order_relaxed);
+    }
+}
+
+HashToPointCacheStats HashToPointCache::stats() const {
+    HashToPointCacheStats st;
+    for (size_t sh = 0; sh <= shardMask_; ++sh) {
+        const Shard &shard = shards_[sh];
+        st.hits += shard.hits.load(memory_order_relaxed);
+        st.misses += shard.misses.load(memory_order_relaxed);
+        st.evictions += shard.evictions.load(memory_order_relaxed);
+        st.entries += shard.entries.load(memory_order_relaxed);
+    }
+    st.capacity = sets_ * WAYS;
+    return st;
+}
@@ -0,0 +1,317 @@
+#include "../include/Hex.h"
+
+#ifdef WRAPPER_X86_SIMD
+void hexEncode_avx2(char *out, const unsigned char *in, size_t n);
+bool hexDecode_avx2(unsigned char *out, const char *in, size_t n);
+#endif
+
+static bool hexSimd() {
+#ifdef WRAPPER_X86_SIMD
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+#else
+    return false;
+#endif
+}
+
+static const char HEX_DIGITS[] = "0123456789abcdef";
+
+/**
+ * Digit value of every byte, -1 for non-digits
+ */
+static const signed char *digitTable() {
+    static signed char table[256];
+    static bool init = [] {
+        memset(table, -1, sizeof(table));
+        for (int i = 0; i < 10; ++i) table['0' + i] = (signed char) i;
+        for (int i = 0; i < 6; ++i) table['a' + i] = table['A' + i] = (signed char) (10 + i);
+        return true;
+    }();
+    (void) init;
+    return table;
+}
+
+void Hex_encode(char *out, const unsigned char *in, size_t n) {
+    size_t done = 0;
+#ifdef WRAPPER_X86_SIMD
+    if (n >= 32 && hexSimd()) {
+        done = n & ~(size_t) 31;
+        hexEncode_avx2(out, in, done);
+    }
+#endif
+    for (size_t i = done; i < n; ++i) {
+        out[2 * i] = HEX_DIGITS[in[i] >> 4];
+        out[2 * i + 1] = HEX_DIGITS[in[i] & 15];
+    }
+}
+
+bool Hex_decode(unsigned char *out, const char *in, size_t n) {
+    size_t done = 0;
+#ifdef WRAPPER_X86_SIMD
+    if (n >= 32 && hexSimd()) {
+        done = n & ~(size_t) 31;
+        if (!hexDecode_avx2(out, in, done)) return false;
+    }
+#endif
+    const signed char *T = digitTable();
+    int bad = 0;
+    for (size_t i = done; i < n; ++i) {
+        int hi = T[(unsigned char) in[2 * i]], lo = T[(unsigned char) in[2 * i + 1]];
+        bad |= hi | lo;
+        out[i] = (unsigned char) ((hi & 15) << 4 | (lo & 15));
+    }
+    return bad >= 0;
+}
+
+string Hex_encode(const unsigned char *in, size_t n) {
+    string s(2 * n, '\0');
+    Hex_encode(&s[0], in, n);
+    return s;
+}
+
+static invalid_argument badHex(const char *in, size_t len) {
+    return invalid_argument("Invalid hex: '" + string(in, min(len, (size_t) 32)) + (len > 32 ? "...'" : "'"));
+}
+
+void Hex_decodeRight(unsigned char *out, size_t outLen, const char *in, size_t len) {
+    size_t bytes = (len + 1) / 2;
+    if (bytes > outLen) {
+        throw invalid_argument("Hex value of " + to_string(len) + " digits does not fit in " + to_string(outLen) + " bytes");
+    }
+    memset(out, 0, outLen - bytes);
+    unsigned char *p = out + outLen - bytes;
+    const char *digits = in;
+    if (len & 1) {
+        int v = digitTable()[(unsigned char) *digits++];
+        if (v < 0) throw badHex(in, len);
+        *p++ = (unsigned char) v;
+    }
+    if (!Hex_decode(p, digits, len / 2)) throw badHex(in, len);
+}
+
+string Hex_encodeBIG(BIG b) {
+    char bytes[MODBYTES_B384_58];
+    BIG_toBytes(bytes, b);
+    return Hex_encode((const unsigned char *) bytes, sizeof(bytes));
+}
+
+void Hex_decodeBIG(BIG b, const char *in, size_t len) {
+    unsigned char bytes[MODBYTES_B384_58];
+    Hex_decodeRight(bytes, sizeof(bytes), in, len);
+    BIG_fromBytes(b, (char *) bytes);
+}
+
+string Hex_encodeMpz(const mpz_class &a) {
+    if (a == 0) return "0";
+    size_t n = (mpz_sizeinbase(a.get_mpz_t(), 2) + 7) / 8;
+    vector<unsigned char> bytes(n);
+    mpz_export(bytes.data(), nullptr, 1, 1, 0, 0, a.get_mpz_t());
+    string s(2 * n + 1, '-');
+    Hex_encode(&s[1], bytes.data(), n);
+    // get_str(16) has no leading zero digit
+    size_t skip = s[1] == '0' ? 2 : 1;
+    if (a < 0) skip--, s[skip] = '-';
+    return s.substr(skip);
+}
+
+void Hex_decodeMpz(mpz_class &a, const char *in, size_t len) {
+    bool negative = len > 0 && in[0] == '-';
+    const char *digits = in + negative;
+    size_t n = len - negative;
+    if (n == 0) throw badHex(in, len);
+    unsigned char stackBuf[128];
+    vector<unsigned char> heapBuf;
+    size_t bytes = (n + 1) / 2;
+    unsigned char *buf = stackBuf;
+    if (bytes > sizeof(stackBuf)) {
+        heapBuf.resize(bytes);
+        buf = heapBuf.data();
+    }
+    Hex_decodeRight(buf, bytes, digits, n);
+    mpz_import(a.get_mpz_t(), bytes, 1, 1, 0, 0, buf);
+    if (negative) a = -a;
+}
+
+string Hex_encodeOctet(const octet &o) {
+    return Hex_encode((const unsigned char *) o.val, (size_t) o.len);
+}
+
+void Hex_decodeOctet(octet &o, const char *in, size_t len) {
+    if (len & 1) throw badHex(in, len);
+    if (len / 2 > (size_t) o.max) {
+        throw invalid_argument("Octet of " + to_string(o.max) + " bytes is too small for " + to_string(len / 2));
+    }
+    if (!Hex_decode((unsigned char *) o.val, in, len / 2)) throw badHex(in, len);
+    o.len = (int) (len / 2);
+}
+
+string Hex_encodeECP(ECP &P, bool compress) {
+    char buf[2 * MODBYTES_B384_58 + 1];
+    octet W = {0, sizeof(buf), buf};
+    ECP_toOctet(&W, &P, compress);
+    return Hex_encodeOctet(W);
+}
+
+void Hex_decodeECP(ECP &P, const char *in, size_t len) {
+    char buf[2 * MODBYTES_B384_58 + 1];
+    octet W = {0, sizeof(buf), buf};
+    Hex_decodeOctet(W, in, len);
+    if (!ECP_fromOctet(&P, &W)) throw invalid_argument("Hex value is not a G1 point");
+}
+
+string Hex_encodeECP2(ECP2 &P, bool compress) {
+    char buf[4 * MODBYTES_B384_58 + 1];
+    octet W = {0, sizeof(buf), buf};
+    ECP2_toOctet(&W, &P, compress);
+    return Hex_encodeOctet(W);
+}
+
+void Hex_decodeECP2(ECP2 &P, const char *in, size_t len) {
+    char buf[4 * MODBYTES_B384_58 + 1];
+    octet W = {0, sizeof(buf), buf};
+    Hex_decodeOctet(W, in, len);
+    if (!ECP2_fromOctet(&P, &W)) throw invalid_argument("Hex value is not a G2 point");
+}
+
+HexReader::HexReader(const string &path) : file_(path) {
+    data_ = (const char *) file_.data();
+    end_ = data_ + file_.size();
+}
+
+static bool isSpace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+bool HexReader::token(const char *&begin, size_t &len) {
+    while (data_ < end_ && isSpace(*data_)) {
+        if (*data_ == '\n') nextLine_++;
+        data_++;
+    }
+    if (data_ == end_) return false;
+    begin = data_;
+    while (data_ < end_ && !isSpace(*data_)) data_++;
+    len = (size_t) (data_ - begin);
+    line_ = nextLine_;
+    return true;
+}
+
+void HexReader::fail(const invalid_argument &e) const {
+    throw runtime_error("Hex input line " + to_string(line_) + ": " + e.what());
+}
+
+bool HexReader::next(BIG b) {
+    const char *p;
+    size_t len;
+    if (!token(p, len)) return false;
+    try {
+        Hex_decodeBIG(b, p, len);
+    } catch (const invalid_argument &e) {
+        fail(e);
+    }
+    return true;
+}
+
+bool HexReader::next(mpz_class &a) {
+    const char *p;
+    size_t len;
+    if (!token(p, len)) return false;
+    try {
+        Hex_decodeMpz(a, p, len);
+    } catch (const invalid_argument &e) {
+        fail(e);
+    }
+    return true;
+}
+
+bool HexReader::next(ECP &P) {
+    const char *p;
+    size_t len;
+    if (!token(p, len)) return false;
+    try {
+        Hex_decodeECP(P, p, len);
+    } catch (const invalid_argument &e) {
+        fail(e);
+    }
+    return true;
+}
+
+bool HexReader::next(ECP2 &P) {
+    const char *p;
+    size_t len;
+    if (!token(p, len)) return false;
+    try {
+        Hex_decodeECP2(P, p, len);
+    } catch (const invalid_argument &e) {
+        fail(e);
+    }
+    return true;
+}
+
+bool HexReader::next(vector<unsigned char> &bytes) {
+    const char *p;
+    size_t len;
+    if (!token(p, len)) return false;
+    if (len & 1) fail(badHex(p, len));
+    bytes.resize(len / 2);
+    if (!Hex_decode(bytes.data(), p, len / 2)) fail(badHex(p, len));
+    return true;
+}
+
+// Lines are handed to the stream in blocks of about this size
+static const size_t HEX_WRITER_BLOCK = 1 << 20;
+
+HexWriter::~HexWriter() {
+    // errors surface only through an explicit flush()
+    try {
+        flush();
+    } catch (const runtime_error &) {
+    }
+}
+
+void HexWriter::line(const unsigned char *bytes, size_t n) {
+    size_t off = buf_.size();
+    buf_.resize(off + 2 * n + 1);
+    Hex_encode(&buf_[off], bytes, n);
+    buf_[off + 2 * n] = '\n';
+    if (buf_.size() >= HEX_WRITER_BLOCK) flush();
+}
+
+void HexWriter::write(BIG b) {
+    char bytes[MODBYTES_B384_58];
+    BIG_toBytes(bytes, b);
+    line((const unsigned char *) bytes, sizeof(bytes));
+}
+
+void HexWriter::write(const mpz_class &a) {
+    buf_ += Hex_encodeMpz(a);
+    buf_ += '\n';
+    if (buf_.size() >= HEX_WRITER_BLOCK) flush();
+}
+
+void HexWriter::write(ECP &P, bool compress) {
+    char buf[2 * MODBYTES_B384_58 + 1];
+    octet W = {0, sizeof(buf), buf};
+    ECP_toOctet(&W, &P, compress);
+    line((const unsigned char *) W.val, (size_t) W.len);
+}
+
+void HexWriter::write(ECP2 &P, bool compress) {
+    char buf[4 * MODBYTES_B384_58 + 1];
+    octet W = {0, sizeof(buf), buf};
+    ECP2_toOctet(&W, &P, compress);
+    line((const unsigned char *) W.val, (size_t) W.len);
+}
+
+void HexWriter::write(const unsigned char *bytes, size_t n) {
+    line(bytes, n);
+}
+
+void HexWriter::flush() {
+    if (buf_.empty()) return;
+    size_t size = buf_.size();
+    size_t written = fwrite(buf_.data(), 1, size, out_);
+    buf_.clear();
+    if (written != size) {
+        throw runtime_error("HexWriter: write failed");
+    }
+}
@@ -0,0 +1,57 @@
+// Compiled with -mavx2 (see CMakeLists.txt); only called after runtime CPU detection
+#include <immintrin.h>
+#include <cstddef>
+
+/**
+ * out[0 .. 2n) = hex of in[0 .. n), n a multiple of 32
+ */
+void hexEncode_avx2(char *out, const unsigned char *in, size_t n) {
+    const __m256i digits = _mm256_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f',
+                                            '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+    const __m256i low = _mm256_set1_epi8(0x0f);
+    for (size_t i = 0; i < n; i += 32) {
+        __m256i b = _mm256_loadu_si256((const __m256i *) (in + i));
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi16(b, 4), low);
+        __m256i lo = _mm256_and_si256(b, low);
+        // unpack works per 128-bit lane: a = hex of bytes 0-7 | 16-23, c = bytes 8-15 | 24-31
+        __m256i a = _mm256_shuffle_epi8(digits, _mm256_unpacklo_epi8(hi, lo));
+        __m256i c = _mm256_shuffle_epi8(digits, _mm256_unpackhi_epi8(hi, lo));
+        _mm256_storeu_si256((__m256i *) (out + 2 * i), _mm256_permute2x128_si256(a, c, 0x20));
+        _mm256_storeu_si256((__m256i *) (out + 2 * i + 32), _mm256_permute2x128_si256(a, c, 0x31));
+    }
+}
+
+/**
+ * Values of 32 hex digits; sets bad to nonzero bytes where a character is not a digit
+ */
+static inline __m256i hexDigits(__m256i c, __m256i &bad) {
+    __m256i lower = _mm256_or_si256(c, _mm256_set1_epi8(0x20));
+    // signed compares: bytes >= 0x80 are negative and fail both ranges
+    __m256i isDigit = _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('0' - 1)),
+                                       _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), c));
+    __m256i isAlpha = _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+                                       _mm256_cmpgt_epi8(_mm256_set1_epi8('f' + 1), lower));
+    bad = _mm256_or_si256(bad, _mm256_andnot_si256(_mm256_or_si256(isDigit, isAlpha), _mm256_set1_epi8(-1)));
+    __m256i dv = _mm256_sub_epi8(c, _mm256_set1_epi8('0'));
+    __m256i av = _mm256_sub_epi8(lower, _mm256_set1_epi8('a' - 10));
+    return _mm256_blendv_epi8(av, dv, isDigit);
+}
+
+/**
+ * out[0 .. n) = bytes of the hex digits in[0 .. 2n), n a multiple of 32
+ * @return false if a character is not a hex digit
+ */
+bool hexDecode_avx2(unsigned char *out, const char *in, size_t n) {
+    const __m256i weights = _mm256_set1_epi16(0x0110);  // bytes (16, 1): high digit first
+    __m256i bad = _mm256_setzero_si256();
+    for (size_t i = 0; i < n; i += 32) {
+        __m256i c0 = _mm256_loadu_si256((const __m256i *) (in + 2 * i));
+        __m256i c1 = _mm256_loadu_si256((const __m256i *) (in + 2 * i + 32));
+        __m256i w0 = _mm256_maddubs_epi16(hexDigits(c0, bad), weights);
+        __m256i w1 = _mm256_maddubs_epi16(hexDigits(c1, bad), weights);
+        // packus interleaves the 128-bit lanes; permute restores byte order
+        __m256i b = _mm256_permute4x64_epi64(_mm256_packus_epi16(w0, w1), 0xd8);
+        _mm256_storeu_si256((__m256i *) (out + i), b);
+    }
+    return _mm256_testz_si256(bad, bad);
+}
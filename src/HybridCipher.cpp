@@ -0,0 +1,444 @@
+#include "../include/HybridCipher.h"
+#include "AesGcm.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace {
+    const unsigned char MAGIC[4] = {'G', 'T', 'A', 'E'};
+    const unsigned char VERSION = 1;
+    const char *const KDF_LABEL = "miracl-wrapper hybrid v1";
+
+    /**
+     * HMAC-SHA256 on MIRACL's SHA-256
+     */
+    struct Hmac {
+        hash256 inner, outer;
+
+        Hmac(const unsigned char *key, size_t keyLen) {
+            unsigned char block[64] = {0};
+            if (keyLen > 64) {
+                hash256 h;
+                HASH256_init(&h);
+                for (size_t i = 0; i < keyLen; ++i) HASH256_process(&h, key[i]);
+                HASH256_hash(&h, (char *) block);
+            } else {
+                memcpy(block, key, keyLen);
+            }
+            HASH256_init(&inner);
+            HASH256_init(&outer);
+            for (unsigned char b: block) {
+                HASH256_process(&inner, b ^ 0x36);
+                HASH256_process(&outer, b ^ 0x5c);
+            }
+        }
+
+        void update(const unsigned char *p, size_t len) {
+            for (size_t i = 0; i < len; ++i) HASH256_process(&inner, p[i]);
+        }
+
+        void finish(unsigned char mac[32]) {
+            unsigned char digest[32];
+            HASH256_hash(&inner, (char *) digest);
+            for (unsigned char b: digest) HASH256_process(&outer, b);
+            HASH256_hash(&outer, (char *) mac);
+        }
+    };
+
+    bool detectAesni() {
+#ifdef WRAPPER_X86_SIMD
+        return __builtin_cpu_supports("aes") && __builtin_cpu_supports("pclmul");
+#else
+        return false;
+#endif
+    }
+
+    atomic<bool> useAesni{detectAesni()};
+
+    /**
+     * The chunk cipher: AES-256-GCM under the message key, on AES-NI or MIRACL's GCM
+     */
+    class ChunkCipher {
+    public:
+        explicit ChunkCipher(const unsigned char key[32]) : aesni_(useAesni.load()) {
+            memcpy(key_, key, 32);
+#ifdef WRAPPER_X86_SIMD
+            if (aesni_) aesGcmSetKey_aesni(aesniKey_, key);
+#endif
+        }
+
+        /**
+         * Encrypts len bytes at p in place and writes the tag right behind them
+         */
+        void seal(uint64_t index, bool final, unsigned char *p, size_t len) const {
+            unsigned char iv[12];
+            nonce(iv, index, final);
+#ifdef WRAPPER_X86_SIMD
+            if (aesni_) {
+                aesGcmEncrypt_aesni(aesniKey_, iv, p, p, len, p + len);
+                return;
+            }
+#endif
+            gcm g;
+            GCM_init(&g, 32, (char *) key_, 12, (char *) iv);
+            GCM_add_plain(&g, (char *) p, (char *) p, (int) len);
+            GCM_finish(&g, (char *) p + len);
+        }
+
+        /**
+         * Decrypts len bytes at p in place if the tag right behind them matches
+         */
+        bool open(uint64_t index, bool final, unsigned char *p, size_t len) const {
+            unsigned char iv[12], tag[16];
+            nonce(iv, index, final);
+#ifdef WRAPPER_X86_SIMD
+            if (aesni_) {
+                aesGcmDecrypt_aesni(aesniKey_, iv, p, p, len, tag);
+            } else
+#endif
+            {
+                gcm g;
+                GCM_init(&g, 32, (char *) key_, 12, (char *) iv);
+                GCM_add_cipher(&g, (char *) p, (char *) p, (int) len);
+                GCM_finish(&g, (char *) tag);
+            }
+            unsigned char diff = 0;
+            for (int i = 0; i < 16; ++i) diff |= tag[i] ^ p[len + i];
+            return diff == 0;
+        }
+
+    private:
+        /**
+         * BE64(index) || 00 00 00 || final flag
+         */
+        static void nonce(unsigned char iv[12], uint64_t index, bool final) {
+            for (int i = 0; i < 8; ++i) iv[i] = (unsigned char) (index >> (56 - 8 * i));
+            iv[8] = iv[9] = iv[10] = 0;
+            iv[11] = final ? 1 : 0;
+        }
+
+        bool aesni_;
+        unsigned char key_[32];
+#ifdef WRAPPER_X86_SIMD
+        AesGcmAesniKey aesniKey_;
+#endif
+    };
+
+    /**
+     * A batch of chunks, each in a slot of chunkBytes + tag bytes. Decryption takes chunkBytes
+     * from the unauthenticated header, so its buffer starts empty and grows as ciphertext arrives.
+     */
+    struct Stage {
+        vector<unsigned char> buf;
+        vector<size_t> len;                    // plaintext bytes of each chunk
+        vector<char> final, ok;
+        uint64_t first = 0;                    // index of the first chunk in the stream
+        size_t count = 0;
+        size_t slot = 0;
+
+        Stage(size_t batch, size_t chunkBytes, bool grow = false)
+            : buf(grow ? 0 : batch * (chunkBytes + HYBRID_TAG_BYTES)), len(batch), final(batch), ok(batch),
+              slot(chunkBytes + HYBRID_TAG_BYTES) {}
+
+        unsigned char *chunk(size_t i) { return buf.data() + i * slot; }
+    };
+
+    /**
+     * Threads that run one job at a time, fn(0) .. fn(n - 1), while the caller does the I/O;
+     * with a single thread the job runs on the caller
+     */
+    class ChunkWorkers {
+    public:
+        explicit ChunkWorkers(size_t threads) {
+            if (threads > 1) {
+                for (size_t i = 0; i < threads; ++i) threads_.emplace_back(&ChunkWorkers::loop, this);
+            }
+        }
+
+        ~ChunkWorkers() {
+            {
+                unique_lock<mutex> lock(mutex_);
+                done_.wait(lock, [this] { return active_ == 0; });
+                stopping_ = true;
+            }
+            start_.notify_all();
+            for (thread &t: threads_) t.join();
+        }
+
+        void start(size_t n, function<void(size_t)> fn) {
+            if (threads_.empty()) {
+                for (size_t i = 0; i < n; ++i) fn(i);
+                return;
+            }
+            {
+                lock_guard<mutex> lock(mutex_);
+                fn_ = std::move(fn);
+                n_ = n;
+                next_ = 0;
+                active_ = threads_.size();
+                ++generation_;
+            }
+            start_.notify_all();
+        }
+
+        void wait() {
+            unique_lock<mutex> lock(mutex_);
+            done_.wait(lock, [this] { return active_ == 0; });
+        }
+
+    private:
+        void loop() {
+            uint64_t seen = 0;
+            unique_lock<mutex> lock(mutex_);
+            for (;;) {
+                start_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+                if (stopping_) return;
+                seen = generation_;
+                lock.unlock();
+                for (size_t i; (i = next_.fetch_add(1)) < n_;) fn_(i);
+                lock.lock();
+                if (--active_ == 0) done_.notify_all();
+            }
+        }
+
+        vector<thread> threads_;
+        mutex mutex_;
+        condition_variable start_, done_;
+        function<void(size_t)> fn_;
+        size_t n_ = 0, active_ = 0;
+        atomic<size_t> next_{0};
+        uint64_t generation_ = 0;
+        bool stopping_ = false;
+    };
+
+    size_t threadCount(const HybridConfig &config) {
+        return config.threads ? config.threads : max(1u, thread::hardware_concurrency());
+    }
+
+    size_t batchSize(const HybridConfig &config, size_t threads, size_t chunkBytes) {
+        size_t batch = config.batchChunks ? config.batchChunks : 4 * threads;
+        return max<size_t>(1, min(batch, HYBRID_MAX_BATCH_BYTES / (2 * (chunkBytes + HYBRID_TAG_BYTES))));
+    }
+
+    void checkChunkBytes(size_t chunkBytes) {
+        if (chunkBytes == 0 || chunkBytes > HYBRID_MAX_CHUNK_BYTES) {
+            throw invalid_argument("Hybrid chunk size must be in [1, " + to_string(HYBRID_MAX_CHUNK_BYTES) + "]");
+        }
+    }
+
+    void deriveKey(unsigned char key[32], const FP12 &g, const unsigned char header[HYBRID_HEADER_BYTES],
+                   const string &context) {
+        string info = KDF_LABEL;
+        info.append((const char *) header, HYBRID_HEADER_BYTES);
+        info += context;
+        GT_kdf(key, 32, g, header + 12, 32, info);
+    }
+
+    const size_t GROW_STEP = (size_t) 1 << 20;  // first read into a growing Stage slot
+
+    /**
+     * Reads up to len bytes; returns how many arrived
+     */
+    size_t readFully(istream &in, unsigned char *p, size_t len) {
+        in.read((char *) p, (streamsize) len);
+        return (size_t) in.gcount();
+    }
+
+    /**
+     * readFully into slot i of a growing Stage, enlarging the buffer only as far as bytes
+     * actually arrive (at most doubling what has been read so far)
+     */
+    size_t readGrowing(istream &in, Stage &s, size_t i, size_t len) {
+        size_t got = 0;
+        while (got < len) {
+            size_t want = min(len - got, max(got, GROW_STEP));
+            size_t end = i * s.slot + got + want;
+            if (s.buf.size() < end) s.buf.resize(end);
+            size_t n = readFully(in, s.buf.data() + i * s.slot + got, want);
+            got += n;
+            if (n < want) break;
+        }
+        return got;
+    }
+
+    /**
+     * The read / process / write pipeline shared by both directions: fill(stage) reads the next
+     * batch and returns true once the final chunk is in, work(stage, i) processes chunk i and
+     * drain(stage) writes a processed batch. Reading and writing overlap with the processing
+     * of the batch in between.
+     */
+    void runPipeline(Stage *stages, size_t threads, const function<bool(Stage &)> &fill,
+                     const function<void(Stage &, size_t)> &work, const function<void(Stage &)> &drain) {
+        ChunkWorkers workers(threads);
+        auto launch = [&](Stage &s) { workers.start(s.count, [&work, &s](size_t i) { work(s, i); }); };
+        bool lastRead = fill(stages[0]);
+        launch(stages[0]);
+        for (int cur = 0;; cur ^= 1) {
+            bool more = !lastRead;
+            if (more) lastRead = fill(stages[cur ^ 1]);
+            workers.wait();
+            if (more) launch(stages[cur ^ 1]);
+            drain(stages[cur]);
+            if (!more) break;
+        }
+    }
+}
+
+void GT_kdf(unsigned char *out, size_t outLen, const FP12 &g, const unsigned char *salt, size_t saltLen,
+            const string &info) {
+    if (outLen > 255 * 32) throw invalid_argument("GT_kdf: at most " + to_string(255 * 32) + " bytes");
+    // Extract: PRK = HMAC(salt, IKM)
+    Hmac extract(salt, saltLen);
+    const FP4 *fp4[3] = {&g.a, &g.b, &g.c};
+    for (const FP4 *x: fp4) {
+        const FP *coeffs[4] = {&x->a.a, &x->a.b, &x->b.a, &x->b.b};
+        for (const FP *c: coeffs) {
+            FP t = *c;
+            BIG v;
+            unsigned char bytes[MODBYTES_B384_58];
+            FP_redc(v, &t);
+            BIG_toBytes((char *) bytes, v);
+            extract.update(bytes, sizeof(bytes));
+        }
+    }
+    unsigned char prk[32];
+    extract.finish(prk);
+    // Expand: T(i) = HMAC(PRK, T(i - 1) || info || i)
+    unsigned char t[32];
+    for (size_t done = 0, i = 1; done < outLen; done += 32, ++i) {
+        Hmac expand(prk, sizeof(prk));
+        if (i > 1) expand.update(t, sizeof(t));
+        expand.update((const unsigned char *) info.data(), info.size());
+        unsigned char counter = (unsigned char) i;
+        expand.update(&counter, 1);
+        expand.finish(t);
+        memcpy(out + done, t, min<size_t>(32, outLen - done));
+    }
+}
+
+uint64_t Hybrid_encrypt(const FP12 &key, istream &in, ostream &out, csprng &rng, const string &context,
+                        const HybridConfig &config) {
+    checkChunkBytes(config.chunkBytes);
+    unsigned char header[HYBRID_HEADER_BYTES] = {0};
+    memcpy(header, MAGIC, 4);
+    header[4] = VERSION;
+    for (int i = 0; i < 4; ++i) header[8 + i] = (unsigned char) (config.chunkBytes >> (8 * i));
+    for (size_t i = 12; i < HYBRID_HEADER_BYTES; ++i) header[i] = (unsigned char) RAND_byte(&rng);
+    unsigned char messageKey[32];
+    deriveKey(messageKey, key, header, context);
+    ChunkCipher cipher(messageKey);
+
+    out.write((const char *) header, HYBRID_HEADER_BYTES);
+    size_t threads = threadCount(config), chunkBytes = config.chunkBytes, batch = batchSize(config, threads, chunkBytes);
+    Stage stages[2] = {Stage(batch, chunkBytes), Stage(batch, chunkBytes)};
+    uint64_t next = 0, total = 0;
+    auto fill = [&](Stage &s) {
+        s.first = next;
+        s.count = 0;
+        bool final = false;
+        while (s.count < batch && !final) {
+            size_t n = readFully(in, s.chunk(s.count), chunkBytes);
+            if (in.bad()) throw runtime_error("Hybrid_encrypt: read failed");
+            // A full chunk is the last one only if nothing follows it
+            final = n < chunkBytes || in.peek() == char_traits<char>::eof();
+            s.len[s.count] = n;
+            s.final[s.count] = final;
+            total += n;
+            s.count++;
+        }
+        next += s.count;
+        return final;
+    };
+    auto work = [&](Stage &s, size_t i) { cipher.seal(s.first + i, s.final[i], s.chunk(i), s.len[i]); };
+    auto drain = [&](Stage &s) {
+        for (size_t i = 0; i < s.count; ++i) out.write((const char *) s.chunk(i), s.len[i] + HYBRID_TAG_BYTES);
+        if (!out) throw runtime_error("Hybrid_encrypt: write failed");
+    };
+    runPipeline(stages, threads, fill, work, drain);
+    out.flush();
+    if (!out) throw runtime_error("Hybrid_encrypt: write failed");
+    return total;
+}
+
+uint64_t Hybrid_decrypt(const FP12 &key, istream &in, ostream &out, const string &context,
+                        const HybridConfig &config) {
+    unsigned char header[HYBRID_HEADER_BYTES];
+    if (readFully(in, header, HYBRID_HEADER_BYTES) != HYBRID_HEADER_BYTES) {
+        throw runtime_error("Hybrid_decrypt: truncated header");
+    }
+    if (memcmp(header, MAGIC, 4) != 0 || header[4] != VERSION || header[5] || header[6] || header[7]) {
+        throw runtime_error("Hybrid_decrypt: not a hybrid ciphertext (or unsupported version)");
+    }
+    size_t chunkBytes = 0;
+    for (int i = 0; i < 4; ++i) chunkBytes |= (size_t) header[8 + i] << (8 * i);
+    if (chunkBytes == 0 || chunkBytes > HYBRID_MAX_CHUNK_BYTES) {
+        throw runtime_error("Hybrid_decrypt: chunk size " + to_string(chunkBytes) + " out of range");
+    }
+    unsigned char messageKey[32];
+    deriveKey(messageKey, key, header, context);
+    ChunkCipher cipher(messageKey);
+
+    size_t threads = threadCount(config), batch = batchSize(config, threads, chunkBytes);
+    size_t slot = chunkBytes + HYBRID_TAG_BYTES;
+    Stage stages[2] = {Stage(batch, chunkBytes, true), Stage(batch, chunkBytes, true)};
+    uint64_t next = 0, total = 0;
+    auto fill = [&](Stage &s) {
+        s.first = next;
+        s.count = 0;
+        bool final = false;
+        while (s.count < batch && !final) {
+            size_t n = readGrowing(in, s, s.count, slot);
+            if (n < HYBRID_TAG_BYTES) throw runtime_error("Hybrid_decrypt: truncated ciphertext");
+            final = n < slot || in.peek() == char_traits<char>::eof();
+            s.len[s.count] = n - HYBRID_TAG_BYTES;
+            s.final[s.count] = final;
+            s.count++;
+        }
+        next += s.count;
+        return final;
+    };
+    auto work = [&](Stage &s, size_t i) { s.ok[i] = cipher.open(s.first + i, s.final[i], s.chunk(i), s.len[i]); };
+    auto drain = [&](Stage &s) {
+        for (size_t i = 0; i < s.count; ++i) {
+            if (!s.ok[i]) {
+                throw runtime_error("Hybrid_decrypt: chunk " + to_string(s.first + i) + " failed to authenticate");
+            }
+            out.write((const char *) s.chunk(i), s.len[i]);
+            total += s.len[i];
+        }
+        if (!out) throw runtime_error("Hybrid_decrypt: write failed");
+    };
+    runPipeline(stages, threads, fill, work, drain);
+    out.flush();
+    if (!out) throw runtime_error("Hybrid_decrypt: write failed");
+    return total;
+}
+
+vector<unsigned char> Hybrid_encrypt(const FP12 &key, const vector<unsigned char> &plain, csprng &rng,
+                                     const string &context, const HybridConfig &config) {
+    istringstream in(string(plain.begin(), plain.end()));
+    ostringstream out;
+    Hybrid_encrypt(key, in, out, rng, context, config);
+    string s = out.str();
+    return vector<unsigned char>(s.begin(), s.end());
+}
+
+vector<unsigned char> Hybrid_decrypt(const FP12 &key, const vector<unsigned char> &cipher, const string &context,
+                                     const HybridConfig &config) {
+    istringstream in(string(cipher.begin(), cipher.end()));
+    ostringstream out;
+    Hybrid_decrypt(key, in, out, context, config);
+    string s = out.str();
+    return vector<unsigned char>(s.begin(), s.end());
+}
+
+bool Hybrid_aesni() {
+    return useAesni.load();
+}
+
+bool Hybrid_setAesni(bool enable) {
+    useAesni = enable && detectAesni();
+    return useAesni.load();
+}
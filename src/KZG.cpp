@@ -0,0 +1,179 @@
+#include "../include/KZG.h"
+#include "../include/MSM.h"
+#include "../include/FpBatch.h"
+
+static const char KZG_SRS_MAGIC[8] = {'K', 'Z', 'G', 'S', 'R', 'S', 0, 0};
+
+static size_t alignUp(size_t v) {
+    return (v + 63) & ~(size_t) 63;
+}
+
+static mpz_class modq(const mpz_class &a) {
+    const mpz_class &q = getCurveOrder();
+    mpz_class r = a % q;
+    if (r < 0) r += q;
+    return r;
+}
+
+mpz_class rootOfUnity(size_t n) {
+    // q - 1 = 2^32 * t with t odd, and 7 generates Fq^*
+    assert(n > 0 && (n & (n - 1)) == 0 && n <= (1ULL << 32));
+    const mpz_class &q = getCurveOrder();
+    return pow_mpz(7, (q - 1) / mpz_class((unsigned long) n), q);
+}
+
+void KZG_generateSRS(const string &path, size_t powers, size_t lagrangeSize, const mpz_class &tau) {
+    assert(powers > 0);
+    assert(lagrangeSize == 0 || (lagrangeSize & (lagrangeSize - 1)) == 0);
+    const mpz_class &q = getCurveOrder();
+
+    KZGSrsHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, KZG_SRS_MAGIC, sizeof(h.magic));
+    h.version = KZG_SRS_VERSION;
+    h.g1Size = sizeof(ECP);
+    h.g2Size = sizeof(ECP2);
+    h.powers = powers;
+    h.lagrangeSize = lagrangeSize;
+    h.g1Offset = alignUp(sizeof(KZGSrsHeader));
+    h.lagrangeOffset = alignUp(h.g1Offset + powers * sizeof(ECP));
+    h.g2Offset = alignUp(h.lagrangeOffset + lagrangeSize * sizeof(ECP));
+    vector<unsigned char> buf(h.g2Offset + 2 * sizeof(ECP2), 0);
+    memcpy(buf.data(), &h, sizeof(h));
+
+    ECP *g1 = (ECP *) (buf.data() + h.g1Offset);
+    mpz_class t = modq(tau), power = 1;
+    for (size_t i = 0; i < powers; ++i) {
+        ECP_generator(&g1[i]);
+        ECP_mul(g1[i], power);
+        power = power * t % q;
+    }
+    ECP_batchAffine(g1, powers);
+
+    if (lagrangeSize > 0) {
+        // L_i(tau) = omega^i / n * (tau^n - 1) / (tau - omega^i)
+        ECP *lag = (ECP *) (buf.data() + h.lagrangeOffset);
+        mpz_class n((unsigned long) lagrangeSize);
+        mpz_class omega = rootOfUnity(lagrangeSize), omegaI = 1;
+        mpz_class scale = modq((pow_mpz(t, n, q) - 1) * invert_mpz(n, q));
+        for (size_t i = 0; i < lagrangeSize; ++i) {
+            mpz_class li = modq(scale * omegaI * invert_mpz(modq(t - omegaI), q));
+            ECP_generator(&lag[i]);
+            ECP_mul(lag[i], li);
+            omegaI = omegaI * omega % q;
+        }
+        ECP_batchAffine(lag, lagrangeSize);
+    }
+
+    ECP2 *g2 = (ECP2 *) (buf.data() + h.g2Offset);
+    ECP2_generator(&g2[0]);
+    ECP2_generator(&g2[1]);
+    ECP2_mul(g2[1], t);
+    ECP2_affine(&g2[1]);
+
+    writeFileAtomic(path, buf.data(), buf.size());
+}
+
+KZG::KZG(const string &srsPath) : file_(srsPath) {
+    if (file_.size() < sizeof(KZGSrsHeader)) {
+        throw runtime_error("KZG SRS file is truncated: " + srsPath);
+    }
+    header_ = (const KZGSrsHeader *) file_.data();
+    if (memcmp(header_->magic, KZG_SRS_MAGIC, sizeof(KZG_SRS_MAGIC)) != 0 || header_->version != KZG_SRS_VERSION) {
+        throw runtime_error("Not a KZG SRS file (or unsupported version): " + srsPath);
+    }
+    if (header_->g1Size != sizeof(ECP) || header_->g2Size != sizeof(ECP2)) {
+        throw runtime_error("KZG SRS file was written with a different point layout: " + srsPath);
+    }
+    if (header_->powers == 0 ||
+        header_->g1Offset + header_->powers * sizeof(ECP) > file_.size() ||
+        header_->lagrangeOffset + header_->lagrangeSize * sizeof(ECP) > file_.size() ||
+        header_->g2Offset + 2 * sizeof(ECP2) > file_.size()) {
+        throw runtime_error("KZG SRS file is truncated: " + srsPath);
+    }
+    g1_ = (const ECP *) (file_.data() + header_->g1Offset);
+    lagrange_ = header_->lagrangeSize ? (const ECP *) (file_.data() + header_->lagrangeOffset) : nullptr;
+    g2_ = (const ECP2 *) (file_.data() + header_->g2Offset);
+}
+
+ECP KZG::commit(const vector<mpz_class> &coeffs) const {
+    if (coeffs.size() > header_->powers) {
+        throw runtime_error("Polynomial degree exceeds the KZG SRS size");
+    }
+    return ECP_msm(g1_, coeffs);
+}
+
+ECP KZG::commitLagrange(const vector<mpz_class> &evals) const {
+    if (lagrange_ == nullptr || evals.size() > header_->lagrangeSize) {
+        throw runtime_error("Evaluation vector exceeds the KZG Lagrange basis");
+    }
+    return ECP_msm(lagrange_, evals);
+}
+
+KZGOpening KZG::open(const vector<mpz_class> &coeffs, const mpz_class &z, const ECP &commitment) const {
+    const mpz_class &q = getCurveOrder();
+    KZGOpening o;
+    o.commitment = commitment;
+    o.z = modq(z);
+
+    // Synthetic division by (X - z): the Horner partial sums are the quotient coefficients
+    size_t n = coeffs.size();
+    vector<mpz_class> quotient(n > 1 ? n - 1 : 0);
+    mpz_class acc = 0;
+    for (size_t k = n; k-- > 0;) {
+        acc = (acc * o.z + coeffs[k]) % q;
+        if (k > 0) quotient[k - 1] = acc;
+    }
+    o.y = modq(acc);
+    o.proof = commit(quotient);
+    return o;
+}
+
+bool KZG::verify(const KZGOpening &opening) const {
+    // e(C - y*G + z*pi, [1]_2) * e(-pi, [tau]_2) == 1
+    const mpz_class &q = getCurveOrder();
+    ECP G;
+    ECP_generator(&G);
+    vector<ECP> points = {opening.commitment, G, opening.proof};
+    vector<mpz_class> scalars = {1, q - modq(opening.y), opening.z};
+    ECP lhs = ECP_msm(points, scalars);
+    ECP negProof = opening.proof;
+    ECP_neg(&negProof);
+    return pairingProductIsOne({lhs, negProof}, {g2_[0], g2_[1]});
+}
+
+bool KZG::batchVerify(const vector<KZGOpening> &openings, csprng &rng) const {
+    // sum r_i (C_i - y_i*G + z_i*pi_i) paired with [1]_2, sum r_i pi_i paired with [tau]_2
+    const mpz_class &q = getCurveOrder();
+    size_t m = openings.size();
+    if (m == 0) return true;
+    BIG order;
+    BIG_rcopy(order, CURVE_Order);
+
+    vector<ECP> points, proofs;
+    vector<mpz_class> scalars, weights;
+    points.reserve(2 * m + 1);
+    scalars.reserve(2 * m + 1);
+    mpz_class ySum = 0;
+    for (const KZGOpening &o: openings) {
+        BIG r;
+        BIG_randtrunc(r, order, 128, &rng);
+        mpz_class rm = BIG_to_mpz(r);
+        points.push_back(o.commitment);
+        scalars.push_back(rm);
+        points.push_back(o.proof);
+        scalars.push_back(rm * o.z % q);
+        proofs.push_back(o.proof);
+        weights.push_back(rm);
+        ySum = (ySum + rm * o.y) % q;
+    }
+    ECP G;
+    ECP_generator(&G);
+    points.push_back(G);
+    scalars.push_back(q - modq(ySum));
+
+    ECP lhs = ECP_msm(points, scalars);
+    ECP rhs = ECP_msm(proofs, weights);
+    ECP_neg(&rhs);
+    return pairingProductIsOne({lhs, rhs}, {g2_[0], g2_[1]});
+}
@@ -0,0 +1,204 @@
+#include "../include/MSM.h"
+#include "../include/GroupTraits.h"
+#include "../include/Tuning.h"
+#include "Scalar.h"
+#include <algorithm>
+
+int msmDefaultWindowBits(size_t n) {
+    if (n < 4) return 2;
+    int lg = 63 - __builtin_clzll((unsigned long long) n);
+    int lglg = 31 - __builtin_clz((unsigned) lg);
+    int c = lg - lglg + 1;
+    if (c < 3) c = 3;
+    if (c > 16) c = 16;
+    return c;
+}
+
+int msmWindowBits(size_t n) {
+    int cls = n < 2 ? 0 : 63 - __builtin_clzll((unsigned long long) n);
+    return Tuning_active().msmWindow[min(cls, TUNING_MSM_CLASSES - 1)];
+}
+
+/**
+ * Pippenger bucket method: for every c-bit window (most significant first) the points are
+ * dropped into 2^c - 1 buckets by digit, and the buckets are folded with a running sum so
+ * that bucket d contributes exactly d times. Windows are joined with c doublings.
+ */
+template<typename Point>
+static Point msm(const Point *points, const ScalarWords *scalars, size_t n) {
+    typedef GroupTraits<Point> G;
+    Point res;
+    G::inf(res);
+
+    int maxBits = 0;
+    for (size_t i = 0; i < n; ++i) {
+        maxBits = max(maxBits, scalars[i].bits());
+    }
+    if (maxBits == 0) return res;
+
+    int c = msmWindowBits(n);
+    int windows = (maxBits + c - 1) / c;
+    size_t bucketCount = ((size_t) 1 << c) - 1;
+    vector<Point> buckets(bucketCount);
+    vector<char> used(bucketCount);
+
+    for (int j = windows - 1; j >= 0; --j) {
+        if (j != windows - 1) {
+            for (int k = 0; k < c; ++k) G::dbl(res);
+        }
+        fill(used.begin(), used.end(), 0);
+        for (size_t i = 0; i < n; ++i) {
+            uint32_t d = scalars[i].window(j * c, c);
+            if (d == 0) continue;
+            if (used[d - 1]) {
+                G::add(buckets[d - 1], points[i]);
+            } else {
+                G::copy(buckets[d - 1], points[i]);
+                used[d - 1] = 1;
+            }
+        }
+        Point sum, acc;
+        G::inf(sum);
+        G::inf(acc);
+        bool started = false;
+        for (size_t b = bucketCount; b-- > 0;) {
+            if (used[b]) {
+                G::add(sum, buckets[b]);
+                started = true;
+            }
+            if (started) G::add(acc, sum);
+        }
+        G::add(res, acc);
+    }
+    return res;
+}
+
+/**
+ * Straus' method: every term gets a table of odd multiples and a wNAF recoding of its scalar
+ * (reduced to the representative of least magnitude), and all terms share one doubling chain.
+ * The cost is about max-bits doublings plus one addition per nonzero digit, so short scalars
+ * are proportionally cheaper.
+ */
+template<typename Point>
+static Point straus(const Point *points, const mpz_class *scalars, size_t n) {
+    typedef GroupTraits<Point> G;
+    const mpz_class &q = getCurveOrder();
+    vector<mpz_class> k(n);
+    size_t maxBits = 0;
+    for (size_t i = 0; i < n; ++i) {
+        k[i] = scalarCentered(scalars[i], q);
+        maxBits = max(maxBits, mpz_sizeinbase(k[i].get_mpz_t(), 2));
+    }
+    // short scalars have few nonzero digits: a 4-entry table is enough
+    int w = maxBits <= 80 ? 4 : 5;
+    size_t tableSize = (size_t) 1 << (w - 2);
+    vector<vector<int8_t>> digits(n);
+    vector<Point> table(n * tableSize);
+    size_t len = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (G::isInf(points[i])) continue;
+        scalarWnaf(digits[i], k[i], w);
+        if (digits[i].empty()) continue;
+        Point *t = &table[i * tableSize], twice;
+        G::copy(t[0], points[i]);
+        G::copy(twice, points[i]);
+        G::dbl(twice);
+        for (size_t j = 1; j < tableSize; ++j) {
+            G::copy(t[j], t[j - 1]);
+            G::add(t[j], twice);
+        }
+        len = max(len, digits[i].size());
+    }
+    Point res;
+    G::inf(res);
+    for (size_t b = len; b-- > 0;) {
+        G::dbl(res);
+        for (size_t i = 0; i < n; ++i) {
+            int d = b < digits[i].size() ? digits[i][b] : 0;
+            if (d > 0) G::add(res, table[i * tableSize + (d - 1) / 2]);
+            if (d < 0) G::sub(res, table[i * tableSize + (-d - 1) / 2]);
+        }
+    }
+    return res;
+}
+
+template<typename Point>
+static Point msmBIG(const Point *points, BIG *scalars, size_t n) {
+    if (n <= Tuning_active().strausMaxTerms) {
+        vector<mpz_class> k(n);
+        for (size_t i = 0; i < n; ++i) k[i] = BIG_to_mpz(scalars[i]);
+        return straus(points, k.data(), n);
+    }
+    vector<ScalarWords> s(n);
+    for (size_t i = 0; i < n; ++i) {
+        scalarFromBIG(s[i], scalars[i]);
+    }
+    return msm(points, s.data(), n);
+}
+
+template<typename Point>
+static Point msmMpz(const Point *points, const vector<mpz_class> &scalars) {
+    if (scalars.size() <= Tuning_active().strausMaxTerms) return straus(points, scalars.data(), scalars.size());
+    const mpz_class &q = getCurveOrder();
+    vector<ScalarWords> s(scalars.size());
+    for (size_t i = 0; i < scalars.size(); ++i) {
+        scalarFromMpz(s[i], scalars[i], &q);
+    }
+    return msm(points, s.data(), scalars.size());
+}
+
+ECP ECP_msm(const ECP *points, BIG *scalars, size_t n) {
+    return msmBIG(points, scalars, n);
+}
+
+ECP ECP_msm(const vector<ECP> &points, const vector<mpz_class> &scalars) {
+    assert(points.size() == scalars.size());
+    return msmMpz(points.data(), scalars);
+}
+
+ECP ECP_msm(const ECP *points, const vector<mpz_class> &scalars) {
+    return msmMpz(points, scalars);
+}
+
+ECP2 ECP2_msm(const ECP2 *points, BIG *scalars, size_t n) {
+    return msmBIG(points, scalars, n);
+}
+
+ECP2 ECP2_msm(const vector<ECP2> &points, const vector<mpz_class> &scalars) {
+    assert(points.size() == scalars.size());
+    return msmMpz(points.data(), scalars);
+}
+
+ECP2 ECP2_msm(const ECP2 *points, const vector<mpz_class> &scalars) {
+    return msmMpz(points, scalars);
+}
+
+ECP ECP_msm(const G1Batch &points, const vector<mpz_class> &scalars) {
+    assert(points.size() == scalars.size());
+    return msmMpz(points.data(), scalars);
+}
+
+ECP2 ECP2_msm(const G2Batch &points, const vector<mpz_class> &scalars) {
+    assert(points.size() == scalars.size());
+    return msmMpz(points.data(), scalars);
+}
+
+ECP ECP_mulShort(const ECP &P, const mpz_class &k) {
+    return straus(&P, &k, 1);
+}
+
+ECP2 ECP2_mulShort(const ECP2 &P, const mpz_class &k) {
+    return straus(&P, &k, 1);
+}
+
+ECP ECP_mul2(const ECP &P, const mpz_class &a, const ECP &Q, const mpz_class &b) {
+    ECP points[2] = {P, Q};
+    mpz_class scalars[2] = {a, b};
+    return straus(points, scalars, 2);
+}
+
+ECP2 ECP2_mul2(const ECP2 &P, const mpz_class &a, const ECP2 &Q, const mpz_class &b) {
+    ECP2 points[2] = {P, Q};
+    mpz_class scalars[2] = {a, b};
+    return straus(points, scalars, 2);
+}
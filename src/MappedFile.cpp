@@ -0,0 +1,67 @@
+#include "../include/MappedFile.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const string &path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw runtime_error("Cannot open " + path);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        throw runtime_error("Cannot map empty or unreadable file " + path);
+    }
+    void *p = mmap(nullptr, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        throw runtime_error("mmap failed for " + path);
+    }
+    data_ = (const unsigned char *) p;
+    size_ = (size_t) st.st_size;
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept: data_(other.data_), size_(other.size_) {
+    other.data_ = nullptr;
+    other.size_ = 0;
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+    if (this != &other) {
+        close();
+        data_ = other.data_;
+        size_ = other.size_;
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+void MappedFile::close() {
+    if (data_ != nullptr) {
+        munmap((void *) data_, size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
+
+void writeFileAtomic(const string &path, const void *data, size_t len) {
+    string tmp = path + ".tmp." + to_string(getpid());
+    FILE *f = fopen(tmp.c_str(), "wb");
+    if (f == nullptr) {
+        throw runtime_error("Cannot create " + tmp);
+    }
+    bool ok = fwrite(data, 1, len, f) == len;
+    ok = (fflush(f) == 0) && ok;
+    ok = (fclose(f) == 0) && ok;
+    if (!ok || rename(tmp.c_str(), path.c_str()) != 0) {
+        remove(tmp.c_str());
+        throw runtime_error("Cannot write " + path);
+    }
+}
@@ -0,0 +1,264 @@
+#include "ModInv.h"
+
+namespace {
+    typedef __int128 i128;
+
+    const uint64_t M62 = UINT64_MAX >> 2;
+
+    /**
+     * Transition matrix of 62 divsteps, scaled by 2^62:
+     * 2^62 * (f', g') = (u * f + v * g, q * f + r * g)
+     */
+    struct Trans {
+        int64_t u, v, q, r;
+    };
+
+    template<int N>
+    void toS62(int64_t s[N], const uint64_t w[MODINV_WORDS]) {
+        for (int i = 0; i < N; ++i) {
+            int bit = 62 * i, idx = bit >> 6, off = bit & 63;
+            uint64_t v = idx < (int) MODINV_WORDS ? w[idx] >> off : 0;
+            if (off > 2 && idx + 1 < (int) MODINV_WORDS) v |= w[idx + 1] << (64 - off);
+            s[i] = (int64_t) (v & M62);
+        }
+    }
+
+    /**
+     * Inverse of toS62 for a normalized value (all limbs in [0, 2^62))
+     */
+    template<int N>
+    void fromS62(uint64_t w[MODINV_WORDS], const int64_t s[N]) {
+        for (size_t j = 0; j < MODINV_WORDS; ++j) w[j] = 0;
+        for (int i = 0; i < N; ++i) {
+            int bit = 62 * i, idx = bit >> 6, off = bit & 63;
+            uint64_t v = (uint64_t) s[i];
+            if (idx < (int) MODINV_WORDS) w[idx] |= v << off;
+            if (off > 2 && idx + 1 < (int) MODINV_WORDS) w[idx + 1] |= v >> (64 - off);
+        }
+    }
+
+    /**
+     * 62 branch-free divsteps on the low words of f and g; returns the new delta
+     */
+    int64_t divsteps(int64_t delta, uint64_t f, uint64_t g, Trans &t) {
+        uint64_t u = 1, v = 0, q = 0, r = 1;
+        for (int i = 0; i < 62; ++i) {
+            uint64_t c1 = (uint64_t) ((-delta) >> 63);  // delta > 0
+            uint64_t c2 = (uint64_t) 0 - (g & 1);      // g odd
+            uint64_t x = (f ^ c1) - c1, y = (u ^ c1) - c1, z = (v ^ c1) - c1;
+            g += x & c2;
+            q += y & c2;
+            r += z & c2;
+            c1 &= c2;                                  // swap f and g
+            delta = ((delta ^ (int64_t) c1) - (int64_t) c1) + 1;
+            f += g & c1;
+            u += q & c1;
+            v += r & c1;
+            g >>= 1;
+            u <<= 1;
+            v <<= 1;
+        }
+        t = {(int64_t) u, (int64_t) v, (int64_t) q, (int64_t) r};
+        return delta;
+    }
+
+    /**
+     * The same 62 divsteps, skipping runs of zero bits and cancelling several bits of g at once;
+     * works on eta = -delta
+     */
+    int64_t divstepsVar(int64_t eta, uint64_t f, uint64_t g, Trans &t) {
+        uint64_t u = 1, v = 0, q = 0, r = 1;
+        int i = 62;
+        for (;;) {
+            int zeros = __builtin_ctzll(g | (UINT64_MAX << i));
+            g >>= zeros;
+            u <<= zeros;
+            v <<= zeros;
+            eta -= zeros;
+            i -= zeros;
+            if (i == 0) break;
+            // f and g are odd
+            uint64_t m, w;
+            int limit;
+            if (eta < 0) {
+                uint64_t tmp;
+                eta = -eta;
+                tmp = f, f = g, g = (uint64_t) 0 - tmp;
+                tmp = u, u = q, q = (uint64_t) 0 - tmp;
+                tmp = v, v = r, r = (uint64_t) 0 - tmp;
+                // cancel up to 6 bits of g, no more than i and no more than eta + 1
+                limit = (int) eta + 1 > i ? i : (int) eta + 1;
+                m = (UINT64_MAX >> (64 - limit)) & 63U;
+                w = (f * g * (f * f - 2)) & m;
+            } else {
+                limit = (int) eta + 1 > i ? i : (int) eta + 1;
+                m = (UINT64_MAX >> (64 - limit)) & 15U;
+                w = f + (((f + 1) & 4) << 1);
+                w = ((uint64_t) 0 - w * g) & m;
+            }
+            g += f * w;
+            q += u * w;
+            r += v * w;
+        }
+        t = {(int64_t) u, (int64_t) v, (int64_t) q, (int64_t) r};
+        return eta;
+    }
+
+    /**
+     * (f, g) = t * (f, g) / 2^62, exact
+     */
+    template<int N>
+    void updateFG(int64_t f[N], int64_t g[N], const Trans &t) {
+        i128 cf = (i128) t.u * f[0] + (i128) t.v * g[0];
+        i128 cg = (i128) t.q * f[0] + (i128) t.r * g[0];
+        cf >>= 62;
+        cg >>= 62;
+        for (int i = 1; i < N; ++i) {
+            cf += (i128) t.u * f[i] + (i128) t.v * g[i];
+            cg += (i128) t.q * f[i] + (i128) t.r * g[i];
+            f[i - 1] = (int64_t) ((uint64_t) cf & M62);
+            g[i - 1] = (int64_t) ((uint64_t) cg & M62);
+            cf >>= 62;
+            cg >>= 62;
+        }
+        f[N - 1] = (int64_t) cf;
+        g[N - 1] = (int64_t) cg;
+    }
+
+    /**
+     * (d, e) = t * (d, e) / 2^62 mod m, keeping both in (-2m, m)
+     */
+    template<int N>
+    void updateDE(int64_t d[N], int64_t e[N], const Trans &t, const ModInvModulus &M) {
+        int64_t sd = d[N - 1] >> 63, se = e[N - 1] >> 63;
+        // add m to negative inputs, then the multiple of m that clears the low 62 bits
+        int64_t md = (t.u & sd) + (t.v & se);
+        int64_t me = (t.q & sd) + (t.r & se);
+        i128 cd = (i128) t.u * d[0] + (i128) t.v * e[0];
+        i128 ce = (i128) t.q * d[0] + (i128) t.r * e[0];
+        md -= (int64_t) ((M.inv62 * (uint64_t) cd + (uint64_t) md) & M62);
+        me -= (int64_t) ((M.inv62 * (uint64_t) ce + (uint64_t) me) & M62);
+        cd += (i128) M.m[0] * md;
+        ce += (i128) M.m[0] * me;
+        cd >>= 62;
+        ce >>= 62;
+        for (int i = 1; i < N; ++i) {
+            cd += (i128) t.u * d[i] + (i128) t.v * e[i] + (i128) M.m[i] * md;
+            ce += (i128) t.q * d[i] + (i128) t.r * e[i] + (i128) M.m[i] * me;
+            d[i - 1] = (int64_t) ((uint64_t) cd & M62);
+            e[i - 1] = (int64_t) ((uint64_t) ce & M62);
+            cd >>= 62;
+            ce >>= 62;
+        }
+        d[N - 1] = (int64_t) cd;
+        e[N - 1] = (int64_t) ce;
+    }
+
+    /**
+     * Propagates carries so that limbs 0 .. N-2 are in [0, 2^62) and the sign is in the top limb
+     */
+    template<int N>
+    void carry(int64_t a[N]) {
+        for (int i = 0; i < N - 1; ++i) {
+            a[i + 1] += a[i] >> 62;
+            a[i] &= (int64_t) M62;
+        }
+    }
+
+    /**
+     * a += m if mask is all ones
+     */
+    template<int N>
+    void addMasked(int64_t a[N], const int64_t m[N], int64_t mask) {
+        for (int i = 0; i < N; ++i) a[i] += m[i] & mask;
+        carry<N>(a);
+    }
+
+    /**
+     * Brings d from (-2m, m) to [0, m), negating it first if sign is all ones
+     */
+    template<int N>
+    void normalize(int64_t d[N], int64_t sign, const ModInvModulus &M) {
+        addMasked<N>(d, M.m, d[N - 1] >> 63);
+        for (int i = 0; i < N; ++i) d[i] = (d[i] ^ sign) - sign;
+        carry<N>(d);
+        addMasked<N>(d, M.m, d[N - 1] >> 63);
+    }
+
+    template<int N>
+    bool isZero(const int64_t a[N]) {
+        int64_t z = 0;
+        for (int i = 0; i < N; ++i) z |= a[i];
+        return z == 0;
+    }
+
+    /**
+     * f == 1 or f == -1
+     */
+    template<int N>
+    bool isUnit(const int64_t f[N]) {
+        bool one = f[0] == 1, minusOne = f[0] == (int64_t) M62;
+        for (int i = 1; i < N - 1; ++i) {
+            one = one && f[i] == 0;
+            minusOne = minusOne && f[i] == (int64_t) M62;
+        }
+        return (one && f[N - 1] == 0) || (minusOne && f[N - 1] == -1);
+    }
+
+
+    template<int N>
+    bool modinvLimbs(uint64_t r[MODINV_WORDS], const uint64_t a[MODINV_WORDS], const ModInvModulus &M,
+                     bool constantTime) {
+        int64_t d[N] = {0}, e[N] = {1}, f[N], g[N];
+        for (int i = 0; i < N; ++i) f[i] = M.m[i];
+        toS62<N>(g, a);
+        Trans t;
+        if (constantTime) {
+            int64_t delta = 1;
+            for (int i = 0; i < M.rounds; ++i) {
+                delta = divsteps(delta, (uint64_t) f[0], (uint64_t) g[0], t);
+                updateFG<N>(f, g, t);
+                updateDE<N>(d, e, t, M);
+            }
+        } else {
+            int64_t eta = -1;
+            while (!isZero<N>(g)) {
+                eta = divstepsVar(eta, (uint64_t) f[0], (uint64_t) g[0], t);
+                updateFG<N>(f, g, t);
+                updateDE<N>(d, e, t, M);
+            }
+        }
+        // f = gcd(a, m) up to sign and d * a = f (mod m)
+        bool ok = isUnit<N>(f);
+        normalize<N>(d, f[N - 1] >> 63, M);
+        fromS62<N>(r, d);
+        if (!ok) {
+            for (size_t i = 0; i < MODINV_WORDS; ++i) r[i] = 0;
+        }
+        return ok;
+    }
+}
+
+void modinvSetup(ModInvModulus &M, const uint64_t m[MODINV_WORDS]) {
+    toS62<7>(M.m, m);
+    // Newton iteration doubles the correct low bits: 3 -> 6 -> ... -> 96
+    uint64_t inv = m[0];
+    for (int i = 0; i < 5; ++i) inv *= 2 - m[0] * inv;
+    M.inv62 = inv & M62;
+    int bits = 0;
+    for (int i = (int) MODINV_WORDS - 1; i >= 0; --i) {
+        if (m[i]) {
+            bits = 64 * i + 64 - __builtin_clzll(m[i]);
+            break;
+        }
+    }
+    // d and e stay in (-2m, m): five limbs cover moduli up to 308 bits
+    M.limbs = bits <= 5 * 62 - 2 ? 5 : 7;
+    // Bernstein-Yang bound on the divsteps needed for d-bit inputs
+    int steps = bits < 46 ? (49 * bits + 80) / 17 : (49 * bits + 57) / 17;
+    M.rounds = (steps + 61) / 62;
+}
+
+bool modinv(uint64_t r[MODINV_WORDS], const uint64_t a[MODINV_WORDS], const ModInvModulus &M, bool constantTime) {
+    return M.limbs == 5 ? modinvLimbs<5>(r, a, M, constantTime) : modinvLimbs<7>(r, a, M, constantTime);
+}
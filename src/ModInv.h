@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Modular inversion by Bernstein-Yang divsteps ("safegcd") for odd moduli up to 384 bits.
+ *
+ * Values are held in five (moduli up to 308 bits) or seven signed 62-bit limbs. Each round
+ * runs 62 divsteps on the low word of f and g only, collecting them into a 2x2 matrix. It then
+ * applies the matrix to the full numbers with a few 64x64->128 multiplies. There is no division and no heap allocation.
+ * The variable-time path stops as soon as g reaches zero. The constant-time path always runs
+ * the worst-case number of rounds for the modulus width, with branch-free divsteps.
+ */
+const size_t MODINV_WORDS = 6;   // 64-bit words of a modulus / operand
+
+struct ModInvModulus {
+    int64_t m[7];                // modulus in signed 62-bit limbs
+    int limbs;                   // limbs in use (5 or 7)
+    uint64_t inv62;              // m^-1 mod 2^62
+    int rounds;                  // 62-divstep rounds that always suffice (constant-time path)
+};
+
+/**
+ * Prepares an odd modulus given as MODINV_WORDS little-endian words
+ */
+void modinvSetup(ModInvModulus &M, const uint64_t m[MODINV_WORDS]);
+
+/**
+ * r = a^-1 mod m for 0 <= a < m
+ * @return false (and r = 0) if a is not invertible
+ */
+bool modinv(uint64_t r[MODINV_WORDS], const uint64_t a[MODINV_WORDS], const ModInvModulus &M, bool constantTime);
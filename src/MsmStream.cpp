@@ -0,0 +1,252 @@
+#include "../include/MsmStream.h"
+#include "../include/MappedFile.h"
+#include "Scalar.h"
+#include <memory>
+#include <thread>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    const size_t SCALAR_BYTES = 32;           // scalars of MsmStream_files, big-endian
+    const size_t MIN_PARALLEL_TERMS = 256;    // smaller chunks are added on the calling thread
+
+    /**
+     * madvise on bytes [from, to) of a mapping; the range is widened to whole pages, or
+     * narrowed at the end when `shrink` (so that a release never reaches unread data)
+     */
+    void advise(const unsigned char *base, size_t from, size_t to, int advice, bool shrink) {
+        auto page = (uintptr_t) sysconf(_SC_PAGESIZE);
+        uintptr_t start = ((uintptr_t) base + from) & ~(page - 1), end = (uintptr_t) base + to;
+        if (shrink) end &= ~(page - 1);
+        if (end > start) madvise((void *) start, end - start, advice);
+    }
+
+    template<typename Point>
+    MsmChunkSource<Point> fileSource(shared_ptr<MappedFile> points, shared_ptr<MappedFile> scalars, size_t elem,
+                                     size_t total) {
+        typedef GroupTraits<Point> G;
+        size_t next = 0;
+        return [points, scalars, elem, total, next](Point *P, BIG *s, size_t max) mutable {
+            size_t n = min(max, total - next);
+            // read ahead the chunk after this one
+            advise(points->data(), (next + n) * elem, min(total, next + 2 * n) * elem, MADV_WILLNEED, false);
+            advise(scalars->data(), (next + n) * SCALAR_BYTES, min(total, next + 2 * n) * SCALAR_BYTES,
+                   MADV_WILLNEED, false);
+            for (size_t i = 0; i < n; ++i) {
+                octet W = {(int) elem, (int) elem, (char *) points->data() + (next + i) * elem};
+                if (!G::fromOctet(P[i], W)) {
+                    throw invalid_argument("MsmStream_files: point " + to_string(next + i) + " does not decode");
+                }
+                char b[MODBYTES_B384_58] = {0};
+                memcpy(b + MODBYTES_B384_58 - SCALAR_BYTES, scalars->data() + (next + i) * SCALAR_BYTES, SCALAR_BYTES);
+                BIG_fromBytes(s[i], b);
+            }
+            // the pages of this chunk are not needed again (those before it are released already)
+            advise(points->data(), next * elem, (next + n) * elem, MADV_DONTNEED, true);
+            advise(scalars->data(), next * SCALAR_BYTES, (next + n) * SCALAR_BYTES, MADV_DONTNEED, true);
+            next += n;
+            return n;
+        };
+    }
+
+    /**
+     * Whether `path` is an existing regular file of 0 bytes (which MappedFile cannot map)
+     */
+    bool emptyFile(const string &path) {
+        struct stat st;
+        return stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode) && st.st_size == 0;
+    }
+
+    template<typename Point>
+    MsmChunkSource<Point> openFiles(const string &pointsPath, const string &scalarsPath, bool compressed,
+                                    size_t &terms) {
+        if (emptyFile(pointsPath) && emptyFile(scalarsPath)) {
+            terms = 0;
+            return [](Point *, BIG *, size_t) { return (size_t) 0; };
+        }
+        auto points = make_shared<MappedFile>(pointsPath);
+        auto scalars = make_shared<MappedFile>(scalarsPath);
+        size_t elem = GroupTraits<Point>::encodedSize(compressed);
+        terms = points->size() / elem;
+        if (points->size() % elem != 0 || scalars->size() != terms * SCALAR_BYTES) {
+            throw invalid_argument("MsmStream_files: " + pointsPath + " and " + scalarsPath +
+                                   " do not hold the same number of terms");
+        }
+        return fileSource<Point>(points, scalars, elem, terms);
+    }
+
+    template<typename Point>
+    Point msmFiles(const string &pointsPath, const string &scalarsPath, bool compressed) {
+        size_t terms;
+        MsmChunkSource<Point> source = openFiles<Point>(pointsPath, scalarsPath, compressed, terms);
+        if (terms == 0) {
+            Point res;
+            GroupTraits<Point>::inf(res);
+            return res;
+        }
+        MsmStream<Point> stream(terms);
+        stream.addSource(source);
+        return stream.result();
+    }
+}
+
+template<typename Point>
+MsmStream<Point>::MsmStream(size_t expectedTerms, size_t maxBucketBytes, unsigned threads) {
+    int bits = (int) mpz_sizeinbase(getCurveOrder().get_mpz_t(), 2);
+    auto bytesFor = [&](int c) {
+        return (size_t) ((bits + c - 1) / c) * (((size_t) 1 << c) - 1) * sizeof(Point);
+    };
+    c_ = msmWindowBits(expectedTerms ? expectedTerms : SIZE_MAX);
+    while (c_ > 1 && bytesFor(c_) > maxBucketBytes) --c_;
+    if (bytesFor(c_) > maxBucketBytes) {
+        throw invalid_argument("MsmStream: " + to_string(maxBucketBytes) + " bytes cannot hold the buckets");
+    }
+    windows_ = (bits + c_ - 1) / c_;
+    perWindow_ = ((size_t) 1 << c_) - 1;
+    threads_ = min<unsigned>(threads ? threads : max(1u, thread::hardware_concurrency()), (unsigned) windows_);
+    buckets_.resize(windows_ * perWindow_);
+    used_.assign(buckets_.size(), 0);
+}
+
+/**
+ * Drops every term into the bucket of its digit in every window; worker t owns the windows
+ * t, t + threads, ..., so the workers never share a bucket
+ */
+template<typename Point>
+void MsmStream<Point>::accumulate(const Point *points, const ScalarWords *scalars, size_t n) {
+    auto work = [&](unsigned t, unsigned workers) {
+        for (int j = (int) t; j < windows_; j += (int) workers) {
+            Point *bucket = &buckets_[j * perWindow_];
+            char *used = &used_[j * perWindow_];
+            for (size_t i = 0; i < n; ++i) {
+                uint32_t d = scalars[i].window(j * c_, c_);
+                if (d == 0) continue;
+                if (used[d - 1]) {
+                    G::add(bucket[d - 1], points[i]);
+                } else {
+                    G::copy(bucket[d - 1], points[i]);
+                    used[d - 1] = 1;
+                }
+            }
+        }
+    };
+    unsigned workers = n >= MIN_PARALLEL_TERMS ? threads_ : 1;
+    vector<thread> pool;
+    for (unsigned t = 1; t < workers; ++t) pool.emplace_back(work, t, workers);
+    work(0, workers);
+    for (thread &t: pool) t.join();
+    terms_ += n;
+}
+
+template<typename Point>
+void MsmStream<Point>::add(const Point *points, const BIG *scalars, size_t n) {
+    BIG q;
+    BIG_rcopy(q, CURVE_Order);
+    vector<ScalarWords> s(n);
+    for (size_t i = 0; i < n; ++i) {
+        BIG t;
+        BIG_rcopy(t, scalars[i]);
+        BIG_norm(t);
+        BIG_mod(t, q);
+        scalarFromBIG(s[i], t);
+    }
+    accumulate(points, s.data(), n);
+}
+
+template<typename Point>
+void MsmStream<Point>::add(const Point *points, const mpz_class *scalars, size_t n) {
+    const mpz_class &q = getCurveOrder();
+    vector<ScalarWords> s(n);
+    for (size_t i = 0; i < n; ++i) scalarFromMpz(s[i], scalars[i], &q);
+    accumulate(points, s.data(), n);
+}
+
+template<typename Point>
+void MsmStream<Point>::add(const vector<Point> &points, const vector<mpz_class> &scalars) {
+    assert(points.size() == scalars.size());
+    add(points.data(), scalars.data(), scalars.size());
+}
+
+template<typename Point>
+void MsmStream<Point>::addSource(const MsmChunkSource<Point> &source, size_t chunkTerms) {
+    if (chunkTerms == 0) {
+        throw invalid_argument("MsmStream: chunks must hold at least one term");
+    }
+    vector<Point> points[2] = {vector<Point>(chunkTerms), vector<Point>(chunkTerms)};
+    unique_ptr<BIG[]> scalars[2] = {unique_ptr<BIG[]>(new BIG[chunkTerms]), unique_ptr<BIG[]>(new BIG[chunkTerms])};
+    size_t n = source(points[0].data(), scalars[0].get(), chunkTerms);
+    for (int cur = 0; n > 0; cur ^= 1) {
+        size_t next = 0;
+        exception_ptr error;
+        thread reader([&] {
+            try {
+                next = source(points[cur ^ 1].data(), scalars[cur ^ 1].get(), chunkTerms);
+            } catch (...) {
+                error = current_exception();
+            }
+        });
+        add(points[cur].data(), scalars[cur].get(), n);
+        reader.join();
+        if (error) rethrow_exception(error);
+        n = next;
+    }
+}
+
+template<typename Point>
+Point MsmStream<Point>::result() const {
+    // bucket d of a window contributes d times through the running sum
+    vector<Point> sums(windows_);
+    auto fold = [&](unsigned t) {
+        for (int j = (int) t; j < windows_; j += (int) threads_) {
+            const Point *bucket = &buckets_[j * perWindow_];
+            const char *used = &used_[j * perWindow_];
+            Point sum, acc;
+            G::inf(sum);
+            G::inf(acc);
+            bool started = false;
+            for (size_t b = perWindow_; b-- > 0;) {
+                if (used[b]) {
+                    G::add(sum, bucket[b]);
+                    started = true;
+                }
+                if (started) G::add(acc, sum);
+            }
+            G::copy(sums[j], acc);
+        }
+    };
+    vector<thread> pool;
+    for (unsigned t = 1; t < threads_; ++t) pool.emplace_back(fold, t);
+    fold(0);
+    for (thread &t: pool) t.join();
+    Point res;
+    G::inf(res);
+    for (int j = windows_ - 1; j >= 0; --j) {
+        if (j != windows_ - 1) {
+            for (int k = 0; k < c_; ++k) G::dbl(res);
+        }
+        G::add(res, sums[j]);
+    }
+    return res;
+}
+
+template<typename Point>
+MsmChunkSource<Point> MsmStream_files(const string &pointsPath, const string &scalarsPath, bool compressed) {
+    size_t terms;
+    return openFiles<Point>(pointsPath, scalarsPath, compressed, terms);
+}
+
+ECP ECP_msmFiles(const string &pointsPath, const string &scalarsPath, bool compressed) {
+    return msmFiles<ECP>(pointsPath, scalarsPath, compressed);
+}
+
+ECP2 ECP2_msmFiles(const string &pointsPath, const string &scalarsPath, bool compressed) {
+    return msmFiles<ECP2>(pointsPath, scalarsPath, compressed);
+}
+
+template class MsmStream<ECP>;
+template class MsmStream<ECP2>;
+
+template MsmChunkSource<ECP> MsmStream_files<ECP>(const string &, const string &, bool);
+
+template MsmChunkSource<ECP2> MsmStream_files<ECP2>(const string &, const string &, bool);
@@ -0,0 +1,154 @@
+#include "../include/PairingVerifier.h"
+#include "../include/MSM.h"
+#include <random>
+
+PairingVerifier::PairingVerifier(const PairingVerifierConfig &config) : config_(config) {
+    if (config_.maxBatch == 0) config_.maxBatch = 1;
+    if (config_.workers == 0) config_.workers = max(1u, thread::hardware_concurrency());
+    batchLimit_ = config_.maxBatch;
+    stats_.batchSizeHistogram.assign(64 - __builtin_clzll((unsigned long long) config_.maxBatch), 0);
+    for (size_t i = 0; i < config_.workers; ++i) {
+        workers_.emplace_back(&PairingVerifier::workerLoop, this);
+    }
+}
+
+PairingVerifier::~PairingVerifier() {
+    {
+        lock_guard<mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    for (thread &t: workers_) t.join();
+}
+
+future<bool> PairingVerifier::submit(PairingCheck check) {
+    auto promise = make_shared<std::promise<bool>>();
+    future<bool> result = promise->get_future();
+    submit(std::move(check), [promise](bool ok) { promise->set_value(ok); });
+    return result;
+}
+
+void PairingVerifier::submit(PairingCheck check, function<void(bool)> callback) {
+    assert(check.g1.size() == check.g2.size());
+    bool wake;
+    {
+        lock_guard<mutex> lock(mutex_);
+        pending_.push_back({std::move(check), std::move(callback), chrono::steady_clock::now()});
+        wake = pending_.size() == 1 || pending_.size() >= batchLimit_;
+    }
+    {
+        lock_guard<mutex> lock(statsMutex_);
+        stats_.submitted++;
+    }
+    // Wake a worker for the first pending check (it starts the latency timer) and when a batch is full
+    if (wake) cv_.notify_one();
+}
+
+PairingVerifierStats PairingVerifier::stats() const {
+    lock_guard<mutex> lock(statsMutex_);
+    return stats_;
+}
+
+vector<PairingVerifier::Pending> PairingVerifier::takeBatch() {
+    unique_lock<mutex> lock(mutex_);
+    for (;;) {
+        if (pending_.empty()) {
+            if (stopping_) return {};
+            cv_.wait(lock);
+            continue;
+        }
+        auto deadline = pending_.front().enqueued + config_.maxLatency;
+        if (pending_.size() >= batchLimit_ || stopping_ || chrono::steady_clock::now() >= deadline) break;
+        cv_.wait_until(lock, deadline);
+    }
+    size_t n = min(batchLimit_, pending_.size());
+    vector<Pending> batch;
+    batch.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        batch.push_back(std::move(pending_.front()));
+        pending_.pop_front();
+    }
+    // Leftovers may already be due: let another worker pick them up
+    if (!pending_.empty()) cv_.notify_one();
+    return batch;
+}
+
+void PairingVerifier::workerLoop() {
+    // Each worker owns a csprng for the batching exponents, seeded from the OS
+    csprng rng;
+    char raw[64];
+    random_device rd;
+    for (size_t i = 0; i < sizeof(raw); i += 4) {
+        unsigned int v = rd();
+        memcpy(raw + i, &v, 4);
+    }
+    octet RAW = {sizeof(raw), sizeof(raw), raw};
+    CREATE_CSPRNG(&rng, &RAW);
+
+    for (;;) {
+        vector<Pending> batch = takeBatch();
+        if (batch.empty()) break;
+        verifyBatch(batch, rng);
+    }
+    KILL_CSPRNG(&rng);
+}
+
+bool PairingVerifier::verifyOne(const PairingCheck &check) {
+    return pairingProductIsOne(check.g1, check.g2);
+}
+
+void PairingVerifier::verifyBatch(vector<Pending> &batch, csprng &rng) {
+    bool batchOk;
+    if (batch.size() == 1) {
+        batchOk = verifyOne(batch[0].check);
+    } else {
+        // prod_k (prod_i e(P_ki, Q_ki))^r_k == 1, with r_k folded into the G1 points
+        BIG order, r;
+        BIG_rcopy(order, CURVE_Order);
+        vector<ECP> g1;
+        vector<ECP2> g2;
+        for (Pending &p: batch) {
+            BIG_randtrunc(r, order, 128, &rng);
+            mpz_class rm = BIG_to_mpz(r);
+            for (size_t i = 0; i < p.check.g1.size(); ++i) {
+                // 128-bit exponent: about half the doublings of a full-length ECP_mul
+                g1.push_back(ECP_mulShort(p.check.g1[i], rm));
+                g2.push_back(p.check.g2[i]);
+            }
+        }
+        batchOk = pairingProductIsOne(g1, g2);
+    }
+
+    size_t individual = 0, rejected = 0;
+    if (batchOk) {
+        for (Pending &p: batch) p.done(true);
+    } else if (batch.size() == 1) {
+        rejected = 1;
+        batch[0].done(false);
+    } else {
+        for (Pending &p: batch) {
+            bool ok = verifyOne(p.check);
+            individual++;
+            if (!ok) rejected++;
+            p.done(ok);
+        }
+    }
+
+    {
+        lock_guard<mutex> lock(mutex_);
+        if (!batchOk && batch.size() > 1) {
+            batchLimit_ = max<size_t>(1, batchLimit_ / 2);
+        } else if (batchOk && batchLimit_ < config_.maxBatch) {
+            batchLimit_ = min(config_.maxBatch, batchLimit_ * 2);
+        }
+    }
+    lock_guard<mutex> lock(statsMutex_);
+    uint64_t before = stats_.batches;
+    stats_.batches++;
+    stats_.meanBatchSize = (stats_.meanBatchSize * before + batch.size()) / stats_.batches;
+    if (!batchOk && batch.size() > 1) stats_.failedBatches++;
+    stats_.individualChecks += individual;
+    stats_.rejected += rejected;
+    size_t bucket = 63 - __builtin_clzll((unsigned long long) batch.size());
+    if (bucket < stats_.batchSizeHistogram.size()) stats_.batchSizeHistogram[bucket]++;
+}
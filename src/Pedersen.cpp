@@ -0,0 +1,185 @@
+#include "../include/Pedersen.h"
+#include "../include/FpBatch.h"
+#include "../include/MSM.h"
+#include "Scalar.h"
+#include <thread>
+
+/**
+ * hash_to_curve (RFC 9380, BLS12381G1_XMD:SHA-256_SSWU_RO_) of msg under dst
+ */
+static ECP hashToCurve(const string &dst, const char *msg, int len) {
+    const int L = 64;  // ceil((381 + 128) / 8) bytes per field element
+    char okm[2 * L];
+    vector<char> dstBytes(dst.begin(), dst.end()), msgBytes(msg, msg + len);
+    octet OKM = {0, sizeof(okm), okm};
+    octet DST = {(int) dstBytes.size(), (int) dstBytes.size(), dstBytes.data()};
+    octet M = {len, len, msgBytes.data()};
+    XMD_Expand(MC_SHA2, 32, &OKM, 2 * L, &DST, &M);
+
+    BIG p;
+    BIG_rcopy(p, Modulus);
+    ECP P[2];
+    for (int i = 0; i < 2; ++i) {
+        DBIG dx;
+        BIG x;
+        FP u;
+        BIG_dfromBytesLen(dx, okm + i * L, L);
+        BIG_dmod(x, dx, p);
+        FP_nres(&u, x);
+        ECP_map2point(&P[i], &u);
+    }
+    ECP_add(&P[0], &P[1]);
+    ECP_cfp(&P[0]);
+    ECP_affine(&P[0]);
+    return P[0];
+}
+
+ECP PedersenVector::deriveGenerator(const string &dst, uint64_t i) {
+    char msg[8];
+    for (int b = 0; b < 8; ++b) msg[b] = (char) (i >> (56 - 8 * b));
+    return hashToCurve(dst, msg, 8);
+}
+
+int PedersenVector::windowCount(int windowBits) {
+    // One extra digit position absorbs the carry of the signed recoding
+    int bits = (int) mpz_sizeinbase(getCurveOrder().get_mpz_t(), 2);
+    return (bits + windowBits - 1) / windowBits + 1;
+}
+
+size_t PedersenVector::tableSize(size_t n, int windowBits) {
+    return (n + 1) * (size_t) windowCount(windowBits);
+}
+
+int PedersenVector::defaultWindowBits(size_t n) {
+    int best = 2;
+    double bestCost = 0;
+    for (int w = 2; w <= 16; ++w) {
+        double cost = (double) (n + 1) * windowCount(w) + (double) ((size_t) 1 << w);
+        if (w == 2 || cost < bestCost) {
+            best = w;
+            bestCost = cost;
+        }
+    }
+    return best;
+}
+
+PedersenVector::PedersenVector(size_t n, int windowBits, const string &dst)
+    : n_(n), w_(windowBits ? windowBits : defaultWindowBits(n)) {
+    if (w_ < 2 || w_ > 16) {
+        throw invalid_argument("PedersenVector: window width must be in [2, 16]");
+    }
+    windows_ = windowCount(w_);
+    own_.resize(tableSize(n_, w_));
+    // Every row is a hash to the curve and 256 doublings, independent of the others: spread them over the cores
+    size_t rows = n_ + 1;
+    size_t threads = min<size_t>(rows, max(1u, thread::hardware_concurrency()));
+    auto build = [&](size_t first) {
+        for (size_t k = first; k < rows; k += threads) {
+            ECP *row = &own_[k * windows_];
+            row[0] = k < n_ ? deriveGenerator(dst, k) : hashToCurve(dst, "H", 1);
+            for (int j = 1; j < windows_; ++j) {
+                ECP_copy(&row[j], &row[j - 1]);
+                for (int b = 0; b < w_; ++b) ECP_dbl(&row[j]);
+            }
+        }
+    };
+    vector<thread> workers;
+    for (size_t t = 1; t < threads; ++t) workers.emplace_back(build, t);
+    build(0);
+    for (thread &t: workers) t.join();
+    ECP_batchAffine(own_.data(), own_.size());
+    table_ = own_.data();
+}
+
+PedersenVector::PedersenVector(const ECP *table, size_t count, size_t n, int windowBits)
+    : n_(n), w_(windowBits), table_(table) {
+    if (w_ < 2 || w_ > 16) {
+        throw invalid_argument("PedersenVector: window width must be in [2, 16]");
+    }
+    if (count != tableSize(n_, w_)) {
+        throw invalid_argument("PedersenVector: table size does not match the vector length and window width");
+    }
+    windows_ = windowCount(w_);
+}
+
+const ECP &PedersenVector::generator(size_t i) const {
+    if (i >= n_) {
+        throw out_of_range("PedersenVector: generator " + to_string(i) + " of " + to_string(n_));
+    }
+    return table_[i * windows_];
+}
+
+ECP PedersenVector::commit(const vector<mpz_class> &values, const mpz_class &blinding) const {
+    if (values.size() > n_) {
+        throw invalid_argument("PedersenVector: " + to_string(values.size()) + " values for " + to_string(n_) +
+                               " generators");
+    }
+    const mpz_class &q = getCurveOrder();
+    int half = 1 << (w_ - 1);
+    vector<ECP> buckets(half);
+    vector<char> used(half);
+    auto drop = [&](const ECP &P, int d) {
+        size_t b = (size_t) (d > 0 ? d : -d) - 1;
+        if (used[b]) {
+            if (d > 0) ECP_add(&buckets[b], const_cast<ECP *>(&P));
+            else ECP_sub(&buckets[b], const_cast<ECP *>(&P));
+        } else {
+            ECP_copy(&buckets[b], const_cast<ECP *>(&P));
+            if (d < 0) ECP_neg(&buckets[b]);
+            used[b] = 1;
+        }
+    };
+    // Every (value, digit position) pair lands in the bucket of its signed digit
+    ScalarWords s;
+    for (size_t k = 0; k <= values.size(); ++k) {
+        const mpz_class &v = k < values.size() ? values[k] : blinding;
+        scalarFromMpz(s, v, &q);
+        if (s.bits() == 0) continue;
+        const ECP *row = &table_[(k < values.size() ? k : n_) * windows_];
+        int carry = 0;
+        for (int j = 0; j < windows_; ++j) {
+            int d = (int) s.window(j * w_, w_) + carry;
+            carry = 0;
+            if (d > half) {
+                d -= 2 * half;
+                carry = 1;
+            }
+            if (d != 0) drop(row[j], d);
+        }
+    }
+    // sum over d of d * bucket[d - 1], with a running sum from the top
+    ECP sum, acc;
+    ECP_inf(&sum);
+    ECP_inf(&acc);
+    bool started = false;
+    for (size_t b = half; b-- > 0;) {
+        if (used[b]) {
+            ECP_add(&sum, &buckets[b]);
+            started = true;
+        }
+        if (started) ECP_add(&acc, &sum);
+    }
+    return acc;
+}
+
+bool PedersenVector::open(const ECP &C, const vector<mpz_class> &values, const mpz_class &blinding) const {
+    ECP R = commit(values, blinding);
+    return ECP_equals(&R, const_cast<ECP *>(&C));
+}
+
+void PedersenVector::update(ECP &C, size_t slot, const mpz_class &oldValue, const mpz_class &newValue) const {
+    ECP delta = ECP_mulShort(generator(slot), newValue - oldValue);
+    ECP_add(&C, &delta);
+}
+
+void PedersenVector::reblind(ECP &C, const mpz_class &oldBlinding, const mpz_class &newBlinding) const {
+    ECP delta = ECP_mulShort(blindingGenerator(), newBlinding - oldBlinding);
+    ECP_add(&C, &delta);
+}
+
+ECP PedersenVector::add(const ECP &A, const ECP &B) {
+    ECP R;
+    ECP_copy(&R, const_cast<ECP *>(&A));
+    ECP_add(&R, const_cast<ECP *>(&B));
+    return R;
+}
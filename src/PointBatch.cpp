@@ -0,0 +1,109 @@
+#include "../include/PointBatch.h"
+#include <memory>
+
+template<typename Point>
+PointBatch<Point>::PointBatch(size_t n) {
+    resize(n);
+}
+
+template<typename Point>
+void PointBatch<Point>::resize(size_t n) {
+    size_t old = points_.size();
+    points_.resize(n);
+    for (size_t i = old; i < n; ++i) G::inf(points_[i]);
+}
+
+template<typename Point>
+void PointBatch<Point>::normalize() {
+    G::batchAffine(points_.data(), points_.size());
+}
+
+template<typename Point>
+void PointBatch<Point>::checkSize(const PointBatch &other) const {
+    if (other.size() != size()) {
+        throw invalid_argument("PointBatch: size mismatch (" + to_string(size()) + " vs " +
+                               to_string(other.size()) + ")");
+    }
+}
+
+template<typename Point>
+void PointBatch<Point>::add(const PointBatch &other) {
+    checkSize(other);
+    for (size_t i = 0; i < points_.size(); ++i) G::add(points_[i], other.points_[i]);
+}
+
+template<typename Point>
+void PointBatch<Point>::sub(const PointBatch &other) {
+    checkSize(other);
+    for (size_t i = 0; i < points_.size(); ++i) G::sub(points_[i], other.points_[i]);
+}
+
+template<typename Point>
+void PointBatch<Point>::negate() {
+    for (Point &P: points_) G::neg(P);
+}
+
+template<typename Point>
+Point PointBatch<Point>::sum() const {
+    Point r;
+    G::inf(r);
+    for (const Point &P: points_) G::add(r, P);
+    return r;
+}
+
+template<typename Point>
+void PointBatch<Point>::equalsEach(const PointBatch &other, bool *eq) const {
+    checkSize(other);
+    G::batchEquals(points_.data(), other.points_.data(), points_.size(), eq);
+}
+
+template<typename Point>
+bool PointBatch<Point>::operator==(const PointBatch &other) const {
+    if (other.size() != size()) return false;
+    unique_ptr<bool[]> eq(new bool[size()]);
+    equalsEach(other, eq.get());
+    for (size_t i = 0; i < size(); ++i) {
+        if (!eq[i]) return false;
+    }
+    return true;
+}
+
+template<typename Point>
+bool PointBatch<Point>::allInSubgroup() const {
+    for (const Point &P: points_) {
+        if (!G::isMember(P)) return false;
+    }
+    return true;
+}
+
+template<typename Point>
+vector<unsigned char> PointBatch<Point>::toBytes(bool compress) {
+    // After one batched inversion the per-point encoder finds z = 1 and skips its own
+    normalize();
+    size_t len = encodedSize(compress);
+    vector<unsigned char> out(len * points_.size());
+    for (size_t i = 0; i < points_.size(); ++i) {
+        octet W = {0, (int) len, (char *) out.data() + i * len};
+        G::toOctet(W, points_[i], compress);
+    }
+    return out;
+}
+
+template<typename Point>
+PointBatch<Point> PointBatch<Point>::fromBytes(const unsigned char *bytes, size_t len, bool compress) {
+    size_t elem = encodedSize(compress);
+    if (len % elem != 0) {
+        throw invalid_argument("PointBatch: " + to_string(len) + " bytes is not a whole number of points");
+    }
+    PointBatch batch(len / elem);
+    for (size_t i = 0; i < batch.size(); ++i) {
+        octet W = {(int) elem, (int) elem, (char *) bytes + i * elem};
+        if (!G::fromOctet(batch.points_[i], W)) {
+            throw invalid_argument("PointBatch: point " + to_string(i) + " does not decode");
+        }
+    }
+    return batch;
+}
+
+template class PointBatch<ECP>;
+template class PointBatch<ECP2>;
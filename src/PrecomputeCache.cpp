@@ -0,0 +1,243 @@
+#include "../include/PrecomputeCache.h"
+#include "../include/FixedBase.h"
+#include "../include/GTFixedBase.h"
+#include <numeric>
+
+static const char PRECOMPUTE_MAGIC[8] = {'P', 'R', 'E', 'C', 'O', 'M', 'P', 0};
+static const char PRECOMPUTE_CURVE[16] = {'B', 'L', 'S', '1', '2', '3', '8', '1', '/', 'B', '3', '8', '4', '_', '5', '8'};
+
+const char *const PRECOMPUTE_G1_GENERATOR = "g1.generator.fixedbase";
+const char *const PRECOMPUTE_G2_GENERATOR = "g2.generator.fixedbase";
+const char *const PRECOMPUTE_GT_GENERATOR = "gt.generator.fixedbase";
+
+static size_t alignUp(size_t v) {
+    return (v + 63) & ~(size_t) 63;
+}
+
+static uint64_t rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+uint64_t precomputeChecksum(const void *data, size_t len) {
+    // Four independent multiply-rotate lanes over 32-byte stripes, then a final avalanche
+    const uint64_t P1 = 0x9E3779B185EBCA87ULL, P2 = 0xC2B2AE3D27D4EB4FULL;
+    const unsigned char *p = (const unsigned char *) data;
+    uint64_t h[4] = {P1, P2, ~P1, ~P2};
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        for (int l = 0; l < 4; ++l) {
+            uint64_t w;
+            memcpy(&w, p + i + 8 * l, 8);
+            h[l] = rotl(h[l] + w * P2, 31) * P1;
+        }
+    }
+    uint64_t r = (rotl(h[0], 1) + rotl(h[1], 7) + rotl(h[2], 12) + rotl(h[3], 18)) ^ (uint64_t) len;
+    for (; i < len; ++i) r = (r ^ p[i]) * P1;
+    r ^= r >> 33;
+    r *= P2;
+    r ^= r >> 29;
+    return r;
+}
+
+void PrecomputeCacheBuilder::addRaw(const string &name, const void *data, size_t elemSize, size_t count) {
+    if (name.empty() || name.size() >= sizeof(PrecomputeSectionEntry::name)) {
+        throw invalid_argument("Precompute cache: bad section name '" + name + "'");
+    }
+    if (elemSize == 0) {
+        throw invalid_argument("Precompute cache: zero element size for " + name);
+    }
+    for (const Section &s: sections_) {
+        if (s.name == name) throw invalid_argument("Precompute cache: duplicate section " + name);
+    }
+    const unsigned char *bytes = (const unsigned char *) data;
+    sections_.push_back({name, elemSize, vector<unsigned char>(bytes, bytes + elemSize * count)});
+}
+
+void PrecomputeCacheBuilder::write(const string &path) const {
+    PrecomputeCacheHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, PRECOMPUTE_MAGIC, sizeof(h.magic));
+    memcpy(h.curve, PRECOMPUTE_CURVE, sizeof(h.curve));
+    h.version = PRECOMPUTE_CACHE_VERSION;
+    h.sectionCount = (uint32_t) sections_.size();
+    h.fpSize = sizeof(FP);
+    h.g1Size = sizeof(ECP);
+    h.g2Size = sizeof(ECP2);
+    h.frSize = sizeof(Fr);
+    h.tableOffset = alignUp(sizeof(h));
+
+    vector<PrecomputeSectionEntry> entries(sections_.size());
+    size_t off = alignUp(h.tableOffset + entries.size() * sizeof(PrecomputeSectionEntry));
+    for (size_t i = 0; i < sections_.size(); ++i) {
+        const Section &s = sections_[i];
+        PrecomputeSectionEntry &e = entries[i];
+        memset(&e, 0, sizeof(e));
+        memcpy(e.name, s.name.data(), s.name.size());
+        e.offset = off;
+        e.size = s.bytes.size();
+        e.elemSize = s.elemSize;
+        e.checksum = precomputeChecksum(s.bytes.data(), s.bytes.size());
+        off = alignUp(off + s.bytes.size());
+    }
+    h.fileSize = off;
+    h.tableChecksum = precomputeChecksum(entries.data(), entries.size() * sizeof(PrecomputeSectionEntry));
+
+    vector<unsigned char> buf(off, 0);
+    memcpy(buf.data(), &h, sizeof(h));
+    if (!entries.empty()) {
+        memcpy(buf.data() + h.tableOffset, entries.data(), entries.size() * sizeof(PrecomputeSectionEntry));
+    }
+    for (size_t i = 0; i < sections_.size(); ++i) {
+        if (!sections_[i].bytes.empty()) {
+            memcpy(buf.data() + entries[i].offset, sections_[i].bytes.data(), sections_[i].bytes.size());
+        }
+    }
+    writeFileAtomic(path, buf.data(), buf.size());
+}
+
+PrecomputeCache::PrecomputeCache(const string &path, bool verifyChecksums) : file_(path) {
+    const unsigned char *base = file_.data();
+    size_t size = file_.size();
+    if (size < sizeof(PrecomputeCacheHeader)) {
+        throw runtime_error("Precompute cache is truncated: " + path);
+    }
+    PrecomputeCacheHeader h;
+    memcpy(&h, base, sizeof(h));
+    if (memcmp(h.magic, PRECOMPUTE_MAGIC, sizeof(h.magic)) != 0) {
+        throw runtime_error("Not a precompute cache: " + path);
+    }
+    if (h.version != PRECOMPUTE_CACHE_VERSION) {
+        throw runtime_error("Precompute cache version mismatch: " + path);
+    }
+    if (memcmp(h.curve, PRECOMPUTE_CURVE, sizeof(h.curve)) != 0 || h.fpSize != sizeof(FP) ||
+        h.g1Size != sizeof(ECP) || h.g2Size != sizeof(ECP2) || h.frSize != sizeof(Fr)) {
+        throw runtime_error("Precompute cache was built for another curve or struct layout: " + path);
+    }
+    size_t tableBytes = (size_t) h.sectionCount * sizeof(PrecomputeSectionEntry);
+    if (h.fileSize != size || h.tableOffset % 64 != 0 || h.tableOffset + tableBytes > size) {
+        throw runtime_error("Precompute cache is truncated: " + path);
+    }
+    entries_ = (const PrecomputeSectionEntry *) (base + h.tableOffset);
+    count_ = h.sectionCount;
+    if (precomputeChecksum(entries_, tableBytes) != h.tableChecksum) {
+        throw runtime_error("Precompute cache section table is corrupt: " + path);
+    }
+    for (size_t i = 0; i < count_; ++i) {
+        const PrecomputeSectionEntry &e = entries_[i];
+        if (memchr(e.name, 0, sizeof(e.name)) == nullptr || e.elemSize == 0 || e.size % e.elemSize != 0 ||
+            e.offset % 64 != 0 || e.offset > size || e.size > size - e.offset) {
+            throw runtime_error("Precompute cache section table is corrupt: " + path);
+        }
+        if (verifyChecksums && precomputeChecksum(base + e.offset, e.size) != e.checksum) {
+            throw runtime_error("Precompute cache section " + string(e.name) + " is corrupt: " + path);
+        }
+    }
+}
+
+PrecomputeCache PrecomputeCache::openOrBuild(const string &path, const function<void(PrecomputeCacheBuilder &)> &build,
+                                             bool *rebuilt) {
+    try {
+        PrecomputeCache cache(path);
+        if (rebuilt != nullptr) *rebuilt = false;
+        return cache;
+    } catch (const runtime_error &) {
+        // missing, stale or corrupt: rebuild below
+    }
+    PrecomputeCacheBuilder builder;
+    build(builder);
+    builder.write(path);
+    if (rebuilt != nullptr) *rebuilt = true;
+    return PrecomputeCache(path);
+}
+
+const PrecomputeSectionEntry *PrecomputeCache::find(const string &name) const {
+    for (size_t i = 0; i < count_; ++i) {
+        if (name == entries_[i].name) return &entries_[i];
+    }
+    return nullptr;
+}
+
+const PrecomputeSectionEntry *PrecomputeCache::section(const string &name, size_t elemSize) const {
+    const PrecomputeSectionEntry *e = find(name);
+    if (e == nullptr) {
+        throw runtime_error("Precompute cache has no section " + name);
+    }
+    if (e->elemSize != elemSize) {
+        throw runtime_error("Precompute cache section " + name + " has a different element type");
+    }
+    return e;
+}
+
+vector<string> PrecomputeCache::sections() const {
+    vector<string> names;
+    for (size_t i = 0; i < count_; ++i) names.emplace_back(entries_[i].name);
+    return names;
+}
+
+void Precompute_addGenerators(PrecomputeCacheBuilder &builder) {
+    ECP g1;
+    ECP2 g2;
+    ECP_generator(&g1);
+    ECP2_generator(&g2);
+    vector<ECP> t1;
+    vector<ECP2> t2;
+    ECP_fixedBaseTable(t1, g1);
+    ECP2_fixedBaseTable(t2, g2);
+    builder.add(PRECOMPUTE_G1_GENERATOR, t1.data(), t1.size());
+    builder.add(PRECOMPUTE_G2_GENERATOR, t2.data(), t2.size());
+}
+
+void Precompute_addGTGenerator(PrecomputeCacheBuilder &builder) {
+    ECP g1;
+    ECP2 g2;
+    ECP_generator(&g1);
+    ECP2_generator(&g2);
+    GTFixedBase gt(e(g1, g2), PRECOMPUTE_GT_WINDOW);
+    builder.add(PRECOMPUTE_GT_GENERATOR, gt.table(), GTFixedBase::tableSize(PRECOMPUTE_GT_WINDOW));
+}
+
+string Precompute_shamirSection(const ShamirEngine &engine) {
+    string domain = engine.domain() == ShamirDomain::Integers ? "int" : "roots";
+    return "shamir." + domain + ".n" + to_string(engine.parties()) + ".t" + to_string(engine.threshold()) +
+           ".k" + to_string(engine.packing());
+}
+
+void Precompute_addShamirWeights(PrecomputeCacheBuilder &builder, const ShamirEngine &engine) {
+    vector<size_t> ids(engine.threshold());
+    iota(ids.begin(), ids.end(), 0);
+    vector<Fr> w = engine.reconstructionWeights(ids);
+    builder.add(Precompute_shamirSection(engine), w.data(), w.size());
+}
+
+bool Precompute_loadShamirWeights(const PrecomputeCache &cache, ShamirEngine &engine) {
+    string name = Precompute_shamirSection(engine);
+    if (!cache.has(name)) return false;
+    size_t count;
+    const Fr *w = cache.get<Fr>(name, count);
+    if (count != engine.packing() * engine.threshold()) {
+        throw runtime_error("Precompute cache section " + name + " has the wrong size");
+    }
+    vector<size_t> ids(engine.threshold());
+    iota(ids.begin(), ids.end(), 0);
+    engine.preloadWeights(ids, w);
+    return true;
+}
+
+template<typename Group>
+string Precompute_discreteLogSection(const Group &base, uint64_t babySteps) {
+    char name[48];
+    snprintf(name, sizeof(name), "dlog.%s.%016llx.m%llu", is_same<Group, ECP>::value ? "g1" : "gt",
+             (unsigned long long) DiscreteLog<Group>::fingerprint(base), (unsigned long long) babySteps);
+    return name;
+}
+
+template<typename Group>
+void Precompute_addDiscreteLog(PrecomputeCacheBuilder &builder, const DiscreteLog<Group> &dlog) {
+    builder.add(Precompute_discreteLogSection(dlog.base(), dlog.babySteps()), dlog.table(),
+                DiscreteLog<Group>::tableSize(dlog.babySteps()));
+}
+
+template string Precompute_discreteLogSection(const ECP &, uint64_t);
+template string Precompute_discreteLogSection(const FP12 &, uint64_t);
+template void Precompute_addDiscreteLog(PrecomputeCacheBuilder &, const G1DiscreteLog &);
+template void Precompute_addDiscreteLog(PrecomputeCacheBuilder &, const GTDiscreteLog &);
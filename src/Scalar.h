@@ -0,0 +1,100 @@
+#pragma once
+
+#include "../include/Tools.h"
+
+/**
+ * Fixed-width little-endian view of a non-negative scalar (at most 384 bits, the width of a BIG).
+ * Internal helper shared by the multi-scalar multiplication routines: window digits are read
+ * from plain 64-bit words instead of going through BIG_bit / hex strings for every access.
+ */
+struct ScalarWords {
+    static const int WORDS = 6;
+    uint64_t w[WORDS];
+
+    /**
+     * Number of significant bits (0 for a zero scalar)
+     */
+    int bits() const {
+        for (int i = WORDS - 1; i >= 0; --i) {
+            if (w[i]) return 64 * i + 64 - __builtin_clzll(w[i]);
+        }
+        return 0;
+    }
+
+    /**
+     * Extracts `width` bits starting at bit `pos` (width <= 32)
+     */
+    uint32_t window(int pos, int width) const {
+        int idx = pos >> 6, off = pos & 63;
+        if (idx >= WORDS) return 0;
+        uint64_t v = w[idx] >> off;
+        if (off + width > 64 && idx + 1 < WORDS) v |= w[idx + 1] << (64 - off);
+        return (uint32_t) (v & ((1ULL << width) - 1));
+    }
+};
+
+/**
+ * Loads a BIG (normalized, non-negative) into a ScalarWords
+ */
+inline void scalarFromBIG(ScalarWords &s, BIG b) {
+    char bytes[MODBYTES_B384_58];
+    BIG_toBytes(bytes, b);
+    memset(s.w, 0, sizeof(s.w));
+    for (int i = 0; i < MODBYTES_B384_58; ++i) {
+        int bit = 8 * (MODBYTES_B384_58 - 1 - i);
+        s.w[bit >> 6] |= (uint64_t) (unsigned char) bytes[i] << (bit & 63);
+    }
+}
+
+/**
+ * Loads an mpz_class into a ScalarWords, reducing it into [0, q) first when q is given
+ */
+inline void scalarFromMpz(ScalarWords &s, const mpz_class &t, const mpz_class *q = nullptr) {
+    memset(s.w, 0, sizeof(s.w));
+    if (q != nullptr && (t < 0 || t >= *q)) {
+        mpz_class r = t % *q;
+        if (r < 0) r += *q;
+        mpz_export(s.w, nullptr, -1, sizeof(uint64_t), 0, 0, r.get_mpz_t());
+        return;
+    }
+    assert(mpz_sizeinbase(t.get_mpz_t(), 2) <= 64 * ScalarWords::WORDS);
+    mpz_export(s.w, nullptr, -1, sizeof(uint64_t), 0, 0, t.get_mpz_t());
+}
+
+/**
+ * r mod q in (-q/2, q/2]
+ */
+inline mpz_class scalarCentered(const mpz_class &r, const mpz_class &q) {
+    mpz_class c = r % q;
+    if (c < 0) c += q;
+    if (c > q / 2) c -= q;
+    return c;
+}
+
+/**
+ * Width-w NAF of v (|v| of at most 384 bits), least significant digit first: every nonzero
+ * digit is odd and in (-2^(w-1), 2^(w-1)), and of any w consecutive digits at most one is
+ * nonzero. Digits are negated for negative v; no trailing zeros.
+ */
+inline void scalarWnaf(vector<int8_t> &digits, const mpz_class &v, int w) {
+    ScalarWords s;
+    mpz_class a = abs(v);
+    scalarFromMpz(s, a);
+    int len = s.bits() + 1;
+    digits.assign(len, 0);
+    int sign = v < 0 ? -1 : 1, carry = 0, last = -1;
+    for (int bit = 0; bit < len;) {
+        if ((int) s.window(bit, 1) == carry) {
+            bit++;
+            continue;
+        }
+        int now = min(w, len - bit);
+        int word = (int) s.window(bit, now) + carry;
+        carry = (word >> (w - 1)) & 1;
+        word -= carry << w;
+        digits[bit] = (int8_t) (sign * word);
+        last = bit;
+        bit += now;
+    }
+    digits.resize(last + 1);
+}
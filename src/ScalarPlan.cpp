@@ -0,0 +1,339 @@
+#include "../include/ScalarPlan.h"
+#include "GmpHeapScope.h"
+#include "Scalar.h"
+
+namespace {
+    const int TABLE = 1 << (ScalarPlan::WINDOW - 2);   // odd multiples 1, 3, ..., 15
+
+    /**
+     * Endomorphism constants, with the eigenvalues checked against the generators
+     */
+    struct Endomorphisms {
+        bool g1 = false;
+        bool g2 = false;
+        FP beta;                     // phi(x, y) = (beta * x, y) acts as lambda on G1
+        mpz_class lambda;
+        FP2 frob;                    // constant of ECP2_frob; psi acts as u on G2
+        mpz_class absX;              // |x|, the curve parameter
+        int signU = 1;               // u = signU * |x| mod q
+        mpz_class x2;                // x^2
+    };
+
+    void phi(ECP &P, const Endomorphisms &E) {
+        FP_mul(&P.x, &P.x, const_cast<FP *>(&E.beta));
+    }
+
+    void psi(ECP2 &P, const Endomorphisms &E) {
+        ECP2_frob(&P, const_cast<FP2 *>(&E.frob));
+    }
+
+    const Endomorphisms &endomorphisms() {
+        static const Endomorphisms E = [] {
+            GmpHeapScope heap;
+            Endomorphisms e;
+            const mpz_class &q = getCurveOrder();
+            BIG bx;
+            BIG_rcopy(bx, CURVE_Bnx);
+            e.absX = BIG_to_mpz(bx);
+            e.x2 = e.absX * e.absX;
+
+            // G1: lambda is one of the two roots of l^2 + l + 1 = 0, depending on beta
+            ECP G, img;
+            ECP_generator(&G);
+            FP_rcopy(&e.beta, CRu);
+            ECP_copy(&img, &G);
+            phi(img, e);
+            for (const mpz_class &l: {mpz_class(q - e.x2), mpz_class(e.x2 - 1)}) {
+                ECP lG;
+                ECP_copy(&lG, &G);
+                ECP_mul(lG, l);
+                if (ECP_equals(&lG, &img)) {
+                    e.lambda = l;
+                    e.g1 = true;
+                    break;
+                }
+            }
+
+            // G2: MIRACL's Frobenius constant, inverted for M-type twists; u = x mod q
+            ECP2 H;
+            ECP2_generator(&H);
+            FP fa, fb;
+            FP_rcopy(&fa, Fra);
+            FP_rcopy(&fb, Frb);
+            FP2 X, Xinv;
+            FP2_from_FPs(&X, &fa, &fb);
+            FP2_inv(&Xinv, &X, nullptr);
+            FP2_norm(&Xinv);
+            for (FP2 *c: {&Xinv, &X}) {
+                FP2_copy(&e.frob, c);
+                ECP2 img2;
+                ECP2_copy(&img2, &H);
+                psi(img2, e);
+                for (int s: {-1, 1}) {
+                    ECP2 uH;
+                    ECP2_copy(&uH, &H);
+                    ECP2_mul(uH, s < 0 ? mpz_class(q - e.absX) : e.absX);
+                    if (ECP2_equals(&uH, &img2)) {
+                        e.signU = s;
+                        e.g2 = true;
+                        break;
+                    }
+                }
+                if (e.g2) break;
+            }
+            return e;
+        }();
+        return E;
+    }
+
+    /**
+     * R = sum of parts[c] * endo^c(P) by interleaved wNAF, in projective coordinates
+     */
+    template<typename Point, typename Endo>
+    void wnafApply(Point &P, const vector<int8_t> *parts, int m, Endo endo) {
+        typedef GroupTraits<Point> G;
+        if (G::isInf(P)) return;
+        Point table[4][TABLE], twice;
+        G::copy(table[0][0], P);
+        G::copy(twice, P);
+        G::dbl(twice);
+        for (int j = 1; j < TABLE; ++j) {
+            G::copy(table[0][j], table[0][j - 1]);
+            G::add(table[0][j], twice);
+        }
+        size_t len = 0;
+        int top = 0;
+        for (int c = 0; c < m; ++c) {
+            len = max(len, parts[c].size());
+            if (!parts[c].empty()) top = c;
+        }
+        // table c holds endo^c of the odd multiples
+        for (int c = 1; c <= top; ++c) {
+            for (int j = 0; j < TABLE; ++j) {
+                G::copy(table[c][j], table[c - 1][j]);
+                endo(table[c][j]);
+            }
+        }
+        Point R;
+        G::inf(R);
+        for (size_t i = len; i-- > 0;) {
+            G::dbl(R);
+            for (int c = 0; c < m; ++c) {
+                int d = i < parts[c].size() ? parts[c][i] : 0;
+                if (d > 0) G::add(R, table[c][(d - 1) / 2]);
+                if (d < 0) G::sub(R, table[c][(-d - 1) / 2]);
+            }
+        }
+        G::copy(P, R);
+    }
+
+    /**
+     * Affine x and y of a batch of G1 points, one FP array each
+     */
+    struct AffineLanes {
+        vector<FP> x, y;
+
+        explicit AffineLanes(size_t n = 0) : x(n), y(n) {}
+    };
+
+    /**
+     * Scratch for the batched affine formulas
+     */
+    struct AffineScratch {
+        vector<FP> den, inv, lam, t, u;
+
+        explicit AffineScratch(size_t n) : den(n), inv(n), lam(n), t(n), u(n) {}
+    };
+
+    void markZeros(const vector<FP> &den, size_t n, vector<char> &spoiled) {
+        for (size_t i = 0; i < n; ++i) {
+            if (FP_iszilch(const_cast<FP *>(&den[i]))) spoiled[i] = 1;
+        }
+    }
+
+    /**
+     * (x3, y3) = (lam^2 - x - x2, lam * (x - x3) - y), written over (x, y)
+     */
+    void affineFinish(FP *x, FP *y, const FP *x2, size_t n, AffineScratch &s) {
+        FpBatch_sqr(s.t.data(), s.lam.data(), n);
+        FpBatch_sub(s.t.data(), s.t.data(), x, n);
+        FpBatch_sub(s.t.data(), s.t.data(), x2, n);       // x3
+        FpBatch_sub(s.u.data(), x, s.t.data(), n);
+        FpBatch_mul(s.u.data(), s.u.data(), s.lam.data(), n);
+        FpBatch_sub(y, s.u.data(), y, n);
+        memcpy(x, s.t.data(), n * sizeof(FP));
+    }
+
+    /**
+     * (x, y) += (x2, y2) for every lane; lanes with equal x are marked spoiled
+     */
+    void batchAdd(FP *x, FP *y, const FP *x2, const FP *y2, size_t n, AffineScratch &s, vector<char> &spoiled) {
+        FpBatch_sub(s.den.data(), x2, x, n);
+        markZeros(s.den, n, spoiled);
+        FpBatch_inv(s.inv.data(), s.den.data(), n);
+        FpBatch_sub(s.lam.data(), y2, y, n);
+        FpBatch_mul(s.lam.data(), s.lam.data(), s.inv.data(), n);
+        affineFinish(x, y, x2, n, s);
+    }
+
+    /**
+     * (x, y) = 2 (x, y) for every lane; lanes with y = 0 are marked spoiled
+     */
+    void batchDouble(FP *x, FP *y, size_t n, AffineScratch &s, vector<char> &spoiled) {
+        FpBatch_add(s.den.data(), y, y, n);
+        markZeros(s.den, n, spoiled);
+        FpBatch_inv(s.inv.data(), s.den.data(), n);
+        FpBatch_sqr(s.t.data(), x, n);
+        FpBatch_add(s.lam.data(), s.t.data(), s.t.data(), n);
+        FpBatch_add(s.lam.data(), s.lam.data(), s.t.data(), n);
+        FpBatch_mul(s.lam.data(), s.lam.data(), s.inv.data(), n);
+        affineFinish(x, y, x, n, s);
+    }
+}
+
+ScalarPlan::ScalarPlan(const mpz_class &k) {
+    init(k);
+}
+
+ScalarPlan::ScalarPlan(BIG k) {
+    init(BIG_to_mpz(k));
+}
+
+void ScalarPlan::init(mpz_class k) {
+    const mpz_class &q = getCurveOrder();
+    const Endomorphisms &E = endomorphisms();
+    k %= q;
+    if (k < 0) k += q;
+    zero_ = k == 0;
+
+    // G1: k1 = +-(k div x^2) leaves a k0 of about 128 bits for one of the two signs
+    if (E.g1) {
+        mpz_class t = k / E.x2, best0, best1;
+        bool first = true;
+        for (const mpz_class &k1: {t, mpz_class(-t)}) {
+            mpz_class k0 = scalarCentered(k - k1 * E.lambda, q);
+            if (first || abs(k0) < abs(best0)) {
+                first = false;
+                best0 = k0;
+                best1 = k1;
+            }
+        }
+        scalarWnaf(g1_[0], best0, WINDOW);
+        scalarWnaf(g1_[1], best1, WINDOW);
+    } else {
+        scalarWnaf(g1_[0], scalarCentered(k, q), WINDOW);
+    }
+
+    // G2: base-|x| digits of k; |x|^i = (signU * u)^i
+    if (E.g2) {
+        mpz_class rest = k;
+        for (int i = 0; i < 4; ++i) {
+            mpz_class digit = i == 3 ? rest : mpz_class(rest % E.absX);
+            rest = (rest - digit) / E.absX;
+            if (E.signU < 0 && (i & 1)) digit = -digit;
+            scalarWnaf(g2_[i], digit, WINDOW);
+        }
+    } else {
+        scalarWnaf(g2_[0], scalarCentered(k, q), WINDOW);
+    }
+}
+
+void ScalarPlan::apply(ECP &P) const {
+    const Endomorphisms &E = endomorphisms();
+    wnafApply(P, g1_, 2, [&E](ECP &Q) { phi(Q, E); });
+}
+
+void ScalarPlan::apply(ECP2 &P) const {
+    const Endomorphisms &E = endomorphisms();
+    wnafApply(P, g2_, 4, [&E](ECP2 &Q) { psi(Q, E); });
+}
+
+void ScalarPlan::apply(ECP2 *P, size_t n) const {
+    for (size_t i = 0; i < n; ++i) apply(P[i]);
+}
+
+void ScalarPlan::apply(ECP *P, size_t n) const {
+    // below this the shared inversions do not pay for the extra passes
+    const size_t BATCH_MIN = 4;
+    if (n < BATCH_MIN) {
+        for (size_t i = 0; i < n; ++i) {
+            apply(P[i]);
+            ECP_affine(&P[i]);
+        }
+        return;
+    }
+    if (zero_) {
+        for (size_t i = 0; i < n; ++i) ECP_inf(&P[i]);
+        return;
+    }
+    ECP_batchAffine(P, n);
+    vector<size_t> lane;
+    for (size_t i = 0; i < n; ++i) {
+        if (!ECP_isinf(&P[i])) lane.push_back(i);
+    }
+    size_t m = lane.size();
+    if (m == 0) return;
+
+    // Odd multiples (2j+1) P for every lane: table[j].x[i], and the phi images
+    const Endomorphisms &E = endomorphisms();
+    int parts = g1_[1].empty() ? 1 : 2;
+    vector<AffineLanes> table(parts * TABLE, AffineLanes(m)), negY(parts * TABLE);
+    AffineScratch scratch(m);
+    vector<char> spoiled(m, 0);
+    for (size_t i = 0; i < m; ++i) {
+        FP_copy(&table[0].x[i], &P[lane[i]].x);
+        FP_copy(&table[0].y[i], &P[lane[i]].y);
+    }
+    AffineLanes twice = table[0];
+    batchDouble(twice.x.data(), twice.y.data(), m, scratch, spoiled);
+    for (int j = 1; j < TABLE; ++j) {
+        table[j] = table[j - 1];
+        batchAdd(table[j].x.data(), table[j].y.data(), twice.x.data(), twice.y.data(), m, scratch, spoiled);
+    }
+    if (parts == 2) {
+        vector<FP> beta(m, E.beta);
+        for (int j = 0; j < TABLE; ++j) {
+            table[TABLE + j].y = table[j].y;
+            FpBatch_mul(table[TABLE + j].x.data(), table[j].x.data(), beta.data(), m);
+        }
+    }
+    vector<FP> zero(m);
+    for (FP &z: zero) FP_zero(&z);
+    for (int j = 0; j < parts * TABLE; ++j) {
+        negY[j].y.resize(m);
+        FpBatch_sub(negY[j].y.data(), zero.data(), table[j].y.data(), m);
+    }
+
+    AffineLanes acc(m);
+    bool started = false;
+    size_t len = max(g1_[0].size(), g1_[1].size());
+    for (size_t i = len; i-- > 0;) {
+        if (started) batchDouble(acc.x.data(), acc.y.data(), m, scratch, spoiled);
+        for (int c = 0; c < parts; ++c) {
+            int d = i < g1_[c].size() ? g1_[c][i] : 0;
+            if (d == 0) continue;
+            int j = c * TABLE + (abs(d) - 1) / 2;
+            const vector<FP> &y = d > 0 ? table[j].y : negY[j].y;
+            if (started) {
+                batchAdd(acc.x.data(), acc.y.data(), table[j].x.data(), y.data(), m, scratch, spoiled);
+            } else {
+                acc.x = table[j].x;
+                acc.y = y;
+                started = true;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < m; ++i) {
+        ECP &R = P[lane[i]];
+        if (spoiled[i]) {
+            // an exceptional case of the affine formulas (e.g. a partial sum hit infinity)
+            apply(R);
+            ECP_affine(&R);
+            continue;
+        }
+        FP_copy(&R.x, &acc.x[i]);
+        FP_copy(&R.y, &acc.y[i]);
+        FP_one(&R.z);
+    }
+}
@@ -0,0 +1,156 @@
+#include "../include/ScalarRng.h"
+#include "ChaChaKernel.h"
+
+#ifdef WRAPPER_X86_SIMD
+void chacha20Blocks_avx2(const uint32_t *in, uint64_t counter, unsigned char *out);
+#endif
+
+typedef void (*ChaChaBlocksFn)(const uint32_t *in, uint64_t counter, unsigned char *out);
+
+static ChaChaBlocksFn chachaBlocks() {
+    static const ChaChaBlocksFn fn = [] {
+#ifdef WRAPPER_X86_SIMD
+        if (__builtin_cpu_supports("avx2")) return (ChaChaBlocksFn) chacha20Blocks_avx2;
+#endif
+        return (ChaChaBlocksFn) chacha20Blocks;
+    }();
+    return fn;
+}
+
+/**
+ * The curve order as 4 little-endian words
+ */
+static const uint64_t *orderWords() {
+    static uint64_t q[4];
+    static bool init = [] {
+        mpz_export(q, nullptr, -1, sizeof(uint64_t), 0, 0, getCurveOrder().get_mpz_t());
+        return true;
+    }();
+    (void) init;
+    return q;
+}
+
+static bool isScalar(const uint64_t w[4], const uint64_t q[4]) {
+    if ((w[0] | w[1] | w[2] | w[3]) == 0) return false;
+    for (int i = 3; i >= 0; --i) {
+        if (w[i] != q[i]) return w[i] < q[i];
+    }
+    return false;
+}
+
+/**
+ * Splits a 256-bit value into the 58-bit limbs of a BIG
+ */
+static void wordsToBIG(BIG b, const uint64_t w[4]) {
+    for (int k = 0; k < NLEN_B384_58; ++k) {
+        int bit = BASEBITS_B384_58 * k, idx = bit >> 6, off = bit & 63;
+        uint64_t v = idx < 4 ? w[idx] >> off : 0;
+        if (off > 64 - BASEBITS_B384_58 && idx + 1 < 4) v |= w[idx + 1] << (64 - off);
+        b[k] = (chunk) (v & (uint64_t) BMASK_B384_58);
+    }
+}
+
+ScalarRng::ScalarRng() {
+    unsigned char key[32];
+    random_device rd;
+    for (size_t i = 0; i < sizeof(key); i += 4) {
+        unsigned int v = rd();
+        memcpy(key + i, &v, 4);
+    }
+    setKey(key);
+}
+
+ScalarRng::ScalarRng(uint64_t seed) {
+    unsigned char key[32] = {0};
+    for (int i = 0; i < 8; ++i) key[i] = (unsigned char) (seed >> (8 * i));
+    setKey(key);
+}
+
+ScalarRng::ScalarRng(const unsigned char key[32]) {
+    setKey(key);
+}
+
+ScalarRng::ScalarRng(csprng &rng) {
+    unsigned char key[32];
+    for (unsigned char &b: key) b = (unsigned char) RAND_byte(&rng);
+    setKey(key);
+}
+
+void ScalarRng::setKey(const unsigned char key[32]) {
+    static const uint32_t SIGMA[4] = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574};  // "expand 32-byte k"
+    memcpy(state_, SIGMA, sizeof(SIGMA));
+    for (int i = 0; i < 8; ++i) {
+        state_[4 + i] = (uint32_t) key[4 * i] | (uint32_t) key[4 * i + 1] << 8 |
+                        (uint32_t) key[4 * i + 2] << 16 | (uint32_t) key[4 * i + 3] << 24;
+    }
+    state_[12] = state_[13] = state_[14] = state_[15] = 0;
+    counter_ = 0;
+    pos_ = sizeof(buf_);
+}
+
+void ScalarRng::refill() {
+    chachaBlocks()(state_, counter_, buf_);
+    counter_ += CHACHA_LANES;
+    pos_ = 0;
+}
+
+void ScalarRng::bytes(unsigned char *out, size_t len) {
+    while (len > 0) {
+        if (pos_ == sizeof(buf_)) refill();
+        size_t take = min(len, sizeof(buf_) - pos_);
+        memcpy(out, buf_ + pos_, take);
+        pos_ += take;
+        out += take;
+        len -= take;
+    }
+}
+
+void ScalarRng::candidates(uint64_t *words, size_t n) {
+    const uint64_t *q = orderWords();
+    size_t produced = 0;
+    while (produced < n) {
+        if (pos_ + 32 > sizeof(buf_)) refill();
+        // Scan what is left of the buffer in one pass
+        for (; pos_ + 32 <= sizeof(buf_) && produced < n; pos_ += 32) {
+            uint64_t *w = words + 4 * produced;
+            memcpy(w, buf_ + pos_, 32);
+            w[3] &= 0x7fffffffffffffffULL;
+            if (isScalar(w, q)) produced++;
+        }
+    }
+}
+
+// Candidates are drawn in blocks of this many scalars
+static const size_t FILL_BLOCK = 64;
+
+void ScalarRng::fill(BIG *out, size_t n) {
+    uint64_t words[4 * FILL_BLOCK];
+    for (size_t off = 0; off < n; off += FILL_BLOCK) {
+        size_t m = min(FILL_BLOCK, n - off);
+        candidates(words, m);
+        for (size_t i = 0; i < m; ++i) wordsToBIG(out[off + i], words + 4 * i);
+    }
+}
+
+void ScalarRng::fill(mpz_class *out, size_t n) {
+    uint64_t words[4 * FILL_BLOCK];
+    for (size_t off = 0; off < n; off += FILL_BLOCK) {
+        size_t m = min(FILL_BLOCK, n - off);
+        candidates(words, m);
+        for (size_t i = 0; i < m; ++i) {
+            mpz_import(out[off + i].get_mpz_t(), 4, -1, sizeof(uint64_t), 0, 0, words + 4 * i);
+        }
+    }
+}
+
+void ScalarRng::fill(Fr *out, size_t n) {
+    // Accepted words are used as the Montgomery representation directly
+    static_assert(sizeof(Fr) == 4 * sizeof(uint64_t), "Fr is four words");
+    if (n > 0) candidates(out[0].v, n);
+}
+
+mpz_class ScalarRng::nextMpz() {
+    mpz_class r;
+    fill(&r, 1);
+    return r;
+}
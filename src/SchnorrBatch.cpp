@@ -0,0 +1,199 @@
+#include "../include/SchnorrBatch.h"
+#include "../include/MSM.h"
+#include "../include/PointBatch.h"
+
+namespace {
+    const char *const CHALLENGE_TAG = "miracl-wrapper schnorr v1";
+
+    ECP msmOf(const ECP *points, const vector<mpz_class> &scalars) { return ECP_msm(points, scalars); }
+
+    ECP2 msmOf(const ECP2 *points, const vector<mpz_class> &scalars) { return ECP2_msm(points, scalars); }
+
+    ECP mul2Of(const ECP &P, const mpz_class &a, const ECP &Q, const mpz_class &b) { return ECP_mul2(P, a, Q, b); }
+
+    ECP2 mul2Of(const ECP2 &P, const mpz_class &a, const ECP2 &Q, const mpz_class &b) { return ECP2_mul2(P, a, Q, b); }
+
+    /**
+     * SHA-512 of the tag, the points and the message, reduced modulo q; the points should be
+     * affine so that encoding them costs no inversion
+     */
+    template<typename Point>
+    mpz_class challengeOf(const Point *points[3], const string &message) {
+        typedef GroupTraits<Point> G;
+        hash512 h;
+        HASH512_init(&h);
+        for (const char *p = CHALLENGE_TAG; *p; ++p) HASH512_process(&h, *p);
+        size_t size = G::encodedSize(true);
+        vector<char> buf(size);
+        for (int i = 0; i < 3; ++i) {
+            octet W = {0, (int) size, buf.data()};
+            Point P;
+            G::copy(P, *points[i]);
+            G::toOctet(W, P, true);
+            for (int j = 0; j < W.len; ++j) HASH512_process(&h, buf[j]);
+        }
+        // length prefix: messages cannot run into each other
+        uint64_t len = message.size();
+        for (int b = 7; b >= 0; --b) HASH512_process(&h, (int) (len >> (8 * b)) & 0xff);
+        for (char ch: message) HASH512_process(&h, ch);
+        char digest[64];
+        HASH512_hash(&h, digest);
+        mpz_class c;
+        mpz_import(c.get_mpz_t(), sizeof(digest), 1, 1, 0, 0, digest);
+        return c % getCurveOrder();
+    }
+
+    /**
+     * Random nonzero 128-bit weight
+     */
+    mpz_class weight(ScalarRng &rng) {
+        unsigned char bytes[16];
+        rng.bytes(bytes, sizeof(bytes));
+        bytes[15] |= 1;
+        mpz_class r;
+        mpz_import(r.get_mpz_t(), sizeof(bytes), 1, 1, 0, 0, bytes);
+        return r;
+    }
+
+    /**
+     * The weighted batch, with X_i and R_i negated once so that all MSM scalars stay small
+     * or reduced
+     */
+    template<typename Point>
+    struct Folded {
+        typedef GroupTraits<Point> G;
+        const Point &g;
+        vector<Point> negX, negR;
+        vector<mpz_class> r, rc, rs;         // r_i, r_i * c_i mod q, r_i * s_i mod q
+        SchnorrBatchResult result;
+
+        Folded(const Point &base, const vector<SchnorrProof<Point>> &proofs, ScalarRng &rng)
+            : g(base), negX(proofs.size()), negR(proofs.size()), r(proofs.size()), rc(proofs.size()),
+              rs(proofs.size()) {
+            const mpz_class &q = getCurveOrder();
+            for (size_t i = 0; i < proofs.size(); ++i) {
+                G::copy(negX[i], proofs[i].X);
+                G::neg(negX[i]);
+                G::copy(negR[i], proofs[i].R);
+                G::neg(negR[i]);
+                r[i] = weight(rng);
+                rc[i] = r[i] * proofs[i].c % q;
+                rs[i] = r[i] * proofs[i].s % q;
+            }
+        }
+
+        /**
+         * The combined equation of proofs [lo, hi)
+         */
+        bool check(size_t lo, size_t hi) {
+            result.checks++;
+            const mpz_class &q = getCurveOrder();
+            vector<Point> points(negX.begin() + lo, negX.begin() + hi);
+            vector<mpz_class> scalars(rc.begin() + lo, rc.begin() + hi);
+            mpz_class gScalar = 0;
+            for (size_t i = lo; i < hi; ++i) gScalar += rs[i];
+            points.push_back(g);
+            scalars.push_back(gScalar % q);
+            Point sum = msmOf(points.data(), scalars);
+            Point commitments = msmOf(negR.data() + lo, vector<mpz_class>(r.begin() + lo, r.begin() + hi));
+            G::add(sum, commitments);
+            return G::isInf(sum);
+        }
+
+        /**
+         * Isolates the failing proofs of [lo, hi); knownBad skips the check of a range whose
+         * failure follows from its parent failing and its sibling passing
+         */
+        void bisect(size_t lo, size_t hi, bool knownBad) {
+            if (!knownBad && check(lo, hi)) return;
+            if (hi - lo == 1) {
+                result.invalid.push_back(lo);
+                return;
+            }
+            size_t mid = lo + (hi - lo) / 2;
+            bool leftOk = check(lo, mid);
+            if (!leftOk) bisect(lo, mid, true);
+            bisect(mid, hi, leftOk);
+        }
+    };
+}
+
+template<typename Point>
+mpz_class Schnorr_challenge(const Point &g, const Point &X, const Point &R, const string &message) {
+    const Point *points[3] = {&g, &X, &R};
+    return challengeOf(points, message);
+}
+
+template<typename Point>
+void Schnorr_challenges(const Point &g, vector<SchnorrProof<Point>> &proofs, const vector<string> &messages) {
+    if (!messages.empty() && messages.size() != proofs.size()) {
+        throw invalid_argument("Schnorr_challenges: " + to_string(messages.size()) + " messages for " +
+                               to_string(proofs.size()) + " proofs");
+    }
+    // g, then X_i and R_i of every proof, normalized together
+    PointBatch<Point> points(2 * proofs.size() + 1);
+    GroupTraits<Point>::copy(points[0], g);
+    for (size_t i = 0; i < proofs.size(); ++i) {
+        GroupTraits<Point>::copy(points[2 * i + 1], proofs[i].X);
+        GroupTraits<Point>::copy(points[2 * i + 2], proofs[i].R);
+    }
+    points.normalize();
+    static const string none;
+    for (size_t i = 0; i < proofs.size(); ++i) {
+        const Point *p[3] = {&points[0], &points[2 * i + 1], &points[2 * i + 2]};
+        proofs[i].c = challengeOf(p, messages.empty() ? none : messages[i]);
+    }
+}
+
+template<typename Point>
+SchnorrProof<Point> Schnorr_prove(const Point &g, const mpz_class &x, const string &message, ScalarRng &rng) {
+    typedef GroupTraits<Point> G;
+    const mpz_class &q = getCurveOrder();
+    mpz_class k = rng.nextMpz();
+    SchnorrProof<Point> proof;
+    BIG b;
+    G::copy(proof.X, g);
+    mpz_class xr = (x % q + q) % q;
+    mpz_to_BIG(xr, b);
+    G::mul(proof.X, b);
+    G::copy(proof.R, g);
+    mpz_to_BIG(k, b);
+    G::mul(proof.R, b);
+    proof.c = Schnorr_challenge(g, proof.X, proof.R, message);
+    proof.s = (k + proof.c * xr) % q;
+    return proof;
+}
+
+template<typename Point>
+bool Schnorr_verify(const Point &g, const SchnorrProof<Point> &proof) {
+    Point lhs = mul2Of(g, proof.s, proof.X, -proof.c);
+    return GroupTraits<Point>::equals(lhs, proof.R);
+}
+
+template<typename Point>
+SchnorrBatchResult Schnorr_batchVerify(const Point &g, const vector<SchnorrProof<Point>> &proofs, ScalarRng &rng) {
+    if (proofs.empty()) return SchnorrBatchResult();
+    Folded<Point> folded(g, proofs, rng);
+    folded.bisect(0, proofs.size(), false);
+    folded.result.valid = folded.result.invalid.empty();
+    return folded.result;
+}
+
+template<typename Point>
+SchnorrBatchResult Schnorr_batchVerify(const Point &g, const vector<SchnorrProof<Point>> &proofs) {
+    static thread_local ScalarRng rng;
+    return Schnorr_batchVerify(g, proofs, rng);
+}
+
+template mpz_class Schnorr_challenge(const ECP &, const ECP &, const ECP &, const string &);
+template mpz_class Schnorr_challenge(const ECP2 &, const ECP2 &, const ECP2 &, const string &);
+template void Schnorr_challenges(const ECP &, vector<G1SchnorrProof> &, const vector<string> &);
+template void Schnorr_challenges(const ECP2 &, vector<G2SchnorrProof> &, const vector<string> &);
+template G1SchnorrProof Schnorr_prove(const ECP &, const mpz_class &, const string &, ScalarRng &);
+template G2SchnorrProof Schnorr_prove(const ECP2 &, const mpz_class &, const string &, ScalarRng &);
+template bool Schnorr_verify(const ECP &, const G1SchnorrProof &);
+template bool Schnorr_verify(const ECP2 &, const G2SchnorrProof &);
+template SchnorrBatchResult Schnorr_batchVerify(const ECP &, const vector<G1SchnorrProof> &, ScalarRng &);
+template SchnorrBatchResult Schnorr_batchVerify(const ECP2 &, const vector<G2SchnorrProof> &, ScalarRng &);
+template SchnorrBatchResult Schnorr_batchVerify(const ECP &, const vector<G1SchnorrProof> &);
+template SchnorrBatchResult Schnorr_batchVerify(const ECP2 &, const vector<G2SchnorrProof> &);
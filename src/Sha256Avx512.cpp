@@ -0,0 +1,7 @@
+// Compiled with -mavx512f (see CMakeLists.txt); only called after runtime CPU detection
+#define SHA256_LANES 16
+#include "Sha256Kernel.h"
+
+void sha256Lanes_avx512(const unsigned char *const *msgs, const size_t *lens, int count, unsigned char *digests) {
+    sha256Lanes(msgs, lens, count, digests);
+}
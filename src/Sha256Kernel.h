@@ -0,0 +1,126 @@
+#pragma once
+
+/**
+ * SHA-256 of several independent messages at once (one message per vector lane).
+ *
+ * Written with GCC/Clang vector extensions like ChaChaKernel.h: the including file defines
+ * SHA256_LANES (4 in the baseline objects, 8 in Sha256Avx2.cpp, 16 in Sha256Avx512.cpp) and
+ * the same code compiles to SSE2, AVX2 or AVX-512 lanes. Internal linkage and no STL, for the
+ * same reason as FpBatchKernel.h.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#ifndef SHA256_LANES
+#error "define SHA256_LANES before including Sha256Kernel.h"
+#endif
+
+namespace {
+
+    typedef uint32_t Sha256Vec __attribute__((vector_size(4 * SHA256_LANES)));
+
+    const uint32_t SHA256_K[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+    const uint32_t SHA256_H0[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                   0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+#define SHA256_ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+    inline uint32_t sha256Load(const unsigned char *p) {
+        return (uint32_t) p[0] << 24 | (uint32_t) p[1] << 16 | (uint32_t) p[2] << 8 | p[3];
+    }
+
+    /**
+     * The final one or two blocks of a message: the bytes after its last whole block, 0x80,
+     * zeros and the bit length
+     * @return Number of tail blocks
+     */
+    inline int sha256Tail(const unsigned char *msg, size_t len, unsigned char tail[128]) {
+        size_t whole = len & ~(size_t) 63, rest = len - whole;
+        int blocks = rest + 9 > 64 ? 2 : 1;
+        memset(tail, 0, 64 * blocks);
+        if (rest) memcpy(tail, msg + whole, rest);
+        tail[rest] = 0x80;
+        uint64_t bits = (uint64_t) len * 8;
+        for (int i = 0; i < 8; ++i) tail[64 * blocks - 1 - i] = (unsigned char) (bits >> (8 * i));
+        return blocks;
+    }
+
+    /**
+     * digests[32 * l ..] = SHA-256 of msgs[l] (lens[l] bytes) for l < count <= SHA256_LANES.
+     * Every lane runs the compression function on its own blocks; a lane whose message is
+     * shorter keeps its state once its blocks are done.
+     */
+    inline void sha256Lanes(const unsigned char *const *msgs, const size_t *lens, int count, unsigned char *digests) {
+        unsigned char tails[SHA256_LANES][128];
+        size_t blocks[SHA256_LANES], whole[SHA256_LANES], most = 0;
+        for (int l = 0; l < SHA256_LANES; ++l) {
+            if (l < count) {
+                whole[l] = lens[l] / 64;
+                blocks[l] = whole[l] + sha256Tail(msgs[l], lens[l], tails[l]);
+            } else {
+                whole[l] = blocks[l] = 0;
+            }
+            if (blocks[l] > most) most = blocks[l];
+        }
+        Sha256Vec h[8];
+        for (int i = 0; i < 8; ++i) {
+            for (int l = 0; l < SHA256_LANES; ++l) h[i][l] = SHA256_H0[i];
+        }
+        for (size_t b = 0; b < most; ++b) {
+            Sha256Vec w[16], active;
+            uint32_t words[16][SHA256_LANES];
+            for (int l = 0; l < SHA256_LANES; ++l) {
+                const unsigned char *block = b < whole[l] ? msgs[l] + 64 * b
+                                                          : b < blocks[l] ? tails[l] + 64 * (b - whole[l]) : tails[0];
+                for (int t = 0; t < 16; ++t) words[t][l] = sha256Load(block + 4 * t);
+                active[l] = b < blocks[l] ? 0xffffffffu : 0;
+            }
+            for (int t = 0; t < 16; ++t) memcpy(&w[t], words[t], sizeof(Sha256Vec));
+            Sha256Vec a = h[0], bb = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], hh = h[7];
+            for (int t = 0; t < 64; ++t) {
+                if (t >= 16) {
+                    Sha256Vec w15 = w[(t - 15) & 15], w2 = w[(t - 2) & 15];
+                    Sha256Vec s0 = SHA256_ROTR(w15, 7) ^ SHA256_ROTR(w15, 18) ^ (w15 >> 3);
+                    Sha256Vec s1 = SHA256_ROTR(w2, 17) ^ SHA256_ROTR(w2, 19) ^ (w2 >> 10);
+                    w[t & 15] += s0 + w[(t - 7) & 15] + s1;
+                }
+                Sha256Vec t1 = hh + (SHA256_ROTR(e, 6) ^ SHA256_ROTR(e, 11) ^ SHA256_ROTR(e, 25)) +
+                               ((e & f) ^ (~e & g)) + SHA256_K[t] + w[t & 15];
+                Sha256Vec t2 = (SHA256_ROTR(a, 2) ^ SHA256_ROTR(a, 13) ^ SHA256_ROTR(a, 22)) +
+                               ((a & bb) ^ (a & c) ^ (bb & c));
+                hh = g;
+                g = f;
+                f = e;
+                e = d + t1;
+                d = c;
+                c = bb;
+                bb = a;
+                a = t1 + t2;
+            }
+            Sha256Vec out[8] = {a, bb, c, d, e, f, g, hh};
+            for (int i = 0; i < 8; ++i) h[i] += out[i] & active;
+        }
+        for (int l = 0; l < count; ++l) {
+            for (int i = 0; i < 8; ++i) {
+                uint32_t v = h[i][l];
+                digests[32 * l + 4 * i] = (unsigned char) (v >> 24);
+                digests[32 * l + 4 * i + 1] = (unsigned char) (v >> 16);
+                digests[32 * l + 4 * i + 2] = (unsigned char) (v >> 8);
+                digests[32 * l + 4 * i + 3] = (unsigned char) v;
+            }
+        }
+    }
+
+#undef SHA256_ROTR
+}
@@ -0,0 +1,70 @@
+// Compiled with -msha -msse4.1 (see CMakeLists.txt); only called after runtime CPU detection
+#include <immintrin.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+static const uint32_t SHANI_K[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+/**
+ * One compression on the state held as ABEF / CDGH, the layout of the SHA instructions
+ */
+static inline void compress(__m128i &abef, __m128i &cdgh, const unsigned char *block) {
+    const __m128i swap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i m[4];
+    for (int i = 0; i < 4; ++i) {
+        m[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (block + 16 * i)), swap);
+    }
+    __m128i abefSave = abef, cdghSave = cdgh;
+    // 16 groups of 4 rounds; message words i + 4 .. are scheduled from the previous groups
+    for (int i = 0; i < 16; ++i) {
+        __m128i &cur = m[i & 3];
+        if (i >= 4) {
+            cur = _mm_sha256msg1_epu32(cur, m[(i + 1) & 3]);
+            cur = _mm_add_epi32(cur, _mm_alignr_epi8(m[(i + 3) & 3], m[(i + 2) & 3], 4));
+            cur = _mm_sha256msg2_epu32(cur, m[(i + 3) & 3]);
+        }
+        __m128i k = _mm_add_epi32(cur, _mm_loadu_si128((const __m128i *) &SHANI_K[4 * i]));
+        cdgh = _mm_sha256rnds2_epu32(cdgh, abef, k);
+        abef = _mm_sha256rnds2_epu32(abef, cdgh, _mm_shuffle_epi32(k, 0x0e));
+    }
+    abef = _mm_add_epi32(abef, abefSave);
+    cdgh = _mm_add_epi32(cdgh, cdghSave);
+}
+
+/**
+ * digest = SHA-256 of msg[0 .. len)
+ */
+void sha256_shani(const unsigned char *msg, size_t len, unsigned char *digest) {
+    // state words a..h as ABEF (a in the top lane) and CDGH
+    __m128i abef = _mm_set_epi32(0x6a09e667, 0xbb67ae85, 0x510e527f, 0x9b05688c);
+    __m128i cdgh = _mm_set_epi32(0x3c6ef372, 0xa54ff53a, 0x1f83d9ab, 0x5be0cd19);
+    size_t whole = len & ~(size_t) 63, rest = len - whole;
+    for (size_t off = 0; off < whole; off += 64) compress(abef, cdgh, msg + off);
+    unsigned char tail[128] = {0};
+    if (rest) memcpy(tail, msg + whole, rest);
+    tail[rest] = 0x80;
+    size_t tailLen = rest + 9 > 64 ? 128 : 64;
+    uint64_t bits = (uint64_t) len * 8;
+    for (int i = 0; i < 8; ++i) tail[tailLen - 1 - i] = (unsigned char) (bits >> (8 * i));
+    compress(abef, cdgh, tail);
+    if (tailLen == 128) compress(abef, cdgh, tail + 64);
+    uint32_t s[8];
+    _mm_storeu_si128((__m128i *) s, abef);          // f e b a
+    _mm_storeu_si128((__m128i *) (s + 4), cdgh);    // h g d c
+    const uint32_t h[8] = {s[3], s[2], s[7], s[6], s[1], s[0], s[5], s[4]};
+    for (int i = 0; i < 8; ++i) {
+        digest[4 * i] = (unsigned char) (h[i] >> 24);
+        digest[4 * i + 1] = (unsigned char) (h[i] >> 16);
+        digest[4 * i + 2] = (unsigned char) (h[i] >> 8);
+        digest[4 * i + 3] = (unsigned char) h[i];
+    }
+}
@@ -0,0 +1,244 @@
+#include "../include/Shamir.h"
+#include <stdexcept>
+
+// Secrets are shared in blocks so the coefficients of a block stay in cache while all
+// parties are evaluated
+static const size_t SHARE_BLOCK = 64;
+
+ShamirEngine::ShamirEngine(size_t parties, size_t threshold, ShamirDomain domain, size_t packing)
+        : n_(parties), t_(threshold), k_(packing), domain_(domain) {
+    if (n_ == 0 || t_ == 0 || t_ > n_) {
+        throw invalid_argument("Shamir: threshold must be in [1, parties]");
+    }
+    if (k_ == 0 || k_ > t_) {
+        throw invalid_argument("Shamir: packing must be in [1, threshold]");
+    }
+    if (k_ > 1 && domain_ != ShamirDomain::Integers) {
+        throw invalid_argument("Shamir: packed sharing requires the Integers domain");
+    }
+
+    points_.resize(n_);
+    if (domain_ == ShamirDomain::Integers) {
+        for (size_t p = 0; p < n_; ++p) Fr_fromU64(points_[p], p + 1);
+    } else {
+        nttSize_ = 1;
+        while (nttSize_ < n_ || nttSize_ < t_) nttSize_ <<= 1;
+        Fr omega;
+        Fr_rootOfUnity(omega, nttSize_);
+        Fr_one(points_[0]);
+        for (size_t p = 1; p < n_; ++p) Fr_mul(points_[p], points_[p - 1], omega);
+    }
+
+    if (k_ > 1) {
+        // Defining points: the k secret points followed by t - k points for the randomness
+        vector<Fr> def(t_);
+        for (size_t i = 0; i < t_; ++i) {
+            Fr_fromU64(def[i], i);
+            Fr_neg(def[i], def[i]);
+        }
+        vector<Fr> bary = baryWeights(def);
+        shareWeights_.resize(n_ * t_);
+        for (size_t p = 0; p < n_; ++p) {
+            lagrangeAt(&shareWeights_[p * t_], def, bary, points_[p]);
+        }
+    }
+}
+
+vector<Fr> ShamirEngine::secretPoints() const {
+    vector<Fr> pts(k_);
+    for (size_t s = 0; s < k_; ++s) {
+        Fr_fromU64(pts[s], s);
+        Fr_neg(pts[s], pts[s]);
+    }
+    return pts;
+}
+
+vector<Fr> ShamirEngine::baryWeights(const vector<Fr> &xs) {
+    size_t m = xs.size();
+    vector<Fr> w(m);
+    for (size_t i = 0; i < m; ++i) {
+        Fr acc, d;
+        Fr_one(acc);
+        for (size_t j = 0; j < m; ++j) {
+            if (i == j) continue;
+            Fr_sub(d, xs[i], xs[j]);
+            Fr_mul(acc, acc, d);
+        }
+        w[i] = acc;
+    }
+    Fr_batchInv(w.data(), w.data(), m);
+    return w;
+}
+
+void ShamirEngine::lagrangeAt(Fr *w, const vector<Fr> &xs, const vector<Fr> &bary, const Fr &target) {
+    size_t m = xs.size();
+    vector<Fr> diff(m);
+    for (size_t i = 0; i < m; ++i) {
+        Fr_sub(diff[i], target, xs[i]);
+        if (Fr_isZero(diff[i])) {
+            // target is one of the interpolation points
+            for (size_t j = 0; j < m; ++j) Fr_zero(w[j]);
+            Fr_one(w[i]);
+            return;
+        }
+    }
+    // w_i = bary_i * prod_{j != i} (target - x_j), from prefix and suffix products
+    Fr acc;
+    Fr_one(acc);
+    for (size_t i = 0; i < m; ++i) {
+        w[i] = acc;
+        Fr_mul(acc, acc, diff[i]);
+    }
+    Fr_one(acc);
+    for (size_t i = m; i-- > 0;) {
+        Fr_mul(w[i], w[i], acc);
+        Fr_mul(w[i], w[i], bary[i]);
+        Fr_mul(acc, acc, diff[i]);
+    }
+}
+
+ShamirShares ShamirEngine::share(const Fr *secrets, size_t count, csprng &rng) const {
+    ShamirShares out;
+    out.parties = n_;
+    out.secrets = count;
+    out.perParty = (count + k_ - 1) / k_;
+    out.data.resize(n_ * out.perParty);
+    size_t polys = out.perParty;
+
+    if (domain_ == ShamirDomain::RootsOfUnity) {
+        vector<Fr> buf(nttSize_);
+        for (size_t s = 0; s < polys; ++s) {
+            buf[0] = secrets[s];
+            for (size_t c = 1; c < t_; ++c) Fr_random(buf[c], rng);
+            for (size_t c = t_; c < nttSize_; ++c) Fr_zero(buf[c]);
+            Fr_ntt(buf.data(), nttSize_);
+            for (size_t p = 0; p < n_; ++p) out.data[p * polys + s] = buf[p];
+        }
+        return out;
+    }
+
+    // coeffs[c * SHARE_BLOCK + b]: coefficient c of polynomial b of the block (plain), or
+    // defining value c (packed: the k secrets then t - k random values)
+    vector<Fr> coeffs(t_ * SHARE_BLOCK);
+    Fr acc[SHARE_BLOCK];
+    for (size_t s0 = 0; s0 < polys; s0 += SHARE_BLOCK) {
+        size_t B = min(SHARE_BLOCK, polys - s0);
+        for (size_t b = 0; b < B; ++b) {
+            for (size_t c = 0; c < k_; ++c) {
+                size_t idx = (s0 + b) * k_ + c;
+                if (idx < count) {
+                    coeffs[c * SHARE_BLOCK + b] = secrets[idx];
+                } else {
+                    Fr_zero(coeffs[c * SHARE_BLOCK + b]);
+                }
+            }
+            for (size_t c = k_; c < t_; ++c) Fr_random(coeffs[c * SHARE_BLOCK + b], rng);
+        }
+
+        for (size_t p = 0; p < n_; ++p) {
+            Fr *dst = &out.data[p * polys + s0];
+            if (k_ == 1) {
+                // Horner at x_p, all polynomials of the block side by side
+                const Fr &x = points_[p];
+                for (size_t b = 0; b < B; ++b) acc[b] = coeffs[(t_ - 1) * SHARE_BLOCK + b];
+                for (size_t c = t_ - 1; c-- > 0;) {
+                    const Fr *row = &coeffs[c * SHARE_BLOCK];
+                    for (size_t b = 0; b < B; ++b) {
+                        Fr_mul(acc[b], acc[b], x);
+                        Fr_add(acc[b], acc[b], row[b]);
+                    }
+                }
+            } else {
+                // share_p = sum_c W[p][c] * value_c
+                const Fr *w = &shareWeights_[p * t_];
+                for (size_t b = 0; b < B; ++b) Fr_zero(acc[b]);
+                for (size_t c = 0; c < t_; ++c) {
+                    const Fr *row = &coeffs[c * SHARE_BLOCK];
+                    for (size_t b = 0; b < B; ++b) {
+                        Fr tmp;
+                        Fr_mul(tmp, w[c], row[b]);
+                        Fr_add(acc[b], acc[b], tmp);
+                    }
+                }
+            }
+            memcpy(dst, acc, B * sizeof(Fr));
+        }
+    }
+    return out;
+}
+
+ShamirShares ShamirEngine::share(const vector<mpz_class> &secrets, csprng &rng) const {
+    vector<Fr> s(secrets.size());
+    for (size_t i = 0; i < secrets.size(); ++i) Fr_fromMpz(s[i], secrets[i]);
+    return share(s.data(), s.size(), rng);
+}
+
+vector<Fr> ShamirEngine::reconstructionWeights(const vector<size_t> &ids) const {
+    if (ids.size() < t_) {
+        throw invalid_argument("Shamir: not enough shares to reconstruct");
+    }
+    vector<size_t> key(ids.begin(), ids.begin() + t_);
+    {
+        lock_guard<mutex> lock(cacheMutex_);
+        auto it = weightCache_.find(key);
+        if (it != weightCache_.end()) return it->second;
+    }
+
+    vector<Fr> xs(t_);
+    for (size_t i = 0; i < t_; ++i) {
+        if (key[i] >= n_) throw invalid_argument("Shamir: party index out of range");
+        xs[i] = points_[key[i]];
+    }
+    vector<Fr> bary = baryWeights(xs);
+    vector<Fr> targets = secretPoints();
+    vector<Fr> w(k_ * t_);
+    for (size_t s = 0; s < k_; ++s) {
+        lagrangeAt(&w[s * t_], xs, bary, targets[s]);
+    }
+
+    lock_guard<mutex> lock(cacheMutex_);
+    if (weightCache_.size() >= WEIGHT_CACHE_LIMIT) weightCache_.clear();
+    weightCache_[key] = w;
+    return w;
+}
+
+void ShamirEngine::preloadWeights(const vector<size_t> &ids, const Fr *weights) {
+    if (ids.size() < t_) {
+        throw invalid_argument("Shamir: not enough parties for the weights");
+    }
+    vector<size_t> key(ids.begin(), ids.begin() + t_);
+    lock_guard<mutex> lock(cacheMutex_);
+    if (weightCache_.size() >= WEIGHT_CACHE_LIMIT) weightCache_.clear();
+    weightCache_[key].assign(weights, weights + k_ * t_);
+}
+
+vector<Fr> ShamirEngine::reconstruct(const vector<size_t> &ids, const vector<const Fr *> &rows, size_t secrets) const {
+    assert(ids.size() == rows.size());
+    vector<Fr> w = reconstructionWeights(ids);
+    size_t polys = (secrets + k_ - 1) / k_;
+    vector<Fr> out(secrets);
+    for (size_t s = 0; s < k_; ++s) {
+        const Fr *ws = &w[s * t_];
+        for (size_t j = 0; j < polys; ++j) {
+            size_t idx = j * k_ + s;
+            if (idx >= secrets) continue;
+            Fr acc, tmp;
+            Fr_zero(acc);
+            for (size_t i = 0; i < t_; ++i) {
+                Fr_mul(tmp, ws[i], rows[i][j]);
+                Fr_add(acc, acc, tmp);
+            }
+            out[idx] = acc;
+        }
+    }
+    return out;
+}
+
+vector<Fr> ShamirEngine::reconstruct(const ShamirShares &shares, const vector<size_t> &ids) const {
+    vector<const Fr *> rows(ids.size());
+    for (size_t i = 0; i < ids.size(); ++i) {
+        if (ids[i] >= shares.parties) throw invalid_argument("Shamir: party index out of range");
+        rows[i] = shares.party(ids[i]);
+    }
+    return reconstruct(ids, rows, shares.secrets);
+}
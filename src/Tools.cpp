@@ -1,4 +1,11 @@
 #include "../include/Tools.h"
+#include "../include/Fr.h"
+#include "../include/Hex.h"
+#include "../include/Tuning.h"
+#include "ModInv.h"
+#include "CurveKernels.h"
+#include "GmpHeapScope.h"
+#include "TraceScope.h"
 
 void initRNG(csprng *rng) {
     char raw[100];
@@ -19,112 +26,145 @@ void initRNG(csprng *rng) {
 
 
 void randBig(BIG big, csprng &rng) {
-    BIG mod;
-    BIG_rcopy(mod, CURVE_Order);
+    static BIG mod;
+    static bool init = (BIG_rcopy(mod, CURVE_Order), true);
+    (void) init;
     BIG_randtrunc(big, mod, 2 * CURVE_SECURITY_BLS12381, &rng);
 }
 
+/**
+ * Bits of |v| (at least 1), the size of a scalar or modulus argument in a trace
+ */
+static uint64_t traceBits(const mpz_class &v) {
+    return mpz_sizeinbase(v.get_mpz_t(), 2);
+}
+
+/**
+ * Captures two mpz arguments as the BIGs the BIG overload of the call would record
+ */
+static void traceBigs(TraceScope &trace, const mpz_class &a, const mpz_class &b) {
+    BIG ab, bb;
+    mpz_to_BIG(a, ab);
+    mpz_to_BIG(b, bb);
+    trace.big(ab).big(bb);
+}
+
 ECP randECP(csprng &rng) {
+    TraceScope trace(TraceOp::RandECP, 0);
+    trace.start();
     ECP ecp;
     ECP_generator(&ecp);
     BIG r;
     randBig(r, rng);
-    ECP_mul(&ecp, r);
+    curveKernels().ecpMul(&ecp, r);
     return ecp;
 }
 
 ECP2 randECP2(csprng &rng) {
+    TraceScope trace(TraceOp::RandECP2, 0);
+    trace.start();
     ECP2 ecp2;
     ECP2_generator(&ecp2);
     BIG r;
     randBig(r, rng);
-    ECP2_mul(&ecp2, r);
+    curveKernels().ecp2Mul(&ecp2, r);
     return ecp2;
 }
 
 string charsToString(char *ch) {
-    ostringstream oss;
-    for (size_t i = 0; i < 48; ++i) {
-        unsigned char ucharValue = static_cast<unsigned char>(ch[i]);
-        oss << hex << setw(2) << setfill('0') << static_cast<int>(ucharValue);
-    }
-    return oss.str();
+    return Hex_encode((const unsigned char *) ch, 48);
 }
 
 mpz_class BIG_to_mpz(BIG big) {
     char ch[48];
     BIG_toBytes(ch, big);
     mpz_class t;
-    t.set_str(charsToString(ch).c_str(), 16);
+    mpz_import(t.get_mpz_t(), sizeof(ch), 1, 1, 0, 0, ch);
     return t;
 }
 
 void mpz_to_BIG(const mpz_class &t, BIG &big) {
-    std::string hexStr = t.get_str(16);
-
-    if (hexStr.length() < 64) {
-        hexStr.insert(0, 64 - hexStr.length(), '0');
-    }
-    char ch[32] = {0};
-    for (size_t i = 0; i < 32; ++i) {
-        std::string byteStr = hexStr.substr(2 * i, 2);
-        ch[i] = static_cast<unsigned char>(strtol(byteStr.c_str(), nullptr, 16));
+    char ch[48] = {0};
+    size_t n = (mpz_sizeinbase(t.get_mpz_t(), 2) + 7) / 8;
+    if (n > sizeof(ch)) {
+        throw invalid_argument("mpz_to_BIG: value exceeds 384 bits");
     }
-    BIG_fromBytesLen(big, ch, 32);
+    // magnitude, right-aligned big-endian
+    mpz_export(ch + sizeof(ch) - n, nullptr, 1, 1, 0, 0, t.get_mpz_t());
+    BIG_fromBytes(big, ch);
 }
 
 void str_to_BIG(string hex_string, BIG &big) {
-    if (hex_string.length() < 96) {
-        hex_string.insert(0, 96 - hex_string.length(), '0');
-    }
-    char byte_array[48];
-    for (size_t i = 0; i < 48; i++) {
-        sscanf(hex_string.substr(i * 2, 2).c_str(), "%2hhx", &byte_array[i]);
-    }
-    BIG_fromBytes(big, byte_array);
+    Hex_decodeBIG(big, hex_string.data(), hex_string.size());
 }
 
-
 void ECP_mul(ECP &P1, const mpz_class &t) {
+    TraceScope trace(TraceOp::ECP_mul, traceBits(t));
+    if (trace.capturing()) trace.point(P1).mpz(t);
+    trace.start();
     BIG t1;
     mpz_to_BIG(t, t1);
-    ECP_mul(&P1, t1);
+    curveKernels().ecpMul(&P1, t1);
 }
 
 void ECP2_mul(ECP2 &P2, const mpz_class &t) {
+    TraceScope trace(TraceOp::ECP2_mul, traceBits(t));
+    if (trace.capturing()) trace.point(P2).mpz(t);
+    trace.start();
     BIG t1;
     mpz_to_BIG(t, t1);
-    ECP2_mul(&P2, t1);
+    curveKernels().ecp2Mul(&P2, t1);
 }
 
 void FP12_mulMy(FP12 &a, FP12 &b) {
+    TraceScope trace(TraceOp::FP12_mul, 0);
+    if (trace.capturing()) trace.gt(a).gt(b);
+    trace.start();
     FP12_mul(&a, &b);
     FP12_reduce(&a);
 }
 
 void FP12_pow(FP12 &r, const mpz_class &exp) {
+    TraceScope trace(TraceOp::FP12_pow, traceBits(exp));
+    if (trace.capturing()) trace.gt(r).mpz(exp);
+    trace.start();
     BIG exp_big;
     mpz_to_BIG(exp, exp_big);
-    FP12_pow(&r, &r, exp_big);
-    FP12_reduce(&r);
+    curveKernels().gtPow(&r, exp_big);
 }
 
 void FP12_inv(FP12 &r) {
+    TraceScope trace(TraceOp::FP12_inv, 0);
+    if (trace.capturing()) trace.gt(r);
+    trace.start();
     FP12_inv(&r, &r);
     FP12_reduce(&r);
 }
 
 FP12 e(ECP P1, ECP2 P2) {
+    TraceScope trace(TraceOp::Pairing, 0);
+    if (trace.capturing()) trace.point(P1).point(P2);
+    trace.start();
     FP12 temp1;
-    PAIR_ate(&temp1, &P2, &P1);
-    PAIR_fexp(&temp1);
-    FP12_reduce(&temp1);
+    curveKernels().pair(&temp1, &P1, &P2);
     if (FP12_isunity(&temp1) || FP12_iszilch(&temp1)) {
         printf("pairing error [temp1]\n");
     }
     return temp1;
 }
 
+bool pairingProductIsOne(const vector<ECP> &P1, const vector<ECP2> &P2) {
+    assert(P1.size() == P2.size());
+    TraceScope trace(TraceOp::PairingProduct, P1.size());
+    if (trace.capturing()) {
+        trace.count(P1.size());
+        for (const ECP &P: P1) trace.point(P);
+        for (const ECP2 &P: P2) trace.point(P);
+    }
+    trace.start();
+    return curveKernels().productIsOne(P1.data(), P2.data(), P1.size());
+}
+
 void initState(gmp_randstate_t &state) {
     gmp_randinit_default(state);
     gmp_randseed_ui(state, duration_cast<nanoseconds>(high_resolution_clock::now().time_since_epoch()).count());
@@ -132,26 +172,125 @@ void initState(gmp_randstate_t &state) {
 
 mpz_class rand_mpz(gmp_randstate_t state) {
     mpz_class res;
-    mpz_class max_value = 0x73EDA753299D7D483339D80809A1D80553BDA402FFFE5BFEFFFFFFFF00000001_mpz;  // 设置最大值为 椭圆曲线阶-1
+    static const mpz_class max_value = [] {  // 设置最大值为 椭圆曲线阶-1
+        GmpHeapScope heap;
+        return mpz_class(getCurveOrder() - 1);
+    }();
     mpz_urandomm(res.get_mpz_t(), state, max_value.get_mpz_t());
     return res + 1;
 }
 
+const mpz_class &getCurveOrder() {
+    static const mpz_class order = [] {
+        GmpHeapScope heap;
+        BIG q;
+        BIG_rcopy(q, CURVE_Order);
+        return BIG_to_mpz(q);
+    }();
+    return order;
+}
+
 mpz_class pow_mpz(const mpz_class &base, const mpz_class &exp, const mpz_class &mod) {
+    TraceScope trace(TraceOp::PowMpz, traceBits(exp));
+    if (trace.capturing()) trace.mpz(base).mpz(exp).mpz(mod);
+    trace.start();
+    if (Tuning_active().frPow && exp >= 0 && mpz_sizeinbase(exp.get_mpz_t(), 2) <= 256 && mod == getCurveOrder()) {
+        Fr b, r;
+        uint64_t e[4] = {0, 0, 0, 0};
+        Fr_fromMpz(b, base);
+        mpz_export(e, nullptr, -1, sizeof(uint64_t), 0, 0, exp.get_mpz_t());
+        Fr_pow(r, b, e);
+        return Fr_toMpz(r);
+    }
     mpz_class res;
     mpz_powm(res.get_mpz_t(), base.get_mpz_t(), exp.get_mpz_t(), mod.get_mpz_t());
     return res;
 }
 
+/**
+ * Exports 0 <= v < 2^384 as MODINV_WORDS little-endian words
+ */
+static void mpzToWords(uint64_t w[MODINV_WORDS], const mpz_class &v) {
+    memset(w, 0, MODINV_WORDS * sizeof(uint64_t));
+    mpz_export(w, nullptr, -1, sizeof(uint64_t), 0, 0, v.get_mpz_t());
+}
+
 mpz_class invert_mpz(const mpz_class &a, const mpz_class &m) {
+    TraceScope trace(TraceOp::InvertMpz, traceBits(m));
+    if (trace.capturing()) trace.mpz(a).mpz(m);
+    trace.start();
     mpz_class res;
+    if (mpz_odd_p(m.get_mpz_t()) && m > 1 && mpz_sizeinbase(m.get_mpz_t(), 2) <= 64 * MODINV_WORDS &&
+        Tuning_active().divstepsInverse) {
+        uint64_t mw[MODINV_WORDS], aw[MODINV_WORDS], rw[MODINV_WORDS];
+        mpzToWords(mw, m);
+        if (a >= 0 && a < m) {
+            mpzToWords(aw, a);
+        } else {
+            mpz_class t;
+            mpz_mod(t.get_mpz_t(), a.get_mpz_t(), m.get_mpz_t());
+            mpzToWords(aw, t);
+        }
+        ModInvModulus M;
+        modinvSetup(M, mw);
+        modinv(rw, aw, M, false);
+        mpz_import(res.get_mpz_t(), MODINV_WORDS, -1, sizeof(uint64_t), 0, 0, rw);
+        return res;
+    }
     mpz_invert(res.get_mpz_t(), a.get_mpz_t(), m.get_mpz_t());
     return res;
 }
 
+vector<mpz_class> invert_mpz_batch(const vector<mpz_class> &a, const mpz_class &m) {
+    size_t n = a.size();
+    TraceScope trace(TraceOp::InvertMpzBatch, n);
+    if (trace.capturing()) {
+        trace.count(n);
+        for (const mpz_class &v: a) trace.mpz(v);
+        trace.mpz(m);
+    }
+    trace.start();
+    vector<mpz_class> res(n);
+    if (m == getCurveOrder()) {
+        vector<Fr> f(n);
+        for (size_t i = 0; i < n; ++i) Fr_fromMpz(f[i], a[i]);
+        Fr_batchInv(f.data(), f.data(), n);
+        for (size_t i = 0; i < n; ++i) res[i] = Fr_toMpz(f[i]);
+        return res;
+    }
+    // prefix[i] = a[0] * ... * a[i-1] over the nonzero residues
+    vector<mpz_class> red(n), prefix(n);
+    mpz_class acc = 1;
+    for (size_t i = 0; i < n; ++i) {
+        mpz_mod(red[i].get_mpz_t(), a[i].get_mpz_t(), m.get_mpz_t());
+        prefix[i] = acc;
+        if (red[i] != 0) acc = acc * red[i] % m;
+    }
+    mpz_class inv = invert_mpz(acc, m);
+    if (inv == 0) {
+        // some element shares a factor with m: invert one by one
+        for (size_t i = 0; i < n; ++i) res[i] = red[i] == 0 ? mpz_class(0) : invert_mpz(red[i], m);
+        return res;
+    }
+    for (size_t i = n; i-- > 0;) {
+        if (red[i] == 0) continue;
+        res[i] = inv * prefix[i] % m;
+        inv = inv * red[i] % m;
+    }
+    return res;
+}
+
 vector<mpz_class> getLagrangeCoffs(const vector<mpz_class> &x, const vector<mpz_class> &y, const mpz_class &modulus) {
     size_t n = x.size();
     assert(n == y.size() && n > 0);
+    TraceScope trace(TraceOp::LagrangeCoffs, n);
+    if (trace.capturing()) {
+        trace.count(n);
+        for (const mpz_class &v: x) trace.mpz(v);
+        for (const mpz_class &v: y) trace.mpz(v);
+        trace.mpz(modulus);
+    }
+    trace.start();
     vector<mpz_class> result(n, 0);
     for (size_t i = 0; i < n; ++i) {
         vector<mpz_class> basis(1, 1);
@@ -194,6 +333,13 @@ vector<mpz_class> getLagrangeCoffs(const vector<mpz_class> &x, const vector<mpz_
 }
 
 mpz_class computePoly(const vector<mpz_class> &poly, const mpz_class &x, const mpz_class &modulus) {
+    TraceScope trace(TraceOp::ComputePoly, poly.size());
+    if (trace.capturing()) {
+        trace.count(poly.size());
+        for (const mpz_class &v: poly) trace.mpz(v);
+        trace.mpz(x).mpz(modulus);
+    }
+    trace.start();
     mpz_class result = 0;
     mpz_class power = 1;
     for (const auto &coef: poly) {
@@ -205,6 +351,13 @@ mpz_class computePoly(const vector<mpz_class> &poly, const mpz_class &x, const m
 
 vector<mpz_class> getLagrangeBasis(const vector<mpz_class> &x, const mpz_class &q) {
     size_t n = x.size();
+    TraceScope trace(TraceOp::LagrangeBasis, n);
+    if (trace.capturing()) {
+        trace.count(n);
+        for (const mpz_class &v: x) trace.mpz(v);
+        trace.mpz(q);
+    }
+    trace.start();
     vector<mpz_class> lambdas(n);
     for (size_t i = 0; i < n; ++i) {
         mpz_class numerator = 1, denominator = 1;
@@ -240,9 +393,7 @@ void showOctet(const octet *S) {
     printf("Octet={max:%d,", S->max);
     printf("len:%d,", S->len);
     printf("data:");
-    for (int i = 0; i < S->len; i++) {
-        printf("%02x", (unsigned char) S->val[i]); // Print each byte in hex
-    }
+    fputs(Hex_encodeOctet(*S).c_str(), stdout);
     printf("}\n");
 }
 
@@ -302,6 +453,9 @@ octet mpzToOctet(const mpz_class &num) {
 }
 
 void hashZp256(BIG res, octet *ct, BIG q) {
+    TraceScope trace(TraceOp::HashZp256, (uint64_t) ct->max);
+    if (trace.capturing()) trace.bytes(ct->val, ct->max).big(q);
+    trace.start();
     hash256 h;
     char hashstr[48];
     memset(hashstr, 0, 48);
@@ -315,6 +469,9 @@ void hashZp256(BIG res, octet *ct, BIG q) {
 }
 
 void hashToZp256(BIG res, BIG beHashed, BIG q) {
+    TraceScope trace(TraceOp::HashToZp256, MODBYTES_B384_58);
+    if (trace.capturing()) trace.big(beHashed).big(q);
+    trace.start();
     char idChar[48];
     BIG_toBytes(idChar, beHashed);
     octet id_i_oc;
@@ -324,6 +481,9 @@ void hashToZp256(BIG res, BIG beHashed, BIG q) {
 }
 
 mpz_class hashToZp256(mpz_class beHashed, mpz_class q) {
+    TraceScope trace(TraceOp::HashToZp256, MODBYTES_B384_58);
+    if (trace.capturing()) traceBigs(trace, beHashed, q);
+    trace.start();
     mpz_class res;
     BIG res_b, beHashed_b, module_b;
     mpz_to_BIG(res, res_b);
@@ -334,22 +494,31 @@ mpz_class hashToZp256(mpz_class beHashed, mpz_class q) {
 }
 
 ECP hashToPoint(BIG big, BIG q) {
+    TraceScope trace(TraceOp::HashToPoint, MODBYTES_B384_58);
+    if (trace.capturing()) trace.big(big).big(q);
+    trace.start();
     BIG hash;
     hashToZp256(hash, big, q);
     ECP res;
     ECP_generator(&res);
-    ECP_mul(&res, hash);
+    curveKernels().ecpMul(&res, hash);
     return res;
 }
 
 ECP hashToPoint(mpz_class big, mpz_class q) {
+    TraceScope trace(TraceOp::HashToPoint, MODBYTES_B384_58);
+    if (trace.capturing()) traceBigs(trace, big, q);
+    trace.start();
     BIG tb, tq;
     mpz_to_BIG(big, tb);
     mpz_to_BIG(q, tq);
     return hashToPoint(tb, tq);
 }
 
-void BIG_inv(BIG &res, const BIG a, const BIG m) {
+/**
+ * Extended Euclidean inversion, for even moduli
+ */
+static void BIG_invEuclid(BIG &res, const BIG a, const BIG m) {
     BIG m0, x0, x1, one, a_back, module;
     // 此处大费周折复制变量是为了防止求逆元时改变了参数a,m的值
     BIG_rcopy(a_back, a);
@@ -379,6 +548,95 @@ void BIG_inv(BIG &res, const BIG a, const BIG m) {
     BIG_copy(res, x1);
 }
 
+/**
+ * Splits a normalized BIG below 2^384 into MODINV_WORDS little-endian words
+ */
+static void bigToWords(uint64_t w[MODINV_WORDS], const BIG a) {
+    memset(w, 0, MODINV_WORDS * sizeof(uint64_t));
+    for (int k = 0; k < NLEN_B384_58; ++k) {
+        int bit = BASEBITS_B384_58 * k, idx = bit >> 6, off = bit & 63;
+        uint64_t v = (uint64_t) a[k];
+        if (idx < (int) MODINV_WORDS) w[idx] |= v << off;
+        if (off > 64 - BASEBITS_B384_58 && idx + 1 < (int) MODINV_WORDS) w[idx + 1] |= v >> (64 - off);
+    }
+}
+
+static void wordsToBig(BIG b, const uint64_t w[MODINV_WORDS]) {
+    for (int k = 0; k < NLEN_B384_58; ++k) {
+        int bit = BASEBITS_B384_58 * k, idx = bit >> 6, off = bit & 63;
+        uint64_t v = idx < (int) MODINV_WORDS ? w[idx] >> off : 0;
+        if (off > 64 - BASEBITS_B384_58 && idx + 1 < (int) MODINV_WORDS) v |= w[idx + 1] << (64 - off);
+        b[k] = (chunk) (v & (uint64_t) BMASK_B384_58);
+    }
+}
+
+void BIG_inv(BIG &res, const BIG a, const BIG m, bool constantTime) {
+    BIG mm, aa;
+    BIG_rcopy(mm, m);
+    BIG_rcopy(aa, a);
+    BIG_norm(mm);
+    BIG_norm(aa);
+    TraceScope trace(constantTime ? TraceOp::BigInvConstantTime : TraceOp::BigInv, BIG_nbits(mm));
+    if (trace.capturing()) trace.big(aa).big(mm);
+    trace.start();
+    if (BIG_parity(mm) == 0) {
+        if (constantTime) throw invalid_argument("BIG_inv: constant-time inversion needs an odd modulus");
+        BIG_invEuclid(res, aa, mm);
+        return;
+    }
+    if (!constantTime) BIG_mod(aa, mm);
+    uint64_t mw[MODINV_WORDS], aw[MODINV_WORDS], rw[MODINV_WORDS];
+    bigToWords(mw, mm);
+    bigToWords(aw, aa);
+    ModInvModulus M;
+    modinvSetup(M, mw);
+    modinv(rw, aw, M, constantTime);
+    wordsToBig(res, rw);
+}
+
+void BIG_batchInv(BIG *r, const BIG *a, size_t n, const BIG m) {
+    BIG mm, order;
+    BIG_rcopy(mm, m);
+    BIG_norm(mm);
+    TraceScope trace(TraceOp::BigBatchInv, n);
+    if (trace.capturing()) {
+        trace.count(n);
+        for (size_t i = 0; i < n; ++i) trace.big(a[i]);
+        trace.big(mm);
+    }
+    trace.start();
+    BIG_rcopy(order, CURVE_Order);
+    if (BIG_comp(mm, order) == 0) {
+        vector<Fr> f(n);
+        for (size_t i = 0; i < n; ++i) {
+            BIG t;
+            BIG_rcopy(t, a[i]);
+            BIG_mod(t, mm);
+            Fr_fromBIG(f[i], t);
+        }
+        Fr_batchInv(f.data(), f.data(), n);
+        for (size_t i = 0; i < n; ++i) Fr_toBIG(r[i], f[i]);
+        return;
+    }
+    uint64_t w[MODINV_WORDS];
+    vector<mpz_class> v(n);
+    for (size_t i = 0; i < n; ++i) {
+        BIG t;
+        BIG_rcopy(t, a[i]);
+        BIG_mod(t, mm);
+        bigToWords(w, t);
+        mpz_import(v[i].get_mpz_t(), MODINV_WORDS, -1, sizeof(uint64_t), 0, 0, w);
+    }
+    bigToWords(w, mm);
+    mpz_class mz;
+    mpz_import(mz.get_mpz_t(), MODINV_WORDS, -1, sizeof(uint64_t), 0, 0, w);
+    v = invert_mpz_batch(v, mz);
+    for (size_t i = 0; i < n; ++i) {
+        mpzToWords(w, v[i]);
+        wordsToBig(r[i], w);
+    }
+}
+
 void showBIG(BIG big) {
     BIG_output(big);
     cout << endl;
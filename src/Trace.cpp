@@ -0,0 +1,803 @@
+#include "TraceScope.h"
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <mutex>
+
+atomic<bool> traceEnabled{false};
+
+namespace {
+    const char TRACE_MAGIC[8] = {'W', 'T', 'R', 'A', 'C', 'E', 0, 0};
+    const uint32_t TRACE_INPUTS = 1;          // header flag: records carry their inputs
+    const size_t CHUNK_BYTES = 1 << 16;       // a thread's records are written in chunks of about this size
+
+    const char *const OP_NAMES[] = {
+            "ECP_mul", "ECP2_mul", "FP12_mulMy", "FP12_pow", "FP12_inv", "e", "pairingProductIsOne", "pow_mpz",
+            "invert_mpz", "invert_mpz_batch", "getLagrangeCoffs", "computePoly", "getLagrangeBasis", "hashZp256",
+            "hashToZp256", "hashToPoint", "BIG_inv", "BIG_inv(constantTime)", "BIG_batchInv", "randECP", "randECP2"};
+    static_assert(sizeof(OP_NAMES) / sizeof(OP_NAMES[0]) == (size_t) TraceOp::Count, "one name per TraceOp");
+
+    thread_local int traceDepth = 0;          // TraceScopes entered on this thread
+
+    void putVarint(vector<unsigned char> &out, uint64_t v) {
+        while (v >= 0x80) {
+            out.push_back((unsigned char) (v | 0x80));
+            v >>= 7;
+        }
+        out.push_back((unsigned char) v);
+    }
+
+    void putU32(vector<unsigned char> &out, uint32_t v) {
+        for (int i = 0; i < 4; ++i) out.push_back((unsigned char) (v >> (8 * i)));
+    }
+
+    struct ThreadBuffer;
+
+    struct TraceState {
+        mutex lock;                           // taken before any ThreadBuffer::lock
+        FILE *file = nullptr;
+        // written by Trace_start while calls of the previous trace may still be finishing
+        atomic<bool> capture{false};
+        atomic<int64_t> epoch{0};             // steady_clock nanoseconds at Trace_start
+        atomic<uint64_t> generation{0};       // advanced by every start and stop
+        atomic<uint32_t> nextThread{0};
+        vector<ThreadBuffer *> buffers;
+    };
+
+    TraceState &state() {
+        static TraceState s;
+        return s;
+    }
+
+    /**
+     * The pending chunk of one thread
+     */
+    struct ThreadBuffer {
+        mutex lock;
+        vector<unsigned char> bytes;
+        uint64_t generation = 0;              // trace the chunk belongs to
+        uint32_t thread = 0;
+        uint64_t last = 0;                    // start of the previous record of the chunk
+
+        ThreadBuffer() {
+            TraceState &s = state();
+            lock_guard<mutex> g(s.lock);
+            s.buffers.push_back(this);
+        }
+
+        ~ThreadBuffer() {
+            TraceState &s = state();
+            lock_guard<mutex> g(s.lock);
+            {
+                lock_guard<mutex> b(lock);
+                flushLocked(s);
+            }
+            s.buffers.erase(find(s.buffers.begin(), s.buffers.end(), this));
+        }
+
+        /**
+         * Writes the chunk; needs the state lock and this buffer's lock
+         */
+        void flushLocked(TraceState &s) {
+            if (!bytes.empty() && s.file != nullptr && generation == s.generation.load()) {
+                vector<unsigned char> header;
+                putU32(header, (uint32_t) bytes.size());
+                putU32(header, thread);
+                fwrite(header.data(), 1, header.size(), s.file);
+                fwrite(bytes.data(), 1, bytes.size(), s.file);
+            }
+            bytes.clear();
+            last = 0;
+        }
+    };
+
+    /**
+     * Adds a record to the calling thread's chunk; a call that began under an earlier trace
+     * (generation) is dropped
+     */
+    void append(TraceOp op, uint64_t size, uint64_t generation, steady_clock::time_point start,
+                steady_clock::time_point end, const vector<unsigned char> &input) {
+        static thread_local ThreadBuffer buf;
+        TraceState &s = state();
+        unique_lock<mutex> g(buf.lock);
+        if (generation != s.generation.load()) return;
+        if (buf.generation != generation) {
+            buf.bytes.clear();
+            buf.generation = generation;
+            buf.thread = s.nextThread++;
+            buf.last = 0;
+        }
+        int64_t since = duration_cast<nanoseconds>(start.time_since_epoch()).count() - s.epoch.load();
+        auto at = (uint64_t) max<int64_t>(0, since);
+        at = max(at, buf.last);
+        buf.bytes.push_back((unsigned char) op);
+        putVarint(buf.bytes, size);
+        putVarint(buf.bytes, at - buf.last);
+        putVarint(buf.bytes, (uint64_t) duration_cast<nanoseconds>(end - start).count());
+        if (s.capture.load()) {
+            putVarint(buf.bytes, input.size());
+            buf.bytes.insert(buf.bytes.end(), input.begin(), input.end());
+        }
+        buf.last = at;
+        if (buf.bytes.size() < CHUNK_BYTES) return;
+        g.unlock();
+        lock_guard<mutex> sg(s.lock);
+        lock_guard<mutex> bg(buf.lock);
+        buf.flushLocked(s);
+    }
+
+    /**
+     * Starts a trace named by WRAPPER_TRACE when the library is loaded and completes it at exit
+     */
+    struct EnvTrace {
+        EnvTrace() {
+            // built first, so the state outlives this object and the destructor below may use it
+            state();
+            const char *path = getenv("WRAPPER_TRACE");
+            if (path == nullptr || *path == 0) return;
+            const char *inputs = getenv("WRAPPER_TRACE_INPUTS");
+            try {
+                Trace_start(path, inputs != nullptr && strcmp(inputs, "1") == 0);
+            } catch (const runtime_error &e) {
+                cerr << "WRAPPER_TRACE: " << e.what() << endl;
+            }
+        }
+
+        ~EnvTrace() { Trace_stop(); }
+    } envTrace;
+}
+
+const char *TraceOp_name(TraceOp op) {
+    return op < TraceOp::Count ? OP_NAMES[(size_t) op] : "unknown";
+}
+
+void TraceScope::enter(TraceOp op, uint64_t size) {
+    entered_ = true;
+    if (traceDepth++ > 0) return;
+    recording_ = true;
+    generation_ = state().generation.load();
+    capture_ = state().capture.load();
+    op_ = op;
+    size_ = size;
+    start_ = steady_clock::now();
+}
+
+void TraceScope::leave() {
+    if (recording_ && traceEnabled.load(memory_order_acquire)) {
+        append(op_, size_, generation_, start_, steady_clock::now(), input_);
+    }
+    --traceDepth;
+}
+
+TraceScope &TraceScope::count(uint64_t n) {
+    putVarint(input_, n);
+    return *this;
+}
+
+TraceScope &TraceScope::bytes(const void *data, size_t len) {
+    putVarint(input_, len);
+    const unsigned char *p = (const unsigned char *) data;
+    input_.insert(input_.end(), p, p + len);
+    return *this;
+}
+
+TraceScope &TraceScope::mpz(const mpz_class &v) {
+    input_.push_back(v < 0 ? 1 : 0);
+    size_t len = (mpz_sizeinbase(v.get_mpz_t(), 2) + 7) / 8;
+    vector<unsigned char> mag(len);
+    if (v != 0) mpz_export(mag.data(), &len, 1, 1, 0, 0, v.get_mpz_t());
+    return bytes(mag.data(), v != 0 ? len : 0);
+}
+
+TraceScope &TraceScope::big(const BIG v) {
+    BIG t;
+    char raw[MODBYTES_B384_58];
+    BIG_rcopy(t, v);
+    BIG_toBytes(raw, t);
+    return bytes(raw, sizeof(raw));
+}
+
+TraceScope &TraceScope::point(const ECP &P) {
+    char raw[2 * MODBYTES_B384_58 + 1];
+    octet W = {0, sizeof(raw), raw};
+    ECP t = P;
+    ECP_toOctet(&W, &t, false);
+    return bytes(raw, W.len);
+}
+
+TraceScope &TraceScope::point(const ECP2 &P) {
+    char raw[4 * MODBYTES_B384_58 + 1];
+    octet W = {0, sizeof(raw), raw};
+    ECP2 t = P;
+    ECP2_toOctet(&W, &t, false);
+    return bytes(raw, W.len);
+}
+
+TraceScope &TraceScope::gt(const FP12 &x) {
+    char raw[12 * MODBYTES_B384_58];
+    octet W = {0, sizeof(raw), raw};
+    FP12 t = x;
+    FP12_toOctet(&W, &t);
+    return bytes(raw, W.len);
+}
+
+void Trace_start(const string &path, bool captureInputs) {
+    TraceState &s = state();
+    lock_guard<mutex> g(s.lock);
+    if (s.file != nullptr) {
+        throw runtime_error("Trace_start: a trace is already active");
+    }
+    FILE *f = fopen(path.c_str(), "wb");
+    if (f == nullptr) {
+        throw runtime_error("Cannot create trace file " + path);
+    }
+    vector<unsigned char> header(TRACE_MAGIC, TRACE_MAGIC + sizeof(TRACE_MAGIC));
+    putU32(header, TRACE_FORMAT_VERSION);
+    putU32(header, captureInputs ? TRACE_INPUTS : 0);
+    fwrite(header.data(), 1, header.size(), f);
+    s.file = f;
+    s.capture = captureInputs;
+    s.epoch = duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+    s.nextThread = 0;
+    s.generation++;
+    traceEnabled.store(true, memory_order_release);
+}
+
+void Trace_stop() {
+    TraceState &s = state();
+    traceEnabled.store(false, memory_order_release);
+    lock_guard<mutex> g(s.lock);
+    if (s.file == nullptr) return;
+    for (ThreadBuffer *b: s.buffers) {
+        lock_guard<mutex> bg(b->lock);
+        b->flushLocked(s);
+    }
+    fclose(s.file);
+    s.file = nullptr;
+    s.generation++;
+}
+
+bool Trace_active() {
+    return traceEnabled.load(memory_order_acquire);
+}
+
+namespace {
+    /**
+     * Bounds-checked reader of the trace file and of encoded inputs
+     */
+    struct Reader {
+        const unsigned char *p, *end;
+
+        bool has(size_t n) const { return (size_t) (end - p) >= n; }
+
+        uint64_t varint() {
+            uint64_t v = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                if (p == end) throw runtime_error("Trace record is truncated");
+                unsigned char b = *p++;
+                v |= (uint64_t) (b & 0x7f) << shift;
+                if (!(b & 0x80)) return v;
+            }
+            throw runtime_error("Trace record is corrupt");
+        }
+
+        uint32_t u32() {
+            uint32_t v = 0;
+            for (int i = 0; i < 4; ++i) v |= (uint32_t) *p++ << (8 * i);
+            return v;
+        }
+
+        const unsigned char *take(size_t n) {
+            if (!has(n)) throw runtime_error("Trace record is truncated");
+            const unsigned char *q = p;
+            p += n;
+            return q;
+        }
+
+        mpz_class mpz() {
+            bool negative = *take(1) != 0;
+            size_t len = varint();
+            mpz_class v;
+            if (len) mpz_import(v.get_mpz_t(), len, 1, 1, 0, 0, take(len));
+            return negative ? mpz_class(-v) : v;
+        }
+
+        void big(BIG v) {
+            if (varint() != MODBYTES_B384_58) throw runtime_error("Trace input is corrupt");
+            BIG_fromBytes(v, (char *) take(MODBYTES_B384_58));
+        }
+
+        template<typename Decode>
+        void octetOf(Decode decode) {
+            size_t len = varint();
+            vector<char> raw(len);
+            memcpy(raw.data(), take(len), len);
+            octet W = {(int) len, (int) len, raw.data()};
+            if (!decode(W)) throw runtime_error("Trace input is not a valid element");
+        }
+
+        void point(ECP &P) {
+            octetOf([&](octet &W) { return ECP_fromOctet(&P, &W) != 0; });
+        }
+
+        void point(ECP2 &P) {
+            octetOf([&](octet &W) { return ECP2_fromOctet(&P, &W) != 0; });
+        }
+
+        void gt(FP12 &x) {
+            octetOf([&](octet &W) {
+                if (W.len != 12 * MODBYTES_B384_58) return false;
+                FP12_fromOctet(&x, &W);
+                return true;
+            });
+        }
+    };
+}
+
+vector<TraceRecord> Trace_read(const string &path) {
+    ifstream in(path, ios::binary);
+    if (!in) {
+        throw runtime_error("Cannot open trace file " + path);
+    }
+    vector<unsigned char> data((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    Reader r = {data.data(), data.data() + data.size()};
+    if (!r.has(16) || memcmp(r.take(8), TRACE_MAGIC, 8) != 0) {
+        throw runtime_error("Not a trace file: " + path);
+    }
+    if (r.u32() != TRACE_FORMAT_VERSION) {
+        throw runtime_error("Trace format version mismatch: " + path);
+    }
+    bool inputs = (r.u32() & TRACE_INPUTS) != 0;
+    vector<TraceRecord> records;
+    while (r.has(8)) {
+        uint32_t len = r.u32(), thread = r.u32();
+        if (!r.has(len)) break;               // incomplete last chunk
+        Reader chunk = {r.take(len), r.p};
+        uint64_t at = 0;
+        while (chunk.p != chunk.end) {
+            TraceRecord rec;
+            unsigned char op = *chunk.take(1);
+            if (op >= (unsigned char) TraceOp::Count) {
+                throw runtime_error("Trace file is corrupt: " + path);
+            }
+            rec.op = (TraceOp) op;
+            rec.thread = thread;
+            rec.size = chunk.varint();
+            at += chunk.varint();
+            rec.start = at;
+            rec.duration = chunk.varint();
+            if (inputs) {
+                size_t n = chunk.varint();
+                const unsigned char *p = chunk.take(n);
+                rec.input.assign(p, p + n);
+            }
+            records.push_back(std::move(rec));
+        }
+    }
+    stable_sort(records.begin(), records.end(),
+                [](const TraceRecord &a, const TraceRecord &b) { return a.start < b.start; });
+    return records;
+}
+
+namespace {
+    /**
+     * Turns records into calls: decodes the captured inputs, or draws random inputs of the
+     * recorded size
+     */
+    class Replayer {
+    public:
+        Replayer() {
+            char seed[32];
+            for (int i = 0; i < 32; ++i) seed[i] = (char) (i * 37 + 11);
+            octet S = {sizeof(seed), sizeof(seed), seed};
+            CREATE_CSPRNG(&rng_, &S);
+            gmp_randinit_default(gmp_);
+            gmp_randseed_ui(gmp_, 48);
+        }
+
+        ~Replayer() {
+            KILL_CSPRNG(&rng_);
+            gmp_randclear(gmp_);
+        }
+
+        Replayer(const Replayer &) = delete;
+
+        Replayer &operator=(const Replayer &) = delete;
+
+        /**
+         * A call executing the record once
+         * @param synthesized Set if the inputs are random rather than captured
+         */
+        function<void()> prepare(const TraceRecord &rec, bool &synthesized) {
+            if (!rec.input.empty()) {
+                try {
+                    Reader r = {rec.input.data(), rec.input.data() + rec.input.size()};
+                    function<void()> call = decode(rec.op, r);
+                    if (call) {
+                        synthesized = false;
+                        return call;
+                    }
+                } catch (const runtime_error &) {
+                    // undecodable inputs: fall back to random ones
+                }
+            }
+            synthesized = true;
+            return synthesize(rec.op, rec.size);
+        }
+
+    private:
+        csprng rng_;
+        gmp_randstate_t gmp_;
+        vector<ECP> g1_;
+        vector<ECP2> g2_;
+        vector<FP12> gt_;
+        size_t next_ = 0;
+        static const size_t POOL = 8;
+
+        mpz_class bits(uint64_t n) {
+            mpz_class v;
+            mpz_urandomb(v.get_mpz_t(), gmp_, (mp_bitcnt_t) n);
+            if (n) mpz_setbit(v.get_mpz_t(), (mp_bitcnt_t) n - 1);
+            return v;
+        }
+
+        mpz_class modQ() { return rand_mpz(gmp_); }
+
+        vector<mpz_class> modQ(size_t n) {
+            vector<mpz_class> v(n);
+            for (mpz_class &x: v) x = modQ();
+            return v;
+        }
+
+        const ECP &g1() {
+            if (g1_.size() < POOL) g1_.push_back(randECP(rng_));
+            return g1_[next_++ % g1_.size()];
+        }
+
+        const ECP2 &g2() {
+            if (g2_.size() < POOL) g2_.push_back(randECP2(rng_));
+            return g2_[next_++ % g2_.size()];
+        }
+
+        const FP12 &gt() {
+            if (gt_.size() < POOL) gt_.push_back(e(g1(), g2()));
+            return gt_[next_++ % gt_.size()];
+        }
+
+        static void bigOf(BIG &b, const mpz_class &v) { mpz_to_BIG(v, b); }
+
+        struct Big {
+            BIG v;
+        };
+
+        function<void()> decode(TraceOp op, Reader &r);
+
+        function<void()> synthesize(TraceOp op, uint64_t size);
+    };
+
+    function<void()> Replayer::decode(TraceOp op, Reader &r) {
+        switch (op) {
+            case TraceOp::ECP_mul: {
+                ECP P;
+                r.point(P);
+                mpz_class t = r.mpz();
+                return [P, t] {
+                    ECP R = P;
+                    ECP_mul(R, t);
+                };
+            }
+            case TraceOp::ECP2_mul: {
+                ECP2 P;
+                r.point(P);
+                mpz_class t = r.mpz();
+                return [P, t] {
+                    ECP2 R = P;
+                    ECP2_mul(R, t);
+                };
+            }
+            case TraceOp::FP12_mul: {
+                FP12 a, b;
+                r.gt(a);
+                r.gt(b);
+                return [a, b] {
+                    FP12 x = a, y = b;
+                    FP12_mulMy(x, y);
+                };
+            }
+            case TraceOp::FP12_pow: {
+                FP12 a;
+                r.gt(a);
+                mpz_class k = r.mpz();
+                return [a, k] {
+                    FP12 x = a;
+                    FP12_pow(x, k);
+                };
+            }
+            case TraceOp::FP12_inv: {
+                FP12 a;
+                r.gt(a);
+                return [a] {
+                    FP12 x = a;
+                    FP12_inv(x);
+                };
+            }
+            case TraceOp::Pairing: {
+                ECP P;
+                ECP2 Q;
+                r.point(P);
+                r.point(Q);
+                return [P, Q] { e(P, Q); };
+            }
+            case TraceOp::PairingProduct: {
+                size_t n = r.varint();
+                vector<ECP> P(n);
+                vector<ECP2> Q(n);
+                for (ECP &p: P) r.point(p);
+                for (ECP2 &p: Q) r.point(p);
+                return [P, Q] { pairingProductIsOne(P, Q); };
+            }
+            case TraceOp::PowMpz: {
+                mpz_class b = r.mpz(), k = r.mpz(), m = r.mpz();
+                return [b, k, m] { pow_mpz(b, k, m); };
+            }
+            case TraceOp::InvertMpz: {
+                mpz_class a = r.mpz(), m = r.mpz();
+                return [a, m] { invert_mpz(a, m); };
+            }
+            case TraceOp::InvertMpzBatch: {
+                vector<mpz_class> a(r.varint());
+                for (mpz_class &x: a) x = r.mpz();
+                mpz_class m = r.mpz();
+                return [a, m] { invert_mpz_batch(a, m); };
+            }
+            case TraceOp::LagrangeCoffs: {
+                size_t n = r.varint();
+                vector<mpz_class> x(n), y(n);
+                for (mpz_class &v: x) v = r.mpz();
+                for (mpz_class &v: y) v = r.mpz();
+                mpz_class m = r.mpz();
+                return [x, y, m] { getLagrangeCoffs(x, y, m); };
+            }
+            case TraceOp::ComputePoly: {
+                vector<mpz_class> poly(r.varint());
+                for (mpz_class &v: poly) v = r.mpz();
+                mpz_class x = r.mpz(), m = r.mpz();
+                return [poly, x, m] { computePoly(poly, x, m); };
+            }
+            case TraceOp::LagrangeBasis: {
+                vector<mpz_class> x(r.varint());
+                for (mpz_class &v: x) v = r.mpz();
+                mpz_class m = r.mpz();
+                return [x, m] { getLagrangeBasis(x, m); };
+            }
+            case TraceOp::HashZp256: {
+                size_t n = r.varint();
+                const unsigned char *p = r.take(n);
+                vector<char> ct(p, p + n);
+                Big m;
+                r.big(m.v);
+                return [ct, m] {
+                    vector<char> buf(ct);
+                    octet O = {(int) buf.size(), (int) buf.size(), buf.data()};
+                    Big res, mm = m;
+                    hashZp256(res.v, &O, mm.v);
+                };
+            }
+            case TraceOp::HashToZp256:
+            case TraceOp::HashToPoint: {
+                Big a, m;
+                r.big(a.v);
+                r.big(m.v);
+                if (op == TraceOp::HashToZp256) {
+                    return [a, m] {
+                        Big res, aa = a, mm = m;
+                        hashToZp256(res.v, aa.v, mm.v);
+                    };
+                }
+                return [a, m] {
+                    Big aa = a, mm = m;
+                    hashToPoint(aa.v, mm.v);
+                };
+            }
+            case TraceOp::BigInv:
+            case TraceOp::BigInvConstantTime: {
+                Big a, m;
+                r.big(a.v);
+                r.big(m.v);
+                bool constantTime = op == TraceOp::BigInvConstantTime;
+                return [a, m, constantTime] {
+                    Big res;
+                    BIG_inv(res.v, a.v, m.v, constantTime);
+                };
+            }
+            case TraceOp::BigBatchInv: {
+                vector<Big> a(r.varint());
+                for (Big &x: a) r.big(x.v);
+                Big m;
+                r.big(m.v);
+                return [a, m] {
+                    vector<Big> res(a.size());
+                    if (!a.empty()) BIG_batchInv(&res[0].v, &a[0].v, a.size(), m.v);
+                };
+            }
+            default:
+                return nullptr;
+        }
+    }
+
+    function<void()> Replayer::synthesize(TraceOp op, uint64_t size) {
+        const mpz_class &q = getCurveOrder();
+        switch (op) {
+            case TraceOp::ECP_mul: {
+                ECP P = g1();
+                mpz_class t = bits(size);
+                return [P, t] {
+                    ECP R = P;
+                    ECP_mul(R, t);
+                };
+            }
+            case TraceOp::ECP2_mul: {
+                ECP2 P = g2();
+                mpz_class t = bits(size);
+                return [P, t] {
+                    ECP2 R = P;
+                    ECP2_mul(R, t);
+                };
+            }
+            case TraceOp::FP12_mul: {
+                FP12 a = gt(), b = gt();
+                return [a, b] {
+                    FP12 x = a, y = b;
+                    FP12_mulMy(x, y);
+                };
+            }
+            case TraceOp::FP12_pow: {
+                FP12 a = gt();
+                mpz_class k = bits(size);
+                return [a, k] {
+                    FP12 x = a;
+                    FP12_pow(x, k);
+                };
+            }
+            case TraceOp::FP12_inv: {
+                FP12 a = gt();
+                return [a] {
+                    FP12 x = a;
+                    FP12_inv(x);
+                };
+            }
+            case TraceOp::Pairing: {
+                ECP P = g1();
+                ECP2 Q = g2();
+                return [P, Q] { e(P, Q); };
+            }
+            case TraceOp::PairingProduct: {
+                vector<ECP> P;
+                vector<ECP2> Q;
+                for (uint64_t i = 0; i < size; ++i) {
+                    P.push_back(g1());
+                    Q.push_back(g2());
+                }
+                return [P, Q] { pairingProductIsOne(P, Q); };
+            }
+            case TraceOp::PowMpz: {
+                mpz_class b = modQ(), k = bits(size);
+                return [b, k, q] { pow_mpz(b, k, q); };
+            }
+            case TraceOp::InvertMpz: {
+                mpz_class a = modQ();
+                return [a, q] { invert_mpz(a, q); };
+            }
+            case TraceOp::InvertMpzBatch: {
+                vector<mpz_class> a = modQ(size);
+                return [a, q] { invert_mpz_batch(a, q); };
+            }
+            case TraceOp::LagrangeCoffs:
+            case TraceOp::LagrangeBasis: {
+                vector<mpz_class> x(size), y = modQ(size);
+                for (uint64_t i = 0; i < size; ++i) x[i] = (unsigned long) i + 1;
+                if (op == TraceOp::LagrangeBasis) return [x, q] { getLagrangeBasis(x, q); };
+                return [x, y, q] { getLagrangeCoffs(x, y, q); };
+            }
+            case TraceOp::ComputePoly: {
+                vector<mpz_class> poly = modQ(size);
+                mpz_class x = modQ();
+                return [poly, x, q] { computePoly(poly, x, q); };
+            }
+            case TraceOp::HashZp256: {
+                vector<char> ct(size);
+                for (char &c: ct) c = (char) RAND_byte(&rng_);
+                Big m;
+                bigOf(m.v, q);
+                return [ct, m] {
+                    vector<char> buf(ct);
+                    octet O = {(int) buf.size(), (int) buf.size(), buf.data()};
+                    Big res, mm = m;
+                    hashZp256(res.v, &O, mm.v);
+                };
+            }
+            case TraceOp::HashToZp256:
+            case TraceOp::HashToPoint: {
+                Big a, m;
+                bigOf(a.v, modQ());
+                bigOf(m.v, q);
+                if (op == TraceOp::HashToZp256) {
+                    return [a, m] {
+                        Big res, aa = a, mm = m;
+                        hashToZp256(res.v, aa.v, mm.v);
+                    };
+                }
+                return [a, m] {
+                    Big aa = a, mm = m;
+                    hashToPoint(aa.v, mm.v);
+                };
+            }
+            case TraceOp::BigInv:
+            case TraceOp::BigInvConstantTime: {
+                Big a, m;
+                bigOf(a.v, modQ());
+                bigOf(m.v, q);
+                bool constantTime = op == TraceOp::BigInvConstantTime;
+                return [a, m, constantTime] {
+                    Big res;
+                    BIG_inv(res.v, a.v, m.v, constantTime);
+                };
+            }
+            case TraceOp::BigBatchInv: {
+                vector<Big> a(size);
+                for (Big &x: a) bigOf(x.v, modQ());
+                Big m;
+                bigOf(m.v, q);
+                return [a, m] {
+                    vector<Big> res(a.size());
+                    if (!a.empty()) BIG_batchInv(&res[0].v, &a[0].v, a.size(), m.v);
+                };
+            }
+            case TraceOp::RandECP:
+                return [this] { randECP(rng_); };
+            case TraceOp::RandECP2:
+                return [this] { randECP2(rng_); };
+            default:
+                throw invalid_argument("Trace_replay: unknown operation");
+        }
+    }
+}
+
+vector<TraceOpStats> Trace_replay(const vector<TraceRecord> &records, int repeats) {
+    if (repeats < 1) {
+        throw invalid_argument("Trace_replay: repeats must be positive");
+    }
+    // Counts as an enclosing traced call: the replayed calls are never recorded
+    struct Suppress {
+        Suppress() { ++traceDepth; }
+
+        ~Suppress() { --traceDepth; }
+    } suppress;
+    Replayer replayer;
+    vector<TraceOpStats> stats((size_t) TraceOp::Count);
+    for (size_t i = 0; i < stats.size(); ++i) stats[i].op = (TraceOp) i;
+    for (const TraceRecord &rec: records) {
+        TraceOpStats &st = stats[(size_t) rec.op];
+        bool synthesized;
+        function<void()> call = replayer.prepare(rec, synthesized);
+        uint64_t best = UINT64_MAX;
+        for (int k = 0; k < repeats; ++k) {
+            auto start = steady_clock::now();
+            try {
+                call();
+            } catch (const exception &) {
+                // the recorded call threw as well (e.g. duplicate interpolation points)
+            }
+            best = min(best, (uint64_t) duration_cast<nanoseconds>(steady_clock::now() - start).count());
+        }
+        st.calls++;
+        st.synthesized += synthesized;
+        st.recordedNs += rec.duration;
+        st.replayedNs += best;
+    }
+    vector<TraceOpStats> present;
+    for (const TraceOpStats &st: stats) {
+        if (st.calls) present.push_back(st);
+    }
+    return present;
+}
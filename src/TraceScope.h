@@ -0,0 +1,68 @@
+#pragma once
+
+#include "../include/Trace.h"
+#include <atomic>
+
+extern atomic<bool> traceEnabled;
+
+/**
+ * One traced call of a Tools.h function, on the stack of that function:
+ *
+ *   TraceScope trace(TraceOp::ECP_mul, bits);
+ *   if (trace.capturing()) trace.point(P1).mpz(t);
+ *   trace.start();
+ *
+ * The record is written when the scope ends. Only the outermost scope of a thread records;
+ * scopes nested in it (calls made by the traced function) do nothing.
+ */
+class TraceScope {
+public:
+    TraceScope(TraceOp op, uint64_t size) {
+        if (traceEnabled.load(memory_order_relaxed)) enter(op, size);
+    }
+
+    ~TraceScope() {
+        if (entered_) leave();
+    }
+
+    TraceScope(const TraceScope &) = delete;
+
+    TraceScope &operator=(const TraceScope &) = delete;
+
+    bool capturing() const { return recording_ && capture_; }
+
+    /**
+     * Starts the clock (after the inputs are captured)
+     */
+    void start() {
+        if (recording_) start_ = steady_clock::now();
+    }
+
+    TraceScope &mpz(const mpz_class &v);
+
+    TraceScope &big(const BIG v);
+
+    TraceScope &point(const ECP &P);
+
+    TraceScope &point(const ECP2 &P);
+
+    TraceScope &gt(const FP12 &x);
+
+    TraceScope &bytes(const void *data, size_t len);
+
+    TraceScope &count(uint64_t n);
+
+private:
+    bool entered_ = false;
+    bool recording_ = false;
+    bool capture_ = false;
+    uint64_t generation_ = 0;
+    TraceOp op_ = TraceOp::Count;
+    uint64_t size_ = 0;
+    steady_clock::time_point start_;
+    vector<unsigned char> input_;
+
+    void enter(TraceOp op, uint64_t size);
+
+    void leave();
+};
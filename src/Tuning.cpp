@@ -0,0 +1,428 @@
+#include "../include/Tuning.h"
+#include "../include/MappedFile.h"
+#include <atomic>
+#include <cerrno>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <sys/stat.h>
+
+namespace {
+    const FpBackend FP_BACKENDS[] = {FpBackend::Scalar, FpBackend::AVX2, FpBackend::AVX512};
+    const CurveIsa CURVE_ISAS[] = {CurveIsa::Baseline, CurveIsa::AVX2, CurveIsa::AVX512};
+    const int MSM_MIN_TUNED_CLASS = 4;         // smaller MSMs are mostly Straus, their windows keep the defaults
+    const size_t STRAUS_CANDIDATES[] = {2, 3, 4, 6, 8, 12, 16, 24, 32};
+
+    // Every profile ever made active; never freed, since callers keep references to them
+    mutex installMutex;
+    vector<unique_ptr<TuningProfile>> installed;
+    atomic<const TuningProfile *> activeProfile{nullptr};
+    once_flag loadOnce;
+    atomic<bool> measurePending{false};
+
+    bool sameProfile(const TuningProfile &a, const TuningProfile &b) {
+        return a.cpu == b.cpu && a.fpBackend == b.fpBackend && a.curveIsa == b.curveIsa &&
+               a.divstepsInverse == b.divstepsInverse && a.frPow == b.frPow && a.strausMaxTerms == b.strausMaxTerms &&
+               equal(a.msmWindow, a.msmWindow + TUNING_MSM_CLASSES, b.msmWindow);
+    }
+
+    void install(const TuningProfile &profile) {
+        lock_guard<mutex> lock(installMutex);
+        for (const unique_ptr<TuningProfile> &p: installed) {
+            if (sameProfile(*p, profile)) {
+                activeProfile.store(p.get(), memory_order_release);
+                return;
+            }
+        }
+        installed.emplace_back(new TuningProfile(profile));
+        activeProfile.store(installed.back().get(), memory_order_release);
+    }
+
+    /**
+     * WRAPPER_CURVE_ISA names a supported level, which then overrides the profile (as in CurveIsa.cpp)
+     */
+    bool curveIsaForced() {
+        const char *env = getenv("WRAPPER_CURVE_ISA");
+        if (env == nullptr) return false;
+        for (CurveIsa isa: CURVE_ISAS) {
+            if (strcmp(env, CurveIsa_name(isa)) == 0 && CurveIsa_supported(isa)) return true;
+        }
+        return false;
+    }
+
+    void loadInitial() {
+        const char *mode = getenv("WRAPPER_TUNING");
+        TuningProfile profile = Tuning_defaults();
+        if (mode == nullptr || strcmp(mode, "off") != 0) {
+            bool found = false;
+            try {
+                for (const TuningProfile &p: Tuning_load(Tuning_defaultPath())) {
+                    if (p.cpu == profile.cpu) {
+                        profile = p;
+                        found = true;
+                    }
+                }
+            } catch (const runtime_error &) {
+                // an unreadable profile file means running with the defaults
+            }
+            if (!found && mode != nullptr && strcmp(mode, "auto") == 0) measurePending.store(true);
+        }
+        install(profile);
+    }
+
+    /**
+     * Puts the active profile and backends back when measuring ends, also on an exception
+     */
+    struct Restore {
+        TuningProfile profile = Tuning_active();
+        FpBackend fpBackend = FpBatch_backend();
+        CurveIsa curveIsa = CurveIsa_active();
+
+        ~Restore() {
+            FpBatch_setBackend(fpBackend);
+            CurveIsa_set(curveIsa);
+            install(profile);
+        }
+    };
+
+    /**
+     * Seconds taken by the fastest of `repeats` runs
+     */
+    template<typename F>
+    double fastest(int repeats, F &&run) {
+        double best = numeric_limits<double>::max();
+        for (int r = 0; r < repeats; ++r) {
+            auto start = steady_clock::now();
+            run();
+            best = min(best, duration<double>(steady_clock::now() - start).count());
+        }
+        return best;
+    }
+
+    string trim(const string &s) {
+        size_t b = s.find_first_not_of(" \t\r");
+        if (b == string::npos) return "";
+        return s.substr(b, s.find_last_not_of(" \t\r") - b + 1);
+    }
+
+    void makeParents(const string &path) {
+        for (size_t pos = path.find('/', 1); pos != string::npos; pos = path.find('/', pos + 1)) {
+            string dir = path.substr(0, pos);
+            if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) {
+                throw runtime_error("Cannot create directory " + dir);
+            }
+        }
+    }
+
+    void parseValue(TuningProfile &p, const string &key, const string &value, const string &where) {
+        bool ok = true;
+        if (key == "fp_backend") {
+            ok = false;
+            for (FpBackend b: FP_BACKENDS) {
+                if (value == FpBatch_backendName(b)) {
+                    if (FpBatch_supported(b)) p.fpBackend = b;
+                    ok = true;
+                }
+            }
+        } else if (key == "curve_isa") {
+            ok = false;
+            for (CurveIsa isa: CURVE_ISAS) {
+                if (value == CurveIsa_name(isa)) {
+                    if (CurveIsa_supported(isa)) p.curveIsa = isa;
+                    ok = true;
+                }
+            }
+        } else if (key == "inverse") {
+            ok = value == "divsteps" || value == "gmp";
+            p.divstepsInverse = value == "divsteps";
+        } else if (key == "pow") {
+            ok = value == "fr" || value == "gmp";
+            p.frPow = value == "fr";
+        } else if (key == "straus_max_terms") {
+            char *end;
+            p.strausMaxTerms = strtoul(value.c_str(), &end, 10);
+            ok = !value.empty() && *end == '\0';
+        } else if (key == "msm_window") {
+            istringstream in(value);
+            int c, k = 0;
+            while (ok && in >> c) {
+                ok = k < TUNING_MSM_CLASSES && c >= 2 && c <= 16;
+                if (ok) p.msmWindow[k++] = c;
+            }
+            ok = ok && in.eof();
+        }
+        // other keys belong to newer versions of the format and are ignored
+        if (!ok) throw runtime_error("Tuning: bad " + key + " value '" + value + "' " + where);
+    }
+}
+
+string Tuning_cpuModel() {
+    static const string model = [] {
+        ifstream in("/proc/cpuinfo");
+        string line, name;
+        while (name.empty() && getline(in, line)) {
+            size_t colon = line.find(':');
+            if (colon == string::npos) continue;
+            string key = trim(line.substr(0, colon));
+            if (key == "model name" || key == "Hardware") name = trim(line.substr(colon + 1));
+        }
+        if (name.empty()) return string("unknown");
+        // the name becomes a section header
+        for (char &c: name) {
+            if (c == '[') c = '(';
+            if (c == ']') c = ')';
+        }
+        return name;
+    }();
+    return model;
+}
+
+TuningProfile Tuning_defaults() {
+    TuningProfile p;
+    p.cpu = Tuning_cpuModel();
+    p.fpBackend = FpBackend::Scalar;
+    for (FpBackend b: FP_BACKENDS) {
+        if (FpBatch_supported(b)) p.fpBackend = b;
+    }
+    p.curveIsa = CurveIsa::Baseline;
+    for (CurveIsa isa: CURVE_ISAS) {
+        if (CurveIsa_supported(isa)) p.curveIsa = isa;
+    }
+    p.divstepsInverse = true;
+    p.frPow = false;
+    p.strausMaxTerms = STRAUS_MAX_TERMS;
+    for (int k = 0; k < TUNING_MSM_CLASSES; ++k) p.msmWindow[k] = msmDefaultWindowBits((size_t) 1 << k);
+    return p;
+}
+
+const TuningProfile &Tuning_active() {
+    call_once(loadOnce, loadInitial);
+    if (measurePending.load(memory_order_relaxed) && measurePending.exchange(false)) {
+        TuningProfile tuned = Tuning_measure();
+        Tuning_apply(tuned);
+        try {
+            Tuning_save(Tuning_defaultPath(), tuned);
+        } catch (const runtime_error &) {
+            // not stored: the next process measures again
+        }
+    }
+    return *activeProfile.load(memory_order_acquire);
+}
+
+void Tuning_apply(const TuningProfile &profile) {
+    // settle the first-use profile now, so that it cannot replace this one later
+    call_once(loadOnce, loadInitial);
+    measurePending.store(false);
+    install(profile);
+    FpBatch_setBackend(profile.fpBackend);
+    if (!curveIsaForced()) CurveIsa_set(profile.curveIsa);
+}
+
+TuningProfile Tuning_measure(const TuningConfig &config) {
+    Restore restore;
+    TuningProfile best = Tuning_defaults();
+    int repeats = max(1, config.repeats);
+    csprng rng;
+    initRNG(&rng);
+    gmp_randstate_t state;
+    initState(state);
+
+    // FpBatch backend: a batch of multiplications
+    vector<FP> a(256), b(256), r(256);
+    for (size_t i = 0; i < a.size(); ++i) {
+        BIG x, y;
+        randBig(x, rng);
+        randBig(y, rng);
+        FP_nres(&a[i], x);
+        FP_nres(&b[i], y);
+    }
+    double bestTime = numeric_limits<double>::max();
+    for (FpBackend backend: FP_BACKENDS) {
+        if (!FpBatch_supported(backend)) continue;
+        FpBatch_setBackend(backend);
+        double t = fastest(repeats, [&] {
+            for (int i = 0; i < 16; ++i) FpBatch_mul(r.data(), a.data(), b.data(), a.size());
+        });
+        if (t < bestTime) {
+            bestTime = t;
+            best.fpBackend = backend;
+        }
+    }
+
+    // Curve ISA level: scalar multiplications and a pairing
+    ECP P = randECP(rng);
+    ECP2 Q = randECP2(rng);
+    mpz_class k = rand_mpz(state);
+    bestTime = numeric_limits<double>::max();
+    for (CurveIsa isa: CURVE_ISAS) {
+        if (!CurveIsa_supported(isa)) continue;
+        CurveIsa_set(isa);
+        double t = fastest(repeats, [&] {
+            ECP P1 = P;
+            ECP2 Q1 = Q;
+            for (int i = 0; i < 4; ++i) ECP_mul(P1, k);
+            for (int i = 0; i < 2; ++i) ECP2_mul(Q1, k);
+            FP12 g = e(P1, Q1);
+            FP12_pow(g, k);
+        });
+        if (t < bestTime) {
+            bestTime = t;
+            best.curveIsa = isa;
+        }
+    }
+
+    // invert_mpz modulo the curve order and the base field prime; pow_mpz modulo the curve order
+    BIG p;
+    BIG_rcopy(p, Modulus);
+    const mpz_class &q = getCurveOrder(), fieldPrime = BIG_to_mpz(p);
+    vector<mpz_class> values(64), exponents(16);
+    for (size_t i = 0; i < values.size(); ++i) {
+        mpz_urandomm(values[i].get_mpz_t(), state, (i % 2 ? q : fieldPrime).get_mpz_t());
+    }
+    for (mpz_class &x: exponents) x = rand_mpz(state);
+    double inverseTime[2], powTime[2];
+    for (int candidate = 0; candidate < 2; ++candidate) {
+        TuningProfile trial = best;
+        trial.divstepsInverse = candidate == 1;
+        trial.frPow = candidate == 1;
+        install(trial);
+        inverseTime[candidate] = fastest(repeats, [&] {
+            for (size_t i = 0; i < values.size(); ++i) invert_mpz(values[i], i % 2 ? q : fieldPrime);
+        });
+        powTime[candidate] = fastest(repeats, [&] {
+            for (size_t i = 0; i < exponents.size(); ++i) pow_mpz(values[2 * i + 1], exponents[i], q);
+        });
+    }
+    best.divstepsInverse = inverseTime[1] < inverseTime[0];
+    best.frPow = powTime[1] < powTime[0];
+
+    // Pippenger windows, one class at a time, around the default width
+    size_t maxTerms = max(config.maxMsmTerms, (size_t) 32);
+    vector<ECP> points(maxTerms);
+    vector<mpz_class> scalars(maxTerms);
+    points[0] = randECP(rng);
+    for (size_t i = 1; i < maxTerms; ++i) {
+        points[i] = points[i - 1];
+        ECP_add(&points[i], &points[0]);
+    }
+    for (mpz_class &s: scalars) s = rand_mpz(state);
+    int lastClass = -1;
+    for (int cls = MSM_MIN_TUNED_CLASS; cls < TUNING_MSM_CLASSES && ((size_t) 1 << cls) <= config.maxMsmTerms; ++cls) {
+        size_t n = (size_t) 1 << cls;
+        vector<mpz_class> sub(scalars.begin(), scalars.begin() + n);
+        int c0 = msmDefaultWindowBits(n);
+        bestTime = numeric_limits<double>::max();
+        for (int c = max(2, c0 - 2); c <= min(16, c0 + 2); ++c) {
+            TuningProfile trial = best;
+            trial.strausMaxTerms = 0;
+            trial.msmWindow[cls] = c;
+            install(trial);
+            double t = fastest(repeats, [&] { ECP_msm(points.data(), sub); });
+            if (t < bestTime) {
+                bestTime = t;
+                best.msmWindow[cls] = c;
+            }
+        }
+        lastClass = cls;
+    }
+    if (lastClass >= 0) {
+        int offset = best.msmWindow[lastClass] - msmDefaultWindowBits((size_t) 1 << lastClass);
+        for (int cls = lastClass + 1; cls < TUNING_MSM_CLASSES; ++cls) {
+            best.msmWindow[cls] = min(16, max(2, msmDefaultWindowBits((size_t) 1 << cls) + offset));
+        }
+    }
+
+    // Straus / Pippenger cut-over: the longest run of sizes from the smallest up where Straus wins
+    best.strausMaxTerms = 0;
+    for (size_t n: STRAUS_CANDIDATES) {
+        vector<mpz_class> sub(scalars.begin(), scalars.begin() + n);
+        double t[2];
+        for (int straus = 0; straus < 2; ++straus) {
+            TuningProfile trial = best;
+            trial.strausMaxTerms = straus ? n : 0;
+            install(trial);
+            t[straus] = fastest(repeats, [&] { ECP_msm(points.data(), sub); });
+        }
+        if (t[1] > t[0]) break;
+        best.strausMaxTerms = n;
+    }
+    gmp_randclear(state);
+    return best;
+}
+
+string Tuning_defaultPath() {
+    const char *env = getenv("WRAPPER_TUNING_FILE");
+    if (env != nullptr && *env) return env;
+    const char *cache = getenv("XDG_CACHE_HOME");
+    if (cache != nullptr && *cache) return string(cache) + "/miracl-wrapper/tuning.conf";
+    const char *home = getenv("HOME");
+    if (home != nullptr && *home) return string(home) + "/.cache/miracl-wrapper/tuning.conf";
+    return "miracl-wrapper-tuning.conf";
+}
+
+vector<TuningProfile> Tuning_load(const string &path) {
+    vector<TuningProfile> profiles;
+    ifstream in(path);
+    if (!in) return profiles;
+    TuningProfile current;
+    int version = -1;                          // -1 before the first section
+    auto finish = [&] {
+        if (version == TUNING_PROFILE_VERSION) profiles.push_back(current);
+    };
+    string line;
+    for (int lineNo = 1; getline(in, line); ++lineNo) {
+        line = trim(line);
+        string where = "at " + path + ":" + to_string(lineNo);
+        if (line.empty() || line[0] == '#') continue;
+        if (line[0] == '[') {
+            if (line.back() != ']') throw runtime_error("Tuning: unterminated section header " + where);
+            finish();
+            current = Tuning_defaults();
+            current.cpu = line.substr(1, line.size() - 2);
+            version = 0;
+            continue;
+        }
+        size_t eq = line.find('=');
+        if (eq == string::npos || version < 0) throw runtime_error("Tuning: expected key = value " + where);
+        string key = trim(line.substr(0, eq)), value = trim(line.substr(eq + 1));
+        if (key == "version") {
+            version = atoi(value.c_str());
+        } else if (version == TUNING_PROFILE_VERSION) {
+            parseValue(current, key, value, where);
+        }
+    }
+    finish();
+    return profiles;
+}
+
+void Tuning_save(const string &path, const TuningProfile &profile) {
+    vector<TuningProfile> profiles = Tuning_load(path);
+    bool replaced = false;
+    for (TuningProfile &p: profiles) {
+        if (p.cpu == profile.cpu) {
+            p = profile;
+            replaced = true;
+        }
+    }
+    if (!replaced) profiles.push_back(profile);
+    string text = "# miracl-wrapper tuning profiles, one section per CPU model\n";
+    for (const TuningProfile &p: profiles) text += "\n" + Tuning_format(p);
+    makeParents(path);
+    writeFileAtomic(path, text.data(), text.size());
+}
+
+string Tuning_format(const TuningProfile &profile) {
+    ostringstream out;
+    out << "[" << profile.cpu << "]\n"
+        << "version = " << TUNING_PROFILE_VERSION << "\n"
+        << "fp_backend = " << FpBatch_backendName(profile.fpBackend) << "\n"
+        << "curve_isa = " << CurveIsa_name(profile.curveIsa) << "\n"
+        << "inverse = " << (profile.divstepsInverse ? "divsteps" : "gmp") << "\n"
+        << "pow = " << (profile.frPow ? "fr" : "gmp") << "\n"
+        << "straus_max_terms = " << profile.strausMaxTerms << "\n"
+        << "msm_window =";
+    for (int c: profile.msmWindow) out << " " << c;
+    out << "\n";
+    return out.str();
+}
@@ -0,0 +1,507 @@
+/**
+ * @file macro_benchmark.cpp
+ * @brief End-to-end protocol flows under concurrency, with latency histograms.
+ *
+ * Usage:
+ *   macro_benchmark [--threads N] [--requests N | --duration SECONDS] [--warmup N]
+ *                   [--mix bls=W,threshold=W,ibe=W] [--messages N] [--shamir N:T]
+ *                   [--cache] [--arena] [--verifier] [--json FILE]
+ *
+ * Flows (one request each):
+ *   bls        BLS signature verification: hash the message to G1, check
+ *              e(sig, g2) * e(-H(m), pk) == 1 with one multi-pairing.
+ *   threshold  Threshold BLS: combine T of N partial signatures with the cached Lagrange weights
+ *              of a random signer set (one T-term MSM), then verify the result as above.
+ *   ibe        Boneh-Franklin IBE decryption: e(d_id, U), hash the GT element, unmask.
+ *
+ * Worker threads draw flows at random with the --mix weights. Latencies go into per-thread
+ * log-linear histograms (128 sub-buckets per power of two, under 1% error) that are merged at
+ * the end. The JSON report (stdout, or --json FILE) holds throughput and p50 / p90 / p99 /
+ * p999 / max per flow and overall, the GMP allocator counters (GmpArena.h), and the counters of
+ * the hashToPoint cache (--cache) and of the asynchronous verifier (--verifier) when enabled.
+ * A summary goes to stderr.
+ *
+ *   --cache     hash messages through a HashToPointCache
+ *   --arena     run every request inside a GmpArenaScope
+ *   --verifier  submit the pairing checks to a PairingVerifier and wait for the verdict
+ */
+
+#include "../include/Tools.h"
+#include "../include/MSM.h"
+#include "../include/Shamir.h"
+#include "../include/PairingVerifier.h"
+#include "../include/HashToPointCache.h"
+#include "../include/GmpArena.h"
+#include "../include/CurveIsa.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+using namespace std;
+
+/**
+ * Log-linear latency histogram in nanoseconds: exact below 256, then 128 buckets per power of two
+ */
+class LatencyHistogram {
+public:
+    static const int SUB_BITS = 8;
+    static const size_t HALF = (size_t) 1 << (SUB_BITS - 1);
+
+    LatencyHistogram() : counts_((64 - SUB_BITS + 1) * HALF + 2 * HALF, 0) {}
+
+    void record(uint64_t ns) {
+        counts_[index(ns)]++;
+        count_++;
+        sum_ += ns;
+        max_ = std::max(max_, ns);
+    }
+
+    void merge(const LatencyHistogram &other) {
+        for (size_t i = 0; i < counts_.size(); ++i) counts_[i] += other.counts_[i];
+        count_ += other.count_;
+        sum_ += other.sum_;
+        max_ = std::max(max_, other.max_);
+    }
+
+    uint64_t count() const { return count_; }
+
+    uint64_t max() const { return max_; }
+
+    double mean() const { return count_ ? (double) sum_ / (double) count_ : 0; }
+
+    /**
+     * Smallest recorded value v (to bucket precision) such that a fraction q of the samples is <= v
+     */
+    uint64_t percentile(double q) const {
+        if (count_ == 0) return 0;
+        uint64_t rank = (uint64_t) ceil(q * (double) count_), seen = 0;
+        rank = std::max<uint64_t>(rank, 1);
+        for (size_t i = 0; i < counts_.size(); ++i) {
+            seen += counts_[i];
+            if (seen >= rank) return min(upper(i), max_);
+        }
+        return max_;
+    }
+
+private:
+    vector<uint64_t> counts_;
+    uint64_t count_ = 0, sum_ = 0, max_ = 0;
+
+    static size_t index(uint64_t v) {
+        if (v < 2 * HALF) return (size_t) v;
+        int shift = 63 - __builtin_clzll(v) - (SUB_BITS - 1);
+        return (size_t) shift * HALF + (size_t) (v >> shift);
+    }
+
+    static uint64_t upper(size_t i) {
+        if (i < 2 * HALF) return i;
+        size_t shift = i / HALF - 1;
+        return ((uint64_t) (i - shift * HALF + 1) << shift) - 1;
+    }
+};
+
+enum Flow {
+    FLOW_BLS,
+    FLOW_THRESHOLD,
+    FLOW_IBE,
+    FLOWS
+};
+
+static const char *FLOW_NAMES[FLOWS] = {"bls", "threshold", "ibe"};
+
+struct Options {
+    size_t threads = 4;
+    uint64_t requests = 2000;
+    double duration = 0;             // seconds; overrides requests when > 0
+    uint64_t warmup = 0;             // requests per thread before measuring
+    double mix[FLOWS] = {1, 1, 1};
+    size_t messages = 64;
+    size_t parties = 10, threshold = 7;
+    bool cache = false, arena = false, verifier = false;
+    string json;
+};
+
+/**
+ * Keys, messages and ciphertexts shared read-only by the workers
+ */
+struct Fixture {
+    mpz_class q;
+    BIG order;
+    ECP2 g2;
+    vector<BIG> messages;            // BLS messages and IBE identities
+    ECP2 pk;                         // BLS / threshold public key sk * g2
+    vector<ECP> sigs;                // sk * H(m)
+    ShamirEngine engine;
+    vector<vector<ECP>> partials;    // [message][party] share_p * H(m)
+    vector<ECP> ibeKeys;             // s * H(id)
+    vector<ECP2> ibeU;               // r * g2
+    vector<array<char, 32>> ibeV;    // plaintext XOR mask(e(H(id), s * g2)^r)
+    vector<array<char, 32>> ibePlain;
+
+    explicit Fixture(const Options &opt) : engine(opt.parties, opt.threshold) {}
+};
+
+static void gtMask(char out[32], FP12 &g, BIG order) {
+    char buf[12 * MODBYTES_B384_58];
+    octet W = {0, sizeof(buf), buf};
+    FP12_toOctet(&W, &g);
+    W.max = W.len;
+    BIG h;
+    hashZp256(h, &W, order);
+    char bytes[MODBYTES_B384_58];
+    BIG_toBytes(bytes, h);
+    memcpy(out, bytes + MODBYTES_B384_58 - 32, 32);
+}
+
+static void setUp(Fixture &fx, const Options &opt) {
+    csprng rng;
+    initRNG(&rng);
+    gmp_randstate_t state;
+    initState(state);
+    fx.q = getCurveOrder();
+    mpz_to_BIG(fx.q, fx.order);
+    ECP2_generator(&fx.g2);
+
+    mpz_class sk = rand_mpz(state), master = rand_mpz(state);
+    fx.pk = fx.g2;
+    ECP2_mul(fx.pk, sk);
+    ECP2 ppub = fx.g2;
+    ECP2_mul(ppub, master);
+    Fr skFr;
+    Fr_fromMpz(skFr, sk);
+    ShamirShares shares = fx.engine.share(&skFr, 1, rng);
+
+    fx.messages = vector<BIG>(opt.messages);
+    for (size_t i = 0; i < opt.messages; ++i) {
+        randBig(fx.messages[i], rng);
+        ECP H = hashToPoint(fx.messages[i], fx.order);
+        ECP sig = H;
+        ECP_mul(sig, sk);
+        fx.sigs.push_back(sig);
+        vector<ECP> parts;
+        for (size_t p = 0; p < opt.parties; ++p) {
+            ECP part = H;
+            ECP_mul(part, Fr_toMpz(shares.party(p)[0]));
+            parts.push_back(part);
+        }
+        fx.partials.push_back(parts);
+
+        ECP d = H;
+        ECP_mul(d, master);
+        fx.ibeKeys.push_back(d);
+        mpz_class r = rand_mpz(state);
+        ECP2 U = fx.g2;
+        ECP2_mul(U, r);
+        fx.ibeU.push_back(U);
+        FP12 k = e(H, ppub);
+        FP12_pow(k, r);
+        array<char, 32> plain, mask, v;
+        for (char &c: plain) c = (char) RAND_byte(&rng);
+        gtMask(mask.data(), k, fx.order);
+        for (size_t j = 0; j < 32; ++j) v[j] = plain[j] ^ mask[j];
+        fx.ibePlain.push_back(plain);
+        fx.ibeV.push_back(v);
+    }
+    gmp_randclear(state);
+}
+
+/**
+ * Everything a worker thread needs besides the fixture
+ */
+struct Worker {
+    LatencyHistogram hist[FLOWS];
+    uint64_t errors[FLOWS] = {0, 0, 0};
+    GmpArenaStats alloc;
+    uint64_t seed;
+
+    uint64_t next() {
+        // xorshift64*
+        seed ^= seed >> 12;
+        seed ^= seed << 25;
+        seed ^= seed >> 27;
+        return seed * 0x2545f4914f6cdd1dULL;
+    }
+};
+
+struct Context {
+    const Options &opt;
+    const Fixture &fx;
+    HashToPointCache *cache;
+    PairingVerifier *verifier;
+};
+
+static ECP hashMessage(Context &ctx, size_t m) {
+    BIG id, order;
+    BIG_copy(id, const_cast<chunk *>(ctx.fx.messages[m]));
+    BIG_copy(order, const_cast<chunk *>(ctx.fx.order));
+    return ctx.cache ? ctx.cache->get(id, order) : hashToPoint(id, order);
+}
+
+/**
+ * e(sig, g2) * e(-H, pk) == 1, directly or through the verifier
+ */
+static bool checkSignature(Context &ctx, const ECP &sig, ECP H) {
+    ECP_neg(&H);
+    if (ctx.verifier) {
+        PairingCheck check;
+        check.g1 = {sig, H};
+        check.g2 = {ctx.fx.g2, ctx.fx.pk};
+        return ctx.verifier->submit(std::move(check)).get();
+    }
+    return pairingProductIsOne({sig, H}, {ctx.fx.g2, ctx.fx.pk});
+}
+
+static bool runFlow(Context &ctx, Worker &w, Flow flow) {
+    const Fixture &fx = ctx.fx;
+    size_t m = w.next() % fx.messages.size();
+    switch (flow) {
+        case FLOW_BLS:
+            return checkSignature(ctx, fx.sigs[m], hashMessage(ctx, m));
+        case FLOW_THRESHOLD: {
+            // a random set of T signers
+            vector<size_t> ids(ctx.opt.parties);
+            for (size_t i = 0; i < ids.size(); ++i) ids[i] = i;
+            for (size_t i = 0; i < ctx.opt.threshold; ++i) swap(ids[i], ids[i + w.next() % (ids.size() - i)]);
+            ids.resize(ctx.opt.threshold);
+            sort(ids.begin(), ids.end());
+            vector<Fr> weights = fx.engine.reconstructionWeights(ids);
+            vector<ECP> parts(ids.size());
+            vector<BIG> scalars(ids.size());
+            for (size_t i = 0; i < ids.size(); ++i) {
+                parts[i] = fx.partials[m][ids[i]];
+                Fr_toBIG(scalars[i], weights[i]);
+            }
+            ECP sig = ECP_msm(parts.data(), scalars.data(), parts.size());
+            return checkSignature(ctx, sig, hashMessage(ctx, m));
+        }
+        case FLOW_IBE: {
+            ECP d = fx.ibeKeys[m];
+            ECP2 U = fx.ibeU[m];
+            FP12 k = e(d, U);
+            char mask[32];
+            BIG order;
+            BIG_copy(order, const_cast<chunk *>(fx.order));
+            gtMask(mask, k, order);
+            for (size_t j = 0; j < 32; ++j) {
+                if ((fx.ibeV[m][j] ^ mask[j]) != fx.ibePlain[m][j]) return false;
+            }
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+static Flow pickFlow(const Options &opt, Worker &w) {
+    double total = opt.mix[0] + opt.mix[1] + opt.mix[2];
+    double x = (double) (w.next() >> 11) / 9007199254740992.0 * total;
+    for (int f = 0; f < FLOWS - 1; ++f) {
+        if (x < opt.mix[f]) return (Flow) f;
+        x -= opt.mix[f];
+    }
+    return (Flow) (FLOWS - 1);
+}
+
+static bool runRequest(Context &ctx, Worker &w, Flow flow) {
+    if (!ctx.opt.arena) return runFlow(ctx, w, flow);
+    GmpArenaScope scope;
+    return runFlow(ctx, w, flow);
+}
+
+static void workerLoop(Context &ctx, Worker &w, atomic<uint64_t> &issued, const steady_clock::time_point &deadline,
+                       atomic<bool> &go) {
+    const Options &opt = ctx.opt;
+    for (uint64_t i = 0; i < opt.warmup; ++i) runRequest(ctx, w, pickFlow(opt, w));
+    while (!go.load(memory_order_acquire)) this_thread::yield();
+    GmpArena_resetStats();
+    for (;;) {
+        if (opt.duration > 0) {
+            if (steady_clock::now() >= deadline) break;
+        } else if (issued.fetch_add(1, memory_order_relaxed) >= opt.requests) {
+            break;
+        }
+        Flow flow = pickFlow(opt, w);
+        auto start = steady_clock::now();
+        bool ok = runRequest(ctx, w, flow);
+        w.hist[flow].record((uint64_t) duration_cast<nanoseconds>(steady_clock::now() - start).count());
+        if (!ok) w.errors[flow]++;
+    }
+    w.alloc = GmpArena_stats();
+}
+
+static int usage() {
+    cerr << "usage: macro_benchmark [--threads N] [--requests N | --duration SECONDS] [--warmup N]\n"
+            "                       [--mix bls=W,threshold=W,ibe=W] [--messages N] [--shamir N:T]\n"
+            "                       [--cache] [--arena] [--verifier] [--json FILE]" << endl;
+    return 2;
+}
+
+static void parseMix(Options &opt, const string &spec) {
+    for (double &w: opt.mix) w = 0;
+    stringstream ss(spec);
+    string item;
+    while (getline(ss, item, ',')) {
+        size_t eq = item.find('=');
+        string name = item.substr(0, eq);
+        int f = 0;
+        while (f < FLOWS && name != FLOW_NAMES[f]) f++;
+        if (f == FLOWS || eq == string::npos) throw invalid_argument("bad --mix entry: " + item);
+        opt.mix[f] = stod(item.substr(eq + 1));
+        if (opt.mix[f] < 0) throw invalid_argument("negative --mix weight: " + item);
+    }
+    if (opt.mix[0] + opt.mix[1] + opt.mix[2] <= 0) throw invalid_argument("--mix selects no flow");
+}
+
+static Options parseOptions(int argc, char **argv) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        string a = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (a == "--threads" && hasValue) {
+            opt.threads = stoul(argv[++i]);
+        } else if (a == "--requests" && hasValue) {
+            opt.requests = stoull(argv[++i]);
+        } else if (a == "--duration" && hasValue) {
+            opt.duration = stod(argv[++i]);
+        } else if (a == "--warmup" && hasValue) {
+            opt.warmup = stoull(argv[++i]);
+        } else if (a == "--mix" && hasValue) {
+            parseMix(opt, argv[++i]);
+        } else if (a == "--messages" && hasValue) {
+            opt.messages = stoul(argv[++i]);
+        } else if (a == "--shamir" && hasValue) {
+            if (sscanf(argv[++i], "%zu:%zu", &opt.parties, &opt.threshold) != 2) {
+                throw invalid_argument(string("bad --shamir specification: ") + argv[i]);
+            }
+        } else if (a == "--cache") {
+            opt.cache = true;
+        } else if (a == "--arena") {
+            opt.arena = true;
+        } else if (a == "--verifier") {
+            opt.verifier = true;
+        } else if (a == "--json" && hasValue) {
+            opt.json = argv[++i];
+        } else {
+            throw invalid_argument("unknown option: " + a);
+        }
+    }
+    if (opt.threads == 0 || opt.messages == 0) throw invalid_argument("--threads and --messages must be positive");
+    if (opt.threshold == 0 || opt.threshold > opt.parties) throw invalid_argument("--shamir needs 0 < T <= N");
+    return opt;
+}
+
+static void writeLatency(ostream &out, const LatencyHistogram &h, uint64_t errors, double seconds) {
+    out << "{\"requests\": " << h.count() << ", \"errors\": " << errors
+        << ", \"throughput\": " << (seconds > 0 ? (double) h.count() / seconds : 0)
+        << ", \"latency_us\": {\"mean\": " << h.mean() / 1e3
+        << ", \"p50\": " << (double) h.percentile(0.50) / 1e3
+        << ", \"p90\": " << (double) h.percentile(0.90) / 1e3
+        << ", \"p99\": " << (double) h.percentile(0.99) / 1e3
+        << ", \"p999\": " << (double) h.percentile(0.999) / 1e3
+        << ", \"max\": " << (double) h.max() / 1e3 << "}}";
+}
+
+int main(int argc, char **argv) {
+    Options opt;
+    try {
+        opt = parseOptions(argc, argv);
+    } catch (const exception &e) {
+        cerr << "macro_benchmark: " << e.what() << endl;
+        return usage();
+    }
+
+    GmpArena_install();
+    Fixture fx(opt);
+    setUp(fx, opt);
+    unique_ptr<HashToPointCache> cache(opt.cache ? new HashToPointCache() : nullptr);
+    unique_ptr<PairingVerifier> verifier(opt.verifier ? new PairingVerifier() : nullptr);
+    Context ctx = {opt, fx, cache.get(), verifier.get()};
+
+    vector<Worker> workers(opt.threads);
+    for (size_t t = 0; t < workers.size(); ++t) workers[t].seed = 0x9e3779b97f4a7c15ULL * (t + 1);
+    atomic<uint64_t> issued{0};
+    atomic<bool> go{false};
+    vector<thread> threads;
+    steady_clock::time_point deadline;
+    for (size_t t = 0; t < workers.size(); ++t) {
+        threads.emplace_back([&, t] { workerLoop(ctx, workers[t], issued, deadline, go); });
+    }
+    // deadline is written before the release store the workers acquire
+    auto start = steady_clock::now();
+    deadline = start + duration_cast<steady_clock::duration>(duration<double>(opt.duration));
+    go.store(true, memory_order_release);
+    for (thread &th: threads) th.join();
+    double seconds = duration<double>(steady_clock::now() - start).count();
+
+    LatencyHistogram perFlow[FLOWS], all;
+    uint64_t errors[FLOWS] = {0, 0, 0}, totalErrors = 0;
+    GmpArenaStats alloc;
+    for (Worker &w: workers) {
+        for (int f = 0; f < FLOWS; ++f) {
+            perFlow[f].merge(w.hist[f]);
+            all.merge(w.hist[f]);
+            errors[f] += w.errors[f];
+            totalErrors += w.errors[f];
+        }
+        alloc.arenaAllocs += w.alloc.arenaAllocs;
+        alloc.heapAllocs += w.alloc.heapAllocs;
+        alloc.reallocs += w.alloc.reallocs;
+        alloc.frees += w.alloc.frees;
+        alloc.resets += w.alloc.resets;
+        alloc.reserved += w.alloc.reserved;
+    }
+
+    ofstream file;
+    if (!opt.json.empty()) {
+        file.open(opt.json);
+        if (!file) {
+            cerr << "macro_benchmark: cannot write " << opt.json << endl;
+            return 1;
+        }
+    }
+    ostream &out = opt.json.empty() ? cout : file;
+    out << "{\n  \"config\": {\"threads\": " << opt.threads << ", \"seconds\": " << seconds
+        << ", \"mix\": {\"bls\": " << opt.mix[FLOW_BLS] << ", \"threshold\": " << opt.mix[FLOW_THRESHOLD]
+        << ", \"ibe\": " << opt.mix[FLOW_IBE] << "}, \"messages\": " << opt.messages
+        << ", \"shamir\": \"" << opt.parties << ":" << opt.threshold << "\", \"cache\": " << boolalpha << opt.cache
+        << ", \"arena\": " << opt.arena << ", \"verifier\": " << opt.verifier
+        << ", \"curve_isa\": \"" << CurveIsa_name(CurveIsa_active()) << "\"},\n";
+    out << "  \"overall\": ";
+    writeLatency(out, all, totalErrors, seconds);
+    out << ",\n  \"flows\": {";
+    bool first = true;
+    for (int f = 0; f < FLOWS; ++f) {
+        if (perFlow[f].count() == 0) continue;
+        out << (first ? "\n" : ",\n") << "    \"" << FLOW_NAMES[f] << "\": ";
+        writeLatency(out, perFlow[f], errors[f], seconds);
+        first = false;
+    }
+    out << "\n  },\n  \"gmp_alloc\": {\"heap_allocs\": " << alloc.heapAllocs << ", \"arena_allocs\": " << alloc.arenaAllocs
+        << ", \"reallocs\": " << alloc.reallocs << ", \"frees\": " << alloc.frees
+        << ", \"arena_resets\": " << alloc.resets << ", \"arena_reserved_bytes\": " << alloc.reserved << "}";
+    if (cache) {
+        HashToPointCacheStats st = cache->stats();
+        out << ",\n  \"hash_to_point_cache\": {\"hits\": " << st.hits << ", \"misses\": " << st.misses
+            << ", \"evictions\": " << st.evictions << ", \"hit_rate\": " << st.hitRate() << "}";
+    }
+    if (verifier) {
+        PairingVerifierStats st = verifier->stats();
+        out << ",\n  \"pairing_verifier\": {\"submitted\": " << st.submitted << ", \"batches\": " << st.batches
+            << ", \"failed_batches\": " << st.failedBatches << ", \"mean_batch_size\": " << st.meanBatchSize << "}";
+    }
+    out << "\n}" << endl;
+
+    cerr << fixed << setprecision(1) << all.count() << " requests in " << seconds << " s on " << opt.threads
+         << " threads: " << (double) all.count() / seconds << " req/s" << endl;
+    for (int f = 0; f < FLOWS; ++f) {
+        if (perFlow[f].count() == 0) continue;
+        cerr << "  " << setw(9) << FLOW_NAMES[f] << "  p50 " << (double) perFlow[f].percentile(0.5) / 1e3
+             << " us  p99 " << (double) perFlow[f].percentile(0.99) / 1e3 << " us  p999 "
+             << (double) perFlow[f].percentile(0.999) / 1e3 << " us  errors " << errors[f] << endl;
+    }
+    return totalErrors ? 1 : 0;
+}
@@ -1,4 +1,24 @@
 #include "../include/Tools.h"
+#include "../include/Shamir.h"
+#include "../include/FpBatch.h"
+#include "../include/ScalarRng.h"
+#include "../include/GTFixedBase.h"
+#include "../include/PointBatch.h"
+#include "../include/Hex.h"
+#include "../include/HashToPointCache.h"
+#include "../include/ScalarPlan.h"
+#include "../include/MSM.h"
+#include "../include/GmpArena.h"
+#include "../include/CurveIsa.h"
+#include "../include/AggregateKey.h"
+#include "../include/Tuning.h"
+#include "../include/HybridCipher.h"
+#include "../include/Pedersen.h"
+#include "../include/SchnorrBatch.h"
+#include "../include/DiscreteLog.h"
+#include "../include/Trace.h"
+#include "../include/MsmStream.h"
+#include "../include/HashBatch.h"
 #include "benchmark/benchmark.h"
 
 #include <iostream>
@@ -367,6 +387,846 @@ void Miracl_AES_Dec(benchmark::State &state) {
     AES_end(&a);
 }
 
+// ==================================================================
+// Secret Sharing Benchmarks (n = 1000 parties, t = 334)
+// ==================================================================
+
+void Shamir_share_perPair(benchmark::State &state) {
+    // Baseline: one computePoly per (secret, party) pair
+    initState(state_BM);
+    vector<mpz_class> poly(334);
+    for (auto &c: poly) c = rand_mpz(state_BM);
+    for (auto _: state) {
+        for (int p = 1; p <= 1000; ++p) {
+            benchmark::DoNotOptimize(computePoly(poly, p, q));
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void Shamir_share_batch(benchmark::State &state) {
+    initRNG(&rng);
+    initState(state_BM);
+    ShamirEngine engine(1000, 334, state.range(0) ? ShamirDomain::RootsOfUnity : ShamirDomain::Integers);
+    vector<mpz_class> secrets(100);
+    for (auto &s: secrets) s = rand_mpz(state_BM);
+    for (auto _: state) {
+        ShamirShares shares = engine.share(secrets, rng);
+        benchmark::DoNotOptimize(shares);
+    }
+    state.SetItemsProcessed(state.iterations() * secrets.size());
+}
+
+void Shamir_reconstruct_batch(benchmark::State &state) {
+    initRNG(&rng);
+    initState(state_BM);
+    ShamirEngine engine(1000, 334, ShamirDomain::RootsOfUnity);
+    vector<mpz_class> secrets(1000);
+    for (auto &s: secrets) s = rand_mpz(state_BM);
+    ShamirShares shares = engine.share(secrets, rng);
+    vector<size_t> ids;
+    for (size_t i = 0; i < 334; ++i) ids.push_back(3 * i);
+    for (auto _: state) {
+        vector<Fr> rec = engine.reconstruct(shares, ids);
+        benchmark::DoNotOptimize(rec);
+    }
+    state.SetItemsProcessed(state.iterations() * secrets.size());
+}
+
+// ==================================================================
+// Batched Fp Arithmetic Benchmarks (1024 elements; arg = FpBackend)
+// ==================================================================
+
+static vector<FP> randomFps(size_t n) {
+    vector<FP> v(n);
+    BIG p, x;
+    BIG_rcopy(p, Modulus);
+    for (FP &f: v) {
+        BIG_randomnum(x, p, &rng);
+        FP_nres(&f, x);
+    }
+    return v;
+}
+
+void FpBatch_mul_bench(benchmark::State &state) {
+    initRNG(&rng);
+    FpBackend backend = (FpBackend) state.range(0);
+    if (!FpBatch_supported(backend)) {
+        state.SkipWithError("backend not supported by this CPU");
+        return;
+    }
+    FpBatch_setBackend(backend);
+    vector<FP> a = randomFps(1024), b = randomFps(1024);
+    for (auto _: state) {
+        FpBatch_mul(a.data(), a.data(), b.data(), a.size());
+    }
+    state.SetLabel(FpBatch_backendName(backend));
+    state.SetItemsProcessed(state.iterations() * a.size());
+}
+
+void FpBatch_inv_bench(benchmark::State &state) {
+    initRNG(&rng);
+    FpBackend backend = (FpBackend) state.range(0);
+    if (!FpBatch_supported(backend)) {
+        state.SkipWithError("backend not supported by this CPU");
+        return;
+    }
+    FpBatch_setBackend(backend);
+    vector<FP> a = randomFps(1024), r(1024);
+    for (auto _: state) {
+        FpBatch_inv(r.data(), a.data(), a.size());
+    }
+    state.SetLabel(FpBatch_backendName(backend));
+    state.SetItemsProcessed(state.iterations() * a.size());
+}
+
+// ==================================================================
+// Bulk Scalar Generation Benchmarks (1024 scalars per iteration)
+// ==================================================================
+
+void Rand_randBig_loop(benchmark::State &state) {
+    initRNG(&rng);
+    vector<BIG> out(1024);
+    for (auto _: state) {
+        for (BIG &b: out) randBig(b, rng);
+    }
+    state.SetItemsProcessed(state.iterations() * out.size());
+}
+
+void Rand_rand_mpz_loop(benchmark::State &state) {
+    initState(state_BM);
+    vector<mpz_class> out(1024);
+    for (auto _: state) {
+        for (mpz_class &v: out) v = rand_mpz(state_BM);
+    }
+    state.SetItemsProcessed(state.iterations() * out.size());
+}
+
+void ScalarRng_fill_BIG(benchmark::State &state) {
+    ScalarRng gen(1);
+    vector<BIG> out(1024);
+    for (auto _: state) {
+        gen.fill(out.data(), out.size());
+    }
+    state.SetItemsProcessed(state.iterations() * out.size());
+}
+
+void ScalarRng_fill_mpz(benchmark::State &state) {
+    ScalarRng gen(1);
+    vector<mpz_class> out(1024);
+    for (auto _: state) {
+        gen.fill(out);
+    }
+    state.SetItemsProcessed(state.iterations() * out.size());
+}
+
+void ScalarRng_fill_Fr(benchmark::State &state) {
+    ScalarRng gen(1);
+    vector<Fr> out(1024);
+    for (auto _: state) {
+        gen.fill(out);
+    }
+    state.SetItemsProcessed(state.iterations() * out.size());
+}
+
+// ==================================================================
+// Fixed-Base GT Exponentiation Benchmarks (arg = window width)
+// ==================================================================
+
+void GT_fixedBase_pow(benchmark::State &state) {
+    initRNG(&rng);
+    initState(state_BM);
+    ECP g1;
+    ECP2 g2;
+    ECP_generator(&g1);
+    ECP2_generator(&g2);
+    GTFixedBase gt(e(g1, g2), (int) state.range(0));
+    mpz_class k = rand_mpz(state_BM);
+    FP12 r;
+    for (auto _: state) {
+        gt.pow(r, k);
+        benchmark::DoNotOptimize(r);
+    }
+}
+
+// ==================================================================
+// Point Batch Benchmarks (items = points)
+// ==================================================================
+
+void G1_affine_loop(benchmark::State &state) {
+    initRNG(&rng);
+    vector<ECP> pts(256);
+    ECP g = randECP(rng);
+    for (ECP &P: pts) {
+        P = randECP(rng);
+        ECP_add(&P, &g);
+    }
+    for (auto _: state) {
+        state.PauseTiming();
+        vector<ECP> work = pts;
+        state.ResumeTiming();
+        for (ECP &P: work) ECP_affine(&P);
+        benchmark::DoNotOptimize(work.data());
+    }
+    state.SetItemsProcessed(state.iterations() * pts.size());
+}
+
+void G1Batch_normalize(benchmark::State &state) {
+    initRNG(&rng);
+    G1Batch pts;
+    ECP g = randECP(rng);
+    for (int i = 0; i < 256; ++i) {
+        ECP P = randECP(rng);
+        ECP_add(&P, &g);
+        pts.push_back(P);
+    }
+    for (auto _: state) {
+        state.PauseTiming();
+        G1Batch work = pts;
+        state.ResumeTiming();
+        work.normalize();
+        benchmark::DoNotOptimize(work.data());
+    }
+    state.SetItemsProcessed(state.iterations() * pts.size());
+}
+
+void G2Batch_normalize(benchmark::State &state) {
+    initRNG(&rng);
+    G2Batch pts;
+    ECP2 g = randECP2(rng);
+    for (int i = 0; i < 256; ++i) {
+        ECP2 P = randECP2(rng);
+        ECP2_add(&P, &g);
+        pts.push_back(P);
+    }
+    for (auto _: state) {
+        state.PauseTiming();
+        G2Batch work = pts;
+        state.ResumeTiming();
+        work.normalize();
+        benchmark::DoNotOptimize(work.data());
+    }
+    state.SetItemsProcessed(state.iterations() * pts.size());
+}
+
+// ==================================================================
+// Modular Inversion Benchmarks (compare with Miracl_inv / GMP_inv)
+// ==================================================================
+
+// arg = 1 for the constant-time path
+void Wrapper_BIG_inv(benchmark::State &state) {
+    initRNG(&rng);
+    BIG a, order;
+    randBig(a, rng);
+    BIG_rcopy(order, CURVE_Order);
+    bool constantTime = state.range(0) != 0;
+    for (auto _: state) {
+        BIG_inv(a, a, order, constantTime);
+    }
+}
+
+void Wrapper_invert_mpz(benchmark::State &state) {
+    initState(state_BM);
+    mpz_class a = rand_mpz(state_BM);
+    for (auto _: state) {
+        mpz_class res = invert_mpz(a, q);
+        benchmark::DoNotOptimize(res);
+    }
+}
+
+// items = elements; arg = 0 for the curve order, 1 for the base field modulus
+void BIG_batchInv_bench(benchmark::State &state) {
+    initRNG(&rng);
+    BIG m;
+    BIG_rcopy(m, state.range(0) == 0 ? CURVE_Order : Modulus);
+    vector<BIG> a(256), r(256);
+    for (BIG &x: a) {
+        randBig(x, rng);
+        BIG_mod(x, m);
+    }
+    for (auto _: state) {
+        BIG_batchInv(r.data(), a.data(), a.size(), m);
+        benchmark::DoNotOptimize(r.data());
+    }
+    state.SetItemsProcessed(state.iterations() * a.size());
+}
+
+void invert_mpz_batch_bench(benchmark::State &state) {
+    initState(state_BM);
+    vector<mpz_class> a(256);
+    for (mpz_class &x: a) x = rand_mpz(state_BM);
+    for (auto _: state) {
+        vector<mpz_class> r = invert_mpz_batch(a, q);
+        benchmark::DoNotOptimize(r.data());
+    }
+    state.SetItemsProcessed(state.iterations() * a.size());
+}
+
+// Old str_to_BIG: sscanf on a substr per byte (kept for comparison)
+void Hex_sscanf_BIG(benchmark::State &state) {
+    initRNG(&rng);
+    BIG a;
+    randBig(a, rng);
+    string hex = Hex_encodeBIG(a);
+    char bytes[48];
+    for (auto _: state) {
+        for (size_t i = 0; i < 48; i++) {
+            sscanf(hex.substr(i * 2, 2).c_str(), "%2hhx", &bytes[i]);
+        }
+        BIG_fromBytes(a, bytes);
+        benchmark::DoNotOptimize(a);
+    }
+}
+
+void Hex_str_to_BIG(benchmark::State &state) {
+    initRNG(&rng);
+    BIG a;
+    randBig(a, rng);
+    string hex = Hex_encodeBIG(a);
+    for (auto _: state) {
+        str_to_BIG(hex, a);
+        benchmark::DoNotOptimize(a);
+    }
+}
+
+void Hex_charsToString(benchmark::State &state) {
+    initRNG(&rng);
+    BIG a;
+    randBig(a, rng);
+    char bytes[48];
+    BIG_toBytes(bytes, a);
+    for (auto _: state) {
+        string hex = charsToString(bytes);
+        benchmark::DoNotOptimize(hex);
+    }
+}
+
+// items = bytes
+void Hex_decode_bulk(benchmark::State &state) {
+    vector<unsigned char> bytes(1 << 16);
+    for (size_t i = 0; i < bytes.size(); ++i) bytes[i] = (unsigned char) (i * 131);
+    string hex = Hex_encode(bytes.data(), bytes.size());
+    for (auto _: state) {
+        bool ok = Hex_decode(bytes.data(), hex.data(), bytes.size());
+        benchmark::DoNotOptimize(ok);
+    }
+    state.SetItemsProcessed(state.iterations() * bytes.size());
+}
+
+// items = lookups; identities cycle through a working set that fits in the cache
+void HashToPointCache_get(benchmark::State &state) {
+    static HashToPointCache *cache = nullptr;
+    static vector<BIG> ids(1024);
+    BIG order;
+    BIG_rcopy(order, CURVE_Order);
+    if (state.thread_index() == 0) {
+        initRNG(&rng);
+        cache = new HashToPointCache();
+        for (BIG &id: ids) {
+            randBig(id, rng);
+            cache->get(id, order);
+        }
+    }
+    size_t i = state.thread_index();
+    for (auto _: state) {
+        ECP P = cache->get(ids[i++ % ids.size()], order);
+        benchmark::DoNotOptimize(P);
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        delete cache;
+        cache = nullptr;
+    }
+}
+
+// items = points; one scalar applied to 64 points
+void ECP_mul_sameScalar(benchmark::State &state) {
+    initState(state_BM);
+    initRNG(&rng);
+    mpz_class k = rand_mpz(state_BM);
+    vector<ECP> points(64);
+    for (ECP &P: points) P = randECP(rng);
+    for (auto _: state) {
+        vector<ECP> out = points;
+        for (ECP &P: out) ECP_mul(P, k);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * points.size());
+}
+
+// arg = 0 for one point at a time, 1 for the batch entry point
+void ScalarPlan_G1(benchmark::State &state) {
+    initState(state_BM);
+    initRNG(&rng);
+    ScalarPlan plan(rand_mpz(state_BM));
+    G1Batch points(64);
+    for (ECP &P: points) P = randECP(rng);
+    for (auto _: state) {
+        G1Batch out = points;
+        if (state.range(0) == 0) {
+            for (ECP &P: out) plan.apply(P);
+        } else {
+            plan.apply(out);
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * points.size());
+}
+
+void ScalarPlan_G2(benchmark::State &state) {
+    initState(state_BM);
+    initRNG(&rng);
+    ScalarPlan plan(rand_mpz(state_BM));
+    ECP2 Q = randECP2(rng);
+    for (auto _: state) {
+        ECP2 R = Q;
+        plan.apply(R);
+        benchmark::DoNotOptimize(R);
+    }
+}
+
+// arg = scalar bits (compare with Miracl_ECP_mul)
+void ECP_mulShort_bench(benchmark::State &state) {
+    initState(state_BM);
+    initRNG(&rng);
+    mpz_class k = rand_mpz(state_BM) >> (256 - state.range(0));
+    ECP P = randECP(rng);
+    for (auto _: state) {
+        ECP R = ECP_mulShort(P, k);
+        benchmark::DoNotOptimize(R);
+    }
+}
+
+// arg = 0 for two ECP_mul and an add, 1 for ECP_mul2
+void ECP_mul2_bench(benchmark::State &state) {
+    initState(state_BM);
+    initRNG(&rng);
+    mpz_class a = rand_mpz(state_BM), b = rand_mpz(state_BM);
+    ECP P = randECP(rng), Q = randECP(rng);
+    for (auto _: state) {
+        ECP R;
+        if (state.range(0) == 0) {
+            ECP S = Q;
+            R = P;
+            ECP_mul(R, a);
+            ECP_mul(S, b);
+            ECP_add(&R, &S);
+        } else {
+            R = ECP_mul2(P, a, Q, b);
+        }
+        benchmark::DoNotOptimize(R);
+    }
+}
+
+// arg = number of terms (Straus up to STRAUS_MAX_TERMS)
+void ECP_msm_small(benchmark::State &state) {
+    initState(state_BM);
+    initRNG(&rng);
+    vector<ECP> points(state.range(0));
+    vector<mpz_class> scalars(points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        points[i] = randECP(rng);
+        scalars[i] = rand_mpz(state_BM);
+    }
+    for (auto _: state) {
+        ECP R = ECP_msm(points, scalars);
+        benchmark::DoNotOptimize(R);
+    }
+}
+
+// arg = 0 for GMP's allocator, 1 inside a GmpArenaScope; counters are allocator calls per
+// interpolation of 32 points
+void Lagrange_alloc(benchmark::State &state) {
+    GmpArena_install();
+    const mpz_class &q = getCurveOrder();
+    vector<mpz_class> x(32), y(32);
+    for (size_t i = 0; i < x.size(); ++i) {
+        x[i] = i + 1;
+        y[i] = q - 12345 * (i + 1);
+    }
+    GmpArena_resetStats();
+    for (auto _: state) {
+        if (state.range(0) == 0) {
+            benchmark::DoNotOptimize(getLagrangeCoffs(x, y, q));
+        } else {
+            GmpArenaScope arena;
+            benchmark::DoNotOptimize(getLagrangeCoffs(x, y, q));
+        }
+    }
+    GmpArenaStats st = GmpArena_stats();
+    state.counters["heapAllocs"] = benchmark::Counter((double) st.heapAllocs, benchmark::Counter::kAvgIterations);
+    state.counters["arenaAllocs"] = benchmark::Counter((double) st.arenaAllocs, benchmark::Counter::kAvgIterations);
+}
+
+// arg = CurveIsa level (compare with Miracl_pair / Miracl_ECP_mul); unavailable levels are skipped
+void CurveIsa_pair(benchmark::State &state) {
+    CurveIsa isa = (CurveIsa) state.range(0);
+    if (!CurveIsa_supported(isa)) {
+        state.SkipWithError("ISA level not available");
+        return;
+    }
+    CurveIsa original = CurveIsa_active();
+    CurveIsa_set(isa);
+    ECP P1;
+    ECP2 P2;
+    ECP_generator(&P1);
+    ECP2_generator(&P2);
+    for (auto _: state) {
+        FP12 r = e(P1, P2);
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetLabel(CurveIsa_name(isa));
+    CurveIsa_set(original);
+}
+
+void CurveIsa_ECP_mul(benchmark::State &state) {
+    CurveIsa isa = (CurveIsa) state.range(0);
+    if (!CurveIsa_supported(isa)) {
+        state.SkipWithError("ISA level not available");
+        return;
+    }
+    initState(state_BM);
+    CurveIsa original = CurveIsa_active();
+    CurveIsa_set(isa);
+    mpz_class k = rand_mpz(state_BM);
+    ECP P;
+    ECP_generator(&P);
+    for (auto _: state) {
+        ECP_mul(P, k);
+        benchmark::DoNotOptimize(P);
+    }
+    state.SetLabel(CurveIsa_name(isa));
+    CurveIsa_set(original);
+}
+
+// arg = 0 for an ECP2_add loop over the signers, 1 for AggregateKey; 4096 keys, 16 non-signers
+void AggregateKey_subset(benchmark::State &state) {
+    initRNG(&rng);
+    vector<ECP2> keys(4096);
+    for (ECP2 &K: keys) K = randECP2(rng);
+    G2AggregateKey agg(keys);
+    G2AggregateKey::Bitmap signers(keys.size() / 64, ~0ULL);
+    for (size_t i = 0; i < 16; ++i) signers[i * 4] &= ~(1ULL << (i * 3));
+    for (auto _: state) {
+        ECP2 sum;
+        if (state.range(0) == 0) {
+            ECP2_inf(&sum);
+            for (size_t i = 0; i < keys.size(); ++i) {
+                if (signers[i / 64] >> (i % 64) & 1) ECP2_add(&sum, &keys[i]);
+            }
+        } else {
+            sum = agg.aggregate(signers);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+}
+
+// one epoch: 4 keys leave and 4 join, then the aggregate of a 99% signer set
+void AggregateKey_epoch(benchmark::State &state) {
+    initRNG(&rng);
+    vector<ECP2> keys(4096);
+    for (ECP2 &K: keys) K = randECP2(rng);
+    G2AggregateKey agg(keys);
+    G2AggregateKey::Bitmap signers(keys.size() / 64, ~0ULL);
+    for (size_t i = 0; i < 40; ++i) signers[i] &= ~1ULL;
+    size_t next = 100;
+    for (auto _: state) {
+        for (int i = 0; i < 4; ++i) {
+            size_t slot = next++ % keys.size();
+            agg.remove(slot);
+            agg.add(keys[slot]);
+        }
+        ECP2 sum = agg.aggregate(signers);
+        benchmark::DoNotOptimize(sum);
+    }
+}
+
+// args = {terms, window bits}, Pippenger only (see Tuning.h)
+void Tuning_msm_window(benchmark::State &state) {
+    initState(state_BM);
+    initRNG(&rng);
+    vector<ECP> points(state.range(0));
+    vector<mpz_class> scalars(points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        points[i] = randECP(rng);
+        scalars[i] = rand_mpz(state_BM);
+    }
+    TuningProfile original = Tuning_active(), trial = original;
+    trial.strausMaxTerms = 0;
+    for (int &c: trial.msmWindow) c = (int) state.range(1);
+    Tuning_apply(trial);
+    for (auto _: state) {
+        ECP R = ECP_msm(points, scalars);
+        benchmark::DoNotOptimize(R);
+    }
+    Tuning_apply(original);
+}
+
+// arg = 0 for mpz_powm, 1 for Fr_pow
+void Tuning_pow_mpz(benchmark::State &state) {
+    initState(state_BM);
+    mpz_class a = rand_mpz(state_BM);
+    mpz_class b = rand_mpz(state_BM);
+    TuningProfile original = Tuning_active(), trial = original;
+    trial.frPow = state.range(0) == 1;
+    Tuning_apply(trial);
+    for (auto _: state) {
+        mpz_class res = pow_mpz(a, b, q);
+        benchmark::DoNotOptimize(res);
+    }
+    Tuning_apply(original);
+}
+
+// args = {0 for MIRACL's GCM, 1 for AES-NI; threads}, 16 MiB per iteration
+void Hybrid_encrypt_stream(benchmark::State &state) {
+    bool hasAesni = Hybrid_aesni();
+    if (state.range(0) == 1 && !hasAesni) {
+        state.SkipWithError("AES-NI not available");
+        return;
+    }
+    initRNG(&rng);
+    FP12 key = e(randECP(rng), randECP2(rng));
+    string plain(16 << 20, 'x');
+    HybridConfig config;
+    config.threads = state.range(1);
+    Hybrid_setAesni(state.range(0) == 1);
+    for (auto _: state) {
+        istringstream in(plain);
+        ostringstream out;
+        Hybrid_encrypt(key, in, out, rng, "bench", config);
+        benchmark::DoNotOptimize(out);
+    }
+    Hybrid_setAesni(hasAesni);
+    state.SetBytesProcessed(state.iterations() * plain.size());
+}
+
+// arg = 0 for FP12_toOctet + hashZp256, 1 for GT_kdf
+void GT_key_derivation(benchmark::State &state) {
+    initRNG(&rng);
+    FP12 key = e(randECP(rng), randECP2(rng));
+    BIG order;
+    BIG_rcopy(order, CURVE_Order);
+    unsigned char salt[32] = {0}, out[32];
+    for (auto _: state) {
+        if (state.range(0) == 0) {
+            char buf[12 * MODBYTES_B384_58];
+            octet o = {0, sizeof(buf), buf};
+            BIG res;
+            FP12_toOctet(&o, &key);
+            hashZp256(res, &o, order);
+            benchmark::DoNotOptimize(res);
+        } else {
+            GT_kdf(out, sizeof(out), key, salt, sizeof(salt), "bench");
+            benchmark::DoNotOptimize(out);
+        }
+    }
+}
+
+// args = {vector length, 0 for an ECP_mul loop, 1 for ECP_msm, 2 for PedersenVector::commit}
+void Pedersen_commit(benchmark::State &state) {
+    initState(state_BM);
+    size_t n = state.range(0);
+    PedersenVector key(n);
+    vector<ECP> generators(n);
+    vector<mpz_class> values(n);
+    for (size_t i = 0; i < n; ++i) {
+        generators[i] = key.generator(i);
+        values[i] = rand_mpz(state_BM);
+    }
+    for (auto _: state) {
+        ECP C;
+        if (state.range(1) == 0) {
+            ECP_inf(&C);
+            for (size_t i = 0; i < n; ++i) {
+                ECP T = generators[i];
+                ECP_mul(T, values[i]);
+                ECP_add(&C, &T);
+            }
+        } else if (state.range(1) == 1) {
+            C = ECP_msm(generators, values);
+        } else {
+            C = key.commit(values);
+        }
+        benchmark::DoNotOptimize(C);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// arg = 0 for a +1 update, 1 for a full-size difference
+void Pedersen_update(benchmark::State &state) {
+    initState(state_BM);
+    PedersenVector key(1024);
+    ECP C = key.commit({});
+    mpz_class oldValue = rand_mpz(state_BM);
+    mpz_class newValue = state.range(0) == 0 ? oldValue + 1 : rand_mpz(state_BM);
+    for (auto _: state) {
+        key.update(C, 17, oldValue, newValue);
+    }
+}
+
+// args = {proofs, 0 for Schnorr_verify per proof, 1 for Schnorr_batchVerify}
+void Schnorr_verify_G1(benchmark::State &state) {
+    ScalarRng srng(46);
+    ECP g;
+    ECP_generator(&g);
+    vector<G1SchnorrProof> proofs;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        proofs.push_back(Schnorr_prove(g, srng.nextMpz(), "bench", srng));
+    }
+    for (auto _: state) {
+        bool ok = true;
+        if (state.range(1) == 0) {
+            for (const G1SchnorrProof &p: proofs) ok = Schnorr_verify(g, p) && ok;
+        } else {
+            ok = Schnorr_batchVerify(g, proofs, srng).valid;
+        }
+        benchmark::DoNotOptimize(ok);
+    }
+    state.SetItemsProcessed(state.iterations() * proofs.size());
+}
+
+// args = {proofs, bad proofs}, bisection cost (items = proofs)
+void Schnorr_bisect_G1(benchmark::State &state) {
+    ScalarRng srng(46);
+    ECP g;
+    ECP_generator(&g);
+    vector<G1SchnorrProof> proofs;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        proofs.push_back(Schnorr_prove(g, srng.nextMpz(), "bench", srng));
+    }
+    for (int64_t i = 0; i < state.range(1); ++i) proofs[i * 7919 % proofs.size()].s += 1;
+    size_t checks = 0;
+    for (auto _: state) {
+        SchnorrBatchResult r = Schnorr_batchVerify(g, proofs, srng);
+        checks = r.checks;
+    }
+    state.counters["checks"] = benchmark::Counter((double) checks);
+    state.SetItemsProcessed(state.iterations() * proofs.size());
+}
+
+// Challenge hashing for a batch: Schnorr_challenge per proof vs Schnorr_challenges
+void Schnorr_challenges_G1(benchmark::State &state) {
+    ScalarRng srng(46);
+    ECP g;
+    ECP_generator(&g);
+    vector<G1SchnorrProof> proofs(256);
+    for (G1SchnorrProof &p: proofs) {
+        // projective points, as a deserializer or an MSM leaves them
+        p.X = ECP_mulShort(g, srng.nextMpz());
+        p.R = ECP_mulShort(g, srng.nextMpz());
+    }
+    for (auto _: state) {
+        if (state.range(0) == 0) {
+            for (G1SchnorrProof &p: proofs) p.c = Schnorr_challenge(g, p.X, p.R, "");
+        } else {
+            Schnorr_challenges(g, proofs);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * proofs.size());
+}
+
+// arg = log2 of the baby steps, parallel table build (items = baby steps)
+void DiscreteLog_build_G1(benchmark::State &state) {
+    ECP g;
+    ECP_generator(&g);
+    uint64_t m = (uint64_t) 1 << state.range(0);
+    for (auto _: state) {
+        G1DiscreteLog dlog(g, 2 * m * m, m);
+        benchmark::DoNotOptimize(dlog.table());
+    }
+    state.SetItemsProcessed(state.iterations() * m);
+}
+
+// args = {log2 of the range, log2 of the baby steps, threads}, 16 queries (items = queries)
+void DiscreteLog_solve_G1(benchmark::State &state) {
+    ECP g;
+    ECP_generator(&g);
+    uint64_t range = (uint64_t) 1 << state.range(0);
+    G1DiscreteLog dlog(g, range, (uint64_t) 1 << state.range(1));
+    ScalarRng srng(47);
+    vector<ECP> targets;
+    for (int i = 0; i < 16; ++i) {
+        uint64_t m;
+        srng.bytes((unsigned char *) &m, sizeof(m));
+        targets.push_back(ECP_mulShort(g, mpz_class((unsigned long) (m % range))));
+    }
+    for (auto _: state) {
+        vector<int64_t> found = dlog.solveBatch(targets, (unsigned) state.range(2));
+        benchmark::DoNotOptimize(found.data());
+    }
+    state.counters["giant_steps"] = benchmark::Counter((double) dlog.giantSteps());
+    state.SetItemsProcessed(state.iterations() * targets.size());
+}
+
+// arg = 0 untraced, 1 traced, 2 traced with inputs; 255-bit G1 scalar multiplication
+void Trace_overhead_ECP_mul(benchmark::State &state) {
+    ECP g;
+    ECP_generator(&g);
+    mpz_class t = getCurveOrder() - 1;
+    string path = "bench_trace.bin";
+    if (state.range(0)) Trace_start(path, state.range(0) == 2);
+    for (auto _: state) {
+        ECP P = g;
+        ECP_mul(P, t);
+        benchmark::DoNotOptimize(P);
+    }
+    Trace_stop();
+    remove(path.c_str());
+}
+
+// args = {log2 of the terms, 0 for ECP_msm, 1 for MsmStream in chunks of 2^14 terms}
+void MsmStream_G1(benchmark::State &state) {
+    initState(state_BM);
+    initRNG(&rng);
+    vector<ECP> points((size_t) 1 << state.range(0));
+    vector<mpz_class> scalars(points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        points[i] = randECP(rng);
+        scalars[i] = rand_mpz(state_BM);
+    }
+    for (auto _: state) {
+        ECP R;
+        if (state.range(1) == 0) {
+            R = ECP_msm(points, scalars);
+        } else {
+            G1MsmStream stream(points.size());
+            stream.addSource(MsmStream_iterators(points.begin(), points.end(), scalars.begin()), 1 << 14);
+            R = stream.result();
+        }
+        benchmark::DoNotOptimize(R);
+    }
+    state.SetItemsProcessed(state.iterations() * points.size());
+}
+
+// args = {HashBackend, or -1 for a loop of hashToZp256}; 1024 BIGs per iteration
+void HashBatch_hashToZp256_bench(benchmark::State &state) {
+    initRNG(&rng);
+    BIG q;
+    BIG_rcopy(q, CURVE_Order);
+    vector<BIG> in(1024), out(1024);
+    for (BIG &b: in) randBig(b, rng);
+    if (state.range(0) < 0) {
+        for (auto _: state) {
+            for (size_t i = 0; i < in.size(); ++i) hashToZp256(out[i], in[i], q);
+        }
+        state.SetLabel("per item");
+    } else {
+        auto backend = (HashBackend) state.range(0);
+        if (!HashBatch_supported(backend)) {
+            state.SkipWithError("backend not supported by this CPU");
+            return;
+        }
+        HashBackend saved = HashBatch_backend();
+        HashBatch_setBackend(backend);
+        for (auto _: state) {
+            HashBatch_hashToZp256(out.data(), in.data(), in.size(), q);
+        }
+        HashBatch_setBackend(saved);
+        state.SetLabel(HashBatch_backendName(backend));
+    }
+    state.SetItemsProcessed(state.iterations() * in.size());
+}
+
 // ==================================================================
 // Register Benchmarks
 // ==================================================================
@@ -407,4 +1267,98 @@ BENCHMARK(Miracl_hashToPoint);
 BENCHMARK(Miracl_AES_Enc);
 BENCHMARK(Miracl_AES_Dec);
 
+// Secret sharing (items = secrets)
+BENCHMARK(Shamir_share_perPair);
+BENCHMARK(Shamir_share_batch)->Arg(0)->Arg(1);
+BENCHMARK(Shamir_reconstruct_batch);
+
+// Batched Fp (items = field elements)
+BENCHMARK(FpBatch_mul_bench)->Arg((int) FpBackend::Scalar)->Arg((int) FpBackend::AVX2)->Arg((int) FpBackend::AVX512);
+BENCHMARK(FpBatch_inv_bench)->Arg((int) FpBackend::Scalar)->Arg((int) FpBackend::AVX2)->Arg((int) FpBackend::AVX512);
+
+// Fixed-base GT (compare with Miracl_GT_pow)
+BENCHMARK(GT_fixedBase_pow)->Arg(4)->Arg(6)->Arg(8);
+
+// Bulk scalars (items = scalars)
+BENCHMARK(Rand_randBig_loop);
+BENCHMARK(Rand_rand_mpz_loop);
+BENCHMARK(ScalarRng_fill_BIG);
+BENCHMARK(ScalarRng_fill_mpz);
+BENCHMARK(ScalarRng_fill_Fr);
+
+// Modular inversion (compare with Miracl_inv / GMP_inv)
+BENCHMARK(Wrapper_BIG_inv)->Arg(0)->Arg(1);
+BENCHMARK(Wrapper_invert_mpz);
+BENCHMARK(BIG_batchInv_bench)->Arg(0)->Arg(1);
+BENCHMARK(invert_mpz_batch_bench);
+
+// Point batches (items = points)
+BENCHMARK(G1_affine_loop);
+BENCHMARK(G1Batch_normalize);
+BENCHMARK(G2Batch_normalize);
+
+// Hex conversion
+BENCHMARK(Hex_sscanf_BIG);
+BENCHMARK(Hex_str_to_BIG);
+BENCHMARK(Hex_charsToString);
+BENCHMARK(Hex_decode_bulk);
+
+// hashToPoint cache (compare with Miracl_hashToPoint)
+BENCHMARK(HashToPointCache_get)->Threads(1)->Threads(4)->Threads(16);
+
+// One scalar, many points (compare ScalarPlan_G2 with Miracl_ECP2_mul)
+BENCHMARK(ECP_mul_sameScalar);
+BENCHMARK(ScalarPlan_G1)->Arg(0)->Arg(1);
+BENCHMARK(ScalarPlan_G2);
+
+// Short and few-term scalar multiplication (compare with Miracl_ECP_mul)
+BENCHMARK(ECP_mulShort_bench)->Arg(64)->Arg(128)->Arg(255);
+BENCHMARK(ECP_mul2_bench)->Arg(0)->Arg(1);
+BENCHMARK(ECP_msm_small)->Arg(2)->Arg(8)->Arg(9);
+
+// GMP allocation (compare heapAllocs and wall time across threads)
+BENCHMARK(Lagrange_alloc)->Arg(0)->Arg(1)->Threads(1)->Threads(8);
+
+// Curve arithmetic per ISA level
+BENCHMARK(CurveIsa_pair)->Arg((int) CurveIsa::Baseline)->Arg((int) CurveIsa::AVX2)->Arg((int) CurveIsa::AVX512);
+BENCHMARK(CurveIsa_ECP_mul)->Arg((int) CurveIsa::Baseline)->Arg((int) CurveIsa::AVX2)->Arg((int) CurveIsa::AVX512);
+
+// Aggregate public keys
+BENCHMARK(AggregateKey_subset)->Arg(0)->Arg(1);
+BENCHMARK(AggregateKey_epoch);
+
+// Tuning candidates (compare with the choices of Tuning_measure)
+BENCHMARK(Tuning_msm_window)->Args({256, 5})->Args({256, 6})->Args({256, 7})->Args({4096, 8})->Args({4096, 9})
+        ->Args({4096, 10});
+BENCHMARK(Tuning_pow_mpz)->Arg(0)->Arg(1);
+
+// Hybrid encryption (bytes = plaintext)
+BENCHMARK(Hybrid_encrypt_stream)->Args({0, 1})->Args({1, 1})->Args({0, 8})->Args({1, 8})->UseRealTime();
+BENCHMARK(GT_key_derivation)->Arg(0)->Arg(1);
+
+// Pedersen vector commitments (items = vector entries)
+BENCHMARK(Pedersen_commit)->Args({64, 0})->Args({64, 1})->Args({64, 2})->Args({1024, 1})->Args({1024, 2})
+        ->Args({4096, 1})->Args({4096, 2});
+BENCHMARK(Pedersen_update)->Arg(0)->Arg(1);
+
+// Schnorr proof verification (items = proofs)
+BENCHMARK(Schnorr_verify_G1)->Args({64, 0})->Args({64, 1})->Args({1024, 0})->Args({1024, 1});
+BENCHMARK(Schnorr_bisect_G1)->Args({1024, 1})->Args({1024, 8})->Args({1024, 64});
+BENCHMARK(Schnorr_challenges_G1)->Arg(0)->Arg(1);
+
+// Baby-step giant-step discrete log (items = baby steps / queries)
+BENCHMARK(DiscreteLog_build_G1)->Arg(16)->Arg(20)->UseRealTime();
+BENCHMARK(DiscreteLog_solve_G1)->Args({32, 16, 1})->Args({32, 20, 1})->Args({32, 20, 0})->Args({40, 22, 0})
+        ->UseRealTime();
+
+// Call tracing overhead
+BENCHMARK(Trace_overhead_ECP_mul)->Arg(0)->Arg(1)->Arg(2);
+
+// Streaming MSM (items = terms)
+BENCHMARK(MsmStream_G1)->Args({16, 0})->Args({16, 1})->Args({18, 1})->UseRealTime();
+
+// Multi-buffer batch hashing (items = hashes)
+BENCHMARK(HashBatch_hashToZp256_bench)->Arg(-1)->Arg((int) HashBackend::Scalar)->Arg((int) HashBackend::Lanes4)
+        ->Arg((int) HashBackend::ShaNi)->Arg((int) HashBackend::AVX2)->Arg((int) HashBackend::AVX512);
+
 BENCHMARK_MAIN();
\ No newline at end of file
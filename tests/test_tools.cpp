@@ -4,9 +4,34 @@
  */
 
 #include "../include/Tools.h"
+#include "../include/KZG.h"
+#include "../include/Shamir.h"
+#include "../include/PairingVerifier.h"
+#include "../include/FpBatch.h"
+#include "../include/PrecomputeCache.h"
+#include "../include/FixedBase.h"
+#include "../include/ScalarRng.h"
+#include "../include/GTFixedBase.h"
+#include "../include/PointBatch.h"
+#include "../include/MSM.h"
+#include "../include/Hex.h"
+#include "../include/HashToPointCache.h"
+#include "../include/ScalarPlan.h"
+#include "../include/GmpArena.h"
+#include "../include/CurveIsa.h"
+#include "../include/AggregateKey.h"
+#include "../include/Tuning.h"
+#include "../include/HybridCipher.h"
+#include "../include/Pedersen.h"
+#include "../include/SchnorrBatch.h"
+#include "../include/DiscreteLog.h"
+#include "../include/Trace.h"
+#include "../include/MsmStream.h"
+#include "../include/HashBatch.h"
 #include <iostream>
 #include <cassert>
 #include <string>
+#include <fstream>
 
 using namespace std;
 
@@ -186,12 +211,1729 @@ void Test_FP12_Adapter() {
     }
 }
 
-int main() {
+// ==================================================================
+// 4. KZG Commitment Test
+// ==================================================================
+void Test_KZG() {
+    cout << "\n--- Test 4: KZG Commitments ---" << endl;
+
+    initState(state_gmp);
+    initRNG(&rng_tools);
+    const mpz_class &q = getCurveOrder();
+    const string srsPath = "test_kzg_srs.bin";
+    KZG_generateSRS(srsPath, 16, 8, rand_mpz(state_gmp));
+    KZG kzg(srsPath);
+
+    // A. Single opening
+    vector<mpz_class> poly(16);
+    for (auto &c: poly) c = rand_mpz(state_gmp);
+    ECP C = kzg.commit(poly);
+    KZGOpening o = kzg.open(poly, rand_mpz(state_gmp), C);
+    if (o.y == computePoly(poly, o.z, q) && kzg.verify(o)) {
+        TEST_PASS("KZG open / verify");
+    } else {
+        TEST_FAIL("KZG valid opening rejected");
+    }
+    KZGOpening bad = o;
+    bad.y = (bad.y + 1) % q;
+    if (!kzg.verify(bad)) {
+        TEST_PASS("KZG rejects wrong evaluation");
+    } else {
+        TEST_FAIL("KZG accepted wrong evaluation");
+    }
+
+    // B. Lagrange basis commitment matches coefficient commitment
+    vector<mpz_class> small(poly.begin(), poly.begin() + 8), evals(8);
+    mpz_class omega = rootOfUnity(8), x = 1;
+    for (auto &v: evals) {
+        v = computePoly(small, x, q);
+        x = x * omega % q;
+    }
+    ECP C1 = kzg.commit(small), C2 = kzg.commitLagrange(evals);
+    if (ECP_equals(&C1, &C2)) {
+        TEST_PASS("KZG Lagrange commitment matches coefficients");
+    } else {
+        TEST_FAIL("KZG Lagrange commitment mismatch");
+    }
+
+    // C. Batched openings
+    vector<KZGOpening> openings;
+    for (int i = 0; i < 4; ++i) {
+        for (auto &c: poly) c = rand_mpz(state_gmp);
+        openings.push_back(kzg.open(poly, rand_mpz(state_gmp), kzg.commit(poly)));
+    }
+    bool okAll = kzg.batchVerify(openings, rng_tools);
+    openings[2].y = (openings[2].y + 1) % q;
+    bool okBad = kzg.batchVerify(openings, rng_tools);
+    remove(srsPath.c_str());
+    if (okAll && !okBad) {
+        TEST_PASS("KZG batch verification");
+    } else {
+        TEST_FAIL("KZG batch verification failed");
+    }
+}
+
+// ==================================================================
+// 5. Batched Shamir Sharing Test
+// ==================================================================
+void Test_Shamir() {
+    cout << "\n--- Test 5: Batched Shamir Sharing ---" << endl;
+
+    initState(state_gmp);
+    initRNG(&rng_tools);
+    const mpz_class &q = getCurveOrder();
+    vector<mpz_class> secrets(100);
+    for (auto &s: secrets) s = rand_mpz(state_gmp);
+
+    // A. Integers domain, cross-checked against getLagrangeBasis
+    ShamirEngine engine(7, 4);
+    ShamirShares shares = engine.share(secrets, rng_tools);
+    vector<size_t> ids = {6, 2, 4, 0};
+    vector<Fr> rec = engine.reconstruct(shares, ids);
+    vector<mpz_class> xs;
+    for (size_t id: ids) xs.push_back(id + 1);
+    vector<mpz_class> lambdas = getLagrangeBasis(xs, q);
+    bool ok = true;
+    for (size_t s = 0; s < secrets.size(); ++s) {
+        mpz_class viaBasis = 0;
+        for (size_t i = 0; i < ids.size(); ++i) {
+            viaBasis = (viaBasis + lambdas[i] * Fr_toMpz(shares.party(ids[i])[s])) % q;
+        }
+        ok = ok && Fr_toMpz(rec[s]) == secrets[s] && viaBasis == secrets[s];
+    }
+    if (ok) {
+        TEST_PASS("Shamir share / reconstruct (integer points)");
+    } else {
+        TEST_FAIL("Shamir integer-domain reconstruction mismatch");
+    }
+
+    // B. Roots-of-unity domain (NTT evaluation)
+    ShamirEngine nttEngine(9, 5, ShamirDomain::RootsOfUnity);
+    rec = nttEngine.reconstruct(nttEngine.share(secrets, rng_tools), {8, 1, 3, 5, 7});
+    ok = true;
+    for (size_t s = 0; s < secrets.size(); ++s) ok = ok && Fr_toMpz(rec[s]) == secrets[s];
+    if (ok) {
+        TEST_PASS("Shamir share / reconstruct (roots of unity)");
+    } else {
+        TEST_FAIL("Shamir NTT-domain reconstruction mismatch");
+    }
+
+    // C. Packed sharing, 3 secrets per polynomial
+    ShamirEngine packed(9, 5, ShamirDomain::Integers, 3);
+    ShamirShares packedShares = packed.share(secrets, rng_tools);
+    rec = packed.reconstruct(packedShares, {0, 2, 4, 6, 8});
+    ok = packedShares.perParty == 34;
+    for (size_t s = 0; s < secrets.size(); ++s) ok = ok && Fr_toMpz(rec[s]) == secrets[s];
+    if (ok) {
+        TEST_PASS("Packed Shamir share / reconstruct");
+    } else {
+        TEST_FAIL("Packed Shamir reconstruction mismatch");
+    }
+}
+
+// ==================================================================
+// 6. Asynchronous Pairing Verifier Test
+// ==================================================================
+void Test_PairingVerifier() {
+    cout << "\n--- Test 6: Asynchronous Pairing Verifier ---" << endl;
+
+    initRNG(&rng_tools);
+    ECP g1;
+    ECP2 g2;
+    ECP_generator(&g1);
+    ECP2_generator(&g2);
+
+    // e(a*g1, g2) * e(-g1, a*g2) == 1 for a valid check
+    auto makeCheck = [&](bool valid) {
+        BIG a;
+        randBig(a, rng_tools);
+        PairingCheck c;
+        ECP P = g1, negG1 = g1;
+        ECP2 Q = g2;
+        ECP_mul(&P, a);
+        ECP_neg(&negG1);
+        if (!valid) BIG_inc(a, 1);
+        ECP2_mul(&Q, a);
+        c.g1 = {P, negG1};
+        c.g2 = {g2, Q};
+        return c;
+    };
+
+    PairingVerifierConfig config;
+    config.maxBatch = 8;
+    config.maxLatency = chrono::milliseconds(20);
+    config.workers = 2;
+    vector<PairingCheck> checks;
+    vector<bool> expected;
+    for (int i = 0; i < 12; ++i) {
+        expected.push_back(i != 5);
+        checks.push_back(makeCheck(expected.back()));
+    }
+    vector<future<bool>> results;
+    {
+        PairingVerifier verifier(config);
+        for (PairingCheck &c: checks) results.push_back(verifier.submit(c));
+        bool ok = true;
+        for (size_t i = 0; i < results.size(); ++i) ok = ok && results[i].get() == expected[i];
+        PairingVerifierStats st = verifier.stats();
+        if (ok && st.submitted == 12 && st.rejected == 1 && st.failedBatches >= 1) {
+            TEST_PASS("Async batched pairing verification");
+        } else {
+            TEST_FAIL("Async pairing verifier returned wrong verdicts");
+        }
+    }
+}
+
+void Test_FpBatch() {
+    cout << "\n--- Test 7: Batched Fp Arithmetic (SIMD backends vs MIRACL) ---" << endl;
+
+    initRNG(&rng_tools);
+    BIG p, v;
+    BIG_rcopy(p, Modulus);
+    const size_t n = 203;   // not a multiple of any lane count
+    vector<FP> a(n), b(n);
+    for (size_t i = 0; i < n; ++i) {
+        BIG_randomnum(v, p, &rng_tools);
+        FP_nres(&a[i], v);
+        BIG_randomnum(v, p, &rng_tools);
+        FP_nres(&b[i], v);
+    }
+    // Edge cases: zero, one, p - 1, and unreduced inputs carrying an excess
+    FP_zero(&a[0]);
+    FP_one(&b[1]);
+    BIG_copy(v, p);
+    BIG_dec(v, 1);
+    FP_nres(&a[2], v);
+    FP_nres(&b[2], v);
+    FP_add(&a[3], &a[4], &a[5]);
+    FP_sub(&b[6], &b[7], &b[8]);
+
+    // Bit-identical: same limbs after the MIRACL operation and FP_reduce
+    auto same = [](FP &x, FP &y) { return BIG_comp(x.g, y.g) == 0 && x.XES == y.XES; };
+
+    vector<FP> mul(n), sqr(n), add(n), sub(n), inv(n);
+    for (size_t i = 0; i < n; ++i) {
+        FP_mul(&mul[i], &a[i], &b[i]);
+        FP_reduce(&mul[i]);
+        FP_sqr(&sqr[i], &a[i]);
+        FP_reduce(&sqr[i]);
+        FP_add(&add[i], &a[i], &b[i]);
+        FP_reduce(&add[i]);
+        FP_sub(&sub[i], &a[i], &b[i]);
+        FP_reduce(&sub[i]);
+        if (FP_iszilch(&a[i])) {
+            FP_zero(&inv[i]);
+        } else {
+            FP_inv(&inv[i], &a[i], NULL);
+            FP_reduce(&inv[i]);
+        }
+    }
+
+    vector<ECP> pts(17), ref(17);
+    for (size_t i = 0; i < pts.size(); ++i) {
+        ECP_generator(&pts[i]);
+        randBig(v, rng_tools);
+        ECP_mul(&pts[i], v);
+    }
+    ECP_inf(&pts[4]);
+    ECP_affine(&pts[9]);
+
+    FpBackend original = FpBatch_backend();
+    for (FpBackend backend: {FpBackend::Scalar, FpBackend::AVX2, FpBackend::AVX512}) {
+        if (!FpBatch_supported(backend)) {
+            cout << "  (" << FpBatch_backendName(backend) << " not supported by this CPU, skipped)" << endl;
+            continue;
+        }
+        FpBatch_setBackend(backend);
+        string name = FpBatch_backendName(backend);
+        vector<FP> r(n), r2(n);
+        bool ok = true;
+        FpBatch_mul(r.data(), a.data(), b.data(), n);
+        for (size_t i = 0; i < n; ++i) ok = ok && same(r[i], mul[i]);
+        FpBatch_sqr(r.data(), a.data(), n);
+        for (size_t i = 0; i < n; ++i) ok = ok && same(r[i], sqr[i]);
+        FpBatch_add(r.data(), a.data(), b.data(), n);
+        for (size_t i = 0; i < n; ++i) ok = ok && same(r[i], add[i]);
+        FpBatch_sub(r.data(), a.data(), b.data(), n);
+        for (size_t i = 0; i < n; ++i) ok = ok && same(r[i], sub[i]);
+        FpBatch_inv(r.data(), a.data(), n);
+        for (size_t i = 0; i < n; ++i) ok = ok && same(r[i], inv[i]);
+        // In place
+        r2 = a;
+        FpBatch_mul(r2.data(), r2.data(), b.data(), n);
+        for (size_t i = 0; i < n; ++i) ok = ok && same(r2[i], mul[i]);
+        if (ok) {
+            TEST_PASS("FpBatch mul/sqr/add/sub/inv match MIRACL [" + name + "]");
+        } else {
+            TEST_FAIL("FpBatch result differs from MIRACL [" + name + "]");
+        }
+
+        vector<ECP> batch = pts;
+        ECP_batchAffine(batch.data(), batch.size());
+        bool affineOk = true;
+        for (size_t i = 0; i < pts.size(); ++i) {
+            ECP single = pts[i];
+            ECP_affine(&single);
+            affineOk = affineOk && same(batch[i].x, single.x) && same(batch[i].y, single.y)
+                       && same(batch[i].z, single.z) && ECP_equals(&batch[i], &pts[i]);
+        }
+        if (affineOk) {
+            TEST_PASS("ECP_batchAffine matches ECP_affine [" + name + "]");
+        } else {
+            TEST_FAIL("ECP_batchAffine differs from ECP_affine [" + name + "]");
+        }
+    }
+    FpBatch_setBackend(original);
+}
+
+void Test_PrecomputeCache() {
+    cout << "\n--- Test 8: Persistent Precompute Cache ---" << endl;
+
+    string path = "test_precompute.cache";
+    remove(path.c_str());
+    ShamirEngine engine(20, 7);
+    auto build = [&](PrecomputeCacheBuilder &b) {
+        Precompute_addGenerators(b);
+        Precompute_addShamirWeights(b, engine);
+    };
+
+    bool rebuilt = false;
+    PrecomputeCache::openOrBuild(path, build, &rebuilt);
+    bool reopened = true;
+    PrecomputeCache cache = PrecomputeCache::openOrBuild(path, build, &reopened);
+    if (rebuilt && !reopened) {
+        TEST_PASS("Cache built once, then mapped from disk");
+    } else {
+        TEST_FAIL("Cache was not built/reused as expected");
+    }
+
+    size_t n1, n2;
+    const ECP *t1 = cache.get<ECP>(PRECOMPUTE_G1_GENERATOR, n1);
+    const ECP2 *t2 = cache.get<ECP2>(PRECOMPUTE_G2_GENERATOR, n2);
+    mpz_class k = rand_mpz(state_gmp);
+    ECP P = ECP_mulFixedBase(t1, k), expect1;
+    ECP2 Q = ECP2_mulFixedBase(t2, k), expect2;
+    ECP_generator(&expect1);
+    ECP2_generator(&expect2);
+    ECP_mul(expect1, k);
+    ECP2_mul(expect2, k);
+    if (n1 == FIXED_BASE_TABLE_SIZE && n2 == FIXED_BASE_TABLE_SIZE && ECP_equals(&P, &expect1) &&
+        ECP2_equals(&Q, &expect2)) {
+        TEST_PASS("Fixed-base multiplication from mapped tables");
+    } else {
+        TEST_FAIL("Fixed-base multiplication from mapped tables is wrong");
+    }
+
+    ShamirEngine fresh(20, 7);
+    vector<size_t> ids = {0, 1, 2, 3, 4, 5, 6};
+    bool loaded = Precompute_loadShamirWeights(cache, fresh);
+    vector<Fr> w1 = fresh.reconstructionWeights(ids), w2 = engine.reconstructionWeights(ids);
+    bool same = w1.size() == w2.size();
+    for (size_t i = 0; same && i < w1.size(); ++i) same = Fr_equals(w1[i], w2[i]);
+    if (loaded && same) {
+        TEST_PASS("Shamir weights loaded from cache");
+    } else {
+        TEST_FAIL("Shamir weights missing or different in cache");
+    }
+
+    // Corrupt one byte of a table: the cache must be rejected and rebuilt
+    {
+        FILE *f = fopen(path.c_str(), "r+b");
+        fseek(f, -100, SEEK_END);
+        int c = fgetc(f);
+        fseek(f, -100, SEEK_END);
+        fputc(c ^ 0x5a, f);
+        fclose(f);
+    }
+    bool rejected = false;
+    try {
+        PrecomputeCache corrupt(path);
+    } catch (const runtime_error &) {
+        rejected = true;
+    }
+    PrecomputeCache::openOrBuild(path, build, &rebuilt);
+    if (rejected && rebuilt) {
+        TEST_PASS("Corrupt cache rejected and rebuilt");
+    } else {
+        TEST_FAIL("Corrupt cache was accepted");
+    }
+    remove(path.c_str());
+}
+
+void Test_ScalarRng() {
+    cout << "\n--- Test 9: Bulk Scalar Generation (ChaCha20) ---" << endl;
+
+    const mpz_class &q = getCurveOrder();
+    ScalarRng a(2024), b(2024), c(2025);
+    vector<mpz_class> x(500), y(500), z(500);
+    a.fill(x);
+    b.fill(y);
+    c.fill(z);
+    bool inRange = true;
+    for (const mpz_class &v: x) inRange = inRange && v > 0 && v < q;
+    if (x == y && x != z && inRange) {
+        TEST_PASS("Seeded streams are reproducible and in [1, q)");
+    } else {
+        TEST_FAIL("Seeded scalar stream is wrong");
+    }
+
+    // The same seed yields the same scalars in every output type
+    ScalarRng bigRng(2024), frRng(2024);
+    vector<BIG> bigs(500);
+    vector<Fr> frs(500);
+    bigRng.fill(bigs.data(), bigs.size());
+    frRng.fill(frs);
+    bool consistent = true;
+    mpz_class rInv;
+    mpz_class R = mpz_class(1) << 256;
+    mpz_invert(rInv.get_mpz_t(), R.get_mpz_t(), q.get_mpz_t());
+    for (size_t i = 0; i < x.size(); ++i) {
+        consistent = consistent && BIG_to_mpz(bigs[i]) == x[i];
+        // Fr outputs hold the words as their Montgomery representation
+        consistent = consistent && Fr_toMpz(frs[i]) == x[i] * rInv % q;
+    }
+    if (consistent) {
+        TEST_PASS("BIG / mpz_class / Fr outputs agree");
+    } else {
+        TEST_FAIL("ScalarRng outputs disagree between types");
+    }
+
+    initRNG(&rng_tools);
+    ScalarRng keyed(rng_tools);
+    mpz_class k1 = keyed.nextMpz(), k2 = keyed.nextMpz();
+    if (k1 != k2 && k1 > 0 && k1 < q) {
+        TEST_PASS("csprng-keyed generator");
+    } else {
+        TEST_FAIL("csprng-keyed generator is wrong");
+    }
+}
+
+void Test_GTFixedBase() {
+    cout << "\n--- Test 10: Fixed-Base GT Exponentiation ---" << endl;
+
+    initRNG(&rng_tools);
+    ECP g1 = randECP(rng_tools);
+    ECP2 g2;
+    ECP2_generator(&g2);
+    FP12 base = e(g1, g2);
+    const mpz_class &q = getCurveOrder();
+    vector<mpz_class> exps = {0, 1, 2, q - 1, q, q + 5, mpz_class(1) << 200};
+    for (int i = 0; i < 5; ++i) exps.push_back(rand_mpz(state_gmp));
+
+    for (int w: {4, 6, 8}) {
+        GTFixedBase gt(base, w);
+        bool ok = true;
+        for (const mpz_class &k: exps) {
+            FP12 expect = base, got = gt.pow(k);
+            FP12_pow(expect, k % q);
+            ok = ok && FP12_equals(&got, &expect);
+        }
+        // BIG entry point
+        BIG b;
+        randBig(b, rng_tools);
+        FP12 got, expect = base;
+        gt.pow(got, b);
+        FP12_pow(&expect, &expect, b);
+        ok = ok && FP12_equals(&got, &expect);
+        if (ok) {
+            TEST_PASS("GTFixedBase matches FP12_pow (w = " + to_string(w) + ")");
+        } else {
+            TEST_FAIL("GTFixedBase differs from FP12_pow (w = " + to_string(w) + ")");
+        }
+    }
+
+    // A table used in place, as when mapped from a PrecomputeCache
+    GTFixedBase owner(base, 5);
+    GTFixedBase view(owner.table(), GTFixedBase::tableSize(5), 5);
+    mpz_class k = rand_mpz(state_gmp);
+    FP12 a = owner.pow(k), b2 = view.pow(k);
+    if (FP12_equals(&a, &b2)) {
+        TEST_PASS("GTFixedBase over an external table");
+    } else {
+        TEST_FAIL("GTFixedBase over an external table is wrong");
+    }
+}
+
+void Test_PointBatch() {
+    cout << "\n--- Test 11: Point Batches ---" << endl;
+
+    initRNG(&rng_tools);
+    const size_t n = 37;
+    G1Batch a, b;
+    G2Batch c;
+    for (size_t i = 0; i < n; ++i) {
+        a.push_back(randECP(rng_tools));
+        b.push_back(randECP(rng_tools));
+        c.push_back(randECP2(rng_tools));
+    }
+    // Projective sums, a point at infinity and an already-affine point
+    a.add(b);
+    c.add(c);
+    ECP_inf(&a[3]);
+    ECP2_inf(&c[5]);
+    ECP_affine(&a[4]);
+
+    G1Batch a2 = a;
+    G2Batch c2 = c;
+    a2.normalize();
+    c2.normalize();
+    bool ok = true;
+    for (size_t i = 0; i < n; ++i) {
+        ECP p = a[i];
+        ECP2 q = c[i];
+        ECP_affine(&p);
+        ECP2_affine(&q);
+        ok = ok && ECP_equals(&p, &a2[i]) && ECP2_equals(&q, &c2[i]);
+        ok = ok && (i == 3 ? ECP_isinf(&a2[i]) : FP_isunity(&a2[i].z));
+        ok = ok && (i == 5 ? ECP2_isinf(&c2[i]) : FP2_isunity(&c2[i].z));
+    }
+    if (ok) {
+        TEST_PASS("Batch normalization matches ECP_affine / ECP2_affine");
+    } else {
+        TEST_FAIL("Batch normalization differs from ECP_affine / ECP2_affine");
+    }
+
+    // Equality is on group elements, not coordinates
+    G1Batch d = a2;
+    d.negate();
+    d.negate();
+    ECP_dbl(&d[7]);
+    vector<bool> expect(n, true);
+    expect[7] = false;
+    unique_ptr<bool[]> eq(new bool[n]);
+    a.equalsEach(d, eq.get());
+    ok = a == a2 && c == c2 && a != d;
+    for (size_t i = 0; i < n; ++i) ok = ok && eq[i] == expect[i];
+    if (ok) {
+        TEST_PASS("Batch equality across coordinate systems");
+    } else {
+        TEST_FAIL("Batch equality is wrong");
+    }
+
+    // MSM reads the batch in place; sum and subgroup membership
+    vector<mpz_class> ones(n, 1);
+    ECP s1 = ECP_msm(a, ones), s2 = a.sum();
+    G1Batch z = a;
+    z.sub(a);
+    ECP s3 = z.sum();
+    if (ECP_equals(&s1, &s2) && ECP_isinf(&s3) && a.allInSubgroup() && c.allInSubgroup()) {
+        TEST_PASS("Batch sum, MSM and subgroup checks");
+    } else {
+        TEST_FAIL("Batch sum, MSM or subgroup checks are wrong");
+    }
+
+    // Serialization round trip (infinity has no encoding)
+    ECP_generator(&a[3]);
+    ECP2_generator(&c[5]);
+    G1Batch a3 = G1Batch::fromBytes(a.toBytes().data(), n * G1Batch::encodedSize(true));
+    vector<unsigned char> cb = c.toBytes(false);
+    G2Batch c3 = G2Batch::fromBytes(cb.data(), cb.size(), false);
+    if (a3 == a && c3 == c) {
+        TEST_PASS("Batch serialization round trip");
+    } else {
+        TEST_FAIL("Batch serialization round trip failed");
+    }
+}
+
+// ==================================================================
+// 12. Modular Inversion Test
+// ==================================================================
+void Test_ModularInversion() {
+    cout << "\n--- Test 12: Modular Inversion ---" << endl;
+
+    initRNG(&rng_tools);
+    BIG order, modulus, even;
+    BIG_rcopy(order, CURVE_Order);
+    BIG_rcopy(modulus, Modulus);
+    BIG_zero(even);
+    BIG_inc(even, 1000000);
+
+    // Single inversions against MIRACL, with both the fast and the constant-time path
+    bool ok = true;
+    for (int i = 0; i < 20; ++i) {
+        for (BIG *m: {&order, &modulus}) {
+            BIG a, expect, got, gotCT;
+            randBig(a, rng_tools);
+            BIG_mod(a, *m);
+            BIG_invmodp(expect, a, *m);
+            BIG_inv(got, a, *m);
+            BIG_inv(gotCT, a, *m, true);
+            ok = ok && BIG_comp(got, expect) == 0 && BIG_comp(gotCT, expect) == 0;
+        }
+    }
+    BIG seven, inv7;
+    BIG_zero(seven);
+    BIG_inc(seven, 7);
+    BIG_inv(inv7, seven, even);  // even modulus: extended Euclid
+    mpz_class check = BIG_to_mpz(inv7) * 7 % 1000000;
+    ok = ok && check == 1;
+    if (ok) {
+        TEST_PASS("BIG_inv matches BIG_invmodp (variable and constant time)");
+    } else {
+        TEST_FAIL("BIG_inv differs from BIG_invmodp");
+    }
+
+    // Batch inversion over BIG (curve order and base field) and mpz_class
+    const size_t n = 50;
+    vector<BIG> a(n), r(n);
+    ok = true;
+    for (BIG *m: {&order, &modulus}) {
+        for (size_t i = 0; i < n; ++i) {
+            randBig(a[i], rng_tools);
+            BIG_mod(a[i], *m);
+        }
+        BIG_zero(a[7]);
+        BIG_batchInv(r.data(), a.data(), n, *m);
+        for (size_t i = 0; i < n; ++i) {
+            BIG expect;
+            if (i == 7) {
+                BIG_zero(expect);
+            } else {
+                BIG_invmodp(expect, a[i], *m);
+            }
+            ok = ok && BIG_comp(r[i], expect) == 0;
+        }
+    }
+    const mpz_class &q = getCurveOrder();
+    mpz_class p = BIG_to_mpz(modulus);
+    for (const mpz_class &m: {q, p}) {
+        vector<mpz_class> v(n);
+        for (size_t i = 0; i < n; ++i) v[i] = rand_mpz(state_gmp) - q / 2;
+        v[3] = 0;
+        v[4] = m * 3;
+        vector<mpz_class> inv = invert_mpz_batch(v, m);
+        for (size_t i = 0; i < n; ++i) {
+            mpz_class expect;
+            mpz_invert(expect.get_mpz_t(), v[i].get_mpz_t(), m.get_mpz_t());
+            ok = ok && inv[i] == expect && invert_mpz(v[i], m) == expect;
+        }
+    }
+    if (ok) {
+        TEST_PASS("Batch inversion over BIG and mpz_class");
+    } else {
+        TEST_FAIL("Batch inversion is wrong");
+    }
+}
+
+// ==================================================================
+// 13. Hex Codec Test
+// ==================================================================
+void Test_Hex() {
+    cout << "\n--- Test 13: Hex Codec ---" << endl;
+
+    // Byte codec against a printf reference, at lengths around the 32-byte SIMD block
+    bool ok = true;
+    for (size_t n = 0; n < 100; ++n) {
+        vector<unsigned char> bytes(n), back(n);
+        string expect;
+        char digit[3];
+        for (size_t i = 0; i < n; ++i) {
+            bytes[i] = (unsigned char) (i * 131 + n);
+            snprintf(digit, sizeof(digit), "%02x", bytes[i]);
+            expect += digit;
+        }
+        string hex = Hex_encode(bytes.data(), n);
+        ok = ok && hex == expect;
+        for (char &c: hex) c = (char) toupper(c);
+        ok = ok && Hex_decode(back.data(), hex.data(), n) && back == bytes;
+        if (n > 0) {
+            hex[(n * 7) % (2 * n)] = 'g';
+            ok = ok && !Hex_decode(back.data(), hex.data(), n);
+        }
+    }
+    if (ok) {
+        TEST_PASS("Hex_encode / Hex_decode match the reference and reject non-hex input");
+    } else {
+        TEST_FAIL("Hex byte codec is wrong");
+    }
+
+    // BIG, mpz_class and points
+    initRNG(&rng_tools);
+    ok = true;
+    for (int i = 0; i < 10; ++i) {
+        BIG a, b;
+        randBig(a, rng_tools);
+        mpz_class m = BIG_to_mpz(a);
+        str_to_BIG(m.get_str(16), b);
+        ok = ok && BIG_comp(a, b) == 0 && Hex_encodeMpz(m) == m.get_str(16) && Hex_encodeMpz(-m) == "-" + m.get_str(16);
+        mpz_class back;
+        string hex = Hex_encodeBIG(a);
+        Hex_decodeMpz(back, hex.data(), hex.size());
+        ok = ok && hex.size() == 96 && back == m;
+
+        ECP P = randECP(rng_tools), P2;
+        ECP2 Q = randECP2(rng_tools), Q2;
+        for (bool compress: {true, false}) {
+            string hp = Hex_encodeECP(P, compress), hq = Hex_encodeECP2(Q, compress);
+            Hex_decodeECP(P2, hp.data(), hp.size());
+            Hex_decodeECP2(Q2, hq.data(), hq.size());
+            ok = ok && ECP_equals(&P, &P2) && ECP2_equals(&Q, &Q2);
+        }
+    }
+    BIG big;
+    bool rejected = true;
+    for (const string &bad: {string("12x4"), string(97, '1')}) {
+        try {
+            str_to_BIG(bad, big);
+            rejected = false;
+        } catch (const invalid_argument &) {
+        }
+    }
+    if (ok && rejected) {
+        TEST_PASS("BIG, mpz_class and point hex round trips");
+    } else {
+        TEST_FAIL("BIG, mpz_class or point hex conversion is wrong");
+    }
+
+    // Streaming through a file
+    string path = "test_hex.txt";
+    vector<mpz_class> values;
+    FILE *f = fopen(path.c_str(), "w");
+    {
+        HexWriter writer(f);
+        for (int i = 0; i < 1000; ++i) {
+            values.push_back(rand_mpz(state_gmp));
+            writer.write(values.back());
+        }
+    }
+    fputs("not-hex\n", f);
+    fclose(f);
+    HexReader reader(path);
+    vector<mpz_class> read;
+    mpz_class v;
+    size_t badLine = 0;
+    try {
+        while (reader.next(v)) read.push_back(v);
+    } catch (const runtime_error &) {
+        badLine = reader.line();
+    }
+    remove(path.c_str());
+    if (read == values && badLine == 1001) {
+        TEST_PASS("HexReader / HexWriter stream values and report the bad line");
+    } else {
+        TEST_FAIL("Hex streaming is wrong");
+    }
+}
+
+// ==================================================================
+// 14. hashToPoint Cache Test
+// ==================================================================
+void Test_HashToPointCache() {
+    cout << "\n--- Test 14: hashToPoint Cache ---" << endl;
+
+    initRNG(&rng_tools);
+    BIG order;
+    BIG_rcopy(order, CURVE_Order);
+    const size_t n = 64;
+    vector<BIG> ids(n);
+    for (BIG &id: ids) randBig(id, rng_tools);
+
+    // Hits return the same points as hashToPoint
+    HashToPointCache cache;
+    bool ok = true;
+    for (int round = 0; round < 3; ++round) {
+        for (BIG &id: ids) {
+            ECP expect = hashToPoint(id, order);
+            ECP got = cache.get(id, order);
+            ok = ok && ECP_equals(&expect, &got);
+        }
+    }
+    mpz_class idMpz = BIG_to_mpz(ids[0]);
+    ECP viaMpz = cache.get(idMpz, getCurveOrder()), viaBig = hashToPoint(ids[0], order);
+    ok = ok && ECP_equals(&viaMpz, &viaBig);
+    HashToPointCacheStats st = cache.stats();
+    if (ok && st.misses == n && st.hits == 2 * n + 1 && st.entries == n) {
+        TEST_PASS("Cached points match hashToPoint; one miss per identity");
+    } else {
+        TEST_FAIL("hashToPoint cache returned a wrong point or miscounted");
+    }
+
+    // A table much smaller than the working set evicts but stays correct, also under concurrency
+    HashToPointCacheConfig config;
+    config.maxBytes = 4096;
+    HashToPointCache small(config);
+    atomic<bool> allOk{true};
+    vector<thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            for (size_t i = 0; i < 2 * n; ++i) {
+                BIG &id = ids[(i * 7 + t) % n];
+                ECP expect = hashToPoint(id, order);
+                ECP got = small.get(id, order);
+                if (!ECP_equals(&expect, &got)) allOk = false;
+            }
+        });
+    }
+    for (thread &th: threads) th.join();
+    st = small.stats();
+    small.clear();
+    ECP P;
+    bool gone = !small.lookup(P, ids[0], order) && small.stats().entries == 0;
+    if (allOk && st.entries <= st.capacity && st.evictions > 0 && gone) {
+        TEST_PASS("Bounded cache evicts, stays correct across threads and clears");
+    } else {
+        TEST_FAIL("Bounded hashToPoint cache is wrong");
+    }
+}
+
+// ==================================================================
+// 15. Scalar Plan Test
+// ==================================================================
+void Test_ScalarPlan() {
+    cout << "\n--- Test 15: Scalar Plan ---" << endl;
+
+    initState(state_gmp);
+    initRNG(&rng_tools);
+    const mpz_class &q = getCurveOrder();
+    bool ok = true;
+    for (const mpz_class &k: {mpz_class(0), mpz_class(1), mpz_class(-7), mpz_class(q - 1), mpz_class(q + 5),
+                              rand_mpz(state_gmp), rand_mpz(state_gmp)}) {
+        ScalarPlan plan(k);
+        ECP P = randECP(rng_tools), expect = P;
+        ECP2 Q = randECP2(rng_tools), expect2 = Q;
+        ECP_mul(expect, ((k % q) + q) % q);
+        ECP2_mul(expect2, ((k % q) + q) % q);
+        plan.apply(P);
+        plan.apply(Q);
+        ok = ok && ECP_equals(&P, &expect) && ECP2_equals(&Q, &expect2) && plan.isZero() == (k % q == 0);
+    }
+    if (ok) {
+        TEST_PASS("ScalarPlan matches ECP_mul / ECP2_mul on single points");
+    } else {
+        TEST_FAIL("ScalarPlan single-point result is wrong");
+    }
+
+    // Batches, including a point at infinity and repeated points
+    mpz_class k = rand_mpz(state_gmp);
+    ScalarPlan plan(k);
+    G1Batch g1(40);
+    G2Batch g2(5);
+    for (size_t i = 0; i < g1.size(); ++i) {
+        if (i != 3) g1[i] = randECP(rng_tools);
+    }
+    g1[7] = g1[6];
+    for (size_t i = 0; i < g2.size(); ++i) g2[i] = randECP2(rng_tools);
+    G1Batch expect = g1;
+    G2Batch expect2 = g2;
+    for (ECP &P: expect) ECP_mul(P, k);
+    for (ECP2 &Q: expect2) ECP2_mul(Q, k);
+    plan.apply(g1);
+    plan.apply(g2);
+    if (g1 == expect && g2 == expect2) {
+        TEST_PASS("ScalarPlan batch application (batch-affine G1, per-point G2)");
+    } else {
+        TEST_FAIL("ScalarPlan batch result is wrong");
+    }
+}
+
+// ==================================================================
+// 16. Short Scalars and Straus Test
+// ==================================================================
+void Test_ShortScalars() {
+    cout << "\n--- Test 16: Short Scalars and Straus ---" << endl;
+
+    initState(state_gmp);
+    initRNG(&rng_tools);
+    const mpz_class &q = getCurveOrder();
+    bool ok = true;
+    for (const mpz_class &k: {mpz_class(0), mpz_class(1), mpz_class(-3), mpz_class(rand_mpz(state_gmp) >> 191),
+                              mpz_class(-(rand_mpz(state_gmp) >> 127)), rand_mpz(state_gmp)}) {
+        ECP P = randECP(rng_tools), expect = P;
+        ECP2 Q = randECP2(rng_tools), expect2 = Q;
+        ECP_mul(expect, ((k % q) + q) % q);
+        ECP2_mul(expect2, ((k % q) + q) % q);
+        ECP R = ECP_mulShort(P, k);
+        ECP2 R2 = ECP2_mulShort(Q, k);
+        ok = ok && ECP_equals(&R, &expect) && ECP2_equals(&R2, &expect2);
+    }
+    if (ok) {
+        TEST_PASS("ECP_mulShort / ECP2_mulShort match ECP_mul on 64-bit, 128-bit, negative and full scalars");
+    } else {
+        TEST_FAIL("Short-scalar multiplication is wrong");
+    }
+
+    mpz_class a = rand_mpz(state_gmp) >> 127, b = -rand_mpz(state_gmp);
+    ECP P = randECP(rng_tools), Q = randECP(rng_tools);
+    ECP2 P2 = randECP2(rng_tools), Q2 = randECP2(rng_tools);
+    ECP expect = P, t = Q;
+    ECP2 expect2 = P2, t2 = Q2;
+    ECP_mul(expect, a);
+    ECP_mul(t, ((b % q) + q) % q);
+    ECP_add(&expect, &t);
+    ECP2_mul(expect2, a);
+    ECP2_mul(t2, ((b % q) + q) % q);
+    ECP2_add(&expect2, &t2);
+    ECP R = ECP_mul2(P, a, Q, b);
+    ECP2 R2 = ECP2_mul2(P2, a, Q2, b);
+    if (ECP_equals(&R, &expect) && ECP2_equals(&R2, &expect2)) {
+        TEST_PASS("ECP_mul2 / ECP2_mul2 (shared doubling chain)");
+    } else {
+        TEST_FAIL("Double-scalar multiplication is wrong");
+    }
+
+    // Straus serves ECP_msm up to STRAUS_MAX_TERMS terms, Pippenger beyond
+    ok = true;
+    for (size_t n: {(size_t) 1, (size_t) 3, STRAUS_MAX_TERMS, STRAUS_MAX_TERMS + 1}) {
+        vector<ECP> points(n);
+        vector<mpz_class> scalars(n);
+        ECP sum;
+        ECP_inf(&sum);
+        for (size_t i = 0; i < n; ++i) {
+            if (i != 1) points[i] = randECP(rng_tools);
+            scalars[i] = i % 2 ? rand_mpz(state_gmp) >> 191 : rand_mpz(state_gmp);
+            ECP term = points[i];
+            ECP_mul(term, scalars[i]);
+            ECP_add(&sum, &term);
+        }
+        ECP got = ECP_msm(points, scalars);
+        ok = ok && ECP_equals(&got, &sum);
+    }
+    if (ok) {
+        TEST_PASS("ECP_msm matches the sum of ECP_mul around the Straus threshold");
+    } else {
+        TEST_FAIL("Small ECP_msm is wrong");
+    }
+}
+
+// ==================================================================
+// 17. GMP Arena Test
+// ==================================================================
+void Test_GmpArena() {
+    cout << "\n--- Test 17: GMP Arena ---" << endl;
+
+    initState(state_gmp);
+    const mpz_class &q = getCurveOrder();
+    vector<mpz_class> x(24), y(24);
+    for (size_t i = 0; i < x.size(); ++i) {
+        x[i] = i + 1;
+        y[i] = rand_mpz(state_gmp);
+    }
+    vector<mpz_class> coffs = getLagrangeCoffs(x, y, q), basis = getLagrangeBasis(x, q);
+
+    GmpArena_install();
+    GmpArena_resetStats();
+    bool same;
+    {
+        GmpArenaScope arena;
+        same = getLagrangeCoffs(x, y, q) == coffs && getLagrangeBasis(x, q) == basis;
+    }
+    GmpArenaStats st = GmpArena_stats();
+    if (same && st.heapAllocs == 0 && st.arenaAllocs > 0 && st.resets == 1) {
+        TEST_PASS("Interpolation inside a scope allocates only from the arena");
+    } else {
+        TEST_FAIL("Arena-backed interpolation is wrong or reached the heap");
+    }
+
+    // A value created in a scope outlives it, then moves to the heap when it grows
+    mpz_class kept;
+    {
+        GmpArenaScope arena;
+        mpz_class t = coffs[1] * coffs[2];
+        kept.swap(t);
+    }
+    uint64_t resets = GmpArena_stats().resets;
+    kept *= kept;
+    bool escaped = kept == (coffs[1] * coffs[2]) * (coffs[1] * coffs[2]) && GmpArena_stats().resets == resets + 1;
+
+    // Independent arenas on several threads
+    atomic<int> bad{0};
+    vector<thread> workers;
+    for (int t = 0; t < 4; ++t) {
+        workers.emplace_back([&] {
+            for (int r = 0; r < 5; ++r) {
+                GmpArenaScope arena;
+                if (getLagrangeBasis(x, q) != basis) bad++;
+            }
+        });
+    }
+    for (thread &w: workers) w.join();
+    if (escaped && bad == 0) {
+        TEST_PASS("Values may outlive their scope; per-thread arenas");
+    } else {
+        TEST_FAIL("GMP arena lifetime or threading is wrong");
+    }
+}
+
+/**
+ * Run on its own (test_tools --arena-first-use), so that the library's lazily built mpz
+ * statics are first touched inside a scope on a worker thread
+ */
+void Test_GmpArenaFirstUse() {
+    cout << "\n--- Test 17b: GMP Arena and Library Statics ---" << endl;
+
+    GmpArena_install();
+    bool same = false;
+    uint64_t resets = 0;
+    thread worker([&] {
+        GmpArena_resetStats();
+        {
+            GmpArenaScope arena;
+            gmp_randstate_t state;
+            initState(state);
+            mpz_class k = rand_mpz(state) + getCurveOrder();
+            gmp_randclear(state);
+            ScalarPlan plan(k);
+            ECP P, expect;
+            ECP_generator(&P);
+            ECP_generator(&expect);
+            plan.apply(P);
+            ECP_mul(expect, k % getCurveOrder());
+            same = ECP_equals(&P, &expect);
+        }
+        resets = GmpArena_stats().resets;
+    });
+    worker.join();
+    if (same && resets == 1) {
+        TEST_PASS("Statics first built inside a scope do not pin the arena");
+    } else {
+        TEST_FAIL("A library static was allocated in the arena");
+    }
+}
+
+// ==================================================================
+// 18. Curve ISA Dispatch Test
+// ==================================================================
+void Test_CurveIsa() {
+    cout << "\n--- Test 18: Curve ISA Dispatch ---" << endl;
+
+    initState(state_gmp);
+    initRNG(&rng_tools);
+    CurveIsa original = CurveIsa_active();
+    cout << "Active level: " << CurveIsa_name(original) << endl;
+
+    mpz_class k = rand_mpz(state_gmp);
+    ECP P = randECP(rng_tools);
+    ECP2 Q = randECP2(rng_tools);
+    CurveIsa_set(CurveIsa::Baseline);
+    ECP kP = P;
+    ECP2 kQ = Q;
+    ECP_mul(kP, k);
+    ECP2_mul(kQ, k);
+    FP12 g = e(P, Q), gk = g;
+    FP12_pow(gk, k);
+
+    bool ok = true;
+    for (CurveIsa isa: {CurveIsa::Baseline, CurveIsa::AVX2, CurveIsa::AVX512}) {
+        if (!CurveIsa_supported(isa)) {
+            cout << CurveIsa_name(isa) << ": not available" << endl;
+            continue;
+        }
+        CurveIsa_set(isa);
+        ECP P1 = P;
+        ECP2 Q1 = Q;
+        ECP_mul(P1, k);
+        ECP2_mul(Q1, k);
+        FP12 g1 = e(P, Q), gk1 = g1;
+        FP12_pow(gk1, k);
+        // e(kP, Q) * e(-P, kQ) = 1
+        ECP negP = P;
+        ECP_neg(&negP);
+        bool same = CurveIsa_active() == isa && ECP_equals(&P1, &kP) && ECP2_equals(&Q1, &kQ) &&
+                    FP12_equals(&g1, &g) && FP12_equals(&gk1, &gk) && pairingProductIsOne({kP, negP}, {Q, kQ});
+        cout << CurveIsa_name(isa) << ": " << (same ? "matches baseline" : "MISMATCH") << endl;
+        ok = ok && same;
+    }
+    CurveIsa_set(original);
+    if (ok) {
+        TEST_PASS("Every available ISA level matches the baseline build");
+    } else {
+        TEST_FAIL("ISA-specific curve build disagrees with the baseline");
+    }
+}
+
+// ==================================================================
+// 19. Aggregate Key Test
+// ==================================================================
+void Test_AggregateKey() {
+    cout << "\n--- Test 19: Aggregate Key ---" << endl;
+
+    initRNG(&rng_tools);
+    vector<ECP2> keys(100);
+    for (ECP2 &K: keys) K = randECP2(rng_tools);
+    G2AggregateKey agg(keys);
+
+    // Epoch change: two members leave, three join (one reusing a freed slot), one rotates
+    agg.remove(17);
+    agg.remove(64);
+    vector<size_t> joined;
+    for (int i = 0; i < 3; ++i) {
+        ECP2 K = randECP2(rng_tools);
+        joined.push_back(agg.add(K));
+        if (joined.back() >= keys.size()) keys.resize(joined.back() + 1);
+        keys[joined.back()] = K;
+    }
+    keys[5] = randECP2(rng_tools);
+    agg.replace(5, keys[5]);
+
+    // Dense and sparse signer sets
+    bool ok = agg.size() == 101 && !agg.contains(17) && agg.contains(joined[0]);
+    for (int sparse = 0; sparse < 2; ++sparse) {
+        G2AggregateKey::Bitmap signers((agg.slots() + 63) / 64, 0);
+        ECP2 expect;
+        ECP2_inf(&expect);
+        for (size_t i = 0; i < agg.slots(); ++i) {
+            bool sign = agg.contains(i) && (sparse ? i % 9 == 0 : i % 9 != 0);
+            if (!sign) continue;
+            signers[i / 64] |= 1ULL << (i % 64);
+            ECP2_add(&expect, &keys[i]);
+        }
+        ECP2 got = agg.aggregate(signers);
+        ok = ok && ECP2_equals(&got, &expect);
+    }
+    ECP2 all;
+    ECP2_inf(&all);
+    for (size_t i = 0; i < agg.slots(); ++i) {
+        if (agg.contains(i)) ECP2_add(&all, &keys[i]);
+    }
+    ECP2 total = agg.total();
+    ok = ok && ECP2_equals(&total, &all);
+    if (ok) {
+        TEST_PASS("Incremental total and bitmap sub-aggregation match ECP2_add loops");
+    } else {
+        TEST_FAIL("Aggregate key is wrong after membership changes");
+    }
+
+    // Prepared lines give the same pairing as the total itself
+    ECP P = randECP(rng_tools);
+    FP12 r[ATE_BITS_BLS12381], v;
+    PAIR_initmp(r);
+    PAIR_another_pc(r, const_cast<FP4 *>(agg.prepared().data()), &P);
+    PAIR_miller(&v, r);
+    PAIR_fexp(&v);
+    FP12_reduce(&v);
+    FP12 expectGT = e(P, total);
+    bool threw = false;
+    try {
+        G2AggregateKey::Bitmap bad((agg.slots() + 63) / 64, 0);
+        bad[0] = 1ULL << 17;
+        agg.aggregate(bad);
+    } catch (const invalid_argument &) {
+        threw = true;
+    }
+    if (FP12_equals(&v, &expectGT) && threw) {
+        TEST_PASS("Cached prepared G2 lines; signers outside the set are rejected");
+    } else {
+        TEST_FAIL("Prepared lines or bitmap validation is wrong");
+    }
+}
+
+// ==================================================================
+// 20. Tuning Profile Test
+// ==================================================================
+void Test_Tuning() {
+    cout << "\n--- Test 20: Tuning Profile ---" << endl;
+
+    initState(state_gmp);
+    initRNG(&rng_tools);
+    TuningProfile original = Tuning_active();
+    cout << "CPU: " << Tuning_cpuModel() << endl;
+
+    // Profiles round-trip through the file; saving again replaces the section of the same CPU
+    const string path = "test_tuning.conf";
+    remove(path.c_str());
+    TuningProfile other = Tuning_defaults(), mine = Tuning_defaults();
+    other.cpu = "Other CPU @ 1.00GHz";
+    other.strausMaxTerms = 3;
+    mine.divstepsInverse = false;
+    mine.frPow = true;
+    mine.strausMaxTerms = 2;
+    for (int k = 0; k < TUNING_MSM_CLASSES; ++k) mine.msmWindow[k] = 2 + k % 5;
+    Tuning_save(path, other);
+    Tuning_save(path, Tuning_defaults());
+    Tuning_save(path, mine);
+    vector<TuningProfile> loaded = Tuning_load(path);
+    bool ok = loaded.size() == 2 && loaded[0].strausMaxTerms == 3 && loaded[1].cpu == mine.cpu &&
+              Tuning_format(loaded[1]) == Tuning_format(mine);
+    FILE *f = fopen(path.c_str(), "a");
+    fputs("[Broken CPU]\nversion = 1\nmsm_window = 2 99\n", f);
+    fclose(f);
+    bool threw = false;
+    try {
+        Tuning_load(path);
+    } catch (const runtime_error &) {
+        threw = true;
+    }
+    remove(path.c_str());
+    if (ok && threw && Tuning_load(path).empty()) {
+        TEST_PASS("Profiles round-trip per CPU model; malformed files are rejected");
+    } else {
+        TEST_FAIL("Tuning profile file handling is wrong");
+    }
+
+    // Every choice gives the same results, only the speed differs
+    vector<ECP> points(40);
+    vector<mpz_class> scalars(40);
+    for (size_t i = 0; i < points.size(); ++i) {
+        points[i] = randECP(rng_tools);
+        scalars[i] = rand_mpz(state_gmp);
+    }
+    const mpz_class &q = getCurveOrder();
+    mpz_class base = rand_mpz(state_gmp), exp = rand_mpz(state_gmp);
+    Tuning_apply(Tuning_defaults());
+    ECP msm5 = ECP_msm(points.data(), vector<mpz_class>(scalars.begin(), scalars.begin() + 5));
+    ECP msm40 = ECP_msm(points, scalars);
+    mpz_class pw = pow_mpz(base, exp, q), inv = invert_mpz(base, q);
+    Tuning_apply(mine);
+    ECP msm5t = ECP_msm(points.data(), vector<mpz_class>(scalars.begin(), scalars.begin() + 5));
+    ECP msm40t = ECP_msm(points, scalars);
+    ok = msmWindowBits(40) == mine.msmWindow[5] && ECP_equals(&msm5, &msm5t) && ECP_equals(&msm40, &msm40t) &&
+         pow_mpz(base, exp, q) == pw && pow_mpz(base, 0, q) == 1 && invert_mpz(base, q) == inv;
+
+    // A quick measurement gives a usable profile and leaves the active one alone
+    TuningConfig config;
+    config.repeats = 1;
+    config.maxMsmTerms = 64;
+    TuningProfile measured = Tuning_measure(config);
+    bool valid = FpBatch_supported(measured.fpBackend) && CurveIsa_supported(measured.curveIsa) &&
+                 measured.cpu == Tuning_cpuModel();
+    for (int c: measured.msmWindow) valid = valid && c >= 2 && c <= 16;
+    valid = valid && Tuning_format(Tuning_active()) == Tuning_format(mine);
+    Tuning_apply(original);
+    cout << Tuning_format(measured);
+    if (ok && valid) {
+        TEST_PASS("Tuned choices match the defaults' results; measuring restores the active profile");
+    } else {
+        TEST_FAIL("Tuning changed results or left a candidate profile active");
+    }
+}
+
+// ==================================================================
+// 21. Hybrid Cipher Test
+// ==================================================================
+void Test_HybridCipher() {
+    cout << "\n--- Test 21: Hybrid Encryption under a GT Key ---" << endl;
+
+    initRNG(&rng_tools);
+    FP12 key = e(randECP(rng_tools), randECP2(rng_tools));
+    FP12 other = e(randECP(rng_tools), randECP2(rng_tools));
+    bool hasAesni = Hybrid_aesni();
+    cout << "AES-NI: " << (hasAesni ? "yes" : "no") << endl;
+
+    // Round trips around the chunk boundaries, with several threads and small batches; both
+    // GCM implementations produce the same bytes from the same salt
+    HybridConfig config;
+    config.chunkBytes = 100;
+    config.threads = 3;
+    config.batchChunks = 2;
+    HybridConfig single = config;
+    single.threads = 1;
+    bool ok = true;
+    for (size_t n: {0, 1, 99, 100, 101, 250, 1000, 1234}) {
+        vector<unsigned char> plain(n);
+        for (unsigned char &b: plain) b = (unsigned char) rand();
+        csprng saltA = rng_tools, saltB = rng_tools;
+        vector<unsigned char> cipher = Hybrid_encrypt(key, plain, saltA, "test", config);
+        Hybrid_setAesni(!hasAesni);
+        vector<unsigned char> cipher2 = Hybrid_encrypt(key, plain, saltB, "test", single);
+        ok = ok && cipher == cipher2 && Hybrid_decrypt(key, cipher, "test", config) == plain;
+        Hybrid_setAesni(hasAesni);
+        size_t chunks = n ? (n + config.chunkBytes - 1) / config.chunkBytes : 1;
+        ok = ok && cipher.size() == HYBRID_HEADER_BYTES + n + chunks * HYBRID_TAG_BYTES &&
+             Hybrid_decrypt(key, cipher, "test", single) == plain;
+        rng_tools = saltA;
+    }
+
+    // Streams of several megabytes with the default chunking
+    vector<unsigned char> large((3 << 20) + 17);
+    for (size_t i = 0; i < large.size(); ++i) large[i] = (unsigned char) (i * 31 + (i >> 12));
+    istringstream in(string(large.begin(), large.end()));
+    stringstream cipherStream;
+    uint64_t written = Hybrid_encrypt(key, in, cipherStream, rng_tools);
+    ostringstream plainStream;
+    uint64_t read = Hybrid_decrypt(key, cipherStream, plainStream);
+    string round = plainStream.str();
+    ok = ok && written == large.size() && read == large.size() && round == string(large.begin(), large.end());
+    if (ok) {
+        TEST_PASS("Round trips at chunk boundaries; AES-NI and MIRACL GCM agree");
+    } else {
+        TEST_FAIL("Hybrid round trip or backend agreement failed");
+    }
+
+    // Wrong key or context, a flipped bit, a stream cut at a chunk boundary and trailing bytes
+    vector<unsigned char> plain(450, 0x5a);
+    vector<unsigned char> cipher = Hybrid_encrypt(key, plain, rng_tools, "test", config);
+    auto rejects = [&](const FP12 &k, const vector<unsigned char> &c, const string &context) {
+        try {
+            Hybrid_decrypt(k, c, context, config);
+        } catch (const runtime_error &) {
+            return true;
+        }
+        return false;
+    };
+    vector<unsigned char> flipped = cipher, cut = cipher, extended = cipher, header = cipher;
+    flipped[HYBRID_HEADER_BYTES + 3 * (config.chunkBytes + HYBRID_TAG_BYTES) + 5] ^= 1;
+    cut.resize(HYBRID_HEADER_BYTES + 2 * (config.chunkBytes + HYBRID_TAG_BYTES));
+    extended.push_back(0);
+    header[8] ^= 1;
+    if (rejects(other, cipher, "test") && rejects(key, cipher, "") && rejects(key, flipped, "test") &&
+        rejects(key, cut, "test") && rejects(key, extended, "test") && rejects(key, header, "test") &&
+        Hybrid_decrypt(key, cipher, "test", config) == plain) {
+        TEST_PASS("Wrong key / context, tampering, truncation and extension are rejected");
+    } else {
+        TEST_FAIL("A modified hybrid ciphertext was accepted");
+    }
+
+    // A forged header announcing the largest chunks, a short body and a huge batch: the
+    // buffers follow the bytes that arrive, not the header, so this fails on the tag
+    vector<unsigned char> forged(cipher.begin(), cipher.begin() + HYBRID_HEADER_BYTES + 100);
+    for (int i = 0; i < 4; ++i) forged[8 + i] = (unsigned char) (HYBRID_MAX_CHUNK_BYTES >> (8 * i));
+    HybridConfig huge = config;
+    huge.batchChunks = (size_t) 1 << 20;
+    string error;
+    try {
+        Hybrid_decrypt(key, forged, "test", huge);
+    } catch (const runtime_error &e) {
+        error = e.what();
+    } catch (const bad_alloc &) {
+        error = "bad_alloc";
+    }
+    if (error.find("authenticate") != string::npos) {
+        TEST_PASS("A forged chunk size does not allocate before authentication");
+    } else {
+        TEST_FAIL("A forged chunk size failed with: " + error);
+    }
+}
+
+// ==================================================================
+// 22. Pedersen Vector Commitment Test
+// ==================================================================
+void Test_Pedersen() {
+    cout << "\n--- Test 22: Pedersen Vector Commitments ---" << endl;
+
+    initState(state_gmp);
+    const mpz_class &q = getCurveOrder();
+    PedersenVector key(40);
+    PedersenVector small(5, 3);
+    cout << "Window bits: " << key.windowBits() << " (n = 40)" << endl;
+
+    // Generators are hashed to the curve, independent of the key size and all distinct
+    bool ok = true;
+    for (size_t i = 0; i < key.size(); ++i) {
+        ECP G = key.generator(i);
+        ok = ok && PAIR_G1member(&G) && !ECP_isinf(&G);
+        if (i < small.size()) ok = ok && ECP_equals(&G, const_cast<ECP *>(&small.generator(i)));
+        for (size_t j = 0; j < i && ok; ++j) ok = !ECP_equals(&G, const_cast<ECP *>(&key.generator(j)));
+    }
+    ECP H = key.blindingGenerator();
+    ok = ok && PAIR_G1member(&H) && ECP_equals(&H, const_cast<ECP *>(&small.blindingGenerator()));
+
+    // commit matches the ECP_mul loop, for every window width and for short vectors
+    vector<mpz_class> values(key.size());
+    for (mpz_class &v: values) v = rand_mpz(state_gmp);
+    values[1] = 0;
+    values[2] = -1;
+    values[3] = q + 7;
+    mpz_class r = rand_mpz(state_gmp);
+    ECP expected = key.blindingGenerator();
+    ECP_mul(expected, r);
+    for (size_t i = 0; i < values.size(); ++i) {
+        ECP T = key.generator(i);
+        ECP_mul(T, ((values[i] % q) + q) % q);
+        ECP_add(&expected, &T);
+    }
+    ECP C = key.commit(values, r);
+    PedersenVector narrow(40, 2), wide(40, 12);
+    ECP C2 = narrow.commit(values, r), C12 = wide.commit(values, r);
+    vector<mpz_class> prefix(values.begin(), values.begin() + 5);
+    ECP P1 = small.commit(prefix, r), P2 = key.commit(prefix, r);
+    ok = ok && ECP_equals(&C, &expected) && ECP_equals(&C2, &expected) && ECP_equals(&C12, &expected) &&
+         ECP_equals(&P1, &P2) && key.open(C, values, r) && !key.open(C, values, r + 1);
+    if (ok) {
+        TEST_PASS("Hashed generators; commit matches the ECP_mul loop for every window width");
+    } else {
+        TEST_FAIL("Pedersen generators or commitment are wrong");
+    }
+
+    // Single-slot updates, reblinding, homomorphic addition and an external table
+    key.update(C, 7, values[7], values[7] + 1);
+    values[7] += 1;
+    key.update(C, 0, values[0], 42);
+    values[0] = 42;
+    mpz_class r2 = rand_mpz(state_gmp);
+    key.reblind(C, r, r2);
+    vector<mpz_class> other(key.size());
+    for (mpz_class &v: other) v = rand_mpz(state_gmp);
+    mpz_class s = rand_mpz(state_gmp);
+    ECP sum = PedersenVector::add(C, key.commit(other, s));
+    vector<mpz_class> both(values);
+    for (size_t i = 0; i < both.size(); ++i) both[i] += other[i];
+    PedersenVector mapped(key.table(), PedersenVector::tableSize(key.size(), key.windowBits()), key.size(),
+                          key.windowBits());
+    bool threw = false;
+    try {
+        key.commit(vector<mpz_class>(key.size() + 1));
+    } catch (const invalid_argument &) {
+        threw = true;
+    }
+    if (key.open(C, values, r2) && key.open(sum, both, r2 + s) && mapped.open(sum, both, r2 + s) && threw) {
+        TEST_PASS("Updates, reblinding, homomorphic addition and mapped tables");
+    } else {
+        TEST_FAIL("Pedersen update or homomorphism is wrong");
+    }
+}
+
+// ==================================================================
+// 23. Schnorr Batch Verification Test
+// ==================================================================
+template<typename Point>
+bool schnorrBatchCase(const Point &g, ScalarRng &rng) {
+    vector<SchnorrProof<Point>> proofs;
+    vector<string> messages;
+    for (size_t i = 0; i < 33; ++i) {
+        messages.push_back("statement " + to_string(i));
+        proofs.push_back(Schnorr_prove(g, rng.nextMpz(), messages[i], rng));
+    }
+    bool ok = true;
+    for (const SchnorrProof<Point> &p: proofs) ok = ok && Schnorr_verify(g, p);
+    vector<SchnorrProof<Point>> rehashed = proofs;
+    for (SchnorrProof<Point> &p: rehashed) p.c = 0;
+    Schnorr_challenges(g, rehashed, messages);
+    for (size_t i = 0; i < proofs.size(); ++i) ok = ok && rehashed[i].c == proofs[i].c;
+
+    SchnorrBatchResult all = Schnorr_batchVerify(g, proofs, rng);
+    ok = ok && all.valid && all.invalid.empty() && all.checks == 1;
+    // Bad responses, bad challenges and swapped commitments are all pinned down
+    vector<SchnorrProof<Point>> bad = proofs;
+    bad[0].s += 1;
+    bad[17].c += 1;
+    GroupTraits<Point>::copy(bad[31].R, proofs[30].R);
+    SchnorrBatchResult some = Schnorr_batchVerify(g, bad);
+    ok = ok && !some.valid && some.invalid == vector<size_t>({0, 17, 31}) && some.checks < bad.size();
+    return ok;
+}
+
+void Test_SchnorrBatch() {
+    cout << "\n--- Test 23: Schnorr Batch Verification ---" << endl;
+
+    ScalarRng rng(23);
+    ECP g1;
+    ECP2 g2;
+    ECP_generator(&g1);
+    ECP2_generator(&g2);
+    g1 = ECP_mulShort(g1, 5);
+    if (schnorrBatchCase(g1, rng) && schnorrBatchCase(g2, rng)) {
+        TEST_PASS("Batches verify with one check; bisection finds exactly the bad proofs (G1 and G2)");
+    } else {
+        TEST_FAIL("Schnorr batch verification is wrong");
+    }
+}
+
+// ==================================================================
+// 24. Discrete Log Test
+// ==================================================================
+void Test_DiscreteLog() {
+    cout << "\n--- Test 24: Baby-Step Giant-Step Discrete Log ---" << endl;
+
+    ECP g1;
+    ECP2 g2;
+    ECP_generator(&g1);
+    ECP2_generator(&g2);
+    const uint64_t range = 1 << 20;
+    G1DiscreteLog dlog(g1, range, 300);
+    vector<uint64_t> messages = {0, 1, 299, 300, 301, 599, 600, 601, range - 1, 123456, 777777};
+    vector<ECP> targets;
+    for (uint64_t m: messages) targets.push_back(ECP_mulShort(g1, mpz_class((unsigned long) m)));
+    targets.push_back(ECP_mulShort(g1, mpz_class((unsigned long) range)));   // just out of range
+    targets.push_back(ECP_mulShort(g1, -5));
+    vector<int64_t> found = dlog.solveBatch(targets);
+    bool ok = found.size() == targets.size() && found[messages.size()] == -1 && found[messages.size() + 1] == -1;
+    for (size_t i = 0; ok && i < messages.size(); ++i) ok = found[i] == (int64_t) messages[i];
+    ok = ok && dlog.solve(targets[9]) == 123456 && dlog.solve(targets[10], 4) == 777777;
+    if (ok) {
+        TEST_PASS("G1: every message in range recovered, out-of-range targets rejected");
+    } else {
+        TEST_FAIL("G1 discrete log is wrong");
+    }
+
+    // A table mapped from a cache file answers like the one it was built from
+    string path = "test_dlog.cache";
+    remove(path.c_str());
+    PrecomputeCacheBuilder builder;
+    Precompute_addDiscreteLog(builder, dlog);
+    builder.write(path);
+    PrecomputeCache cache(path);
+    size_t n;
+    const uint64_t *table = cache.get<uint64_t>(Precompute_discreteLogSection(g1, 300), n);
+    G1DiscreteLog mapped(g1, range, table, n, 300);
+    bool threw = false;
+    try {
+        G1DiscreteLog(g1, range, table, n, 600);
+    } catch (const invalid_argument &) {
+        threw = true;
+    }
+    if (mapped.solveBatch(targets) == found && threw) {
+        TEST_PASS("Table mapped from a precompute cache");
+    } else {
+        TEST_FAIL("Mapped discrete-log table is wrong");
+    }
+    remove(path.c_str());
+
+    FP12 gt = e(g1, g2);
+    GTDiscreteLog gtLog(gt, 5000);
+    vector<FP12> gtTargets;
+    for (uint64_t m: {0, 1, 42, 4999, 5000}) {
+        FP12 t = gt;
+        if (m == 0) FP12_one(&t);
+        else FP12_pow(t, mpz_class((unsigned long) m));
+        gtTargets.push_back(t);
+    }
+    if (gtLog.solveBatch(gtTargets, 2) == vector<int64_t>({0, 1, 42, 4999, -1})) {
+        TEST_PASS("GT: messages recovered through the conjugate-invariant key");
+    } else {
+        TEST_FAIL("GT discrete log is wrong");
+    }
+}
+
+// ==================================================================
+// 25. Trace Test
+// ==================================================================
+void Test_Trace() {
+    cout << "\n--- Test 25: Record and Replay Trace ---" << endl;
+
+    ECP g1;
+    ECP2 g2;
+    ECP_generator(&g1);
+    ECP2_generator(&g2);
+    const mpz_class &q = getCurveOrder();
+    string path = "test_trace.bin";
+    remove(path.c_str());
+    Trace_start(path, true);
+    bool threw = false;
+    try {
+        Trace_start(path);
+    } catch (const runtime_error &) {
+        threw = true;
+    }
+    ECP P = g1;
+    ECP_mul(P, mpz_class(1000));
+    ECP_mul(P, q - 1);
+    e(P, g2);
+    hashToPoint(mpz_class(7), q);          // hashToZp256 inside it is not recorded
+    thread([&] { invert_mpz(mpz_class(3), q); }).join();
+    Trace_stop();
+    bool active = Trace_active();
+    ECP_mul(P, mpz_class(5));              // after the trace: not recorded
+
+    vector<TraceRecord> records = Trace_read(path);
+    vector<TraceOp> ops;
+    for (const TraceRecord &r: records) ops.push_back(r.op);
+    bool ok = ops == vector<TraceOp>({TraceOp::ECP_mul, TraceOp::ECP_mul, TraceOp::Pairing, TraceOp::HashToPoint,
+                                      TraceOp::InvertMpz});
+    ok = ok && records[0].size == 10 && records[1].size == 255 && records[4].size == 255 &&
+         records[4].thread != records[0].thread && !records[2].input.empty();
+    if (ok && threw && !active) {
+        TEST_PASS("Outermost calls recorded with sizes, threads and inputs");
+    } else {
+        TEST_FAIL("Trace records are wrong");
+    }
+
+    // Captured inputs replay exactly; a trace without inputs replays on random ones
+    vector<TraceOpStats> stats = Trace_replay(records, 2);
+    ok = stats.size() == 4 && stats[0].op == TraceOp::ECP_mul && stats[0].calls == 2;
+    for (const TraceOpStats &s: stats) ok = ok && s.synthesized == 0 && s.replayedNs > 0;
+    for (TraceRecord &r: records) r.input.clear();
+    stats = Trace_replay(records);
+    ok = ok && stats.size() == 4 && stats[2].op == TraceOp::InvertMpz && stats[2].synthesized == 1;
+    if (ok) {
+        TEST_PASS("Replay with captured and synthesized inputs");
+    } else {
+        TEST_FAIL("Trace replay is wrong");
+    }
+    remove(path.c_str());
+}
+
+// ==================================================================
+// 26. Streaming MSM Test
+// ==================================================================
+void Test_MsmStream() {
+    cout << "\n--- Test 26: Out-of-Core Streaming MSM ---" << endl;
+
+    initRNG(&rng_tools);
+    const mpz_class &q = getCurveOrder();
+    size_t n = 1000;
+    vector<ECP> points(n);
+    vector<mpz_class> scalars(n);
+    for (size_t i = 0; i < n; ++i) {
+        points[i] = randECP(rng_tools);
+        scalars[i] = rand_mpz(state_gmp);
+    }
+    scalars[1] = 0;
+    scalars[2] = q + 3;
+    scalars[3] = -7;
+    ECP expect = ECP_msm(points, scalars);
+
+    // uneven chunks, and a bucket budget that forces narrow windows
+    G1MsmStream narrow(n, 1 << 18, 3);
+    narrow.add(points.data(), scalars.data(), 1);
+    narrow.add(points.data() + 1, scalars.data() + 1, 600);
+    narrow.add(points.data() + 601, scalars.data() + 601, n - 601);
+    ECP got = narrow.result();
+    G1MsmStream wide(n);
+    wide.addSource(MsmStream_iterators(points.begin(), points.end(), scalars.begin()), 128);
+    ECP fromIterators = wide.result();
+    bool threw = false;
+    try {
+        G1MsmStream(n, 1000);
+    } catch (const invalid_argument &) {
+        threw = true;
+    }
+    if (ECP_equals(&got, &expect) && ECP_equals(&fromIterators, &expect) && wide.terms() == n &&
+        narrow.bucketBytes() <= (1 << 18) && narrow.windowBits() < wide.windowBits() && threw) {
+        TEST_PASS("Chunked and iterator streams match ECP_msm within the bucket budget");
+    } else {
+        TEST_FAIL("Streaming MSM differs from ECP_msm");
+    }
+
+    // points and 32-byte scalars in files
+    string pointsPath = "test_msm_points.bin", scalarsPath = "test_msm_scalars.bin";
+    G1Batch batch(points);
+    vector<unsigned char> bytes = batch.toBytes(false);
+    ofstream(pointsPath, ios::binary).write((const char *) bytes.data(), (streamsize) bytes.size());
+    {
+        ofstream out(scalarsPath, ios::binary);
+        for (const mpz_class &s: scalars) {
+            mpz_class r = s % q;
+            if (r < 0) r += q;
+            unsigned char b[32] = {0};
+            mpz_export(b + 32 - (mpz_sizeinbase(r.get_mpz_t(), 2) + 7) / 8, nullptr, 1, 1, 0, 0, r.get_mpz_t());
+            out.write((const char *) b, sizeof(b));
+        }
+    }
+    ECP fromFiles = ECP_msmFiles(pointsPath, scalarsPath, false);
+    threw = false;
+    try {
+        MsmStream_files<ECP>(pointsPath, scalarsPath, true);
+    } catch (const invalid_argument &) {
+        threw = true;
+    }
+    if (ECP_equals(&fromFiles, &expect) && threw) {
+        TEST_PASS("Memory-mapped point and scalar files");
+    } else {
+        TEST_FAIL("Streaming MSM over files is wrong");
+    }
+
+    // no terms: the point at infinity, like ECP_msm
+    ofstream(pointsPath, ios::binary | ios::trunc).flush();
+    ofstream(scalarsPath, ios::binary | ios::trunc).flush();
+    ECP empty = ECP_msmFiles(pointsPath, scalarsPath);
+    ECP p0;
+    BIG s0;
+    if (ECP_isinf(&empty) && MsmStream_files<ECP>(pointsPath, scalarsPath)(&p0, &s0, 1) == 0) {
+        TEST_PASS("Empty files give the point at infinity");
+    } else {
+        TEST_FAIL("Streaming MSM over empty files is wrong");
+    }
+    remove(pointsPath.c_str());
+    remove(scalarsPath.c_str());
+
+    ECP2 g2;
+    ECP2_generator(&g2);
+    vector<ECP2> points2(40);
+    for (size_t i = 0; i < points2.size(); ++i) points2[i] = ECP2_mulShort(g2, mpz_class((unsigned long) i + 2));
+    vector<mpz_class> scalars2(scalars.begin(), scalars.begin() + points2.size());
+    G2MsmStream stream2(points2.size());
+    stream2.add(points2, scalars2);
+    ECP2 expect2 = ECP2_msm(points2, scalars2), got2 = stream2.result();
+    if (ECP2_equals(&got2, &expect2)) {
+        TEST_PASS("G2 stream matches ECP2_msm");
+    } else {
+        TEST_FAIL("G2 streaming MSM is wrong");
+    }
+}
+
+void Test_HashBatch() {
+    cout << "\n--- Test 27: Multi-Buffer Batch Hashing ---" << endl;
+
+    initRNG(&rng_tools);
+    BIG q, other;
+    BIG_rcopy(q, CURVE_Order);
+    BIG_copy(other, q);
+    BIG_dec(other, 2);
+    // messages of 0 .. 200 bytes cross the one / two tail block boundary (55 / 56) and whole blocks
+    const int lens[] = {0, 1, 55, 56, 63, 64, 100, 119, 120, 128, 200};
+    size_t n = 37;
+    vector<vector<char>> msgs(n);
+    vector<octet> cts(n);
+    vector<BIG> in(n);
+    for (size_t i = 0; i < n; ++i) {
+        msgs[i].resize(200);
+        for (char &c: msgs[i]) c = (char) rand_mpz(state_gmp).get_ui();
+        cts[i] = {0, lens[i % (sizeof(lens) / sizeof(lens[0]))], msgs[i].data()};
+        randBig(in[i], rng_tools);
+    }
+    BIG_zero(in[0]);
+    vector<mpz_class> inMpz(n);
+    for (size_t i = 0; i < n; ++i) inMpz[i] = BIG_to_mpz(in[i]);
+
+    HashBackend saved = HashBatch_backend();
+    const HashBackend backends[] = {HashBackend::Scalar, HashBackend::Lanes4, HashBackend::ShaNi, HashBackend::AVX2,
+                                    HashBackend::AVX512};
+    for (HashBackend b: backends) {
+        if (!HashBatch_supported(b)) continue;
+        HashBatch_setBackend(b);
+        vector<BIG> zp(n), zpOther(n), toZp(n);
+        HashBatch_hashZp256(zp.data(), cts.data(), n, q);
+        HashBatch_hashZp256(zpOther.data(), cts.data(), n, other);
+        HashBatch_hashToZp256(toZp.data(), in.data(), n, q);
+        vector<mpz_class> toZpMpz = HashBatch_hashToZp256(inMpz, getCurveOrder());
+        vector<ECP> points(5);
+        HashBatch_hashToPoint(points.data(), in.data(), points.size(), q);
+        bool ok = true;
+        for (size_t i = 0; i < n; ++i) {
+            BIG e, eOther, eTo;
+            hashZp256(e, &cts[i], q);
+            hashZp256(eOther, &cts[i], other);
+            hashToZp256(eTo, in[i], q);
+            ok = ok && BIG_comp(e, zp[i]) == 0 && BIG_comp(eOther, zpOther[i]) == 0 && BIG_comp(eTo, toZp[i]) == 0 &&
+                 hashToZp256(inMpz[i], getCurveOrder()) == toZpMpz[i];
+        }
+        for (size_t i = 0; i < points.size(); ++i) {
+            ECP e = hashToPoint(in[i], q);
+            ok = ok && ECP_equals(&e, &points[i]);
+        }
+        if (ok) {
+            TEST_PASS(string("Backend ") + HashBatch_backendName(b) + " matches the per-item hashes");
+        } else {
+            TEST_FAIL(string("Batch hashing differs on backend ") + HashBatch_backendName(b));
+        }
+    }
+    HashBatch_setBackend(saved);
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && string(argv[1]) == "--arena-first-use") {
+        Test_GmpArenaFirstUse();
+        return 0;
+    }
     cout << "=== Running Wrapper Verification ===" << endl;
 
     Test_GMP_Convenience();
     Test_Conversion_And_ECP_Adapter();
     Test_FP12_Adapter();
+    Test_KZG();
+    Test_Shamir();
+    Test_PairingVerifier();
+    Test_FpBatch();
+    Test_PrecomputeCache();
+    Test_ScalarRng();
+    Test_GTFixedBase();
+    Test_PointBatch();
+    Test_ModularInversion();
+    Test_Hex();
+    Test_HashToPointCache();
+    Test_ScalarPlan();
+    Test_ShortScalars();
+    Test_GmpArena();
+    Test_CurveIsa();
+    Test_AggregateKey();
+    Test_Tuning();
+    Test_HybridCipher();
+    Test_Pedersen();
+    Test_SchnorrBatch();
+    Test_DiscreteLog();
+    Test_Trace();
+    Test_MsmStream();
+    Test_HashBatch();
 
     cout << "\n=== All Tests Passed ===" << endl;
     return 0;
@@ -0,0 +1,98 @@
+/**
+ * @file precompute_cache.cpp
+ * @brief Pre-generates or checks a precompute cache file during deployment.
+ *
+ * Usage:
+ *   precompute_cache build <file> [--gt] [--shamir N:T[:roots]]... [--dlog g1|gt:BITS[:M]]...
+ *   precompute_cache check <file>
+ *
+ * `build` writes the fixed-base tables of the G1/G2 generators, the GT table of e(g1, g2) with
+ * --gt, the Shamir reconstruction weights (parties 0 .. T-1) of every configuration given
+ * with --shamir, and with --dlog the discrete-log table of the G1 generator or of e(g1, g2)
+ * for exponents below 2^BITS, with M baby steps (default DiscreteLog::defaultBabySteps).
+ */
+
+#include "../include/PrecomputeCache.h"
+#include <iostream>
+
+using namespace std;
+
+static int usage() {
+    cerr << "usage: precompute_cache build <file> [--gt] [--shamir N:T[:roots]]... [--dlog g1|gt:BITS[:M]]...\n"
+            "       precompute_cache check <file>" << endl;
+    return 2;
+}
+
+static ShamirEngine parseShamir(const string &spec) {
+    size_t n = 0, t = 0;
+    char domain[16] = {0};
+    int fields = sscanf(spec.c_str(), "%zu:%zu:%15s", &n, &t, domain);
+    if (fields < 2 || (fields == 3 && string(domain) != "roots")) {
+        throw invalid_argument("bad --shamir specification: " + spec);
+    }
+    return ShamirEngine(n, t, fields == 3 ? ShamirDomain::RootsOfUnity : ShamirDomain::Integers);
+}
+
+static void addDiscreteLog(PrecomputeCacheBuilder &builder, const string &spec) {
+    char group[4] = {0};
+    unsigned bits = 0;
+    unsigned long long m = 0;
+    int fields = sscanf(spec.c_str(), "%3[^:]:%u:%llu", group, &bits, &m);
+    if (fields < 2 || (string(group) != "g1" && string(group) != "gt") || bits < 1 || bits > 62) {
+        throw invalid_argument("bad --dlog specification: " + spec);
+    }
+    ECP g1;
+    ECP_generator(&g1);
+    uint64_t range = (uint64_t) 1 << bits;
+    if (string(group) == "g1") {
+        Precompute_addDiscreteLog(builder, G1DiscreteLog(g1, range, m));
+    } else {
+        ECP2 g2;
+        ECP2_generator(&g2);
+        Precompute_addDiscreteLog(builder, GTDiscreteLog(e(g1, g2), range, m));
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) return usage();
+    string cmd = argv[1], path = argv[2];
+    try {
+        if (cmd == "build") {
+            vector<string> shamir, dlog;
+            bool gt = false;
+            for (int i = 3; i < argc; ++i) {
+                if (string(argv[i]) == "--gt") {
+                    gt = true;
+                } else if (string(argv[i]) == "--shamir" && i + 1 < argc) {
+                    shamir.push_back(argv[++i]);
+                } else if (string(argv[i]) == "--dlog" && i + 1 < argc) {
+                    dlog.push_back(argv[++i]);
+                } else {
+                    return usage();
+                }
+            }
+            auto start = steady_clock::now();
+            PrecomputeCacheBuilder builder;
+            Precompute_addGenerators(builder);
+            if (gt) Precompute_addGTGenerator(builder);
+            for (const string &spec: shamir) {
+                ShamirEngine engine = parseShamir(spec);
+                Precompute_addShamirWeights(builder, engine);
+            }
+            for (const string &spec: dlog) addDiscreteLog(builder, spec);
+            builder.write(path);
+            auto ms = duration_cast<milliseconds>(steady_clock::now() - start).count();
+            cout << "Wrote " << path << " in " << ms << " ms" << endl;
+        } else if (cmd != "check") {
+            return usage();
+        }
+
+        PrecomputeCache cache(path);
+        cout << path << ": version " << PRECOMPUTE_CACHE_VERSION << ", " << cache.fileSize() << " bytes" << endl;
+        for (const string &name: cache.sections()) cout << "  " << name << endl;
+    } catch (const exception &e) {
+        cerr << "precompute_cache: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,68 @@
+/**
+ * @file trace_replay.cpp
+ * @brief Replays a recorded trace of Tools.h calls against this build of the library.
+ *
+ * Usage:
+ *   trace_replay <trace> [--repeats N]
+ *
+ * Prints, per operation, the number of calls (and how many were replayed on random inputs
+ * because the trace holds no inputs), the recorded and replayed total time and the change.
+ * With --repeats N every call is executed N times and the fastest run counts. Traces are
+ * recorded with Trace_start or the WRAPPER_TRACE environment variable (see Trace.h).
+ */
+
+#include "../include/Trace.h"
+#include <iomanip>
+#include <iostream>
+
+using namespace std;
+
+static int usage() {
+    cerr << "usage: trace_replay <trace> [--repeats N]" << endl;
+    return 2;
+}
+
+static void printRow(const string &name, size_t calls, size_t synthesized, uint64_t recordedNs, uint64_t replayedNs) {
+    cout << left << setw(24) << name << right << setw(10) << calls << setw(10) << synthesized << fixed
+         << setprecision(3) << setw(14) << recordedNs / 1e6 << setw(14) << replayedNs / 1e6;
+    if (recordedNs) {
+        cout << setprecision(1) << setw(9) << showpos << 100.0 * ((double) replayedNs - recordedNs) / recordedNs
+             << noshowpos << "%";
+    }
+    cout << endl;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) return usage();
+    string path = argv[1];
+    int repeats = 1;
+    for (int i = 2; i < argc; ++i) {
+        if (string(argv[i]) == "--repeats" && i + 1 < argc) {
+            repeats = atoi(argv[++i]);
+        } else {
+            return usage();
+        }
+    }
+    try {
+        vector<TraceRecord> records = Trace_read(path);
+        uint32_t threads = 0;
+        for (const TraceRecord &r: records) threads = max(threads, r.thread + 1);
+        cout << path << ": " << records.size() << " calls on " << threads << " threads" << endl;
+        vector<TraceOpStats> stats = Trace_replay(records, repeats);
+        cout << left << setw(24) << "operation" << right << setw(10) << "calls" << setw(10) << "random"
+             << setw(14) << "recorded ms" << setw(14) << "replayed ms" << setw(10) << "change" << endl;
+        TraceOpStats total;
+        for (const TraceOpStats &s: stats) {
+            printRow(TraceOp_name(s.op), s.calls, s.synthesized, s.recordedNs, s.replayedNs);
+            total.calls += s.calls;
+            total.synthesized += s.synthesized;
+            total.recordedNs += s.recordedNs;
+            total.replayedNs += s.replayedNs;
+        }
+        printRow("total", total.calls, total.synthesized, total.recordedNs, total.replayedNs);
+    } catch (const exception &e) {
+        cerr << "trace_replay: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
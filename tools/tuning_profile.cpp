@@ -0,0 +1,75 @@
+/**
+ * @file tuning_profile.cpp
+ * @brief Measures or shows the tuning profile of this machine's CPU model.
+ *
+ * Usage:
+ *   tuning_profile measure [file] [--repeats N] [--max-msm-terms N] [--dry-run]
+ *   tuning_profile show [file]
+ *
+ * `measure` times the candidate kernels (see Tuning.h) and stores the fastest choices in the
+ * profile file under the running CPU model, unless --dry-run is given. `show` prints the
+ * stored profile of this CPU model next to the built-in defaults. The file defaults to
+ * Tuning_defaultPath().
+ */
+
+#include "../include/Tuning.h"
+#include <iostream>
+
+using namespace std;
+
+static int usage() {
+    cerr << "usage: tuning_profile measure [file] [--repeats N] [--max-msm-terms N] [--dry-run]\n"
+            "       tuning_profile show [file]" << endl;
+    return 2;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) return usage();
+    string cmd = argv[1], path = Tuning_defaultPath();
+    TuningConfig config;
+    bool dryRun = false;
+    for (int i = 2; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--repeats" && i + 1 < argc) {
+            config.repeats = atoi(argv[++i]);
+        } else if (arg == "--max-msm-terms" && i + 1 < argc) {
+            config.maxMsmTerms = strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--dry-run") {
+            dryRun = true;
+        } else if (i == 2 && arg[0] != '-') {
+            path = arg;
+        } else {
+            return usage();
+        }
+    }
+    try {
+        if (cmd == "measure") {
+            auto start = steady_clock::now();
+            TuningProfile profile = Tuning_measure(config);
+            auto ms = duration_cast<milliseconds>(steady_clock::now() - start).count();
+            cout << Tuning_format(profile);
+            if (!dryRun) {
+                Tuning_save(path, profile);
+                cout << "Measured in " << ms << " ms, stored in " << path << endl;
+            } else {
+                cout << "Measured in " << ms << " ms, not stored" << endl;
+            }
+        } else if (cmd == "show") {
+            string cpu = Tuning_cpuModel();
+            bool found = false;
+            for (const TuningProfile &p: Tuning_load(path)) {
+                if (p.cpu != cpu) continue;
+                cout << "# stored in " << path << "\n" << Tuning_format(p) << "\n";
+                found = true;
+            }
+            if (!found) cout << "# no profile for this CPU in " << path << "\n\n";
+            cout << "# built-in defaults\n" << Tuning_format(Tuning_defaults());
+        } else {
+            return usage();
+        }
+    } catch (const exception &e) {
+        cerr << "tuning_profile: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}